@@ -0,0 +1,248 @@
+// Per-call cost of lease callouts on the packet path. Handlers of
+// `DHCP6ExporterImpl` run on Kea CalloutHandle with the arguments Kea passes
+// them ("after"), next to copies of the handlers from before callouts stopped
+// probing for missing arguments with exceptions ("before"), so both are
+// measured in one build. Neither case sends anything to the switch: SOLICIT
+// reaches lease6_select with fake allocation, and renew of unchanged prefix
+// only resolves its route
+//
+// usage: nxos_callout_bench [-n calls] [-r runs]
+#include "client_fixture.hpp"
+#include "dhcp6_exporter_impl.hpp"
+#include "lease_utils.hpp"
+#include "span_tracer.hpp"
+#include <algorithm>
+#include <dhcpsrv/cfgmgr.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <future>
+#include <hooks/callout_manager.h>
+#include <iostream>
+
+using Clock = std::chrono::steady_clock;
+using isc::data::Element;
+using isc::dhcp::Lease6;
+using isc::dhcp::LeaseMgrFactory;
+using isc::dhcp::Pkt6;
+
+namespace {
+    struct Options {
+        size_t calls{1000000};
+        size_t runs{5};
+    };
+
+    void usage(const char* name) {
+        std::cerr << "usage: " << name
+                  << " [-n calls] [-r runs]\n"
+                     "  -n  calls of every callout in one run (default 1000000)\n"
+                     "  -r  runs, median is reported (default 5)\n";
+    }
+
+    size_t parseNumber(const char* text) {
+        char* end{nullptr};
+        long  value{std::strtol(text, &end, 10)};
+        if (*text == '\0' || *end != '\0' || value <= 0) {
+            throw std::invalid_argument(string("invalid number: ") + text);
+        }
+        return static_cast<size_t>(value);
+    }
+
+    Options parseOptions(int argc, char* argv[]) {
+        Options options;
+        int     opt;
+        while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+            switch (opt) {
+                case 'n': options.calls = parseNumber(optarg); break;
+                case 'r': options.runs = parseNumber(optarg); break;
+                default: usage(argv[0]); std::exit(2);
+            }
+        }
+        return options;
+    }
+
+    // lease6_select before the change: every argument is read, also for SOLICIT
+    void selectBefore(CalloutHandle& handle) {
+        SpanTracer::CalloutScope calloutSpan("kea.lease6_select");
+        Pkt6Ptr    query;
+        Subnet6Ptr subnet;
+        Lease6Ptr  lease;
+        bool       fake_allocation{false};
+
+        handle.getArgument("query6", query);
+        handle.getArgument("subnet6", subnet);
+        handle.getArgument("lease6", lease);
+        handle.getArgument("fake_allocation", fake_allocation);
+        if (!fake_allocation) { throw std::logic_error("select must be of SOLICIT"); }
+    }
+
+    // renew of IA_PD before the change, shared_ptrs passed by value
+    void renewProcessBefore(Pkt6Ptr query, Lease6Ptr lease, Option6IAPtr iaOpt) {
+        auto     relayAddr{query->getRelay6LinkAddress(0)};
+        auto     transactionId{query->getTransid()};
+        auto     leaseAddr{lease->addr_};
+        auto     leaseAddrPrefixLength{lease->prefixlen_};
+        uint32_t clientIAID{lease->iaid_};
+        auto     clientDUID{lease->duid_};
+
+        Option6IAPtr queryIA_PDOption{
+            dynamic_pointer_cast<Option6IA>(query->getOption(D6O_IA_PD))};
+        auto queryIAPrefixOptionRaw{queryIA_PDOption->getOption(D6O_IAPREFIX)};
+        if (!queryIAPrefixOptionRaw) {
+            isc_throw(isc::Unexpected, "failed to extract IAPREFIX from IA_PD option");
+        }
+        auto queryIAPrefixOption{
+            dynamic_pointer_cast<Option6IAPrefix>(queryIAPrefixOptionRaw)};
+        auto    queryOriginalAddr{queryIAPrefixOption->getAddress()};
+        uint8_t queryOriginalPrefixLength{queryIAPrefixOption->getLength()};
+
+        Lease6Ptr leaseIA_NA{
+            LeaseUtils::findIA_NALeaseByDUID_IAID(clientDUID, clientIAID)};
+        if (!leaseIA_NA) { throw std::logic_error("IA_NA lease of renew is missing"); }
+        auto oldRouteInfo{RouteExport::makeIA_PD(transactionId, clientIAID, clientDUID,
+                                                 leaseIA_NA->addr_, queryOriginalAddr,
+                                                 queryOriginalPrefixLength)};
+        auto newRouteInfo{RouteExport::makeIA_PD(transactionId, clientIAID, clientDUID,
+                                                 leaseIA_NA->addr_, leaseAddr,
+                                                 leaseAddrPrefixLength)};
+        if (queryOriginalAddr != leaseAddr) {
+            throw std::logic_error("renew must keep its prefix");
+        }
+    }
+
+    // lease6_renew before the change: "ia_na" is probed for IA_PD lease
+    // and Kea doesn't pass it, so every renew of prefix throws
+    void renewBefore(CalloutHandle& handle) {
+        SpanTracer::CalloutScope calloutSpan("kea.lease6_renew");
+        Pkt6Ptr      query;
+        Lease6Ptr    lease;
+        Option6IAPtr ia_opt, tmp;
+        bool         isIA_NA{true};
+
+        handle.getArgument("query6", query);
+        handle.getArgument("lease6", lease);
+
+        try {
+            handle.getArgument("ia_na", tmp);
+            if (!tmp) {
+                isIA_NA = false;
+            } else {
+                ia_opt = tmp;
+            }
+        } catch (const isc::hooks::NoSuchArgument&) { isIA_NA = false; }
+
+        try {
+            handle.getArgument("ia_pd", tmp);
+            if (tmp) { ia_opt = tmp; }
+        } catch (const isc::hooks::NoSuchArgument&) {}
+
+        if (isIA_NA) { throw std::logic_error("renew must be of IA_PD"); }
+        renewProcessBefore(query, lease, ia_opt);
+    }
+
+    // median nanoseconds of one call of `callout` over runs
+    template<typename Callout>
+    double nsPerCall(const Options& options, Callout&& callout) {
+        // first run warms up caches, lease database and allocator
+        for (size_t call = 0; call < options.calls / 10 + 1; ++call) { callout(); }
+        std::vector<double> results;
+        for (size_t run = 0; run < options.runs; ++run) {
+            auto startedAt{Clock::now()};
+            for (size_t call = 0; call < options.calls; ++call) { callout(); }
+            std::chrono::duration<double, std::nano> elapsed{Clock::now() - startedAt};
+            results.push_back(elapsed.count() / static_cast<double>(options.calls));
+        }
+        std::sort(results.begin(), results.end());
+        return results[results.size() / 2];
+    }
+
+    void report(const char* name, double beforeNs, double afterNs) {
+        std::cout << name << ": before " << beforeNs << " ns, after " << afterNs
+                  << " ns, " << beforeNs / afterNs << "x\n";
+    }
+}    // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        usage(argv[0]);
+        return 2;
+    }
+    initTestLogger("nxos-callout-bench");
+    try {
+        isc::dhcp::CfgMgr::instance().setFamily(AF_INET6);
+        LeaseMgrFactory::create("type=memfile universe=6 persist=false");
+
+        MockSwitch mock;
+        mock.start();
+        TempDir  dir;
+        IOThread io;
+        auto     parameters{Element::createMap()};
+        parameters->set("connection-type", Element::create("nxos"));
+        parameters->set("connection-params", mockConnectionParams(mock, dir));
+        DHCP6ExporterImpl impl;
+        impl.configureAndInitClient(parameters);
+        impl.startService(io.ioPtr());
+
+        // client with IA_NA address and delegated prefix behind relay
+        const uint32_t  iaid{1};
+        const auto      duid{indexedDuid(1)};
+        const IOAddress address{"2001:db8:100::10"};
+        const IOAddress prefix{"2001:db8:1000::"};
+        auto            addressLease{boost::make_shared<Lease6>(
+            isc::dhcp::Lease::TYPE_NA, address, duid, iaid, 3000, 4000, 1)};
+        auto            prefixLease{boost::make_shared<Lease6>(
+            isc::dhcp::Lease::TYPE_PD, prefix, duid, iaid, 3000, 4000, 1,
+            isc::dhcp::HWAddrPtr(), 56)};
+        LeaseMgrFactory::instance().addLease(addressLease);
+        LeaseMgrFactory::instance().addLease(prefixLease);
+
+        Pkt6::RelayInfo relay;
+        relay.msg_type_ = DHCPV6_RELAY_FORW;
+        relay.linkaddr_ = IOAddress("2001:db8:100::1");
+        relay.peeraddr_ = IOAddress("fe80::10");
+
+        auto solicit{boost::make_shared<Pkt6>(DHCPV6_SOLICIT, 0x1234)};
+        solicit->addRelayInfo(relay);
+        auto renew{boost::make_shared<Pkt6>(DHCPV6_RENEW, 0x1235)};
+        renew->addRelayInfo(relay);
+        auto iaPd{boost::make_shared<Option6IA>(D6O_IA_PD, iaid)};
+        iaPd->addOption(
+            boost::make_shared<Option6IAPrefix>(D6O_IAPREFIX, prefix, 56, 3000, 4000));
+        renew->addOption(iaPd);
+
+        // arguments of Kea callouts, subnet isn't read by the library
+        auto          manager{boost::make_shared<isc::hooks::CalloutManager>()};
+        CalloutHandle selectHandle(manager);
+        selectHandle.setArgument("query6", Pkt6Ptr(solicit));
+        selectHandle.setArgument("subnet6", Subnet6Ptr());
+        selectHandle.setArgument("lease6", Lease6Ptr(addressLease));
+        selectHandle.setArgument("fake_allocation", true);
+        CalloutHandle renewHandle(manager);
+        renewHandle.setArgument("query6", Pkt6Ptr(renew));
+        renewHandle.setArgument("lease6", Lease6Ptr(prefixLease));
+        renewHandle.setArgument("ia_pd", Option6IAPtr(iaPd));
+
+        report("lease6_select SOLICIT",
+               nsPerCall(options, [&] { selectBefore(selectHandle); }),
+               nsPerCall(options, [&] { impl.handleLease6Select(selectHandle); }));
+        report("lease6_renew IA_PD",
+               nsPerCall(options, [&] { renewBefore(renewHandle); }),
+               nsPerCall(options, [&] { impl.handleLease6Renew(renewHandle); }));
+
+        // service is stopped on IOService thread as in the server
+        std::promise<void> stopped;
+        io.io().post([&] {
+            impl.stopService();
+            stopped.set_value();
+        });
+        stopped.get_future().wait();
+        io.stop();
+        LeaseMgrFactory::destroy();
+    } catch (const std::exception& ex) {
+        std::cerr << "benchmark failed: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
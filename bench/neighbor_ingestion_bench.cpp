@@ -0,0 +1,132 @@
+// Ingestion of the IPv6 neighbor table into MAC -> interface map. The mock
+// switch holds the table and every run reads it through
+// `asyncGetHWAddrToInterfaceNameMapping`, so time covers transfer, streaming
+// parse and map build, as on the server during reconciliation. It also covers
+// the mock formatting its response, which is a plain string append per row
+//
+// usage: nxos_neighbor_ingestion_bench [-n neighbors] [-v vlans] [-r runs]
+//                                      [-e httplib|asio]
+//
+// Without -n tables of 1000, 10000 and 100000 neighbors are measured
+#include "client_fixture.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    struct Options {
+        std::vector<size_t> sizes{1000, 10000, 100000};
+        size_t              vlans{16};
+        size_t              runs{5};
+        string              engine{"httplib"};
+    };
+
+    void usage(const char* name) {
+        std::cerr << "usage: " << name
+                  << " [-n neighbors] [-v vlans] [-r runs] [-e httplib|asio]\n"
+                     "  -n  neighbors of the switch, may be repeated"
+                     " (default 1000, 10000 and 100000)\n"
+                     "  -v  vlan interfaces neighbors are spread over (default 16)\n"
+                     "  -r  reads of every table (default 5)\n"
+                     "  -e  http engine of the client (default httplib)\n";
+    }
+
+    size_t parseNumber(const char* text) {
+        char* end{nullptr};
+        long  value{std::strtol(text, &end, 10)};
+        if (*text == '\0' || *end != '\0' || value <= 0) {
+            throw std::invalid_argument(string("invalid number: ") + text);
+        }
+        return static_cast<size_t>(value);
+    }
+
+    Options parseOptions(int argc, char* argv[]) {
+        Options             options;
+        std::vector<size_t> sizes;
+        int                 opt;
+        while ((opt = getopt(argc, argv, "n:v:r:e:")) != -1) {
+            switch (opt) {
+                case 'n': sizes.push_back(parseNumber(optarg)); break;
+                case 'v': options.vlans = parseNumber(optarg); break;
+                case 'r': options.runs = parseNumber(optarg); break;
+                case 'e': options.engine = optarg; break;
+                default: usage(argv[0]); std::exit(2);
+            }
+        }
+        if (!sizes.empty()) { options.sizes = std::move(sizes); }
+        return options;
+    }
+
+    // seconds of one read and size of the map it produced
+    std::pair<double, size_t> readNeighbors(ManagementClient& client) {
+        std::mutex                     mutex;
+        ManagementClient::HWAddrMapPtr result;
+        std::atomic<bool>              done{false};
+        bool                           failed{false};
+        auto                           startedAt{Clock::now()};
+        client.asyncGetHWAddrToInterfaceNameMapping(
+            [&](ManagementClient::HWAddrMapPtr neighbors, bool readFailed) {
+                std::unique_lock lock(mutex);
+                result = std::move(neighbors);
+                failed = readFailed;
+                done   = true;
+            });
+        while (!done) { std::this_thread::sleep_for(std::chrono::microseconds(100)); }
+        double seconds{std::chrono::duration<double>(Clock::now() - startedAt).count()};
+        std::unique_lock lock(mutex);
+        if (failed || !result) { throw std::runtime_error("neighbor table read failed"); }
+        return {seconds, result->size()};
+    }
+
+    void benchSize(const Options& options, size_t neighbors) {
+        MockSwitch mock;
+        mock.populate(neighbors, options.vlans);
+        mock.start();
+
+        TempDir  dir;
+        IOThread io;
+        auto     params{mockConnectionParams(mock, dir, options.engine)};
+        auto     client{ManagementClient::init("nxos", params)};
+        client->startClient(io.io());
+
+        // first read opens connection and grows buffers of the client
+        readNeighbors(*client);
+        std::vector<double> times;
+        size_t              mapped{0};
+        for (size_t run = 0; run < options.runs; ++run) {
+            auto [seconds, size] = readNeighbors(*client);
+            times.push_back(seconds);
+            mapped = size;
+        }
+        client->stopClient();
+        io.stop();
+
+        std::sort(times.begin(), times.end());
+        double median{times[times.size() / 2]};
+        std::cout << neighbors << " neighbors: mapped " << mapped << ", min "
+                  << times.front() * 1e3 << " ms, median " << median * 1e3 << " ms, "
+                  << static_cast<double>(neighbors) / median << " entries/s\n";
+    }
+}    // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        usage(argv[0]);
+        return 2;
+    }
+    initTestLogger("nxos-neighbor-ingestion-bench");
+    try {
+        for (auto size : options.sizes) { benchSize(options, size); }
+    } catch (const std::exception& ex) {
+        std::cerr << "benchmark failed: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,201 @@
+// Set operations of `PrefixSet` over route tables of resync, without switch.
+// Desired set holds `n` /56 delegated prefixes, switch set holds the same
+// prefixes less `c` percent missing on the switch, as many stale ones and a
+// /48 aggregate over every 256 of them. Entries are shuffled before every
+// build, as routes come from lease database and switch in no useful order.
+// Every run measures:
+// - build: sort of `n` entries of the desired set
+// - diff: merge pass of desired set against switch set
+// - longest-match: lookup of one address of every desired prefix in switch set,
+//   missing prefixes fall back to their aggregate
+// - overlapping-pairs: every (aggregate, /56) pair of switch set
+//
+// usage: nxos_prefix_set_bench [-n prefixes] [-c changed-percent] [-r runs]
+//
+// Without -n sets of 1000000 prefixes are measured
+#include "prefix_set.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    struct Options {
+        std::vector<size_t> sizes{1000000};
+        size_t              changedPercent{1};
+        size_t              runs{5};
+    };
+
+    // 2001:db8::/32, /56 prefixes take the next 24 bits
+    constexpr uint64_t BasePrefix{0x20010db800000000};
+    constexpr size_t   MaxPrefixes{size_t{1} << 24};
+    // /56 prefixes under one /48
+    constexpr size_t   AggregatedPrefixes{256};
+
+    void usage(const char* name) {
+        std::cerr << "usage: " << name
+                  << " [-n prefixes] [-c changed-percent] [-r runs]\n"
+                     "  -n  /56 prefixes of desired set, may be repeated"
+                     " (default 1000000)\n"
+                     "  -c  percent of prefixes missing on the switch, as many are"
+                     " stale (default 1)\n"
+                     "  -r  runs of every operation (default 5)\n";
+    }
+
+    size_t parseNumber(const char* text) {
+        char* end{nullptr};
+        long  value{std::strtol(text, &end, 10)};
+        if (*text == '\0' || *end != '\0' || value < 0) {
+            throw std::invalid_argument(string("invalid number: ") + text);
+        }
+        return static_cast<size_t>(value);
+    }
+
+    Options parseOptions(int argc, char* argv[]) {
+        Options             options;
+        std::vector<size_t> sizes;
+        int                 opt;
+        while ((opt = getopt(argc, argv, "n:c:r:")) != -1) {
+            switch (opt) {
+                case 'n': sizes.push_back(parseNumber(optarg)); break;
+                case 'c': options.changedPercent = parseNumber(optarg); break;
+                case 'r': options.runs = parseNumber(optarg); break;
+                default: usage(argv[0]); std::exit(2);
+            }
+        }
+        if (!sizes.empty()) { options.sizes = std::move(sizes); }
+        if (options.changedPercent > 100 || options.runs == 0) {
+            throw std::invalid_argument("changed-percent or runs out of range");
+        }
+        return options;
+    }
+
+    IPv6Prefix pdPrefix(size_t index) {
+        return {BasePrefix | (static_cast<uint64_t>(index) << 8), 0, 56};
+    }
+
+    // min and median of one operation over all runs
+    struct Timing {
+        std::vector<double> times;
+
+        template<typename Operation>
+        void measure(Operation&& operation) {
+            auto startedAt{Clock::now()};
+            operation();
+            std::chrono::duration<double> time{Clock::now() - startedAt};
+            times.push_back(time.count());
+        }
+
+        void print(const char* name, size_t items) {
+            std::sort(times.begin(), times.end());
+            double median{times[times.size() / 2]};
+            std::cout << "  " << name << ": min " << times.front() * 1e3
+                      << " ms, median " << median * 1e3 << " ms, "
+                      << median * 1e9 / static_cast<double>(items) << " ns/prefix\n";
+        }
+    };
+
+    void check(bool condition, const char* what) {
+        if (!condition) { throw std::runtime_error(what); }
+    }
+
+    void benchSize(const Options& options, size_t prefixes) {
+        size_t changed{prefixes * options.changedPercent / 100};
+        if (prefixes == 0 || prefixes + changed > MaxPrefixes) {
+            throw std::invalid_argument("prefixes out of range");
+        }
+        std::mt19937_64    random(prefixes);
+        PrefixSet::Entries desiredEntries;
+        desiredEntries.reserve(prefixes);
+        for (size_t index = 0; index < prefixes; ++index) {
+            desiredEntries.push_back({pdPrefix(index), static_cast<uint32_t>(index)});
+        }
+        // first `changed` prefixes are missing on the switch, the last are stale
+        PrefixSet::Entries switchEntries;
+        for (size_t index = changed; index < prefixes + changed; ++index) {
+            switchEntries.push_back({pdPrefix(index), static_cast<uint32_t>(index)});
+        }
+        size_t aggregates{(prefixes + changed + AggregatedPrefixes - 1) /
+                          AggregatedPrefixes};
+        for (size_t aggregate = 0; aggregate < aggregates; ++aggregate) {
+            auto prefix{pdPrefix(aggregate * AggregatedPrefixes).truncate(48)};
+            switchEntries.push_back(
+                {prefix, static_cast<uint32_t>(MaxPrefixes + aggregate)});
+        }
+        std::shuffle(switchEntries.begin(), switchEntries.end(), random);
+        PrefixSet switchRoutes(std::move(switchEntries));
+
+        std::vector<IPv6Prefix> lookups;
+        lookups.reserve(prefixes);
+        for (size_t index = 0; index < prefixes; ++index) {
+            auto prefix{pdPrefix(index)};
+            lookups.push_back({prefix.high | 0xff, 1, 128});
+        }
+        std::shuffle(lookups.begin(), lookups.end(), random);
+
+        Timing build, diff, longestMatch, overlappingPairs;
+        for (size_t run = 0; run < options.runs; ++run) {
+            auto entries{desiredEntries};
+            std::shuffle(entries.begin(), entries.end(), random);
+            PrefixSet desired;
+            build.measure([&] { desired = PrefixSet(std::move(entries)); });
+
+            size_t missing{0}, stale{0}, installed{0};
+            diff.measure([&] {
+                PrefixSet::diff(
+                    desired, switchRoutes, [&](const PrefixSet::Entry&) { missing++; },
+                    [&](const PrefixSet::Entry&) { stale++; },
+                    [&](PrefixSet::Iterator, PrefixSet::Iterator, PrefixSet::Iterator,
+                        PrefixSet::Iterator) { installed++; });
+            });
+            check(missing == changed && stale == changed + aggregates &&
+                      installed == prefixes - changed,
+                  "diff doesn't match generated sets");
+
+            size_t exact{0}, covered{0};
+            longestMatch.measure([&] {
+                for (const auto& lookup : lookups) {
+                    auto match{switchRoutes.longestMatch(lookup)};
+                    if (!match) { continue; }
+                    (match->prefix.length == 56 ? exact : covered)++;
+                }
+            });
+            check(exact == prefixes - changed && covered == changed,
+                  "longest match doesn't match generated sets");
+
+            size_t pairs{0};
+            overlappingPairs.measure(
+                [&] { pairs = switchRoutes.overlappingPairs().size(); });
+            check(pairs == prefixes, "overlapping pairs don't match generated sets");
+        }
+
+        std::cout << prefixes << " prefixes, " << switchRoutes.size()
+                  << " on switch, " << changed << " missing and stale:\n";
+        build.print("build", prefixes);
+        diff.print("diff", prefixes + switchRoutes.size());
+        longestMatch.print("longest-match", prefixes);
+        overlappingPairs.print("overlapping-pairs", switchRoutes.size());
+    }
+}    // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        usage(argv[0]);
+        return 2;
+    }
+    try {
+        for (auto size : options.sizes) { benchSize(options, size); }
+    } catch (const std::exception& ex) {
+        std::cerr << "benchmark failed: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,314 @@
+// Restore of routes from lease database on startup, as after a reload of the
+// switch. A memfile lease file of `n` clients is generated with Kea's own
+// writer, every client holding an IA_NA address and, for part of them, a
+// delegated prefix. The memfile backend boots from that file, the service
+// connects to the mock switch and restores all routes on its first heartbeat.
+// Every size runs in a process of its own, so peak RSS is of that size only,
+// and the mock switch runs in a child of it, so its route table isn't counted
+//
+// usage: nxos_restore_bench [-n leases] [-s subnets] [-p pd-percent] [-v vlans]
+//                           [-m 0|1] [-d directory]
+//
+// Without -n lease databases of 10000, 100000 and 1000000 clients are measured.
+// Kea versions that restrict lease files to their data directory need -d
+#include "client_fixture.hpp"
+#include "dhcp6_exporter_service.hpp"
+#include <cstdlib>
+#include <dhcp/dhcp4.h>
+#include <dhcpsrv/cfgmgr.h>
+#include <dhcpsrv/csv_lease_file6.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <future>
+#include <iostream>
+#include <sys/wait.h>
+#include <util/multi_threading_mgr.h>
+
+using Clock = std::chrono::steady_clock;
+using isc::data::Element;
+using isc::dhcp::Lease6;
+using isc::dhcp::LeaseMgrFactory;
+
+namespace {
+    struct Options {
+        std::vector<size_t> sizes{10000, 100000, 1000000};
+        size_t              subnets{16};
+        size_t              pdPercent{50};
+        size_t              vlans{16};
+        bool                multiThreading{true};
+        string              directory;
+    };
+
+    // what the mock switch saw during one run
+    struct SwitchResult {
+        uint64_t requests{0};
+        uint64_t failedCommands{0};
+        uint64_t routes{0};
+    };
+
+    constexpr auto RestoreTimeout{std::chrono::minutes(30)};
+
+    void usage(const char* name) {
+        std::cerr << "usage: " << name
+                  << " [-n leases] [-s subnets] [-p pd-percent] [-v vlans] [-m 0|1]"
+                     " [-d directory]\n"
+                     "  -n  clients with IA_NA lease, may be repeated"
+                     " (default 10000, 100000 and 1000000)\n"
+                     "  -s  /40 subnets clients are spread over (default 16)\n"
+                     "  -p  percent of clients also holding IA_PD lease (default 50)\n"
+                     "  -v  vlan interfaces neighbors are spread over (default 16)\n"
+                     "  -m  Kea multi-threading mode (default 1)\n"
+                     "  -d  directory of lease file (default temporary directory)\n";
+    }
+
+    size_t parseNumber(const char* text) {
+        char* end{nullptr};
+        long  value{std::strtol(text, &end, 10)};
+        if (*text == '\0' || *end != '\0' || value < 0) {
+            throw std::invalid_argument(string("invalid number: ") + text);
+        }
+        return static_cast<size_t>(value);
+    }
+
+    Options parseOptions(int argc, char* argv[]) {
+        Options             options;
+        std::vector<size_t> sizes;
+        int                 opt;
+        while ((opt = getopt(argc, argv, "n:s:p:v:m:d:")) != -1) {
+            switch (opt) {
+                case 'n': sizes.push_back(parseNumber(optarg)); break;
+                case 's': options.subnets = parseNumber(optarg); break;
+                case 'p': options.pdPercent = parseNumber(optarg); break;
+                case 'v': options.vlans = parseNumber(optarg); break;
+                case 'm': options.multiThreading = parseNumber(optarg) != 0; break;
+                case 'd': options.directory = optarg; break;
+                default: usage(argv[0]); std::exit(2);
+            }
+        }
+        if (!sizes.empty()) { options.sizes = std::move(sizes); }
+        if (options.subnets == 0 || options.subnets > 256 || options.pdPercent > 100 ||
+            options.vlans == 0) {
+            throw std::invalid_argument("subnets, pd-percent or vlans out of range");
+        }
+        for (auto size : options.sizes) {
+            if (size == 0) { throw std::invalid_argument("leases must be positive"); }
+        }
+        return options;
+    }
+
+    IOAddress subnetPrefix(size_t subnet) {
+        return offsetAddress(IOAddress("2001:db8::"), subnet, 40);
+    }
+
+    // MAC of neighbor `client` of `MockSwitch::populate`
+    isc::dhcp::HWAddrPtr clientHWAddr(size_t client) {
+        std::vector<uint8_t> mac{0x02};
+        for (int shift : {32, 24, 16, 8, 0}) {
+            mac.push_back(static_cast<uint8_t>((client >> shift) & 0xff));
+        }
+        return boost::make_shared<isc::dhcp::HWAddr>(mac, isc::dhcp::HTYPE_ETHER);
+    }
+
+    bool holdsPrefix(const Options& options, size_t client) {
+        return client % 100 < options.pdPercent;
+    }
+
+    // IA_NA lease of every client and IA_PD lease of `pdPercent` of them, clients
+    // are spread over subnets round robin. Returns leases written
+    size_t writeLeaseFile(const Options& options, size_t clients, const string& path) {
+        isc::dhcp::CSVLeaseFile6 file(path);
+        file.recreate();
+        size_t written{0};
+        for (size_t client = 0; client < clients; ++client) {
+            auto     subnet{client % options.subnets};
+            auto     index{client / options.subnets};
+            auto     base{subnetPrefix(subnet)};
+            auto     duid{indexedDuid(client)};
+            uint32_t subnetId{static_cast<uint32_t>(subnet + 1)};
+            Lease6   address(isc::dhcp::Lease::TYPE_NA,
+                             offsetAddress(base, index + 16, 128), duid, 1, 3000, 4000,
+                             subnetId, clientHWAddr(client));
+            file.append(address);
+            written++;
+            if (!holdsPrefix(options, client)) { continue; }
+            Lease6 prefix(isc::dhcp::Lease::TYPE_PD,
+                          offsetAddress(offsetAddress(base, 1, 48), index, 64), duid, 1,
+                          3000, 4000, subnetId, isc::dhcp::HWAddrPtr(), 64);
+            file.append(prefix);
+            written++;
+        }
+        file.close();
+        return written;
+    }
+
+    // serves neighbors of `clients` until parent closes `control`, returns port
+    // and then what it saw through `resultPipe`
+    [[noreturn]] void runMockSwitch(const Options& options, size_t clients,
+                                    int resultPipe, int control) {
+        MockSwitch mock;
+        mock.populate(clients, options.vlans);
+        mock.start();
+        int port{mock.port()};
+        if (write(resultPipe, &port, sizeof(port)) != sizeof(port)) { _exit(1); }
+        char byte;
+        while (read(control, &byte, 1) > 0) {}
+        auto         stats{mock.stats()};
+        SwitchResult result{stats.requests, stats.failedCommands, mock.routeCount()};
+        mock.stop();
+        if (write(resultPipe, &result, sizeof(result)) != sizeof(result)) { _exit(1); }
+        _exit(0);
+    }
+
+    int64_t statValue(const isc::data::ConstElementPtr& stats, const char* name) {
+        return stats->get(name)->intValue();
+    }
+
+    void runSize(const Options& options, size_t clients, const TempDir& dir) {
+        // fork before any thread of this run is started
+        int resultPipe[2];
+        int control[2];
+        if (pipe(resultPipe) != 0 || pipe(control) != 0) {
+            throw std::runtime_error("pipe failed");
+        }
+        pid_t child{fork()};
+        if (child < 0) { throw std::runtime_error("fork failed"); }
+        if (child == 0) {
+            close(resultPipe[0]);
+            close(control[1]);
+            runMockSwitch(options, clients, resultPipe[1], control[0]);
+        }
+        close(resultPipe[1]);
+        close(control[0]);
+        int port{0};
+        if (read(resultPipe[0], &port, sizeof(port)) != sizeof(port)) {
+            throw std::runtime_error("mock switch failed to start");
+        }
+
+        auto path{(options.directory.empty() ? dir.path() : options.directory) +
+                  "/restore-bench-" + std::to_string(clients) + ".csv"};
+        auto writeStartedAt{Clock::now()};
+        auto leases{writeLeaseFile(options, clients, path)};
+        std::chrono::duration<double> writeTime{Clock::now() - writeStartedAt};
+
+        auto& cfgMgr{isc::dhcp::CfgMgr::instance()};
+        cfgMgr.setFamily(AF_INET6);
+        auto subnets{cfgMgr.getStagingCfg()->getCfgSubnets6()};
+        for (size_t subnet = 0; subnet < options.subnets; ++subnet) {
+            subnets->add(boost::make_shared<isc::dhcp::Subnet6>(
+                subnetPrefix(subnet), 40, 1000, 2000, 3000, 4000,
+                static_cast<uint32_t>(subnet + 1)));
+        }
+        cfgMgr.commit();
+        isc::util::MultiThreadingMgr::instance().setMode(options.multiThreading);
+
+        auto loadStartedAt{Clock::now()};
+        // lease file is loaded only with persist, lfc would rewrite it during run
+        LeaseMgrFactory::create(
+            "type=memfile universe=6 persist=true lfc-interval=0 name=" + path);
+        std::chrono::duration<double> loadTime{Clock::now() - loadStartedAt};
+
+        auto url{"http://127.0.0.1:" + std::to_string(port) + "/"};
+        auto connParams{Element::createMap()};
+        connParams->set("host", Element::create(url));
+        auto credentials{Element::createMap()};
+        credentials->set("login", Element::create("admin"));
+        credentials->set("password", Element::create("admin"));
+        connParams->set("credentials", credentials);
+
+        DHCP6ExporterService::Params params{
+            Element::create("nxos"), connParams, nullptr, nullptr, nullptr, nullptr};
+        IOThread io;
+        auto     service{std::make_shared<DHCP6ExporterService>(params)};
+        service->setIOService(io.ioPtr());
+        // first heartbeat finds switch "restored" and restores all leases
+        auto restoreStartedAt{Clock::now()};
+        service->startService();
+        isc::data::ConstElementPtr stats;
+        while (true) {
+            stats = service->restoreStats();
+            if (statValue(stats, "restores") > 0 && !stats->get("running")->boolValue()) {
+                break;
+            }
+            if (Clock::now() - restoreStartedAt > RestoreTimeout) {
+                throw std::runtime_error("restore didn't finish");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::chrono::duration<double> restoreTime{Clock::now() - restoreStartedAt};
+
+        // service is stopped on IOService thread as in the server
+        std::promise<void> stopped;
+        io.io().post([&] {
+            service->stopService();
+            stopped.set_value();
+        });
+        stopped.get_future().wait();
+        io.stop();
+        LeaseMgrFactory::destroy();
+
+        close(control[1]);
+        SwitchResult result;
+        bool         reported{read(resultPipe[0], &result, sizeof(result)) ==
+                      sizeof(result)};
+        int          status{0};
+        waitpid(child, &status, 0);
+        close(resultPipe[0]);
+        std::remove(path.c_str());
+        if (!reported) { throw std::runtime_error("mock switch failed"); }
+
+        auto routes{statValue(stats, "routes")};
+        auto seconds{restoreTime.count()};
+        std::cout << clients << " clients, " << leases << " leases: write "
+                  << writeTime.count() << " s, load " << loadTime.count()
+                  << " s, restore " << seconds << " s (collect "
+                  << statValue(stats, "collect-ms") << " ms, apply "
+                  << statValue(stats, "apply-ms") << " ms), peak RSS "
+                  << statValue(stats, "peak-rss-kb") / 1024 << " MiB\n"
+                  << "  routes " << routes << ", on switch " << result.routes
+                  << ", failed " << statValue(stats, "failed") << ", "
+                  << static_cast<double>(routes) / seconds << " routes/s, requests "
+                  << result.requests << " ("
+                  << statValue(stats, "requests") << " bulk), "
+                  << static_cast<double>(result.requests) / seconds << " requests/s\n";
+        if (result.failedCommands || static_cast<uint64_t>(routes) != result.routes) {
+            throw std::runtime_error("switch doesn't hold restored routes");
+        }
+    }
+}    // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        usage(argv[0]);
+        return 2;
+    }
+    TempDir dir;
+    for (auto clients : options.sizes) {
+        std::cout.flush();
+        pid_t child{fork()};
+        if (child < 0) {
+            std::cerr << "benchmark failed: fork failed\n";
+            return 1;
+        }
+        if (child == 0) {
+            initTestLogger("nxos-restore-bench");
+            try {
+                runSize(options, clients, dir);
+            } catch (const std::exception& ex) {
+                std::cerr << "benchmark failed: " << ex.what() << "\n";
+                std::cout.flush();
+                _exit(1);
+            }
+            std::cout.flush();
+            _exit(0);
+        }
+        int status{0};
+        if (waitpid(child, &status, 0) != child || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+// TLS handshakes of NX-API over HTTPS under load. Routes are applied and
+// removed through persistent connections of the asio engine against mock
+// switch, which closes every connection after `-k` requests, so reconnects
+// show whether sessions are resumed instead of negotiated again.
+//
+// usage: nxos_tls_handshake_bench [-n routes] [-c max-connections]
+//                                 [-k keep-alive-requests] [-l latency-ms]
+#include "client_fixture.hpp"
+#include <cstdlib>
+#include <iostream>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    struct Options {
+        size_t routes{10000};
+        size_t maxConnections{8};
+        // 0 keeps connections open for the whole run
+        size_t keepAliveRequests{100};
+        long   latencyMs{0};
+    };
+
+    void usage(const char* name) {
+        std::cerr << "usage: " << name
+                  << " [-n routes] [-c max-connections] [-k keep-alive-requests]"
+                     " [-l latency-ms]\n"
+                     "  -n  routes applied and removed (default 10000)\n"
+                     "  -c  connections of the client (default 8)\n"
+                     "  -k  requests of one connection, 0 is unlimited (default 100)\n"
+                     "  -l  delay of every response of the switch (default 0)\n";
+    }
+
+    size_t parseNumber(const char* text) {
+        char* end{nullptr};
+        long  value{std::strtol(text, &end, 10)};
+        if (*text == '\0' || *end != '\0' || value < 0) {
+            throw std::invalid_argument(string("invalid number: ") + text);
+        }
+        return static_cast<size_t>(value);
+    }
+
+    Options parseOptions(int argc, char* argv[]) {
+        Options options;
+        int     opt;
+        while ((opt = getopt(argc, argv, "n:c:k:l:")) != -1) {
+            switch (opt) {
+                case 'n': options.routes = parseNumber(optarg); break;
+                case 'c': options.maxConnections = parseNumber(optarg); break;
+                case 'k': options.keepAliveRequests = parseNumber(optarg); break;
+                case 'l': {
+                    options.latencyMs = static_cast<long>(parseNumber(optarg));
+                } break;
+                default: usage(argv[0]); std::exit(2);
+            }
+        }
+        return options;
+    }
+}    // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        usage(argv[0]);
+        return 2;
+    }
+    initTestLogger("nxos-tls-handshake-bench");
+    try {
+        MockSwitch::Config config;
+        config.tls               = true;
+        config.keepAliveRequests = options.keepAliveRequests;
+        config.latency           = std::chrono::milliseconds(options.latencyMs);
+        MockSwitch mock(config);
+        mock.start();
+
+        TempDir dir;
+        auto    params{mockConnectionParams(mock, dir, "asio")};
+        auto    maxConnections{static_cast<long long>(options.maxConnections)};
+        params->set("max-connections", isc::data::Element::create(maxConnections));
+        IOThread       io;
+        TrafficCounter traffic;
+        auto           client{ManagementClient::init("nxos", params)};
+        client->setTrafficObserver(traffic.observer());
+        client->startClient(io.io());
+
+        auto routes{makePdRoutes(options.routes)};
+        auto startedAt{Clock::now()};
+        // routes are removed after all of them are applied,
+        // otherwise remove may reach the switch before its apply
+        for (const auto& route : routes) { client->sendRoutesToSwitch(route); }
+        const auto timeout{std::chrono::minutes(10)};
+        bool       finished{traffic.waitTotal(routes.size(), timeout)};
+        for (const auto& route : routes) { client->removeRoutesFromSwitch(route); }
+        finished = finished && traffic.waitTotal(2 * routes.size(), timeout);
+        double seconds{std::chrono::duration<double>(Clock::now() - startedAt).count()};
+        client->stopClient();
+        io.stop();
+        if (!finished) { std::cerr << "not all requests finished\n"; }
+
+        auto stats{mock.stats()};
+        auto fullHandshakes{stats.connections - stats.resumedSessions};
+        std::cout << "requests: " << stats.requests << " (unanswered "
+                  << traffic.unanswered() << ") in " << seconds << " s, "
+                  << static_cast<double>(stats.requests) / seconds << " requests/s\n"
+                  << "connections: " << stats.connections
+                  << ", full handshakes: " << fullHandshakes
+                  << ", resumed handshakes: " << stats.resumedSessions << "\n"
+                  << "requests per full handshake: "
+                  << (fullHandshakes ? static_cast<double>(stats.requests) /
+                                           static_cast<double>(fullHandshakes)
+                                     : 0)
+                  << "\n";
+        return finished ? 0 : 1;
+    } catch (const std::exception& ex) {
+        std::cerr << "benchmark failed: " << ex.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "nxos_http_client.hpp"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace boost::asio {
+    class io_context;
+}    // namespace boost::asio
+
+// HTTP/1.1 client engine on asio. Connect, TLS handshake, write and read are
+// asynchronous operations on io_context of NXOSHttpClient, so request waiting
+// for the switch doesn't hold a thread and number of requests in flight is
+// limited only by connections per host. Keep-alive connections are reused,
+// chunked responses are decoded while they are received. All HTTPS connections
+// share one TLS context and offer the last negotiated session
+class AsyncHttpEngine {
+  public:
+    // returns false to abort transfer, request completes with CANCELED
+    using BodyReceiver = std::function<bool(const char* data, size_t size)>;
+
+    struct Request {
+        NXOSHttpClient::Method  method{NXOSHttpClient::Method::POST};
+        string                  uri;
+        string                  body;
+        // JSON-RPC if empty
+        string                  contentType;
+        NXOSHttpClient::Headers headers;
+        int                     timeout{10000};
+        // body is passed to receiver while it's received, handler gets empty body
+        BodyReceiver receiver;
+        // body owned by caller until handler is called, sent instead of `body`
+        const string* bodyRef{nullptr};
+    };
+
+    // `body` is owned by engine, handler may swap or move from it.
+    // Swapped buffer receives next response of the connection
+    using ResponseHandler = std::function<void(
+        NXOSHttpClient::ResponseError, NXOSHttpClient::StatusCode, string& body)>;
+
+  public:
+    AsyncHttpEngine(boost::asio::io_context& ioContext, size_t maxConnections);
+    ~AsyncHttpEngine();
+    AsyncHttpEngine(const AsyncHttpEngine&)            = delete;
+    AsyncHttpEngine& operator=(const AsyncHttpEngine&) = delete;
+
+    void setBasicAuth(const isc::http::BasicHttpAuthPtr& auth);
+
+    // loads client certificate and key, throws on failure. Idle HTTPS
+    // connections of previous credentials are closed, busy ones are closed
+    // after their request
+    void setTLSInfo(const TLSInfo& tlsInfo);
+
+    NXOSHttpClient::TLSStats getTLSStats() const;
+
+    // DER of the last resumable session, empty if none
+    string tlsSession() const;
+
+    // session offered on new connections until the switch negotiates another
+    // one, e.g. session of previous engine. Ignored without TLS info
+    void setTLSSession(const string& session);
+
+    // handler is called on thread of io_context
+    void send(const Url& url, Request&& request, ResponseHandler&& handler);
+
+    // close all connections, queued requests complete with CANCELED
+    void stop();
+
+  private:
+    class Connection;
+    class HostPool;
+    struct TLSState;
+
+    using HostPoolPtr = std::shared_ptr<HostPool>;
+
+  private:
+    boost::asio::io_context&  m_ioContext;
+    size_t                    m_maxConnections;
+    string                    m_authorization;
+    std::shared_ptr<TLSState> m_tls;
+    // handshakes of replaced contexts
+    NXOSHttpClient::TLSStats m_retiredStats;
+
+    mutable std::mutex m_poolsMutex;
+    // by raw URL, lookup doesn't build URL text for every request
+    std::unordered_map<string, HostPoolPtr> m_pools;
+    bool                                    m_stopped{false};
+};
@@ -0,0 +1,10 @@
+#pragma once
+#include "common.hpp"
+
+// Value of positive integer `name` of `section` map of hook parameters,
+// `defaultValue` if it's missing. Throws isc::ConfigError naming the field
+// if it isn't a positive integer
+size_t parsePositiveInteger(ConstElementPtr config,
+                            const char*     section,
+                            const char*     name,
+                            size_t          defaultValue);
@@ -1,6 +1,9 @@
 #pragma once
 #include "common.hpp"
 #include "dhcp6_exporter_service.hpp"
+#include "lease_capture.hpp"
+#include "service_handover.hpp"
+#include <optional>
 
 class DHCP6ExporterImpl;
 using DHCP6ExporterImplPtr = std::shared_ptr<DHCP6ExporterImpl>;
@@ -12,12 +15,26 @@ class DHCP6ExporterImpl {
     DHCP6ExporterImpl(const DHCP6ExporterImpl&)            = delete;
     DHCP6ExporterImpl& operator=(const DHCP6ExporterImpl&) = delete;
 
+    // new service takes over state of previous load if "handover" is configured
     void configureAndInitClient(LibraryHandle& handle);
 
+    // "parameters" map of the library, for benchmarks run without hooks manager
+    void configureAndInitClient(ConstElementPtr parameters);
+
     void startService(const IOServicePtr& io_service);
 
+    // Kea unloads the library both on reconfiguration and on shutdown, service
+    // is always stopped and hands its state over to the next load
     void stopService();
 
+    isc::data::ElementPtr flapDampingStats();
+
+    // counters of lease capture, null if capture is disabled
+    isc::data::ElementPtr captureStats();
+
+    // null until hook is configured
+    const DHCP6ExporterServicePtr& service() const { return m_service; }
+
     void handleLease6Select(CalloutHandle& handle);
 
     void handleLease6Expire(CalloutHandle& handle);
@@ -32,11 +49,25 @@ class DHCP6ExporterImpl {
 
   private:
     DHCP6ExporterServicePtr m_service;
+    // state of stopped service is written for the next load if configured
+    std::optional<ServiceHandover::Config> m_handover;
+    // lease events are recorded for replay if "capture" is configured
+    std::unique_ptr<LeaseCapture> m_capture;
 
   private:
+    // write buffered events and close capture file
+    void stopCapture();
+
+    // failure is logged, the next load starts cold
+    void writeHandover();
+
+    // route operations of lease events, recorded by capture before the service
+    void exportRoute(const RouteExport& route);
+    void removeRoute(const RouteExport& route);
+    void reclaimRoute(const RouteExport& route);
+
     template<bool IsRebindProcess>
-    void handleRenewRebindProcess(Pkt6Ptr      query,
-                                  Lease6Ptr    lease,
-                                  Option6IAPtr iaOpt,
-                                  bool         isIA_NA);
+    void handleRenewRebindProcess(const Pkt6Ptr&   query,
+                                  const Lease6Ptr& lease,
+                                  bool             isIA_NA);
 };
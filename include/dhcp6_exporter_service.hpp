@@ -1,21 +1,58 @@
 #pragma once
 #include "common.hpp"
+#include "flap_damper.hpp"
+#include "ha_ownership.hpp"
 #include "heartbeat_service.hpp"
 #include "management_client.hpp"
 #include "route_export.hpp"
+#include "route_spool.hpp"
+#include "service_handover.hpp"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <util/thread_pool.h>
 
 class DHCP6ExporterService;
 using DHCP6ExporterServicePtr = boost::shared_ptr<DHCP6ExporterService>;
 
 class DHCP6ExporterService {
   public:
-    DHCP6ExporterService(ConstElementPtr mgmtConnType, ConstElementPtr mgmtConnParams);
+    // hook parameters of the service.
+    // Null `flapDamping` disables damping of route operations,
+    // null `spool` disables holding of operations during switch outage,
+    // null `ha` makes this server the only writer to the switch,
+    // null `subnetVrfs` exports routes of all subnets into default VRF
+    struct Params {
+        ConstElementPtr connType;
+        ConstElementPtr connParams;
+        ConstElementPtr flapDamping;
+        ConstElementPtr spool;
+        ConstElementPtr ha;
+        ConstElementPtr subnetVrfs;
+    };
+
+  public:
+    explicit DHCP6ExporterService(const Params& params);
     DHCP6ExporterService(const DHCP6ExporterService&)            = delete;
     DHCP6ExporterService& operator=(const DHCP6ExporterService&) = delete;
 
+    const Params& params() const { return m_params; }
+
+    // passive state of stopped service for the next load of the hook
+    ServiceHandover handover();
+
+    // State of previous load of the hook, applied before `startService`.
+    // Returns false and ignores state of another connection to the switch
+    bool adopt(ServiceHandover&& handover);
+
     void         setIOService(const IOServicePtr& io_service);
     IOServicePtr getIOService();
 
+    string connectionName() const { return m_client->connectionName(); }
+
     void startService();
 
     void stopService();
@@ -24,12 +61,242 @@ class DHCP6ExporterService {
 
     void removeRoute(const RouteExport& route);
 
+    // removal of reclaimed lease, every server of HA pair reclaims its copy
+    // of lease database, so it's sent only by owner of full state
+    void reclaimRoute(const RouteExport& route);
+
+    // VRF routes of leases of the subnet are exported into
+    VrfId subnetVrf(isc::dhcp::SubnetID subnetId) const;
+
+    // counters of flap damping, null if damping is disabled
+    isc::data::ElementPtr flapDampingStats();
+
+    // counters of spool of operations held during switch outage, null if disabled
+    isc::data::ElementPtr spoolStats();
+
+    // HA state and shadow route state, null if exporter isn't HA-aware
+    isc::data::ElementPtr haStatus();
+
+    // Reconciliation of a part of lease database with the switch, returns job id.
+    // Throws if HA partner owns full state of the switch.
+    // Job is started after neighbor table is received from the switch.
+    // Subnet and full jobs also read static routes of the switch and send only
+    // routes that are missing or have another nexthop there.
+    // Routes are sent in chunks on IOService
+    uint64_t resyncSubnet(isc::dhcp::SubnetID subnetId);
+
+    uint64_t resyncClient(const isc::dhcp::DuidPtr&       duid,
+                          const std::optional<uint32_t>& iaid);
+
+    // with owned routes also removes routes of the exporter without lease
+    uint64_t resyncAll();
+
+    // remove every route installed by the exporter, returns job id.
+    // Client must own its routes, i.e. `route-tag` is configured
+    uint64_t removeOwnedRoutes();
+
+    // progress of recent resync jobs
+    isc::data::ElementPtr resyncStatus();
+
+    // timings and counters of the last restore after switch reload
+    isc::data::ElementPtr restoreStats();
+
+    // worker threads of management client and heartbeat service
+    isc::data::ElementPtr workerPoolStats();
+
   private:
-    IOServicePtr        m_ioService;
-    ManagementClientPtr m_client;
-    HeartbeatServicePtr m_heartbeatService;
+    using LeaseCollector = std::function<isc::dhcp::Lease6Collection()>;
+
+    enum class ResyncState : uint8_t {
+        RUNNING,
+        FINISHED,
+        FAILED,
+        CANCELLED,
+    };
+
+    struct ResyncJob {
+        uint64_t                 id{0};
+        string                   scope;
+        std::atomic<ResyncState> state{ResyncState::RUNNING};
+        std::atomic<size_t>      leases{0};
+        // leases without route
+        std::atomic<size_t> skipped{0};
+        // routes already present on the switch
+        std::atomic<size_t> unchanged{0};
+        // routes to send and already sent
+        std::atomic<size_t> routes{0};
+        std::atomic<size_t> sent{0};
+        // static routes of the switch without lease
+        std::atomic<size_t> unmatched{0};
+        std::atomic<size_t> overlaps{0};
+        // unmatched routes are removed, only for owned routes of full scope
+        bool removeStale{false};
+        // Routes of leased prefixes with nexthop no lease has. NX-OS keeps
+        // them as ECMP nexthops next to the sent route, so they are removed
+        // for owned routes of any scope
+        std::atomic<size_t> staleNexthops{0};
+        bool                removeStaleNexthops{false};
+        std::atomic<size_t> removed{0};
+    };
+
+    // routes sent per IOService handler
+    static constexpr size_t ResyncChunkSize{256};
+    // overlapping lease prefixes logged per job
+    static constexpr size_t MaxReportedOverlaps{100};
+    // finished jobs are kept for `exporter-resync-status`
+    static constexpr size_t MaxResyncJobs{16};
+
+    // One restore after switch reload. Workers take subnets one by one from
+    // shared counter, so a large subnet doesn't hold the others, and queue
+    // resolved routes in batches. Batches are applied while collection goes on,
+    // at most `maxInFlight` of them at the same time
+    struct RestoreJob {
+        using Clock = std::chrono::steady_clock;
+
+        ManagementClient::HWAddrMapPtr   mapping;
+        std::vector<isc::dhcp::SubnetID> subnets;
+        size_t                           maxInFlight{1};
+        size_t                           workers{1};
+        // next subnet to be taken by a worker
+        std::atomic<size_t> nextSubnet{0};
+        // the last worker to finish hands job back to IOService
+        std::atomic<size_t> finishedWorkers{0};
+        // set when service is stopped, workers leave remaining subnets
+        std::atomic<bool> cancelled{false};
+        std::atomic<size_t> leases{0};
+        std::atomic<size_t> routes{0};
+
+        std::mutex                              mutex;
+        std::deque<ManagementClient::RoutesPtr> batches;
+        size_t                                  inFlight{0};
+        bool                                    collected{false};
+        bool                                    finished{false};
+        ManagementClient::BulkApplyResult       result;
+        Clock::time_point                       startedAt;
+        Clock::time_point                       collectedAt;
+        Clock::time_point                       firstAppliedAt;
+    };
+
+    using RestoreJobPtr = std::shared_ptr<RestoreJob>;
+
+    // lease collection threads of restore, more than one only in MT mode
+    // of lease backend
+    static constexpr size_t MaxRestoreWorkers{8};
+    // routes of one bulk apply
+    static constexpr size_t RestoreBatchRoutes{4096};
+
+    struct RestoreStats {
+        size_t restores{0};
+        bool   running{false};
+        size_t leases{0};
+        size_t routes{0};
+        // time of reading lease database and of applying routes on the switch,
+        // apply starts with the first batch while collection goes on
+        int64_t                           collectMs{0};
+        int64_t                           applyMs{0};
+        ManagementClient::BulkApplyResult result;
+        // peak resident set size of the process after restore
+        int64_t peakRssKb{0};
+    };
 
   private:
+    Params                       m_params;
+    IOServicePtr                 m_ioService;
+    ManagementClientPtr          m_client;
+    HeartbeatServicePtr          m_heartbeatService;
+    std::unique_ptr<FlapDamper>  m_flapDamper;
+    std::unique_ptr<RouteSpool>  m_spool;
+    std::unique_ptr<HAOwnership> m_ha;
+    // restore or resync was cancelled by `stopService`,
+    // its routes may be missing on the switch
+    bool m_interruptedJobs{false};
+    // subnets without entry are in default VRF
+    std::unordered_map<isc::dhcp::SubnetID, VrfId> m_subnetVrfs;
+
+    std::mutex                             m_resyncMutex;
+    std::deque<std::shared_ptr<ResyncJob>> m_resyncJobs;
+    uint64_t                               m_lastResyncId{0};
+
+    std::mutex   m_restoreMutex;
+    RestoreStats m_restoreStats;
+    // collection threads of multi-threading mode live from the first restore
+    // until service is stopped, so response handler of the switch only queues
+    // the job
+    isc::util::ThreadPool<std::function<void()>> m_restorePool;
+    size_t                                       m_restorePoolSize{0};
+    RestoreJobPtr                                m_restoreJob;
+
+  private:
+    // hash of parameters of connection to the switch and VRFs
+    size_t connectionHash() const;
+
+    // features are null if their parameters are null
+    std::unique_ptr<FlapDamper>  createFlapDamper(ConstElementPtr config);
+    std::unique_ptr<RouteSpool>  createSpool(ConstElementPtr config);
+    std::unique_ptr<HAOwnership> createHA(ConstElementPtr config);
+
+    // operation after damping, shadowed while HA partner owns switch writes
+    void forwardRoute(const RouteExport& route, bool remove);
+
+    // operation this server owns, held in spool while the switch is unreachable
+    void spoolRoute(const RouteExport& route, bool remove);
+
+    void sendRoute(const RouteExport& route, bool remove);
+
+    // "subnet-vrfs": [{"subnet-id": 12, "vrf": "TENANT-A"}]
+    void parseSubnetVrfs(ConstElementPtr config);
+
+    // route of a lease from lease database, nullopt if lease has no route
+    std::optional<RouteExport>
+        resolveLeaseRoute(const ManagementClient::HWAddrMap& mapping,
+                          const Lease6Ptr&                  lease);
+
+    std::shared_ptr<ResyncJob> createResyncJob(const string& scope);
+
+    uint64_t startResync(const string&  scope,
+                         bool           diffWithSwitch,
+                         LeaseCollector collect,
+                         bool           removeStale = false);
+
+    void failResync(ResyncJob& job, const string& reason);
+
+    // `installed` is null if job doesn't diff with the switch
+    void resolveResync(const std::shared_ptr<ResyncJob>&        job,
+                       const ManagementClient::HWAddrMap&       mapping,
+                       const ManagementClient::InstalledRoutes* installed,
+                       const LeaseCollector&                    collect);
+
+    // routes missing on the switch or installed with another nexthop,
+    // `stale` receives installed routes without lease if job removes them and
+    // installed nexthops of leased prefixes that no lease has if routes are owned
+    std::vector<RouteExport>
+        filterInstalledRoutes(ResyncJob&                               job,
+                              const std::vector<RouteExport>&          routes,
+                              const ManagementClient::InstalledRoutes& installed,
+                              ManagementClient::Routes&                stale);
+
+    void removeStaleRoutes(const std::shared_ptr<ResyncJob>& job,
+                           ManagementClient::RoutesPtr       routes,
+                           bool                              finishJob);
+
+    void resyncChunk(const std::shared_ptr<ResyncJob>&                      job,
+                     const std::shared_ptr<const std::vector<RouteExport>>& routes,
+                     size_t                                                 offset);
+
+    static const char* resyncStateToString(ResyncState state);
+
     void restoreLeasesFromLeaseDatabase(
         HeartbeatService::HandlerFailedCallback handlerFailed);
+
+    // worker of restore, resolves leases of subnets until none is left
+    void collectRestoreRoutes(const RestoreJobPtr& job);
+
+    // runs on IOService after collection finished
+    void finishRestoreCollection(const RestoreJobPtr& job);
+
+    void queueRestoreBatch(const RestoreJobPtr& job, ManagementClient::RoutesPtr batch);
+
+    void dispatchRestoreBatches(const RestoreJobPtr& job);
+
+    void finishRestore(RestoreJob& job);
 };
@@ -0,0 +1,148 @@
+#pragma once
+#include "common.hpp"
+#include "route_export.hpp"
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace isc::asiolink {
+    class IntervalTimer;
+    using IntervalTimerPtr = boost::shared_ptr<IntervalTimer>;
+}    // namespace isc::asiolink
+
+// Damping of route operations of clients that churn leases.
+// First operation of a route is forwarded at once. Operations of the same route
+// within debounce window after it are held, later one replaces held one and
+// held operation is dropped if the switch already has its state, so
+// apply/remove loops cancel out before reaching the switch.
+// Every export of a client after its removal adds penalty to the client
+// (DUID, IAID), penalty decays exponentially. Operations of client with
+// penalty above suppress threshold are held until penalty decays below
+// reuse threshold, then only the latest intent of every route is forwarded
+class FlapDamper {
+  public:
+    struct Config {
+        size_t debounceIntervalMs{2000};
+        double penalty{1000};
+        double suppressThreshold{3000};
+        double reuseThreshold{750};
+        size_t halfLifeSecs{60};
+        // upper bound of suppression, limits penalty of persistent flapper
+        size_t maxSuppressTimeSecs{600};
+
+        // "flap-damping": {"debounce-interval": 2000, "penalty": 1000,
+        //                  "suppress-threshold": 3000, "reuse-threshold": 750,
+        //                  "half-life": 60, "max-suppress-time": 600}
+        static Config parseConfig(ConstElementPtr config);
+    };
+
+    struct Stats {
+        // operations passed to the switch
+        uint64_t forwarded{0};
+        // held operations replaced by later operation of the same route
+        uint64_t coalesced{0};
+        // held operations dropped because they repeat forwarded one
+        uint64_t cancelled{0};
+        // operations of suppressed clients
+        uint64_t suppressed{0};
+        // times any client crossed suppress threshold
+        uint64_t suppressEvents{0};
+        uint64_t heldOperations{0};
+        uint64_t suppressedClients{0};
+        uint64_t trackedClients{0};
+
+        isc::data::ElementPtr toElement() const;
+    };
+
+    using ForwardHandler = std::function<void(const RouteExport& route, bool remove)>;
+
+  public:
+    FlapDamper(const Config& config, const ForwardHandler& handler);
+
+    void start(IOService& io_service);
+
+    // cancel timer and forward all held operations
+    void stop();
+
+    void push(const RouteExport& route, bool remove);
+
+    Stats stats();
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Operation {
+        RouteExport route;
+        bool        remove;
+    };
+
+    struct ClientKey {
+        uint64_t duidHash;
+        uint32_t iaid;
+
+        bool operator==(const ClientKey& other) const {
+            return duidHash == other.duidHash && iaid == other.iaid;
+        }
+    };
+
+    struct ClientKeyHash {
+        size_t operator()(const ClientKey& key) const;
+    };
+
+    struct ClientState {
+        double            penalty{0};
+        Clock::time_point penaltyUpdatedAt;
+        Clock::time_point lastOperationAt;
+        Clock::time_point suppressedAt;
+        uint32_t          heldRoutes{0};
+        bool              lastRemove{false};
+        bool              suppressed{false};
+    };
+
+    // remove operations may not know nexthop, so route is identified
+    // by client, prefix and VRF only
+    struct RouteKey {
+        uint64_t     duidHash;
+        RouteAddress addr;
+        uint32_t     iaid;
+        uint8_t      prefixLength;
+        bool         isIA_NA;
+        VrfId        vrfId;
+
+        bool operator==(const RouteKey& other) const;
+    };
+
+    struct RouteKeyHash {
+        size_t operator()(const RouteKey& key) const;
+    };
+
+    struct RouteState {
+        Operation         forwarded;
+        Operation         held;
+        Clock::time_point forwardedAt;
+        bool              hasForwarded{false};
+        bool              hasHeld{false};
+    };
+
+  private:
+    Config                          m_config;
+    double                          m_maxPenalty;
+    ForwardHandler                  m_forwardHandler;
+    isc::asiolink::IntervalTimerPtr m_timer;
+
+    std::mutex                                                m_mutex;
+    std::unordered_map<ClientKey, ClientState, ClientKeyHash> m_clients;
+    std::unordered_map<RouteKey, RouteState, RouteKeyHash>    m_routes;
+    Clock::time_point                                         m_lastClientsSweep;
+    Stats                                                     m_stats;
+
+  private:
+    void tick();
+
+    // caller holds `m_mutex`
+    void decayPenalty(ClientState& client, Clock::time_point now) const;
+    void sweepClients(Clock::time_point now);
+
+    static bool isRepeated(const Operation& held, const Operation& forwarded);
+};
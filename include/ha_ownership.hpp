@@ -0,0 +1,135 @@
+#pragma once
+#include "common.hpp"
+#include "route_export.hpp"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace isc::asiolink {
+    class IntervalTimer;
+    using IntervalTimerPtr = boost::shared_ptr<IntervalTimer>;
+}    // namespace isc::asiolink
+
+// Ownership of switch writes between servers of Kea HA pair.
+// HA state of this server is polled with in-process `status-get`, the HA hooks
+// library adds its relationships to the answer. Every route operation goes
+// through ownership before spool. Servers that answer client queries own
+// writes: primary in hot-standby and passive-backup modes, both servers in
+// load-balancing mode, or any server that serves alone in partner-down state.
+// Operations every server runs on its own copy of lease database (restore
+// after switch reload, resync) belong to primary or to the server that serves
+// alone, so load-balancing partners don't write full state twice.
+// Server that doesn't own writes keeps the latest operation of every lease as
+// shadow state and replays it when it takes over
+class HAOwnership {
+  public:
+    struct Config {
+        // server of HA relationship, first relationship is used if empty
+        string serverName;
+        size_t pollIntervalMs{1000};
+        // leases in shadow state, full resync follows takeover above it
+        size_t shadowLimit{100000};
+
+        // "ha": {"server-name": "server1", "poll-interval": 1000,
+        //        "shadow-limit": 100000}
+        static Config parseConfig(ConstElementPtr config);
+    };
+
+    struct Stats {
+        // empty until HA state is received, "standalone" without HA
+        string mode;
+        string role;
+        string state;
+        bool   owner{false};
+        // restore and resync are run by this server
+        bool fullStateOwner{false};
+        // times this server took over switch writes and gave them up
+        uint64_t takeovers{0};
+        uint64_t releases{0};
+        // operations kept in shadow state and sent on takeover
+        uint64_t shadowed{0};
+        uint64_t replayed{0};
+        uint64_t shadowLeases{0};
+        // shadow state lost operations, takeover resyncs with lease database
+        bool overflowed{false};
+
+        isc::data::ElementPtr toElement() const;
+    };
+
+    struct Operation {
+        RouteExport route;
+        bool        remove;
+    };
+
+    // state of stopped instance for the next load of the hook
+    struct Handover {
+        string mode;
+        string role;
+        string state;
+        // shadow state didn't lose operations
+        bool                   complete{true};
+        std::vector<Operation> shadow;
+    };
+
+    using ForwardHandler = std::function<void(const RouteExport& route, bool remove)>;
+    // called on IOService after shadow state is replayed,
+    // `complete` is false if shadow state lost operations
+    using TakeoverHandler = std::function<void(bool complete)>;
+
+  public:
+    HAOwnership(const Config&          config,
+                const ForwardHandler&  forwardHandler,
+                const TakeoverHandler& takeoverHandler);
+
+    // reads HA state once before timer is started
+    void start(IOService& io_service);
+
+    void stop();
+
+    bool isOwner() const { return m_owner; }
+
+    bool isFullStateOwner() const { return m_fullStateOwner; }
+
+    // shadow state of previous load is lost, takeover resyncs with lease database
+    void markShadowIncomplete();
+
+    // HA state and shadow state, instance must be stopped
+    Handover handover();
+
+    // state of previous load, change of HA state since then is seen by the first
+    // poll, e.g. takeover replays shadow state. Called before `start`
+    void adopt(Handover&& handover);
+
+    // returns false if operation isn't shadowed and must be sent to the switch
+    bool push(const RouteExport& route, bool remove);
+
+    Stats stats();
+
+  private:
+    Config                          m_config;
+    ForwardHandler                  m_forwardHandler;
+    TakeoverHandler                 m_takeoverHandler;
+    isc::asiolink::IntervalTimerPtr m_timer;
+    // nothing is sent before HA state is known
+    std::atomic<bool> m_owner{false};
+    std::atomic<bool> m_fullStateOwner{false};
+
+    std::mutex                                                      m_mutex;
+    std::unordered_map<RouteLeaseKey, Operation, RouteLeaseKeyHash> m_shadow;
+    Stats                                                           m_stats;
+
+  private:
+    void poll();
+
+    // Caller holds `m_mutex`. Shadow state is forwarded before ownership is
+    // taken, returns number of replayed operations
+    size_t updateState(const string& mode, const string& role, const string& state);
+
+    static bool ownsWrites(const string& mode, const string& role, const string& state);
+
+    static bool ownsFullState(const string& mode,
+                              const string& role,
+                              const string& state);
+};
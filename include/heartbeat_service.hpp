@@ -1,6 +1,7 @@
 #pragma once
 #include "common.hpp"
 #include <functional>
+#include <optional>
 
 class HeartbeatService;
 using HeartbeatServicePtr = std::shared_ptr<HeartbeatService>;
@@ -10,6 +11,8 @@ class HeartbeatService {
     using HandlerFailedCallback = std::function<void()>;
     using ConnectionRestoredHandler = std::function<void(HandlerFailedCallback)>;
     using ConnectionFailedHandler   = std::function<void()>;
+    // connection of previous load of the hook is confirmed, switch wasn't reloaded
+    using ConnectionResumedHandler = std::function<void()>;
 
   public:
     HeartbeatService(const HeartbeatService&)            = delete;
@@ -25,16 +28,35 @@ class HeartbeatService {
     ConnectionFailedHandler getConnectionFailedHandler() const;
     void setConnectionFailedHandler(const ConnectionFailedHandler& handler);
 
+    ConnectionResumedHandler getConnectionResumedHandler() const;
+    void setConnectionResumedHandler(const ConnectionResumedHandler& handler);
+
     virtual void startService(IOService& io_service) = 0;
 
     virtual void stopService() = 0;
 
     virtual string connectionName() const = 0;
 
+    // uptime of the switch in seconds seen by the last probe after routes were
+    // restored, nullopt while connection is lost
+    virtual std::optional<size_t> switchUptime() { return std::nullopt; }
+
+    // Previous load of the hook saw the switch with `uptimeSecs`. If the first
+    // answered probe shows the switch wasn't reloaded since then, resumed handler
+    // is called instead of restored one. Must be called before `startService`
+    virtual void resumeFrom(size_t /*uptimeSecs*/) {}
+
+    // outcome of route traffic to the same switch, may replace active probes
+    virtual void observeTraffic(bool /*answered*/) {}
+
+    // load of worker threads of the service, null if service has no pool
+    virtual isc::data::ElementPtr workerPoolStats() const;
+
   protected:
     HeartbeatService() = default;
 
   protected:
     ConnectionFailedHandler   connectionFailedHandler;
     ConnectionRestoredHandler connectionRestoredHandler;
+    ConnectionResumedHandler  connectionResumedHandler;
 };
@@ -0,0 +1,56 @@
+#pragma once
+#include "common.hpp"
+#include "route_export.hpp"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace isc::dhcp {
+    struct HWAddr;
+}
+
+// Map from 48-bit MAC address to interned interface name.
+// Open addressing with linear probing over one flat array,
+// so big neighbor tables cost one allocation instead of one per entry
+class HWAddrInterfaceMap {
+  public:
+    using MacKey = uint64_t;
+
+  public:
+    // decode "f6a5.486e.8aad" form used by NX-OS, returns false on malformed input
+    static bool parseCiscoMac(std::string_view rawMac, MacKey& key);
+
+    // only 6-byte hardware addresses have a key
+    static bool toMacKey(const isc::dhcp::HWAddr& hwAddr, MacKey& key);
+
+    void reserve(size_t count);
+
+    // later insert of the same MAC replaces interface
+    void insert(MacKey key, InterfaceId ifId);
+
+    // returns `NoInterfaceId` if MAC is not found
+    InterfaceId find(MacKey key) const;
+    InterfaceId find(const isc::dhcp::HWAddr& hwAddr) const;
+
+    size_t size() const { return m_size; }
+
+  private:
+    struct Slot {
+        MacKey      key;
+        InterfaceId ifId;
+    };
+
+    // MAC has only 48 bits, so all-ones never matches real address
+    static constexpr MacKey EmptyKey{~MacKey{0}};
+
+    std::vector<Slot> m_slots;
+    size_t            m_size{0};
+
+  private:
+    size_t slotIndex(MacKey key) const;
+
+    void rehash(size_t capacity);
+};
+
+// case-insensitive "vlan<digits>" match, replacement of "(vlan)(\d+)" regex
+bool isVlanInterfaceName(std::string_view ifName);
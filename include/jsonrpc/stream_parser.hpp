@@ -0,0 +1,153 @@
+#pragma once
+#include "jsonrpc/utils.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Push JSON parser: input is fed by chunks as they arrive from the network,
+// events are reported to `Handler` as soon as token is complete.
+// Only current token is buffered, so memory doesn't depend on document size
+class JsonStreamParser {
+  public:
+    class Handler {
+      public:
+        virtual ~Handler() = default;
+
+        virtual void onStartObject() = 0;
+        virtual void onEndObject()   = 0;
+        virtual void onStartArray()  = 0;
+        virtual void onEndArray()    = 0;
+
+        virtual void onKey(std::string_view key)      = 0;
+        virtual void onString(std::string_view value) = 0;
+        // number, `true`, `false` or `null` in raw form
+        virtual void onLiteral(std::string_view value) = 0;
+    };
+
+    // longest string or number accepted by the parser
+    static constexpr size_t MaxTokenSize{64 * 1024};
+
+  public:
+    explicit JsonStreamParser(Handler& handler);
+
+    // returns false on malformed input, parser stays in failed state
+    bool feed(const char* data, size_t size);
+
+    // check that document is complete
+    bool finish();
+
+    // prepare for next document, buffers keep their capacity
+    void reset();
+
+    const string& error() const { return m_error; }
+
+  private:
+    enum class Container : uint8_t { OBJECT, ARRAY };
+
+    enum class Expect : uint8_t {
+        VALUE,
+        // after '['
+        VALUE_OR_END,
+        // after '{'
+        KEY_OR_END,
+        // after ',' inside object
+        KEY,
+        COLON,
+        COMMA_OR_END,
+        DONE,
+    };
+
+    enum class Token : uint8_t { NONE, STRING, STRING_ESCAPE, STRING_UNICODE, LITERAL };
+
+  private:
+    Handler&               m_handler;
+    std::vector<Container> m_stack;
+    Expect                 m_expect{Expect::VALUE};
+    Token                  m_token{Token::NONE};
+    bool                   m_tokenIsKey{false};
+    string                 m_buffer;
+    uint32_t               m_codePoint{0};
+    uint32_t               m_highSurrogate{0};
+    int                    m_codePointDigits{0};
+    size_t                 m_offset{0};
+    string                 m_error;
+
+  private:
+    bool fail(const char* what);
+
+    bool parseStructural(char c);
+
+    bool finishLiteral();
+
+    void finishString();
+
+    void appendCodePoint();
+
+    void valueDone();
+};
+
+// Extracts JSON-RPC envelope from streamed NX-API response.
+// Events of every `result.body` value are forwarded to `bodyHandler`,
+// error object is collected and reported by `finish`
+class JsonRpcStreamReader : private JsonStreamParser::Handler {
+  public:
+    explicit JsonRpcStreamReader(JsonStreamParser::Handler& bodyHandler);
+
+    bool feed(const char* data, size_t size) { return m_parser.feed(data, size); }
+
+    // throws JsonRpcException in same cases as `JsonRpcUtils::handleResponse`
+    void finish();
+
+    // prepare for next response, buffers keep their capacity
+    void reset();
+
+    // number of "result" members of the response
+    size_t results() const { return m_results; }
+
+  private:
+    enum class PendingKey : uint8_t { NONE, RESULT, BODY, ERROR, CODE, MESSAGE };
+
+  private:
+    JsonStreamParser::Handler& m_body;
+    JsonStreamParser           m_parser;
+
+    int        m_depth{0};
+    int        m_resultDepth{-1};
+    int        m_bodyDepth{-1};
+    int        m_errorDepth{-1};
+    PendingKey m_pendingKey{PendingKey::NONE};
+
+    size_t m_results{0};
+    bool   m_sawError{false};
+    int    m_errorCode{JsonRpcException::INTERNAL_ERROR};
+    string m_errorMessage;
+
+  private:
+    bool forwarding() const { return m_bodyDepth >= 0; }
+
+    void startContainer(bool isObject);
+    void endContainer(bool isObject);
+
+    void onStartObject() override { startContainer(true); }
+    void onEndObject() override { endContainer(true); }
+    void onStartArray() override { startContainer(false); }
+    void onEndArray() override { endContainer(false); }
+
+    void onKey(std::string_view key) override;
+    void onString(std::string_view value) override;
+    void onLiteral(std::string_view value) override;
+};
+
+// drops all events, for responses which are only validated
+class JsonNullHandler : public JsonStreamParser::Handler {
+  public:
+    void onStartObject() override {}
+    void onEndObject() override {}
+    void onStartArray() override {}
+    void onEndArray() override {}
+
+    void onKey(std::string_view) override {}
+    void onString(std::string_view) override {}
+    void onLiteral(std::string_view) override {}
+};
@@ -3,6 +3,7 @@
 #include <exception>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -103,5 +104,13 @@ class JsonRpcUtils {
     static ConstElementPtr createRequestFromCommands(int id, const string& commands);
     static ConstElementPtr
         createRequestFromCommands(const std::vector<std::pair<int, string>>& commands);
+    // encode request directly into `out`, capacity of `out` is reused between calls
+    static void encodeRequestFromCommands(
+        string& out, std::initializer_list<std::pair<int, std::string_view>> commands);
+    // append one command to request array opened by caller with '['
+    static void appendRequestCommand(string& out, int id, std::string_view command);
     static std::vector<JsonRpcResponse> handleResponse(const string& responseBody);
+    // same as above, but reuses capacity of `result`
+    static void handleResponse(const string&                 responseBody,
+                               std::vector<JsonRpcResponse>& result);
 };
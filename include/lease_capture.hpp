@@ -0,0 +1,102 @@
+#pragma once
+#include "common.hpp"
+#include "route_export.hpp"
+#include <cstdio>
+#include <mutex>
+
+namespace isc::asiolink {
+    class IntervalTimer;
+    using IntervalTimerPtr = boost::shared_ptr<IntervalTimer>;
+}    // namespace isc::asiolink
+
+// Capture of lease events for offline replay with `nxos_dhcp6_exporter_replay`.
+// Every route operation callouts resolve from a lease is appended to capture
+// file with its wall clock time, before damping, spool and HA ownership, so
+// replay through the service sees the same traffic as production.
+// File is 8-byte magic followed by events: 64-bit time in microseconds since
+// epoch and route record with event as its flag. Events are buffered in memory
+// and written when buffer is full or on timer. Capture is stopped when file
+// reaches its size limit
+class LeaseCapture {
+  public:
+    enum class Event : uint8_t {
+        EXPORT,
+        REMOVE,
+        // removal of reclaimed lease
+        RECLAIM,
+    };
+
+    struct Config {
+        string path;
+        size_t maxSize{size_t{1} << 30};
+
+        // "capture": {"path": "/var/lib/kea/nxos-exporter.capture",
+        //             "max-size": 1073741824}
+        static Config parseConfig(ConstElementPtr config);
+    };
+
+    struct Stats {
+        // false after size limit is reached or file couldn't be written
+        bool     capturing{true};
+        uint64_t events{0};
+        uint64_t dropped{0};
+        uint64_t fileBytes{0};
+
+        isc::data::ElementPtr toElement() const;
+    };
+
+    // events of one capture file, event time is in microseconds since epoch
+    struct Record {
+        int64_t     timeUs;
+        Event       event;
+        RouteExport route;
+    };
+
+    static constexpr char Magic[8]{'N', 'X', 'E', 'X', 'C', 'A', 'P', '1'};
+
+  public:
+    // opens capture file, new events are appended to events of previous runs.
+    // Throws if existing file isn't a capture file
+    explicit LeaseCapture(const Config& config);
+    ~LeaseCapture();
+    LeaseCapture(const LeaseCapture&)            = delete;
+    LeaseCapture& operator=(const LeaseCapture&) = delete;
+
+    void start(IOService& io_service);
+
+    // cancel timer and write buffered events
+    void stop();
+
+    void record(Event event, const RouteExport& route);
+
+    Stats stats();
+
+  private:
+    Config                          m_config;
+    isc::asiolink::IntervalTimerPtr m_timer;
+
+    std::mutex m_mutex;
+    std::FILE* m_file{nullptr};
+    string     m_buffer;
+    Stats      m_stats;
+
+  private:
+    // caller holds `m_mutex`
+    void flush();
+};
+
+// reads capture file written by `LeaseCapture`
+class LeaseCaptureReader {
+  public:
+    // throws if file can't be opened or isn't a capture file
+    explicit LeaseCaptureReader(const string& path);
+    ~LeaseCaptureReader();
+    LeaseCaptureReader(const LeaseCaptureReader&)            = delete;
+    LeaseCaptureReader& operator=(const LeaseCaptureReader&) = delete;
+
+    // returns false at end of file or at partial event of interrupted write
+    bool next(LeaseCapture::Record& record);
+
+  private:
+    std::FILE* m_file{nullptr};
+};
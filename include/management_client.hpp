@@ -1,5 +1,6 @@
 #pragma once
 #include "common.hpp"
+#include "hwaddr_map.hpp"
 #include "route_export.hpp"
 #include <unordered_map>
 #include <vector>
@@ -9,15 +10,40 @@ using ManagementClientPtr = std::shared_ptr<ManagementClient>;
 
 class ManagementClient {
   public:
-    struct HWAddrHashHelper {
-        size_t operator()(const isc::dhcp::HWAddr& hwAddr) const;
-    };
-
-    using HWAddrMap =
-        std::unordered_map<isc::dhcp::HWAddr, string, ManagementClient::HWAddrHashHelper>;
+    using HWAddrMap            = HWAddrInterfaceMap;
     using HWAddrMapPtr         = std::shared_ptr<HWAddrMap>;
     using HWAddrMappingHandler = std::function<void(HWAddrMapPtr, bool)>;
 
+    // static route installed on the switch, nexthop is address or interface name
+    struct InstalledRoute {
+        string prefix;
+        string nexthop;
+        VrfId  vrfId{DefaultVrfId};
+    };
+
+    using InstalledRoutes        = std::vector<InstalledRoute>;
+    using InstalledRoutesPtr     = std::shared_ptr<InstalledRoutes>;
+    using InstalledRoutesHandler = std::function<void(InstalledRoutesPtr, bool)>;
+
+    using Routes    = std::vector<RouteExport>;
+    using RoutesPtr = std::shared_ptr<const Routes>;
+
+    struct BulkApplyResult {
+        // routes the switch confirmed and rejected
+        size_t applied{0};
+        size_t failed{0};
+        // requests issued to the switch
+        size_t requests{0};
+        // routes sent one by one without waiting for the switch,
+        // neither applied nor failed yet
+        size_t dispatched{0};
+    };
+
+    using BulkApplyHandler = std::function<void(const BulkApplyResult&)>;
+
+    // `answered` is true if switch answered the request
+    using TrafficObserver = std::function<void(bool answered)>;
+
   public:
     ManagementClient(const ManagementClient&)            = delete;
     ManagementClient& operator=(const ManagementClient&) = delete;
@@ -34,11 +60,52 @@ class ManagementClient {
 
     virtual void removeRoutesFromSwitch(const RouteExport& route) = 0;
 
+    // apply whole set of routes, e.g. restore after switch reload.
+    // Default implementation only sends routes one by one and reports all
+    // of them as applied, result of every route is logged by its request
+    virtual void applyRoutesBulk(RoutesPtr routes, const BulkApplyHandler& handler);
+
+    // remove whole set of routes, default implementation removes them one by one
+    virtual void removeRoutesBulk(RoutesPtr routes, const BulkApplyHandler& handler);
+
+    // bulk applies the switch may receive at the same time
+    virtual size_t maxBulkApplies() const { return 1; }
+
+    // routes installed by the client carry owner mark and
+    // `asyncGetInstalledRoutes` returns only them
+    virtual bool ownsRoutes() const { return false; }
+
     virtual string connectionName() const = 0;
 
+    // DER of the last TLS session with the switch, read after `stopClient`.
+    // Empty if client doesn't use TLS
+    virtual string tlsSession() const { return {}; }
+
+    // session of previous client resumed by the first connections,
+    // must be set before `startClient`
+    virtual void setTLSSession(const string& /*session*/) {}
+
+    // outcome of every request to the switch, must be set before `startClient`
+    void setTrafficObserver(const TrafficObserver& observer) {
+        m_trafficObserver = observer;
+    }
+
+    // non-default VRFs routes are exported into, reads of the switch cover
+    // them too. Must be set before `startClient`
+    void setExportVrfs(const std::vector<VrfId>& vrfs) { m_exportVrfs = vrfs; }
+
+    // load of worker threads of the client, null if client has no pool
+    virtual isc::data::ElementPtr workerPoolStats() const;
+
     virtual void
         asyncGetHWAddrToInterfaceNameMapping(const HWAddrMappingHandler& handler) = 0;
 
+    virtual void asyncGetInstalledRoutes(const InstalledRoutesHandler& handler) = 0;
+
   protected:
     ManagementClient() = default;
+
+  protected:
+    TrafficObserver    m_trafficObserver;
+    std::vector<VrfId> m_exportVrfs;
 };
@@ -1,5 +1,6 @@
 #pragma once
 #include <boost/shared_ptr.hpp>
+#include <cstdint>
 #include <http/basic_auth.h>
 #include <http/url.h>
 #include <optional>
@@ -30,7 +31,22 @@ struct NXOSConnectionConfigParams {
     NXOSConnectionAuth    auth;
     std::optional<string> cert_file;
     std::optional<string> key_file;
+    std::optional<string> ca_file;
     size_t                heartbeatIntervalSecs;
+    size_t                batchSize;
+    size_t                batchIntervalMs;
+    size_t                gnmiPort;
+    size_t                bulkChunkSize;
+    bool                  asyncEngine;
+    size_t                maxConnections;
+    size_t                minThreads;
+    size_t                maxThreads;
+    size_t                uptimeIntervalSecs;
+    bool                  passiveHealth;
+    size_t                bulkMaxInFlight;
+    // routes installed by exporter carry tag and name, tag scopes reads
+    std::optional<uint32_t> routeTag;
+    std::optional<string>   routeName;
 
     static NXOSConnectionConfigParams parseConfig(ConstElementPtr& mgmtConnParams);
 };
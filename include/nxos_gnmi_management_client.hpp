@@ -0,0 +1,38 @@
+#pragma once
+#include "nxos_management_client.hpp"
+#include "route_batcher.hpp"
+#include <memory>
+
+class NXOSGnmiChannel;
+
+// Management client that programs static routes over gNMI.
+// Route changes are batched into one `Set` request with many `update`/`delete`
+// paths, all requests share one HTTP/2 channel.
+// Address lookups (vlan mapping, neighbors) still use NX-API
+class NXOSGnmiManagementClient : public NXOSManagementClient {
+  public:
+    NXOSGnmiManagementClient(ConstElementPtr mgmtConnParams);
+    ~NXOSGnmiManagementClient();
+
+    static std::string_view name() { return "nxos-gnmi"; }
+
+    void startClient(IOService& io_service) override;
+
+    void stopClient() override;
+
+    void asyncGetInstalledRoutes(const InstalledRoutesHandler& handler) override;
+
+  protected:
+    void applyRouteOnSwitch(const RouteExport& route) override;
+
+    void removeRouteOnSwitch(const RouteExport& route, bool clearNDCache) override;
+
+  private:
+    RouteBatcher                     m_batcher;
+    std::shared_ptr<NXOSGnmiChannel> m_channel;
+
+  private:
+    void sendBatch(RouteBatcher::OperationsPtr ops);
+
+    string gnmiTarget() const;
+};
@@ -3,6 +3,8 @@
 #include "nxos/nxos_structs.hpp"
 #include "nxos_connection_params.hpp"
 #include "nxos_http_client.hpp"
+#include <atomic>
+#include <chrono>
 #include <mutex>
 
 namespace isc::asiolink {
@@ -24,6 +26,17 @@ class NXOSHeartbeatService : public HeartbeatService {
 
     string connectionName() const override;
 
+    isc::data::ElementPtr workerPoolStats() const override;
+
+    void observeTraffic(bool answered) override;
+
+    std::optional<size_t> switchUptime() override;
+
+    void resumeFrom(size_t uptimeSecs) override;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
   private:
     NXOSConnectionConfigParams m_params;
     NXOSHttpClientPtr          m_httpClient;
@@ -31,6 +44,14 @@ class NXOSHeartbeatService : public HeartbeatService {
     std::mutex                 m_heartbeatMutex;
     size_t                     m_prevUptimeSecs{0};
     bool                       m_prevLostConnection{true};
+    Clock::time_point          m_lastUptimeAt;
+    // uptime seen by previous load of the hook, until the first answered probe
+    std::optional<size_t> m_resumeUptimeSecs;
+    uint64_t                   m_probes{0};
+    uint64_t                   m_suppressedProbes{0};
+    // passive health, time of last answered and failed route request
+    std::atomic<Clock::rep> m_lastAnsweredAt{0};
+    std::atomic<Clock::rep> m_lastFailedAt{0};
 
   private:
     bool
@@ -40,6 +61,9 @@ class NXOSHeartbeatService : public HeartbeatService {
                                               JsonRpcResponsePtr  response,
                                               NXOSResponse::UptimeResponse& into);
 
+    // probe is skipped while route traffic is answered and uptime isn't due
+    bool probeNeeded();
+
     void heartbeatLoop();
     void handlerFailedCallback();
 };
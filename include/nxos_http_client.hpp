@@ -1,10 +1,12 @@
 #pragma once
 #include "common.hpp"
+#include "jsonrpc/stream_parser.hpp"
 #include "jsonrpc/utils.hpp"
 #include <asiolink/io_service.h>
 #include <boost/shared_ptr.hpp>
 #include <http/basic_auth.h>
 #include <http/url.h>
+#include <optional>
 
 namespace {
     using isc::asiolink::IOService;
@@ -16,7 +18,11 @@ namespace {
 
 class NXOSHttpClientImpl;
 
-struct TLSInfo {};
+struct TLSInfo {
+    string                     certFile;
+    string                     keyFile;
+    std::optional<std::string> caFile;
+};
 
 using TLSInfoPtr = boost::shared_ptr<TLSInfo>;
 
@@ -44,19 +50,111 @@ class NXOSHttpClient {
         PROXY_CONNECTION,
     };
 
+    struct TLSStats {
+        uint64_t connectionsOpened{0};
+        uint64_t fullHandshakes{0};
+        uint64_t resumedHandshakes{0};
+    };
+
+    // load of worker threads running blocking requests
+    struct PoolStats {
+        size_t threads{0};
+        size_t minThreads{0};
+        size_t maxThreads{0};
+        size_t peakThreads{0};
+        size_t busyThreads{0};
+        // requests posted and not yet taken by a thread
+        size_t   queuedTasks{0};
+        uint64_t tasks{0};
+        uint64_t threadsStarted{0};
+        uint64_t threadsParked{0};
+        // busy time of threads to their lifetime since start of the client
+        double utilization{0};
+
+        isc::data::ElementPtr toElement() const;
+    };
+
   public:
     static string ResponseErrorToString(ResponseError error);
 
+    enum class Method { GET, POST };
+
   public:
     using ResponseHandlerCallback = std::function<
         void(JsonRpcResponsePtr, ResponseError, StatusCode, JsonRpcExceptionPtr)>;
+    using RawResponseHandlerCallback =
+        std::function<void(const string&, ResponseError, StatusCode)>;
+    using Headers = std::vector<std::pair<string, string>>;
+    using StreamBodyHandlerPtr = boost::shared_ptr<JsonStreamParser::Handler>;
+    using StreamCompletionCallback =
+        std::function<void(ResponseError, StatusCode, JsonRpcExceptionPtr)>;
+    // `answered` is true if switch returned 2xx response
+    using OutcomeObserver = std::function<void(bool answered)>;
+
+    // State of one JSON-RPC request, owned and reused by the caller.
+    // `onComplete` is called on worker thread instead of `ResponseHandlerCallback`,
+    // so request of pooled context allocates no handler or response objects
+    struct RequestContext {
+        virtual ~RequestContext() = default;
+
+        virtual void onComplete() = 0;
+
+        string                          requestBody;
+        string                          responseBody;
+        std::vector<JsonRpcResponse>    responses;
+        ResponseError                   responseError{SUCCESS};
+        StatusCode                      statusCode{200};
+        std::optional<JsonRpcException> exception;
+        // number of results in the response
+        size_t results{0};
+        // response is only checked for errors and `responses` stay empty,
+        // for requests which ignore results. Checking allocates nothing
+        bool                               validateOnly{false};
+        std::optional<JsonRpcStreamReader> validator;
+
+        // set by `sendRequest`
+        const Url*    url{nullptr};
+        const string* uri{nullptr};
+        int           timeout{0};
+        // span clock of queueing and start of the request, see `SpanTracer::now`
+        uint64_t sentAt{0};
+        uint64_t startedAt{0};
+    };
 
   public:
-    explicit NXOSHttpClient(bool mt_enabled, size_t threadPoolSize = 4);
+    // pool runs `minThreads` threads and grows up to `maxThreads` while
+    // requests are queued, threads above minimum exit after idle timeout
+    explicit NXOSHttpClient(bool   mt_enabled,
+                            size_t maxThreads = 4,
+                            size_t minThreads = 1);
     ~NXOSHttpClient() = default;
 
     void addBasicAuth(const isc::http::BasicHttpAuthPtr& auth);
 
+    // TLS context shared by all connections of the client,
+    // used for requests without own `tlsContext`. HTTPS requests always use
+    // asio engine, idle connections of previous credentials are closed
+    void setTLSInfo(const TLSInfoPtr& tlsInfo);
+
+    // plain HTTP requests use asio engine with up to `maxConnections`
+    // connections per host instead of blocking httplib call per worker thread.
+    // Must be called before `startClient`
+    void enableAsyncEngine(size_t maxConnections);
+
+    TLSStats getTLSStats() const;
+
+    // DER of the last TLS session, kept after `stopClient`. Empty if none
+    string tlsSession() const;
+
+    // session offered on the first HTTPS connections, e.g. of previous client
+    void setTLSSession(const string& session);
+
+    PoolStats getPoolStats() const;
+
+    // called on worker thread after every finished request, cancelled requests
+    // are not reported. Must be called before `startClient`
+    void setOutcomeObserver(const OutcomeObserver& observer);
+
     void startClient(IOService& ioService);
 
     void stopClient();
@@ -68,6 +166,32 @@ class NXOSHttpClient {
                      NXOSHttpClient::ResponseHandlerCallback responseHandler,
                      int                                     timeout = 10000);
 
+    // `url`, `uri` and `context` must be valid until `context.onComplete()` is called
+    void sendRequest(const Url&      url,
+                     const string&   uri,
+                     RequestContext& context,
+                     int             timeout = 10000);
+
+    // plain HTTP request without JSON-RPC envelope, e.g. for NX-API REST
+    void sendRawRequest(const Url&                 url,
+                        Method                     method,
+                        const string&              uri,
+                        const Headers&             headers,
+                        const string&              body,
+                        const string&              contentType,
+                        RawResponseHandlerCallback responseHandler,
+                        int                        timeout = 10000);
+
+    // JSON-RPC request with response parsed while it is received:
+    // events of `result.body` are passed to `bodyHandler` on worker thread,
+    // response is never stored as a whole
+    void sendStreamingRequest(const Url&               url,
+                              const string&            uri,
+                              ConstElementPtr          requestBody,
+                              StreamBodyHandlerPtr     bodyHandler,
+                              StreamCompletionCallback completionHandler,
+                              int                      timeout = 10000);
+
   private:
     boost::shared_ptr<NXOSHttpClientImpl> m_impl;
 
@@ -2,6 +2,9 @@
 #include "management_client.hpp"
 #include "nxos_connection_params.hpp"
 #include "nxos_http_client.hpp"
+#include "object_pool.hpp"
+#include "route_batcher.hpp"
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <http/basic_auth.h>
@@ -33,44 +36,138 @@ class NXOSManagementClient : public ManagementClient {
 
     string connectionName() const override;
 
+    string tlsSession() const override { return m_tlsSession; }
+
+    void setTLSSession(const string& session) override { m_tlsSession = session; }
+
+    isc::data::ElementPtr workerPoolStats() const override;
+
     void sendRoutesToSwitch(const RouteExport& route) override;
 
     void removeRoutesFromSwitch(const RouteExport& route) override;
 
+    // Routes are applied as chunks of CLI commands, one JSON-RPC request per chunk
+    // and one chunk in flight, so switch parses configuration in large blocks.
+    // Failed command is attributed to its route by JSON-RPC id and the rest
+    // of chunk after it is sent again. Chunks always go through JSON-RPC CLI
+    void applyRoutesBulk(RoutesPtr routes, const BulkApplyHandler& handler) override;
+
+    // the same chunks as `applyRoutesBulk`, with remove commands
+    void removeRoutesBulk(RoutesPtr routes, const BulkApplyHandler& handler) override;
+
+    size_t maxBulkApplies() const override { return m_params.bulkMaxInFlight; }
+
+    bool ownsRoutes() const override { return m_params.routeTag.has_value(); }
+
     void asyncGetHWAddrToInterfaceNameMapping(
         const HWAddrMappingHandler& handler) override;
 
+    void asyncGetInstalledRoutes(const InstalledRoutesHandler& handler) override;
+
+  protected:
+    NXOSHttpClientPtr          m_httpClient;
+    NXOSConnectionConfigParams m_params;
+
+  protected:
+    // send single resolved (IA_PD or IA_NAFast) route change to the switch
+    virtual void applyRouteOnSwitch(const RouteExport& route);
+
+    virtual void removeRouteOnSwitch(const RouteExport& route, bool clearNDCache);
+
+    void handleRouteApply(const RouteExport&                    route,
+                          const NXOSHttpClient::RequestContext& context);
+
+    void handleRouteRemove(const RouteExport&                    route,
+                           const NXOSHttpClient::RequestContext& context);
+
+    // log result of batched route changes, on success also clear IPv6 ND cache
+    // entries for removed IA_NA routes. Empty `failureReason` means success
+    void handleBatchResult(const RouteBatcher::OperationsPtr& ops,
+                           const string&                      failureReason);
+
   private:
-    using AddressLookupHandlerInternal =
-        std::function<void(const NXOSResponse::RouteLookupResponse&)>;
+    // State of single route operation, carried through switch lookup and
+    // apply/remove requests. Contexts are pooled, so buffers are reused
+    struct RouteRequestContext : NXOSHttpClient::RequestContext {
+        enum class Stage {
+            // relay link-address -> vlan interface (IA_NA)
+            LOOKUP_RELAY_VLAN,
+            // IA_NA addr -> vlan interface (IA_NAFuzzyRemove)
+            LOOKUP_VLAN,
+            // IA_PD prefix -> IA_NA addr (IA_PDFuzzyRemove)
+            LOOKUP_NEXTHOP,
+            APPLY,
+            REMOVE,
+        };
+
+        NXOSManagementClient* owner{nullptr};
+        RouteExport           route{};
+        Stage                 stage{Stage::APPLY};
+        bool                  remove{false};
+        // CLI commands of the request
+        string command;
+        string ndCacheCommand;
+        string vrfCommand;
+
+        void onComplete() override { owner->handleRouteRequest(*this); }
+
+        const char* spanName() const;
+    };
+
+    using RouteRequestStage = RouteRequestContext::Stage;
+
+    struct BulkApply {
+        RoutesPtr        routes;
+        BulkApplyHandler handler;
+        bool             remove{false};
+        // next route to put into chunk
+        size_t          offset{0};
+        size_t          chunks{0};
+        BulkApplyResult result;
+        // indexes of routes in chunk in flight, command id is position + 1,
+        // or position + 2 after "vrf context" of non-default VRF
+        std::vector<size_t>                   chunkRoutes;
+        VrfId                                 chunkVrf{DefaultVrfId};
+        string                                requestBody;
+        std::chrono::steady_clock::time_point startedAt;
+    };
+
+    using BulkApplyPtr = std::shared_ptr<BulkApply>;
 
   private:
-    NXOSHttpClientPtr m_httpClient;
-    // TODO: implement tls context
-    NXOSConnectionConfigParams m_params;
+    ObjectPool<RouteRequestContext> m_requestPool;
+    // offered by the first connections, taken from HTTP client when it's stopped
+    string m_tlsSession;
 
   private:
     bool clientConnectHandler(const boost::system::error_code& ec, int tcpNativeFd);
 
     void clientCloseHandler(int tcpNativeFd);
 
-    void asyncLookupAddressInternal(const string&                       lookupAddrStr,
-                                    const string&                       lookupAddrType,
-                                    const AddressLookupHandlerInternal& responseHandler);
-
-    void handleRouteApply(const string&                 routeAddrTypeStr,
-                          JsonRpcResponsePtr            response,
-                          const string&                 src,
-                          const string&                 dst,
-                          NXOSHttpClient::ResponseError responseError,
-                          NXOSHttpClient::StatusCode    statusCode,
-                          JsonRpcExceptionPtr           jsonRpcException);
-
-    void handleRouteRemove(const string&                 routeAddrTypeStr,
-                           JsonRpcResponsePtr            response,
-                           const string&                 src,
-                           const string&                 dst,
-                           NXOSHttpClient::ResponseError responseError,
-                           NXOSHttpClient::StatusCode    statusCode,
-                           JsonRpcExceptionPtr           jsonRpcException);
+    RouteRequestContext* acquireRequestContext(const RouteExport& route,
+                                               RouteRequestStage  stage,
+                                               bool               remove);
+
+    void startRouteLookup(const RouteExport& route, RouteRequestStage stage, bool remove);
+
+    void handleRouteRequest(RouteRequestContext& context);
+
+    // returns resolved IA_PD or IA_NAFast route from switch lookup response
+    std::optional<RouteExport> resolveRouteLookup(const RouteRequestContext& context);
+
+    void startBulkApply(RoutesPtr routes, bool remove, const BulkApplyHandler& handler);
+
+    void sendBulkChunk(const BulkApplyPtr& bulk);
+
+    void handleBulkChunk(const BulkApplyPtr&           bulk,
+                         const string&                 responseBody,
+                         NXOSHttpClient::ResponseError responseError,
+                         NXOSHttpClient::StatusCode    statusCode);
+
+    void finishBulkApply(const BulkApplyPtr& bulk);
+
+    // JSON-RPC id of the first route command of chunk
+    static size_t chunkCommandOffset(const BulkApply& bulk) {
+        return bulk.chunkVrf == DefaultVrfId ? 1 : 2;
+    }
 };
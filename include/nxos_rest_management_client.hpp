@@ -0,0 +1,56 @@
+#pragma once
+#include "nxos_management_client.hpp"
+#include "route_batcher.hpp"
+#include <mutex>
+
+// Management client for NX-API REST (DME) endpoints.
+// Route changes are collected into batches and sent
+// as single `ipv6Dom` subtree POST to `/api/mo`
+class NXOSRestManagementClient : public NXOSManagementClient {
+  public:
+    NXOSRestManagementClient(ConstElementPtr mgmtConnParams);
+
+    static std::string_view name() { return "nxos-rest"; }
+
+    void startClient(IOService& io_service) override;
+
+    void stopClient() override;
+
+    void asyncGetInstalledRoutes(const InstalledRoutesHandler& handler) override;
+
+  protected:
+    void applyRouteOnSwitch(const RouteExport& route) override;
+
+    void removeRouteOnSwitch(const RouteExport& route, bool clearNDCache) override;
+
+  private:
+    using RouteOperationsPtr = RouteBatcher::OperationsPtr;
+    using TokenHandler       = std::function<
+        void(const string&, NXOSHttpClient::ResponseError, NXOSHttpClient::StatusCode)>;
+
+  private:
+    RouteBatcher m_batcher;
+
+    std::mutex m_tokenMutex;
+    string     m_token;
+
+  private:
+    void sendBatch(RouteOperationsPtr ops);
+
+    void handleBatchResponse(RouteOperationsPtr            ops,
+                             const string&                 responseBody,
+                             NXOSHttpClient::ResponseError responseError,
+                             NXOSHttpClient::StatusCode    statusCode);
+
+    // send request with session token, login again once if token was expired
+    void sendAuthenticatedRequest(
+        NXOSHttpClient::Method                            method,
+        const string&                                     uri,
+        const string&                                     body,
+        const NXOSHttpClient::RawResponseHandlerCallback& handler,
+        bool                                              reloginOnAuthFailure = true);
+
+    void withToken(const TokenHandler& handler);
+
+    void invalidateToken(const string& token);
+};
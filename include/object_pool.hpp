@@ -0,0 +1,44 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Free list of reusable objects. Objects are created on first demand and
+// are destroyed only with the pool, so buffers inside them keep their capacity
+// and steady-state `acquire`/`release` doesn't touch the heap
+template <typename T>
+class ObjectPool {
+  public:
+    ObjectPool()                             = default;
+    ObjectPool(const ObjectPool&)            = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <typename... Args>
+    T* acquire(Args&&... args) {
+        std::unique_lock lock(m_mutex);
+        if (!m_free.empty()) {
+            auto* object{m_free.back()};
+            m_free.pop_back();
+            return object;
+        }
+        m_objects.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+        // reserve slot for object in free list, so `release` never grows it
+        m_free.reserve(m_objects.size());
+        return m_objects.back().get();
+    }
+
+    void release(T* object) {
+        std::unique_lock lock(m_mutex);
+        m_free.push_back(object);
+    }
+
+    size_t size() const {
+        std::unique_lock lock(m_mutex);
+        return m_objects.size();
+    }
+
+  private:
+    mutable std::mutex              m_mutex;
+    std::vector<std::unique_ptr<T>> m_objects;
+    std::vector<T*>                 m_free;
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include "common.hpp"
+#include "route_export.hpp"
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// IPv6 prefix as 128-bit integer, host bits are always zero
+struct IPv6Prefix {
+    uint64_t high{0};
+    uint64_t low{0};
+    uint8_t  length{0};
+
+    static IPv6Prefix fromAddress(const RouteAddress& addr, uint8_t length);
+
+    // "2001:db8::/48", address without length is /128
+    static std::optional<IPv6Prefix> fromText(std::string_view text);
+
+    // prefix shortened to `newLength` bits
+    IPv6Prefix truncate(uint8_t newLength) const;
+
+    // `other` is equal to or more specific than this prefix
+    bool contains(const IPv6Prefix& other) const {
+        return other.length >= length && other.truncate(length) == *this;
+    }
+
+    string toText() const;
+
+    bool operator==(const IPv6Prefix& other) const {
+        return high == other.high && low == other.low && length == other.length;
+    }
+
+    bool operator<(const IPv6Prefix& other) const {
+        if (high != other.high) { return high < other.high; }
+        if (low != other.low) { return low < other.low; }
+        return length < other.length;
+    }
+};
+
+// Sorted array of IPv6 prefixes for set operations over route tables.
+// Order (address, length) puts every prefix right before the prefixes it covers,
+// so covered prefixes form contiguous range after it and diff of two sets is
+// one merge pass. Entry carries caller's index, e.g. into vector of routes,
+// the same prefix may be present several times with different indexes
+class PrefixSet {
+  public:
+    struct Entry {
+        IPv6Prefix prefix;
+        uint32_t   index;
+    };
+
+    using Entries  = std::vector<Entry>;
+    using Iterator = Entries::const_iterator;
+
+  public:
+    PrefixSet() = default;
+    explicit PrefixSet(Entries entries);
+
+    size_t size() const { return m_entries.size(); }
+    bool   empty() const { return m_entries.empty(); }
+
+    const Entries& entries() const { return m_entries; }
+
+    // entries with exactly this prefix
+    std::pair<Iterator, Iterator> equalRange(const IPv6Prefix& prefix) const;
+
+    bool contains(const IPv6Prefix& prefix) const;
+
+    // most specific entry equal to or covering `prefix`, nullptr if none
+    const Entry* longestMatch(const IPv6Prefix& prefix) const;
+
+    // any entry covers or is covered by `prefix`
+    bool overlaps(const IPv6Prefix& prefix) const;
+
+    // (covering, covered) pairs inside the set, equal prefixes included,
+    // at most `limit` pairs
+    std::vector<std::pair<const Entry*, const Entry*>>
+        overlappingPairs(size_t limit = SIZE_MAX) const;
+
+    // One merge pass over both sets: `onlyLhs(entry)`, `onlyRhs(entry)`
+    // for prefixes present in one set, `both(lhsBegin, lhsEnd, rhsBegin, rhsEnd)`
+    // for every prefix present in both sets
+    template<typename OnlyLhs, typename OnlyRhs, typename Both>
+    static void diff(const PrefixSet& lhs,
+                     const PrefixSet& rhs,
+                     OnlyLhs&&        onlyLhs,
+                     OnlyRhs&&        onlyRhs,
+                     Both&&           both);
+
+  private:
+    Entries m_entries;
+    // bit N is set if set has prefix of length N, longest match probes only them
+    std::bitset<129> m_lengths;
+
+  private:
+    Iterator lowerBound(const IPv6Prefix& prefix) const;
+
+    static Iterator prefixEnd(Iterator it, Iterator end);
+};
+
+template<typename OnlyLhs, typename OnlyRhs, typename Both>
+void PrefixSet::diff(const PrefixSet& lhs,
+                     const PrefixSet& rhs,
+                     OnlyLhs&&        onlyLhs,
+                     OnlyRhs&&        onlyRhs,
+                     Both&&           both) {
+    auto lhsIt{lhs.m_entries.begin()}, lhsEnd{lhs.m_entries.end()};
+    auto rhsIt{rhs.m_entries.begin()}, rhsEnd{rhs.m_entries.end()};
+    while (lhsIt != lhsEnd && rhsIt != rhsEnd) {
+        if (lhsIt->prefix < rhsIt->prefix) {
+            onlyLhs(*lhsIt++);
+        } else if (rhsIt->prefix < lhsIt->prefix) {
+            onlyRhs(*rhsIt++);
+        } else {
+            auto lhsNext{prefixEnd(lhsIt, lhsEnd)};
+            auto rhsNext{prefixEnd(rhsIt, rhsEnd)};
+            both(lhsIt, lhsNext, rhsIt, rhsNext);
+            lhsIt = lhsNext;
+            rhsIt = rhsNext;
+        }
+    }
+    for (; lhsIt != lhsEnd; ++lhsIt) { onlyLhs(*lhsIt); }
+    for (; rhsIt != rhsEnd; ++rhsIt) { onlyRhs(*rhsIt); }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "common.hpp"
+#include "route_export.hpp"
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace isc::asiolink {
+    class IntervalTimer;
+    using IntervalTimerPtr = boost::shared_ptr<IntervalTimer>;
+}    // namespace isc::asiolink
+
+// Collects route changes for management clients that can send
+// many changes in one request. Later change of the same route
+// replaces previous one. Batch is flushed when it's full or by timer
+class RouteBatcher {
+  public:
+    // `route` is resolved: IA_PD or IA_NAFast
+    struct Operation {
+        RouteExport route;
+        bool        remove;
+        bool        clearNDCache;
+    };
+
+    using Operations    = std::vector<Operation>;
+    using OperationsPtr = std::shared_ptr<Operations>;
+    using FlushHandler  = std::function<void(OperationsPtr)>;
+
+  public:
+    RouteBatcher(size_t batchSize, size_t batchIntervalMs, const FlushHandler& handler);
+
+    void start(IOService& io_service);
+
+    // cancel timer and flush pending operations
+    void stop();
+
+    void push(Operation&& op);
+
+    void flush();
+
+  private:
+    // prefix + nexthop of route, same as "src dst" of CLI command
+    struct RouteKey {
+        RouteAddress addr;
+        RouteAddress nexthop;
+        InterfaceId  ifId;
+        uint8_t      prefixLength;
+        VrfId        vrfId;
+
+        bool operator==(const RouteKey& other) const;
+    };
+
+    struct RouteKeyHash {
+        size_t operator()(const RouteKey& key) const;
+    };
+
+  private:
+    size_t                          m_batchSize;
+    size_t                          m_batchIntervalMs;
+    FlushHandler                    m_flushHandler;
+    isc::asiolink::IntervalTimerPtr m_timer;
+
+    std::mutex m_batchMutex;
+    Operations m_pendingOps;
+    // route -> index inside `m_pendingOps`
+    std::unordered_map<RouteKey, size_t, RouteKeyHash> m_pendingIndex;
+
+  private:
+    OperationsPtr takePendingOperations();
+};
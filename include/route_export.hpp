@@ -1,49 +1,177 @@
 #pragma once
 #include "common.hpp"
+#include <array>
+#include <cstdint>
 #include <type_traits>
-#include <variant>
 
-struct IA_NAInfo {
-    IOAddress srcVlanAddr;
-    IOAddress ia_naAddr;
+namespace isc::dhcp {
+    class DUID;
+    using DuidPtr = boost::shared_ptr<DUID>;
+}    // namespace isc::dhcp
+
+// raw IPv6 address, converted to text only when command is created
+struct RouteAddress {
+    std::array<uint8_t, 16> bytes;
+
+    static RouteAddress fromIOAddress(const IOAddress& addr);
+
+    IOAddress toIOAddress() const;
+    string    toText() const;
+    // append text form to `out` without temporary string
+    void appendText(string& out) const;
+
+    bool operator==(const RouteAddress& other) const { return bytes == other.bytes; }
+    bool operator!=(const RouteAddress& other) const { return bytes != other.bytes; }
+};
+
+// id of interned interface name, `NoInterfaceId` means no interface
+using InterfaceId = uint32_t;
+
+constexpr InterfaceId NoInterfaceId{0};
+
+// process-wide table of interface names, names are never removed
+class InterfaceNames {
+  public:
+    static InterfaceId intern(const string& name);
+
+    static const string& name(InterfaceId id);
+};
+
+// id of interned VRF name, `DefaultVrfId` is VRF "default"
+using VrfId = uint16_t;
+
+constexpr VrfId DefaultVrfId{0};
+
+// process-wide table of VRF names, names are never removed
+class VrfNames {
+  public:
+    static const string DefaultName;
+
+    static VrfId intern(const string& name);
+
+    static const string& name(VrfId id);
 };
 
-struct IA_PDInfo {
-    IOAddress dstIa_naAddr;
-    IOAddress ia_pdPrefix;
-    uint8_t   ia_pdLength;
+enum class RouteExportType : uint8_t {
+    // IA_NA addr -> vlan interface of relay link-address
+    IA_NA,
+    // IA_PD prefix -> IA_NA addr
+    IA_PD,
+    // only IA_NA addr is known, vlan interface is taken from the switch
+    IA_NAFuzzyRemove,
+    // only IA_PD prefix is known, IA_NA addr is taken from the switch
+    IA_PDFuzzyRemove,
+    // IA_NA addr -> known vlan interface
+    IA_NAFast,
 };
 
-struct IA_NAInfoFuzzyRemove {
-    IOAddress ia_naAddr;
+struct RouteExport {
+    uint32_t        tid;
+    uint32_t        iaid;
+    uint64_t        duidHash;
+    RouteExportType type;
+    uint8_t         prefixLength;
+    InterfaceId     ifId;
+    // IA_NA addr or IA_PD prefix
+    RouteAddress addr;
+    // relay link-address for IA_NA, IA_NA addr for IA_PD
+    RouteAddress nexthop;
+    // VRF of subnet of the lease, both prefix and nexthop live there
+    VrfId vrfId;
+
+    static RouteExport makeIA_NA(uint32_t                  tid,
+                                 uint32_t                  iaid,
+                                 const isc::dhcp::DuidPtr& duid,
+                                 const IOAddress&          srcVlanAddr,
+                                 const IOAddress&          ia_naAddr);
+
+    static RouteExport makeIA_PD(uint32_t                  tid,
+                                 uint32_t                  iaid,
+                                 const isc::dhcp::DuidPtr& duid,
+                                 const IOAddress&          dstIa_naAddr,
+                                 const IOAddress&          ia_pdPrefix,
+                                 uint8_t                   ia_pdLength);
+
+    static RouteExport makeIA_NAFuzzyRemove(uint32_t                  tid,
+                                            uint32_t                  iaid,
+                                            const isc::dhcp::DuidPtr& duid,
+                                            const IOAddress&          ia_naAddr);
+
+    static RouteExport makeIA_PDFuzzyRemove(uint32_t                  tid,
+                                            uint32_t                  iaid,
+                                            const isc::dhcp::DuidPtr& duid,
+                                            const IOAddress&          ia_pdPrefix,
+                                            uint8_t                   ia_pdLength);
+
+    static RouteExport makeIA_NAFast(uint32_t                  tid,
+                                     uint32_t                  iaid,
+                                     const isc::dhcp::DuidPtr& duid,
+                                     InterfaceId               srcVlanIf,
+                                     const IOAddress&          ia_naAddr);
+
+    static uint64_t hashDUID(const isc::dhcp::DuidPtr& duid);
+
+    bool isIA_NA() const;
+
+    // "addr/len" of IA_NA addr or IA_PD prefix
+    string prefixText() const;
+
+    // IA_NA addr for IA_PD route or vlan interface name for IA_NAFast route
+    string nexthopText() const;
+
+    void appendPrefixText(string& out) const;
+    void appendNexthopText(string& out) const;
+
+    string      toString() const;
+    const char* toDHCPv6IATypeString() const;
 };
 
-struct IA_PDInfoFuzzyRemove {
-    IOAddress ia_pdPrefix;
-    uint8_t   ia_pdLength;
+static_assert(std::is_trivially_copyable_v<RouteExport>,
+              "RouteExport must be cheap to copy into callbacks");
+
+// lease of a route, later operation of the same lease replaces earlier one.
+// The same prefix may be exported into several VRFs
+struct RouteLeaseKey {
+    uint64_t     duidHash;
+    RouteAddress addr;
+    uint32_t     iaid;
+    uint8_t      prefixLength;
+    bool         isIA_NA;
+    VrfId        vrfId;
+
+    static RouteLeaseKey fromRoute(const RouteExport& route);
+
+    bool operator==(const RouteLeaseKey& other) const {
+        return duidHash == other.duidHash && addr == other.addr && iaid == other.iaid &&
+               prefixLength == other.prefixLength && isIA_NA == other.isIA_NA &&
+               vrfId == other.vrfId;
+    }
 };
 
-struct IA_NAFast {
-    string    srcVlanIfName;
-    IOAddress ia_naAddr;
+struct RouteLeaseKeyHash {
+    size_t operator()(const RouteLeaseKey& key) const;
 };
 
-namespace isc::dhcp {
-    class DUID;
-    using DuidPtr = boost::shared_ptr<DUID>;
-}    // namespace isc::dhcp
+// Binary form of route operation, shared by spool file and lease capture.
+// Record is 16-bit payload size followed by payload in host byte order:
+// flag, type, prefix length, tid, iaid, DUID hash, addr, nexthop, interface name.
+// Route of non-default VRF has NUL and VRF name after interface name
+class RouteRecord {
+  public:
+    static constexpr size_t FixedSize{3 + 4 + 4 + 8 + 16 + 16};
+    // interface and VRF names together
+    static constexpr size_t MaxNamesSize{255};
+    static constexpr size_t MaxSize{FixedSize + MaxNamesSize};
 
-struct RouteExport {
-    uint32_t           tid;
-    uint32_t           iaid;
-    isc::dhcp::DuidPtr duid;
-    std::variant<IA_NAInfo,
-                 IA_PDInfo,
-                 IA_NAInfoFuzzyRemove,
-                 IA_PDInfoFuzzyRemove,
-                 IA_NAFast>
-        routeInfo;
-
-    string toString() const;
-    string toDHCPv6IATypeString() const;
+    // flag is the operation, e.g. remove. Returns false and leaves `out` as is
+    // if names of route are longer than `MaxNamesSize`, route can't be restored
+    // from truncated names
+    static bool append(string& out, const RouteExport& route, uint8_t flag);
+
+    // parse payload of `size` bytes after size field,
+    // returns false if payload isn't a route record
+    static bool parse(const char*  payload,
+                      size_t       size,
+                      RouteExport& route,
+                      uint8_t&     flag);
 };
@@ -0,0 +1,112 @@
+#pragma once
+#include "common.hpp"
+#include "route_export.hpp"
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace isc::asiolink {
+    class IntervalTimer;
+    using IntervalTimerPtr = boost::shared_ptr<IntervalTimer>;
+}    // namespace isc::asiolink
+
+// Route operations held while the switch is unreachable.
+// Operations are queued in memory up to memory limit. When queue is full it's
+// compacted, so only the latest operation of every lease is left, and appended
+// to spool file. After the switch is back, spool is drained at fixed rate,
+// file first because it always holds older operations than memory queue.
+// While spool isn't empty new operations are queued behind it, so the switch
+// receives operations of a lease in order. Spool file is kept on stop and
+// drained after the switch is reachable again
+class RouteSpool {
+  public:
+    struct Config {
+        string path;
+        // operations in memory before they are spilled to file
+        size_t memoryLimit{10000};
+        // operations per second sent to the switch while spool is drained
+        size_t drainRate{500};
+
+        // "spool": {"path": "/var/lib/kea/nxos-exporter.spool",
+        //           "memory-limit": 10000, "drain-rate": 500}
+        static Config parseConfig(ConstElementPtr config);
+    };
+
+    struct Stats {
+        bool paused{false};
+        // operations in memory queue and not yet drained from file
+        uint64_t queued{0};
+        uint64_t spooled{0};
+        // operations written to file and dropped by compaction before it
+        uint64_t spilled{0};
+        uint64_t compacted{0};
+        // operations lost because spool file couldn't be written or read
+        uint64_t dropped{0};
+        uint64_t drained{0};
+        uint64_t fileBytes{0};
+
+        isc::data::ElementPtr toElement() const;
+    };
+
+    using ForwardHandler = std::function<void(const RouteExport& route, bool remove)>;
+
+  public:
+    // opens spool file, operations left by previous run are drained first
+    RouteSpool(const Config& config, const ForwardHandler& handler);
+    ~RouteSpool();
+    RouteSpool(const RouteSpool&)            = delete;
+    RouteSpool& operator=(const RouteSpool&) = delete;
+
+    void start(IOService& io_service);
+
+    // cancel timer and spill memory queue to file
+    void stop();
+
+    // switch is unreachable, operations are held until `resume`
+    void pause();
+
+    // switch is back, start draining
+    void resume();
+
+    // returns false if operation isn't held and must be sent to the switch
+    bool push(const RouteExport& route, bool remove);
+
+    Stats stats();
+
+  private:
+    struct Operation {
+        RouteExport route;
+        bool        remove;
+    };
+
+  private:
+    Config                          m_config;
+    ForwardHandler                  m_forwardHandler;
+    isc::asiolink::IntervalTimerPtr m_timer;
+
+    std::mutex            m_mutex;
+    std::deque<Operation> m_memory;
+    std::FILE*            m_file{nullptr};
+    // position of the first operation in file that isn't drained
+    long m_readOffset{0};
+    long m_fileSize{0};
+    // the switch is unreachable, nothing is drained
+    bool m_paused{true};
+    // drained operations are being sent outside of `m_mutex`
+    size_t m_sending{0};
+    Stats  m_stats;
+
+  private:
+    void tick();
+
+    // caller holds `m_mutex`
+    bool empty() const;
+    void spill();
+    bool readOperation(Operation& op);
+    void resetFile();
+
+    // returns false if operation can't be stored and is dropped
+    static bool appendRecord(string& out, const Operation& op);
+};
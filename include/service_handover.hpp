@@ -0,0 +1,49 @@
+#pragma once
+#include "common.hpp"
+#include "ha_ownership.hpp"
+#include <initializer_list>
+#include <optional>
+
+// Passive state of the service handed from unloaded hooks library to its next
+// load. Kea unloads the library on every reconfiguration, the service is
+// stopped with its threads and timers, and the next service starts warm with:
+// - uptime of the switch seen by the last heartbeat, routes aren't restored
+//   if the switch wasn't reloaded meanwhile
+// - TLS session of management client, resumed by its first connections
+// - HA state and shadow route state of this server
+// State is written to handover file on unload and taken by the next load of the
+// same process within `max-age`. File is 8-byte magic, JSON header, TLS session
+// and shadow operations as route records with remove flag. Header keeps hashes
+// of parameters instead of parameters with credentials
+struct ServiceHandover {
+    struct Config {
+        string path;
+        size_t maxAgeMs{60000};
+
+        // "handover": {"path": "/var/lib/kea/nxos-exporter.handover",
+        //              "max-age": 60000}
+        static Config parseConfig(ConstElementPtr config);
+    };
+
+    static constexpr char Magic[8]{'N', 'X', 'E', 'X', 'H', 'N', 'D', '1'};
+
+    // connection to the switch and VRFs, and HA parameters state belongs to
+    size_t connectionHash{0};
+    size_t haHash{0};
+    // nullopt if routes may be missing on the switch
+    std::optional<size_t> switchUptimeSecs;
+    // DER of TLS session, empty without TLS
+    string tlsSession;
+    // null without HA
+    std::optional<HAOwnership::Handover> ha;
+
+    // hash of hook parameters, missing ones included
+    static size_t hashParams(std::initializer_list<ConstElementPtr> params);
+
+    // replaces handover file, only owner can read it. Throws on failure
+    void write(const Config& config) const;
+
+    // reads and removes handover file, nullopt if there is none. Stale file
+    // or file of another process is logged and discarded
+    static std::optional<ServiceHandover> take(const Config& config);
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include "common.hpp"
+#include "route_export.hpp"
+#include <atomic>
+#include <cstdint>
+
+// OpenTelemetry-compatible spans of the export pipeline, written as OTLP/JSON
+// lines (one `ExportTraceServiceRequest` per line) into local file.
+// Trace id is derived from DUID hash, transaction id and IAID of the route,
+// so every stage of one lease event lands in the same trace without carrying
+// context, and sampling decision is the same at every stage
+class SpanTracer {
+  public:
+    // Root span of Kea callout. Routes exported or removed inside the callout
+    // are attached to it by `attachRoute` and become traces of the span
+    class CalloutScope {
+      public:
+        explicit CalloutScope(const char* name);
+        ~CalloutScope();
+        CalloutScope(const CalloutScope&)            = delete;
+        CalloutScope& operator=(const CalloutScope&) = delete;
+
+      private:
+        // renew may remove old route and export new one
+        static constexpr size_t MaxRoutes{2};
+
+        const char*   m_name;
+        uint64_t      m_start;
+        CalloutScope* m_previous;
+        RouteExport   m_routes[MaxRoutes];
+        size_t        m_routesSize{0};
+
+      private:
+        friend class SpanTracer;
+    };
+
+  public:
+    // "tracing": {"file": "/var/log/kea/exporter-spans.json", "sample-ratio": 0.01}
+    // null config disables tracing
+    static void configure(ConstElementPtr config);
+
+    // write buffered spans and close file
+    static void shutdown();
+
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // span clock in ns since epoch, 0 if tracing is disabled,
+    // spans with zero start are dropped by `record`
+    static uint64_t now();
+
+    static bool sampled(const RouteExport& route);
+
+    static void attachRoute(const RouteExport& route);
+
+    // child span of the route's callout span
+    static void record(const char*        name,
+                       const RouteExport& route,
+                       uint64_t           start,
+                       uint64_t           end,
+                       int32_t            httpStatus = 0,
+                       bool               error      = false);
+
+  private:
+    static std::atomic<bool> s_enabled;
+
+  private:
+    static void recordSpan(const char*        name,
+                           const RouteExport& route,
+                           uint64_t           start,
+                           uint64_t           end,
+                           bool               root,
+                           int32_t            httpStatus,
+                           bool               error);
+};
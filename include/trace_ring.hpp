@@ -0,0 +1,75 @@
+#pragma once
+#include "route_export.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+enum class TraceEventType : uint8_t {
+    EXPORT_ROUTE,
+    REMOVE_ROUTE,
+    ROUTE_APPLY_SUCCESS,
+    ROUTE_APPLY_FAILED,
+    ROUTE_REMOVE_SUCCESS,
+    ROUTE_REMOVE_FAILED,
+};
+
+// compact record of one event on the lease/route path, no strings inside
+struct TraceEvent {
+    // nanoseconds since epoch
+    uint64_t       timestamp;
+    uint32_t       threadIndex;
+    TraceEventType type;
+    // HTTP status code or other event-specific result, 0 if none
+    int32_t     result;
+    RouteExport route;
+};
+
+static_assert(std::is_trivially_copyable_v<TraceEvent>,
+              "TraceEvent is copied into ring without formatting");
+
+// Per-thread ring buffers of trace events. Writer is always the owning thread,
+// so `record` is a copy and two atomic stores; reader validates every slot
+// by its sequence number and skips slots overwritten during the copy.
+// Ring of exited thread keeps its events and is reused by the next new thread,
+// so events of finished threads stay visible until the new owner overwrites
+// them and number of rings is bounded by peak number of threads
+class TraceRing {
+  public:
+    // events kept per thread, power of two
+    static constexpr size_t Capacity{4096};
+
+  public:
+    static void record(TraceEventType type, const RouteExport& route, int32_t result = 0);
+
+    // events of all threads ordered by time, at most `limit` latest ones
+    static std::vector<TraceEvent> dump(size_t limit = SIZE_MAX);
+
+    // decoded event for `exporter-trace-dump` command
+    static isc::data::ElementPtr toElement(const TraceEvent& event);
+
+    static const char* typeToString(TraceEventType type);
+
+  private:
+    struct Slot {
+        // index of event + 1, 0 while slot is written
+        std::atomic<uint64_t> sequence{0};
+        TraceEvent            event;
+    };
+
+    struct Ring {
+        uint32_t                threadIndex{0};
+        std::atomic<uint64_t>   head{0};
+        std::unique_ptr<Slot[]> slots{new Slot[Capacity]};
+    };
+
+    struct Registry;
+
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be power of two");
+
+  private:
+    static Registry& registry();
+
+    static Ring& threadRing();
+};
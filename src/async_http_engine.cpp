@@ -0,0 +1,909 @@
+#include "async_http_engine.hpp"
+#include <algorithm>
+#include <array>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/version.hpp>
+#include <charconv>
+#include <deque>
+#include <openssl/ssl.h>
+
+namespace asio = boost::asio;
+using asio::ip::tcp;
+using boost::system::error_code;
+
+namespace {
+    // response head larger than this is treated as broken response
+    constexpr size_t MaxResponseHeadBytes{64 * 1024};
+    constexpr char   JsonRpcContentType[]{"application/json-rpc"};
+
+    bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+        return lhs.size() == rhs.size() &&
+               std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](char a, char b) {
+                   return std::tolower(static_cast<unsigned char>(a)) ==
+                          std::tolower(static_cast<unsigned char>(b));
+               });
+    }
+
+    bool containsIgnoreCase(std::string_view value, std::string_view token) {
+        if (token.size() > value.size()) { return false; }
+        for (size_t i = 0; i + token.size() <= value.size(); ++i) {
+            if (equalsIgnoreCase(value.substr(i, token.size()), token)) { return true; }
+        }
+        return false;
+    }
+
+    std::string_view trim(std::string_view value) {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+            value.remove_prefix(1);
+        }
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+            value.remove_suffix(1);
+        }
+        return value;
+    }
+
+    // Incremental parser of HTTP/1.1 response, body is collected into `body`
+    // or passed to `receiver` with chunked transfer encoding already removed
+    class ResponseParser {
+      public:
+        enum class Result { NEED_MORE, DONE, ERROR, ABORTED };
+
+        int                                  status{0};
+        bool                                 keepAlive{true};
+        string                               body;
+        const AsyncHttpEngine::BodyReceiver* receiver{nullptr};
+
+      public:
+        void reset() {
+            m_state = State::HEAD;
+            m_head.clear();
+            m_line.clear();
+            m_remaining = 0;
+            status      = 0;
+            keepAlive   = true;
+            receiver    = nullptr;
+            body.clear();
+        }
+
+        bool started() const { return m_state != State::HEAD || !m_head.empty(); }
+
+        Result feed(std::string_view data) {
+            while (!data.empty() && m_state != State::DONE) {
+                switch (m_state) {
+                    case State::HEAD: {
+                        auto previousSize{m_head.size()};
+                        m_head.append(data);
+                        // terminator may start in previous part of head
+                        auto from{previousSize < 3 ? 0 : previousSize - 3};
+                        auto end{m_head.find("\r\n\r\n", from)};
+                        if (end == string::npos) {
+                            if (m_head.size() > MaxResponseHeadBytes) {
+                                return Result::ERROR;
+                            }
+                            return Result::NEED_MORE;
+                        }
+                        data = data.substr(end + 4 - previousSize);
+                        m_head.resize(end);
+                        if (!parseHead()) { return Result::ERROR; }
+                    } break;
+                    case State::BODY: {
+                        auto size{std::min(data.size(), m_remaining)};
+                        if (!appendBody(data.substr(0, size))) { return Result::ABORTED; }
+                        data.remove_prefix(size);
+                        m_remaining -= size;
+                        if (!m_remaining) { m_state = State::DONE; }
+                    } break;
+                    case State::UNTIL_CLOSE: {
+                        if (!appendBody(data)) { return Result::ABORTED; }
+                        data = {};
+                    } break;
+                    case State::CHUNK_DATA: {
+                        auto size{std::min(data.size(), m_remaining)};
+                        if (!appendBody(data.substr(0, size))) { return Result::ABORTED; }
+                        data.remove_prefix(size);
+                        m_remaining -= size;
+                        if (!m_remaining) { m_state = State::CHUNK_DATA_END; }
+                    } break;
+                    case State::CHUNK_SIZE:
+                    case State::CHUNK_DATA_END:
+                    case State::TRAILER: {
+                        if (!readLine(data)) { return Result::NEED_MORE; }
+                        if (!parseLine()) { return Result::ERROR; }
+                    } break;
+                    case State::DONE: break;
+                }
+            }
+            if (m_state != State::DONE) { return Result::NEED_MORE; }
+            // server must not send anything before next request
+            if (!data.empty()) { keepAlive = false; }
+            return Result::DONE;
+        }
+
+        // connection is closed by the server
+        Result finish() {
+            if (m_state != State::UNTIL_CLOSE) { return Result::ERROR; }
+            m_state   = State::DONE;
+            keepAlive = false;
+            return Result::DONE;
+        }
+
+      private:
+        enum class State {
+            HEAD,
+            BODY,
+            UNTIL_CLOSE,
+            CHUNK_SIZE,
+            CHUNK_DATA,
+            CHUNK_DATA_END,
+            TRAILER,
+            DONE,
+        };
+
+        State  m_state{State::HEAD};
+        string m_head;
+        string m_line;
+        size_t m_remaining{0};
+
+      private:
+        bool parseHead() {
+            std::string_view head{m_head};
+            auto             lineEnd{head.find("\r\n")};
+            auto             statusLine{head.substr(0, lineEnd)};
+            // "HTTP/1.1 200 OK"
+            if (statusLine.size() < 12 || statusLine.substr(0, 5) != "HTTP/") {
+                return false;
+            }
+            bool http10{statusLine.substr(5, 3) == "1.0"};
+            auto statusText{statusLine.substr(9, 3)};
+            auto [ptr, ec]{std::from_chars(
+                statusText.data(), statusText.data() + statusText.size(), status)};
+            if (ec != std::errc()) { return false; }
+
+            keepAlive = !http10;
+            bool                  chunked{false};
+            std::optional<size_t> contentLength;
+            while (lineEnd != std::string_view::npos) {
+                head.remove_prefix(lineEnd + 2);
+                lineEnd = head.find("\r\n");
+                auto line{head.substr(0, lineEnd)};
+                auto colon{line.find(':')};
+                if (colon == std::string_view::npos) { continue; }
+                auto name{trim(line.substr(0, colon))};
+                auto value{trim(line.substr(colon + 1))};
+                if (equalsIgnoreCase(name, "Content-Length")) {
+                    size_t length{0};
+                    auto [lengthPtr, lengthEc]{std::from_chars(
+                        value.data(), value.data() + value.size(), length)};
+                    if (lengthEc != std::errc()) { return false; }
+                    contentLength = length;
+                } else if (equalsIgnoreCase(name, "Transfer-Encoding")) {
+                    chunked = containsIgnoreCase(value, "chunked");
+                } else if (equalsIgnoreCase(name, "Connection")) {
+                    if (containsIgnoreCase(value, "close")) { keepAlive = false; }
+                    if (containsIgnoreCase(value, "keep-alive")) { keepAlive = true; }
+                }
+            }
+
+            if (status / 100 == 1 || status == 204 || status == 304) {
+                m_state = State::DONE;
+            } else if (chunked) {
+                m_state = State::CHUNK_SIZE;
+            } else if (contentLength) {
+                m_remaining = *contentLength;
+                m_state     = m_remaining ? State::BODY : State::DONE;
+            } else {
+                m_state   = State::UNTIL_CLOSE;
+                keepAlive = false;
+            }
+            if (contentLength && !receiver) { body.reserve(*contentLength); }
+            return true;
+        }
+
+        bool appendBody(std::string_view data) {
+            if (receiver) {
+                return data.empty() || (*receiver)(data.data(), data.size());
+            }
+            body.append(data);
+            return true;
+        }
+
+        // collects line into `m_line`, returns true when line is complete
+        bool readLine(std::string_view& data) {
+            auto end{data.find('\n')};
+            if (end == std::string_view::npos) {
+                m_line.append(data);
+                data = {};
+                return false;
+            }
+            m_line.append(data.substr(0, end));
+            data.remove_prefix(end + 1);
+            if (!m_line.empty() && m_line.back() == '\r') { m_line.pop_back(); }
+            return true;
+        }
+
+        bool parseLine() {
+            std::string_view line{m_line};
+            bool             valid{true};
+            switch (m_state) {
+                case State::CHUNK_SIZE: {
+                    // chunk extensions after ';' are ignored
+                    auto sizeText{trim(line.substr(0, line.find(';')))};
+                    size_t size{0};
+                    auto [ptr, ec]{std::from_chars(
+                        sizeText.data(), sizeText.data() + sizeText.size(), size, 16)};
+                    valid = ec == std::errc() && !sizeText.empty();
+                    if (size) {
+                        m_remaining = size;
+                        m_state     = State::CHUNK_DATA;
+                    } else {
+                        m_state = State::TRAILER;
+                    }
+                } break;
+                case State::CHUNK_DATA_END: {
+                    valid   = line.empty();
+                    m_state = State::CHUNK_SIZE;
+                } break;
+                case State::TRAILER: {
+                    if (line.empty()) { m_state = State::DONE; }
+                } break;
+                default: valid = false;
+            }
+            m_line.clear();
+            return valid;
+        }
+    };
+
+    struct PendingRequest {
+        AsyncHttpEngine::Request         request;
+        AsyncHttpEngine::ResponseHandler handler;
+    };
+}    // namespace
+
+// client TLS context shared by all connections of the engine,
+// the last negotiated session is offered on each new connection
+struct AsyncHttpEngine::TLSState {
+    asio::ssl::context context{asio::ssl::context::tls_client};
+    bool               verifyServer{false};
+
+    std::mutex   sessionMutex;
+    SSL_SESSION* session{nullptr};
+
+    std::atomic<uint64_t> connectionsOpened{0};
+    std::atomic<uint64_t> fullHandshakes{0};
+    std::atomic<uint64_t> resumedHandshakes{0};
+
+    ~TLSState() {
+        if (session) { SSL_SESSION_free(session); }
+    }
+
+    // app data of context is taken by asio for verify callback
+    static int exDataIndex() {
+        static const int index{
+            SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr)};
+        return index;
+    }
+
+    static int newSessionCallback(SSL* ssl, SSL_SESSION* newSession) {
+        auto* self{static_cast<TLSState*>(
+            SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), exDataIndex()))};
+        if (!self) { return 0; }
+        std::unique_lock lock(self->sessionMutex);
+        if (self->session) { SSL_SESSION_free(self->session); }
+        // keep reference passed by OpenSSL
+        self->session = newSession;
+        return 1;
+    }
+};
+
+class AsyncHttpEngine::HostPool : public std::enable_shared_from_this<HostPool> {
+  public:
+    asio::io_context&         ioContext;
+    // URL of the switch for log messages
+    string                    name;
+    string                    host;
+    string                    port;
+    // value of "Host" header
+    string                    hostHeader;
+    string                    authorization;
+    std::shared_ptr<TLSState> tls;
+
+  public:
+    HostPool(asio::io_context&         ioContext,
+             const Url&                url,
+             const string&             authorization,
+             std::shared_ptr<TLSState> tls,
+             size_t                    maxConnections) :
+        ioContext(ioContext),
+        name(url.toText()),
+        host(url.getStrippedHostname()),
+        port(std::to_string(url.getPort())),
+        hostHeader(url.getHostname() + ":" + port),
+        authorization(authorization),
+        tls(std::move(tls)),
+        m_maxConnections(maxConnections) {}
+
+    void submit(PendingRequest&& pending);
+
+    // connection finished request, it's reused for next queued request
+    // or kept idle if server allows it
+    void release(const std::shared_ptr<Connection>& connection, bool keepAlive);
+
+    void stop();
+
+    // credentials of the pool are replaced, idle connections are closed and
+    // busy ones are closed after their request
+    void retire();
+
+    bool stopped() {
+        std::unique_lock lock(m_mutex);
+        return m_stopped;
+    }
+
+  private:
+    size_t m_maxConnections;
+
+    std::mutex                               m_mutex;
+    std::deque<PendingRequest>               m_pending;
+    std::vector<std::shared_ptr<Connection>> m_idle;
+    // all open connections, busy ones are closed on stop
+    std::vector<std::weak_ptr<Connection>> m_connections;
+    bool                                   m_stopped{false};
+    bool                                   m_retired{false};
+
+  private:
+    // caller holds `m_mutex`
+    std::shared_ptr<Connection> createConnection();
+};
+
+// One keep-alive connection. All its operations run on own strand,
+// so socket, timer and parser are never touched concurrently
+class AsyncHttpEngine::Connection : public std::enable_shared_from_this<Connection> {
+  public:
+    explicit Connection(HostPoolPtr pool) :
+        m_pool(std::move(pool)),
+        m_strand(asio::make_strand(m_pool->ioContext)),
+        m_resolver(m_strand),
+        m_socket(m_strand),
+        m_timer(m_strand) {}
+
+    void run(PendingRequest&& pending) {
+        asio::post(m_strand, [self = shared_from_this(),
+                              pending = std::move(pending)]() mutable {
+            self->startRequest(std::move(pending));
+        });
+    }
+
+    void close() {
+        asio::post(m_strand, [self = shared_from_this()] { self->closeSocket(); });
+    }
+
+  private:
+    enum class Stage { RESOLVE, CONNECT, HANDSHAKE, WRITE, READ };
+
+    using TLSStream = asio::ssl::stream<tcp::socket&>;
+
+    using Strand = asio::strand<asio::io_context::executor_type>;
+
+    HostPoolPtr                 m_pool;
+    Strand                      m_strand;
+    tcp::resolver               m_resolver;
+    tcp::socket                 m_socket;
+    std::unique_ptr<TLSStream>  m_tls;
+    asio::steady_timer          m_timer;
+    PendingRequest              m_pending;
+    string                      m_requestText;
+    ResponseParser              m_parser;
+    std::array<char, 16 * 1024> m_readBuffer;
+    Stage                       m_stage{Stage::RESOLVE};
+    // timer of finished request may fire after next request is started
+    uint64_t m_requestId{0};
+    bool     m_busy{false};
+    // request is sent over connection used before, server may have closed it
+    bool m_reused{false};
+    bool m_timedOut{false};
+
+  private:
+    void startRequest(PendingRequest&& pending);
+
+    void buildRequestText();
+
+    void connect();
+
+    void handshake();
+
+    void write();
+
+    void read();
+
+    void onError(const error_code& ec);
+
+    void complete(NXOSHttpClient::ResponseError error);
+
+    void closeSocket();
+
+    template<typename Function>
+    void withStream(Function&& function) {
+        if (m_tls) {
+            function(*m_tls);
+        } else {
+            function(m_socket);
+        }
+    }
+};
+
+void AsyncHttpEngine::HostPool::submit(PendingRequest&& pending) {
+    std::shared_ptr<Connection> connection;
+    {
+        std::unique_lock lock(m_mutex);
+        if (m_stopped) {
+            lock.unlock();
+            string body;
+            pending.handler(NXOSHttpClient::CANCELED, 0, body);
+            return;
+        }
+        if (!m_idle.empty()) {
+            connection = std::move(m_idle.back());
+            m_idle.pop_back();
+        } else if (m_connections.size() < m_maxConnections) {
+            connection = createConnection();
+        } else {
+            m_pending.push_back(std::move(pending));
+            return;
+        }
+    }
+    connection->run(std::move(pending));
+}
+
+std::shared_ptr<AsyncHttpEngine::Connection>
+    AsyncHttpEngine::HostPool::createConnection() {
+    auto connection{std::make_shared<Connection>(shared_from_this())};
+    m_connections.push_back(connection);
+    return connection;
+}
+
+void AsyncHttpEngine::HostPool::release(const std::shared_ptr<Connection>& connection,
+                                        bool                               keepAlive) {
+    std::shared_ptr<Connection> next;
+    PendingRequest              pending;
+    {
+        std::unique_lock lock(m_mutex);
+        if (!keepAlive || m_stopped || m_retired) {
+            // socket of kept-alive connection of retired pool is still open
+            if (keepAlive) { connection->close(); }
+            // connection is closed, it's replaced by new one if requests are queued
+            m_connections.erase(
+                std::remove_if(m_connections.begin(), m_connections.end(),
+                               [&connection](const std::weak_ptr<Connection>& item) {
+                                   auto locked{item.lock()};
+                                   return !locked || locked == connection;
+                               }),
+                m_connections.end());
+            if (m_pending.empty() || m_stopped) { return; }
+            next = createConnection();
+        } else if (m_pending.empty()) {
+            m_idle.push_back(connection);
+            return;
+        } else {
+            next = connection;
+        }
+        pending = std::move(m_pending.front());
+        m_pending.pop_front();
+    }
+    next->run(std::move(pending));
+}
+
+void AsyncHttpEngine::HostPool::stop() {
+    std::deque<PendingRequest>              pending;
+    std::vector<std::shared_ptr<Connection>> connections;
+    {
+        std::unique_lock lock(m_mutex);
+        m_stopped = true;
+        pending.swap(m_pending);
+        m_idle.clear();
+        for (const auto& item : m_connections) {
+            if (auto connection{item.lock()}) { connections.push_back(connection); }
+        }
+        m_connections.clear();
+    }
+    // busy connections complete their requests with CANCELED
+    for (const auto& connection : connections) { connection->close(); }
+    for (auto& request : pending) {
+        string body;
+        request.handler(NXOSHttpClient::CANCELED, 0, body);
+    }
+}
+
+void AsyncHttpEngine::HostPool::retire() {
+    std::vector<std::shared_ptr<Connection>> idle;
+    {
+        std::unique_lock lock(m_mutex);
+        m_retired = true;
+        idle.swap(m_idle);
+    }
+    for (const auto& connection : idle) { connection->close(); }
+}
+
+void AsyncHttpEngine::Connection::startRequest(PendingRequest&& pending) {
+    m_pending  = std::move(pending);
+    m_reused   = m_socket.is_open();
+    m_timedOut = false;
+    m_busy     = true;
+    m_requestId++;
+    // idle connection closed by its pool keeps stream of the closed socket
+    if (!m_reused) { m_tls.reset(); }
+    m_parser.reset();
+    if (m_pending.request.receiver) { m_parser.receiver = &m_pending.request.receiver; }
+    buildRequestText();
+
+    m_timer.expires_after(std::chrono::milliseconds(m_pending.request.timeout));
+    m_timer.async_wait([self = shared_from_this(),
+                        id   = m_requestId](const error_code& ec) {
+        if (ec || !self->m_busy || self->m_requestId != id) { return; }
+        // pending operation completes with `operation_aborted`
+        self->m_timedOut = true;
+        self->closeSocket();
+    });
+
+    if (m_reused) {
+        write();
+    } else {
+        connect();
+    }
+}
+
+void AsyncHttpEngine::Connection::buildRequestText() {
+    const auto&   request{m_pending.request};
+    const string& body{request.bodyRef ? *request.bodyRef : request.body};
+    bool          post{request.method == NXOSHttpClient::Method::POST};
+    m_requestText.clear();
+    m_requestText.reserve(256 + body.size());
+    m_requestText += post ? "POST " : "GET ";
+    m_requestText += request.uri;
+    m_requestText += " HTTP/1.1\r\nHost: ";
+    m_requestText += m_pool->hostHeader;
+    m_requestText += "\r\nConnection: keep-alive\r\n";
+    if (!m_pool->authorization.empty()) {
+        m_requestText += "Authorization: ";
+        m_requestText += m_pool->authorization;
+        m_requestText += "\r\n";
+    }
+    for (const auto& [name, value] : request.headers) {
+        m_requestText += name;
+        m_requestText += ": ";
+        m_requestText += value;
+        m_requestText += "\r\n";
+    }
+    if (post) {
+        m_requestText += "Content-Type: ";
+        if (request.contentType.empty()) {
+            m_requestText += JsonRpcContentType;
+        } else {
+            m_requestText += request.contentType;
+        }
+        m_requestText += "\r\nContent-Length: ";
+        m_requestText += std::to_string(body.size());
+        m_requestText += "\r\n\r\n";
+        m_requestText += body;
+    } else {
+        m_requestText += "\r\n";
+    }
+}
+
+void AsyncHttpEngine::Connection::connect() {
+    m_stage = Stage::RESOLVE;
+    m_resolver.async_resolve(
+        m_pool->host, m_pool->port,
+        [self = shared_from_this()](const error_code&            ec,
+                                    const tcp::resolver::results_type& endpoints) {
+            if (ec || self->m_timedOut) {
+                self->onError(ec);
+                return;
+            }
+            self->m_stage = Stage::CONNECT;
+            asio::async_connect(self->m_socket, endpoints,
+                                [self](const error_code& ec, const tcp::endpoint&) {
+                                    if (ec || self->m_timedOut) {
+                                        self->onError(ec);
+                                        return;
+                                    }
+                                    self->m_socket.set_option(tcp::no_delay(true));
+                                    if (self->m_pool->tls) {
+                                        self->handshake();
+                                    } else {
+                                        self->write();
+                                    }
+                                });
+        });
+}
+
+void AsyncHttpEngine::Connection::handshake() {
+    m_stage = Stage::HANDSHAKE;
+    auto& tls{*m_pool->tls};
+    m_tls = std::make_unique<TLSStream>(m_socket, tls.context);
+    auto* ssl{m_tls->native_handle()};
+    SSL_set_tlsext_host_name(ssl, m_pool->host.c_str());
+    if (tls.verifyServer) {
+#if BOOST_VERSION >= 107300
+        m_tls->set_verify_callback(asio::ssl::host_name_verification(m_pool->host));
+#else
+        m_tls->set_verify_callback(asio::ssl::rfc2818_verification(m_pool->host));
+#endif
+    }
+    tls.connectionsOpened++;
+    {
+        std::unique_lock lock(tls.sessionMutex);
+        if (tls.session && SSL_SESSION_is_resumable(tls.session)) {
+            SSL_set_session(ssl, tls.session);
+        }
+    }
+    m_tls->async_handshake(TLSStream::client, [self = shared_from_this()](
+                                                  const error_code& ec) {
+        if (ec || self->m_timedOut) {
+            self->onError(ec);
+            return;
+        }
+        auto& tls{*self->m_pool->tls};
+        if (SSL_session_reused(self->m_tls->native_handle())) {
+            tls.resumedHandshakes++;
+        } else {
+            tls.fullHandshakes++;
+        }
+        self->write();
+    });
+}
+
+void AsyncHttpEngine::Connection::write() {
+    m_stage = Stage::WRITE;
+    withStream([this](auto& stream) {
+        asio::async_write(stream, asio::buffer(m_requestText),
+                          [self = shared_from_this()](const error_code& ec, size_t) {
+                              if (ec || self->m_timedOut) {
+                                  self->onError(ec);
+                                  return;
+                              }
+                              self->read();
+                          });
+    });
+}
+
+void AsyncHttpEngine::Connection::read() {
+    m_stage = Stage::READ;
+    withStream([this](auto& stream) {
+        stream.async_read_some(
+            asio::buffer(m_readBuffer),
+            [self = shared_from_this()](const error_code& ec, size_t size) {
+                if (self->m_timedOut) {
+                    self->onError(ec);
+                    return;
+                }
+                if (ec) {
+                    // body without length ends with connection
+                    bool closed{ec == asio::error::eof ||
+                                ec == asio::ssl::error::stream_truncated};
+                    if (closed && self->m_parser.finish() ==
+                                      ResponseParser::Result::DONE) {
+                        self->complete(NXOSHttpClient::SUCCESS);
+                    } else {
+                        self->onError(ec);
+                    }
+                    return;
+                }
+                switch (self->m_parser.feed({self->m_readBuffer.data(), size})) {
+                    case ResponseParser::Result::NEED_MORE: self->read(); break;
+                    case ResponseParser::Result::DONE:
+                        self->complete(NXOSHttpClient::SUCCESS);
+                        break;
+                    case ResponseParser::Result::ERROR:
+                        self->complete(NXOSHttpClient::READ);
+                        break;
+                    case ResponseParser::Result::ABORTED:
+                        self->complete(NXOSHttpClient::CANCELED);
+                        break;
+                }
+            });
+    });
+}
+
+void AsyncHttpEngine::Connection::onError(const error_code& ec) {
+    if (m_pool->stopped()) {
+        complete(NXOSHttpClient::CANCELED);
+        return;
+    }
+    if (m_timedOut) {
+        complete(m_stage == Stage::WRITE || m_stage == Stage::READ
+                     ? NXOSHttpClient::READ
+                     : NXOSHttpClient::CONNECTION_TIMEOUT);
+        return;
+    }
+    // server closed idle keep-alive connection before request reached it
+    if (m_reused && (m_stage == Stage::WRITE || !m_parser.started())) {
+        closeSocket();
+        m_tls.reset();
+        m_reused = false;
+        m_parser.reset();
+        connect();
+        return;
+    }
+    LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_UPDATE_INFO_COMMUNICATION_FAILED)
+        .arg(m_pool->name)
+        .arg(ec.message());
+    switch (m_stage) {
+        case Stage::RESOLVE:
+        case Stage::CONNECT: complete(NXOSHttpClient::CONNECTION); break;
+        case Stage::HANDSHAKE: complete(NXOSHttpClient::SSL_CONNECTION); break;
+        case Stage::WRITE: complete(NXOSHttpClient::WRITE); break;
+        case Stage::READ: complete(NXOSHttpClient::READ); break;
+    }
+}
+
+void AsyncHttpEngine::Connection::complete(NXOSHttpClient::ResponseError error) {
+    m_busy = false;
+    m_timer.cancel();
+    bool keepAlive{error == NXOSHttpClient::SUCCESS && m_parser.keepAlive};
+    if (!keepAlive) {
+        closeSocket();
+        // handler of the last operation on the stream runs here
+        m_tls.reset();
+    }
+    auto pending{std::move(m_pending)};
+    // next request runs on this strand only after handler returns, so handler
+    // gets buffer of the parser and buffer it swaps in is reused
+    m_pool->release(shared_from_this(), keepAlive);
+    pending.handler(error, m_parser.status, m_parser.body);
+}
+
+void AsyncHttpEngine::Connection::closeSocket() {
+    error_code ignored;
+    m_resolver.cancel();
+    if (m_tls) {
+        // OpenSSL marks session of SSL freed without shutdown as not resumable,
+        // quiet shutdown only sets the flags and sends nothing
+        SSL_set_quiet_shutdown(m_tls->native_handle(), 1);
+        SSL_shutdown(m_tls->native_handle());
+    }
+    m_socket.shutdown(tcp::socket::shutdown_both, ignored);
+    m_socket.close(ignored);
+    // aborted operation may still be queued on TLS stream, it's dropped
+    // after that operation completed, in `complete` or next `startRequest`
+}
+
+AsyncHttpEngine::AsyncHttpEngine(asio::io_context& ioContext, size_t maxConnections) :
+    m_ioContext(ioContext), m_maxConnections(maxConnections) {}
+
+AsyncHttpEngine::~AsyncHttpEngine() { stop(); }
+
+void AsyncHttpEngine::setBasicAuth(const isc::http::BasicHttpAuthPtr& auth) {
+    m_authorization = auth ? "Basic " + auth->getCredential() : string();
+}
+
+void AsyncHttpEngine::setTLSInfo(const TLSInfo& tlsInfo) {
+    auto tls{std::make_shared<TLSState>()};
+    try {
+        tls->context.use_certificate_chain_file(tlsInfo.certFile);
+        tls->context.use_private_key_file(tlsInfo.keyFile, asio::ssl::context::pem);
+        // without CA file server certificate is not verified,
+        // NX-OS uses self-signed certificate by default
+        if (tlsInfo.caFile) {
+            tls->context.load_verify_file(*tlsInfo.caFile);
+            tls->context.set_verify_mode(asio::ssl::verify_peer);
+            tls->verifyServer = true;
+        } else {
+            tls->context.set_verify_mode(asio::ssl::verify_none);
+        }
+    } catch (const boost::system::system_error& ex) {
+        isc_throw(isc::BadValue, "failed to load TLS credentials: " << ex.what());
+    }
+    auto* sslCtx{tls->context.native_handle()};
+    SSL_CTX_set_ex_data(sslCtx, TLSState::exDataIndex(), tls.get());
+    // sessions are stored only by `newSessionCallback`
+    SSL_CTX_set_session_cache_mode(
+        sslCtx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(sslCtx, &TLSState::newSessionCallback);
+    // pools keep context of their connections alive until they are closed
+    std::vector<HostPoolPtr> retired;
+    {
+        std::unique_lock lock(m_poolsMutex);
+        if (m_tls) {
+            m_retiredStats.connectionsOpened += m_tls->connectionsOpened;
+            m_retiredStats.fullHandshakes += m_tls->fullHandshakes;
+            m_retiredStats.resumedHandshakes += m_tls->resumedHandshakes;
+        }
+        m_tls = std::move(tls);
+        for (auto it{m_pools.begin()}; it != m_pools.end();) {
+            if (it->second->tls) {
+                retired.push_back(std::move(it->second));
+                it = m_pools.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (const auto& pool : retired) { pool->retire(); }
+}
+
+string AsyncHttpEngine::tlsSession() const {
+    std::shared_ptr<TLSState> tls;
+    {
+        std::unique_lock lock(m_poolsMutex);
+        tls = m_tls;
+    }
+    if (!tls) { return {}; }
+    std::unique_lock lock(tls->sessionMutex);
+    if (!tls->session || !SSL_SESSION_is_resumable(tls->session)) { return {}; }
+    int size{i2d_SSL_SESSION(tls->session, nullptr)};
+    if (size <= 0) { return {}; }
+    string session(static_cast<size_t>(size), '\0');
+    auto*  out{reinterpret_cast<unsigned char*>(session.data())};
+    i2d_SSL_SESSION(tls->session, &out);
+    return session;
+}
+
+void AsyncHttpEngine::setTLSSession(const string& session) {
+    std::shared_ptr<TLSState> tls;
+    {
+        std::unique_lock lock(m_poolsMutex);
+        tls = m_tls;
+    }
+    if (!tls || session.empty()) { return; }
+    const auto*  in{reinterpret_cast<const unsigned char*>(session.data())};
+    SSL_SESSION* decoded{
+        d2i_SSL_SESSION(nullptr, &in, static_cast<long>(session.size()))};
+    if (!decoded) { return; }
+    std::unique_lock lock(tls->sessionMutex);
+    if (tls->session) { SSL_SESSION_free(tls->session); }
+    tls->session = decoded;
+}
+
+NXOSHttpClient::TLSStats AsyncHttpEngine::getTLSStats() const {
+    std::unique_lock lock(m_poolsMutex);
+    auto             stats{m_retiredStats};
+    if (m_tls) {
+        stats.connectionsOpened += m_tls->connectionsOpened;
+        stats.fullHandshakes += m_tls->fullHandshakes;
+        stats.resumedHandshakes += m_tls->resumedHandshakes;
+    }
+    return stats;
+}
+
+void AsyncHttpEngine::send(const Url& url, Request&& request, ResponseHandler&& handler) {
+    HostPoolPtr pool;
+    {
+        std::unique_lock lock(m_poolsMutex);
+        if (!m_stopped) {
+            auto it{m_pools.find(url.rawUrl())};
+            if (it == m_pools.end()) {
+                bool https{url.getScheme() == Url::Scheme::HTTPS};
+                it = m_pools
+                         .emplace(url.rawUrl(),
+                                  std::make_shared<HostPool>(m_ioContext, url,
+                                                             m_authorization,
+                                                             https ? m_tls : nullptr,
+                                                             m_maxConnections))
+                         .first;
+            }
+            pool = it->second;
+        }
+    }
+    if (!pool) {
+        string body;
+        handler(NXOSHttpClient::CANCELED, 0, body);
+        return;
+    }
+    if (pool->tls == nullptr && url.getScheme() == Url::Scheme::HTTPS) {
+        string body;
+        handler(NXOSHttpClient::SSL_LOADING_CERTS, 0, body);
+        return;
+    }
+    pool->submit({std::move(request), std::move(handler)});
+}
+
+void AsyncHttpEngine::stop() {
+    std::unordered_map<string, HostPoolPtr> pools;
+    {
+        std::unique_lock lock(m_poolsMutex);
+        m_stopped = true;
+        pools.swap(m_pools);
+    }
+    for (const auto& [url, pool] : pools) { pool->stop(); }
+}
@@ -1,15 +1,286 @@
 #include "dhcp6_exporter_impl.hpp"
 #include "log.hpp"
+#include "span_tracer.hpp"
+#include "trace_ring.hpp"
 #include "version.hpp"
+#include <cc/command_interpreter.h>
 #include <dhcpsrv/cfgmgr.h>
 
 using isc::dhcp::NetworkStatePtr;
 
+using isc::config::createAnswer;
+using isc::data::Element;
 using isc::dhcp::CfgMgr;
 
 namespace {
     DHCP6ExporterImplPtr impl;
-}
+
+    // arguments of control command, null if command has none
+    ConstElementPtr commandArguments(CalloutHandle& handle) {
+        ConstElementPtr command;
+        ConstElementPtr args;
+        handle.getArgument("command", command);
+        isc::config::parseCommand(args, command);
+        return args;
+    }
+
+    const DHCP6ExporterServicePtr& configuredService() {
+        if (!impl || !impl->service()) {
+            isc_throw(isc::InvalidOperation, "exporter is not configured");
+        }
+        return impl->service();
+    }
+
+    ConstElementPtr resyncStartedAnswer(uint64_t jobId) {
+        auto args{Element::createMap()};
+        args->set("job", Element::create(static_cast<long long>(jobId)));
+        return createAnswer(isc::config::CONTROL_RESULT_SUCCESS,
+                            "resync job " + std::to_string(jobId) + " started", args);
+    }
+
+    // {"command": "exporter-trace-dump", "arguments": {"limit": 100}}
+    // returns latest trace events of all threads, oldest first
+    int exporterTraceDump(CalloutHandle& handle) {
+        ConstElementPtr response;
+        try {
+            auto   args{commandArguments(handle)};
+            size_t limit{SIZE_MAX};
+            if (args) {
+                auto limitArg{args->get("limit")};
+                if (limitArg) {
+                    if (limitArg->getType() != Element::integer ||
+                        limitArg->intValue() < 0) {
+                        isc_throw(isc::BadValue,
+                                  "\"limit\" must be a non-negative integer");
+                    }
+                    limit = static_cast<size_t>(limitArg->intValue());
+                }
+            }
+
+            auto events{TraceRing::dump(limit)};
+            auto list{Element::createList()};
+            for (const auto& event : events) { list->add(TraceRing::toElement(event)); }
+            response = createAnswer(isc::config::CONTROL_RESULT_SUCCESS,
+                                    std::to_string(events.size()) + " trace events",
+                                    list);
+        } catch (const std::exception& ex) {
+            response = createAnswer(isc::config::CONTROL_RESULT_ERROR, ex.what());
+        }
+        handle.setArgument("response", response);
+        return 0;
+    }
+
+    // {"command": "exporter-flap-damping-stats"}
+    // returns counters of damped route operations
+    int exporterFlapDampingStats(CalloutHandle& handle) {
+        ConstElementPtr response;
+        auto            stats{impl ? impl->flapDampingStats() : isc::data::ElementPtr()};
+        if (stats) {
+            response = createAnswer(isc::config::CONTROL_RESULT_SUCCESS,
+                                    "flap damping statistics", stats);
+        } else {
+            response = createAnswer(isc::config::CONTROL_RESULT_EMPTY,
+                                    "flap damping is not configured");
+        }
+        handle.setArgument("response", response);
+        return 0;
+    }
+
+    // {"command": "exporter-capture-stats"}
+    // returns counters of lease events captured for replay
+    int exporterCaptureStats(CalloutHandle& handle) {
+        ConstElementPtr response;
+        auto            stats{impl ? impl->captureStats() : isc::data::ElementPtr()};
+        if (stats) {
+            response = createAnswer(isc::config::CONTROL_RESULT_SUCCESS,
+                                    "lease capture statistics", stats);
+        } else {
+            response = createAnswer(isc::config::CONTROL_RESULT_EMPTY,
+                                    "lease capture is not configured");
+        }
+        handle.setArgument("response", response);
+        return 0;
+    }
+
+    // {"command": "exporter-spool-stats"}
+    // returns counters of route operations held during switch outage
+    int exporterSpoolStats(CalloutHandle& handle) {
+        ConstElementPtr response;
+        try {
+            auto stats{configuredService()->spoolStats()};
+            if (stats) {
+                response = createAnswer(isc::config::CONTROL_RESULT_SUCCESS,
+                                        "spool statistics", stats);
+            } else {
+                response = createAnswer(isc::config::CONTROL_RESULT_EMPTY,
+                                        "spool is not configured");
+            }
+        } catch (const std::exception& ex) {
+            response = createAnswer(isc::config::CONTROL_RESULT_ERROR, ex.what());
+        }
+        handle.setArgument("response", response);
+        return 0;
+    }
+
+    // {"command": "exporter-ha-status"}
+    // returns HA state of this server and its shadow route state
+    int exporterHAStatus(CalloutHandle& handle) {
+        ConstElementPtr response;
+        try {
+            auto status{configuredService()->haStatus()};
+            if (status) {
+                response = createAnswer(isc::config::CONTROL_RESULT_SUCCESS,
+                                        "HA status", status);
+            } else {
+                response = createAnswer(isc::config::CONTROL_RESULT_EMPTY,
+                                        "HA ownership is not configured");
+            }
+        } catch (const std::exception& ex) {
+            response = createAnswer(isc::config::CONTROL_RESULT_ERROR, ex.what());
+        }
+        handle.setArgument("response", response);
+        return 0;
+    }
+
+    // {"command": "exporter-resync-subnet", "arguments": {"subnet-id": 12}}
+    // {"command": "exporter-resync-subnet", "arguments": {"prefix": "2001:db8:1::/64"}}
+    int exporterResyncSubnet(CalloutHandle& handle) {
+        ConstElementPtr response;
+        try {
+            auto args{commandArguments(handle)};
+            if (!args || args->getType() != Element::map) {
+                isc_throw(isc::BadValue, "\"subnet-id\" or \"prefix\" is required");
+            }
+            auto cfgSubnets{CfgMgr::instance().getCurrentCfg()->getCfgSubnets6()};
+            auto subnetIdArg{args->get("subnet-id")};
+            auto prefixArg{args->get("prefix")};
+            isc::dhcp::ConstSubnet6Ptr subnet;
+            if (subnetIdArg) {
+                if (subnetIdArg->getType() != Element::integer ||
+                    subnetIdArg->intValue() <= 0) {
+                    isc_throw(isc::BadValue, "\"subnet-id\" must be a positive integer");
+                }
+                subnet = cfgSubnets->getBySubnetId(
+                    static_cast<isc::dhcp::SubnetID>(subnetIdArg->intValue()));
+            } else if (prefixArg) {
+                if (prefixArg->getType() != Element::string) {
+                    isc_throw(isc::BadValue, "\"prefix\" must be a string");
+                }
+                subnet = cfgSubnets->getByPrefix(prefixArg->stringValue());
+            } else {
+                isc_throw(isc::BadValue, "\"subnet-id\" or \"prefix\" is required");
+            }
+            if (!subnet) { isc_throw(isc::BadValue, "subnet not found"); }
+            response =
+                resyncStartedAnswer(configuredService()->resyncSubnet(subnet->getID()));
+        } catch (const std::exception& ex) {
+            response = createAnswer(isc::config::CONTROL_RESULT_ERROR, ex.what());
+        }
+        handle.setArgument("response", response);
+        return 0;
+    }
+
+    // {"command": "exporter-resync-client",
+    //  "arguments": {"duid": "00:01:00:01:...", "iaid": 1}}
+    // "iaid" is optional, without it all leases of DUID are exported
+    int exporterResyncClient(CalloutHandle& handle) {
+        ConstElementPtr response;
+        try {
+            auto args{commandArguments(handle)};
+            auto duidArg{args && args->getType() == Element::map ? args->get("duid")
+                                                                 : ConstElementPtr()};
+            if (!duidArg || duidArg->getType() != Element::string) {
+                isc_throw(isc::BadValue, "\"duid\" must be a string");
+            }
+            auto duid{boost::make_shared<isc::dhcp::DUID>(
+                isc::dhcp::DUID::fromText(duidArg->stringValue()))};
+            std::optional<uint32_t> iaid;
+            auto                    iaidArg{args->get("iaid")};
+            if (iaidArg) {
+                if (iaidArg->getType() != Element::integer || iaidArg->intValue() < 0 ||
+                    iaidArg->intValue() > UINT32_MAX) {
+                    isc_throw(isc::BadValue,
+                              "\"iaid\" must be a 32-bit unsigned integer");
+                }
+                iaid = static_cast<uint32_t>(iaidArg->intValue());
+            }
+            response = resyncStartedAnswer(configuredService()->resyncClient(duid, iaid));
+        } catch (const std::exception& ex) {
+            response = createAnswer(isc::config::CONTROL_RESULT_ERROR, ex.what());
+        }
+        handle.setArgument("response", response);
+        return 0;
+    }
+
+    // {"command": "exporter-resync-all"}
+    int exporterResyncAll(CalloutHandle& handle) {
+        ConstElementPtr response;
+        try {
+            response = resyncStartedAnswer(configuredService()->resyncAll());
+        } catch (const std::exception& ex) {
+            response = createAnswer(isc::config::CONTROL_RESULT_ERROR, ex.what());
+        }
+        handle.setArgument("response", response);
+        return 0;
+    }
+
+    // {"command": "exporter-remove-owned-routes"}
+    // removes every route tagged with `route-tag`, returns id of job
+    int exporterRemoveOwnedRoutes(CalloutHandle& handle) {
+        ConstElementPtr response;
+        try {
+            response = resyncStartedAnswer(configuredService()->removeOwnedRoutes());
+        } catch (const std::exception& ex) {
+            response = createAnswer(isc::config::CONTROL_RESULT_ERROR, ex.what());
+        }
+        handle.setArgument("response", response);
+        return 0;
+    }
+
+    // {"command": "exporter-resync-status"}
+    // returns progress of recent resync jobs, oldest first
+    int exporterResyncStatus(CalloutHandle& handle) {
+        ConstElementPtr response;
+        try {
+            response = createAnswer(isc::config::CONTROL_RESULT_SUCCESS, "resync jobs",
+                                    configuredService()->resyncStatus());
+        } catch (const std::exception& ex) {
+            response = createAnswer(isc::config::CONTROL_RESULT_ERROR, ex.what());
+        }
+        handle.setArgument("response", response);
+        return 0;
+    }
+
+    // {"command": "exporter-restore-stats"}
+    // returns timings and counters of the last restore after switch reload
+    int exporterRestoreStats(CalloutHandle& handle) {
+        ConstElementPtr response;
+        try {
+            response = createAnswer(isc::config::CONTROL_RESULT_SUCCESS,
+                                    "restore statistics",
+                                    configuredService()->restoreStats());
+        } catch (const std::exception& ex) {
+            response = createAnswer(isc::config::CONTROL_RESULT_ERROR, ex.what());
+        }
+        handle.setArgument("response", response);
+        return 0;
+    }
+
+    // {"command": "exporter-worker-pool-stats"}
+    // returns threads, queue depth and utilization of worker pools
+    int exporterWorkerPoolStats(CalloutHandle& handle) {
+        ConstElementPtr response;
+        try {
+            response = createAnswer(isc::config::CONTROL_RESULT_SUCCESS,
+                                    "worker pool statistics",
+                                    configuredService()->workerPoolStats());
+        } catch (const std::exception& ex) {
+            response = createAnswer(isc::config::CONTROL_RESULT_ERROR, ex.what());
+        }
+        handle.setArgument("response", response);
+        return 0;
+    }
+}    // namespace
 
 extern "C" {
 EXPORTED int version() { return KEA_HOOKS_VERSION; }
@@ -27,7 +298,21 @@ EXPORTED int load(LibraryHandle& handle) {
         // TODO: extract config options and pass to implementation
         impl->configureAndInitClient(handle);
 
-        // TODO: register command callouts for commands
+        handle.registerCommandCallout("exporter-trace-dump", exporterTraceDump);
+        handle.registerCommandCallout("exporter-flap-damping-stats",
+                                      exporterFlapDampingStats);
+        handle.registerCommandCallout("exporter-capture-stats", exporterCaptureStats);
+        handle.registerCommandCallout("exporter-spool-stats", exporterSpoolStats);
+        handle.registerCommandCallout("exporter-ha-status", exporterHAStatus);
+        handle.registerCommandCallout("exporter-resync-subnet", exporterResyncSubnet);
+        handle.registerCommandCallout("exporter-resync-client", exporterResyncClient);
+        handle.registerCommandCallout("exporter-resync-all", exporterResyncAll);
+        handle.registerCommandCallout("exporter-resync-status", exporterResyncStatus);
+        handle.registerCommandCallout("exporter-remove-owned-routes",
+                                      exporterRemoveOwnedRoutes);
+        handle.registerCommandCallout("exporter-restore-stats", exporterRestoreStats);
+        handle.registerCommandCallout("exporter-worker-pool-stats",
+                                      exporterWorkerPoolStats);
     } catch (const std::exception& ex) {
         LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_INIT_FAILED).arg(ex.what());
         return 1;
@@ -40,7 +325,9 @@ EXPORTED int load(LibraryHandle& handle) {
 }
 
 EXPORTED int unload() {
+    if (impl) { impl->stopService(); }
     impl.reset();
+    SpanTracer::shutdown();
     LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_UNLOAD).arg("nxos_dhcp6_exporter");
     return 0;
 }
@@ -0,0 +1,19 @@
+#include "config_params.hpp"
+#include <cc/data.h>
+#include <cc/dhcp_config_error.h>
+
+using isc::data::Element;
+
+size_t parsePositiveInteger(ConstElementPtr config,
+                            const char*     section,
+                            const char*     name,
+                            size_t          defaultValue) {
+    auto element{config->get(name)};
+    if (!element) { return defaultValue; }
+    if (element->getType() != Element::integer || element->intValue() <= 0) {
+        isc_throw(isc::ConfigError, "Field \"" << name << "\" in \"" << section
+                                               << "\" must be a non-zero "
+                                                  "non-negative integer");
+    }
+    return static_cast<size_t>(element->intValue());
+}
@@ -1,118 +1,194 @@
 #include "dhcp6_exporter_impl.hpp"
 #include "lease_utils.hpp"
+#include "span_tracer.hpp"
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/lease_mgr_factory.h>
 
 void DHCP6ExporterImpl::configureAndInitClient(LibraryHandle& handle) {
-    ConstElementPtr mgmtConnType{handle.getParameter("connection-type")};
+    configureAndInitClient(handle.getParameters());
+}
+
+void DHCP6ExporterImpl::configureAndInitClient(ConstElementPtr parameters) {
+    if (!parameters || parameters->getType() != isc::data::Element::map) {
+        isc_throw(isc::BadValue, "No parameter \"connection-type\" in config");
+    }
+    ConstElementPtr mgmtConnType{parameters->get("connection-type")};
     if (!mgmtConnType) {
         isc_throw(isc::BadValue, "No parameter \"connection-type\" in config");
     }
     if (mgmtConnType->getType() != isc::data::Element::string) {
         isc_throw(isc::BadValue, "parameter \"connection-type\" must be a string");
     }
-    ConstElementPtr mgmtConnParams{handle.getParameter("connection-params")};
+    ConstElementPtr mgmtConnParams{parameters->get("connection-params")};
     if (!mgmtConnParams) {
         isc_throw(isc::BadValue, "No parameter \"connection-params\" in config");
     }
     if (mgmtConnParams->getType() != isc::data::Element::map) {
         isc_throw(isc::BadValue, "parameter \"connection-params\" must be a map");
     }
-    m_service = boost::make_shared<DHCP6ExporterService>(mgmtConnType, mgmtConnParams);
+    DHCP6ExporterService::Params params{mgmtConnType,
+                                        mgmtConnParams,
+                                        parameters->get("flap-damping"),
+                                        parameters->get("spool"),
+                                        parameters->get("ha"),
+                                        parameters->get("subnet-vrfs")};
+    ConstElementPtr capture{parameters->get("capture")};
+    if (capture) {
+        m_capture =
+            std::make_unique<LeaseCapture>(LeaseCapture::Config::parseConfig(capture));
+    }
+    ConstElementPtr handover{parameters->get("handover")};
+    if (handover) { m_handover = ServiceHandover::Config::parseConfig(handover); }
+    SpanTracer::configure(parameters->get("tracing"));
+    m_service = boost::make_shared<DHCP6ExporterService>(params);
+    if (m_handover) {
+        auto state{ServiceHandover::take(*m_handover)};
+        if (state) { m_service->adopt(std::move(*state)); }
+    }
 }
 
 void DHCP6ExporterImpl::startService(const IOServicePtr& io_service) {
-    if (m_service) {
-        m_service->setIOService(io_service);
-        m_service->startService();
-        LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_START_SERVICE)
-            .arg("nxos_dhcp6_exporter");
-    }
+    if (!m_service) { return; }
+    if (m_capture) { m_capture->start(*io_service); }
+    m_service->setIOService(io_service);
+    m_service->startService();
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_START_SERVICE)
+        .arg("nxos_dhcp6_exporter");
+}
+
+isc::data::ElementPtr DHCP6ExporterImpl::flapDampingStats() {
+    if (!m_service) { return isc::data::ElementPtr(); }
+    return m_service->flapDampingStats();
+}
+
+isc::data::ElementPtr DHCP6ExporterImpl::captureStats() {
+    if (!m_capture) { return isc::data::ElementPtr(); }
+    return m_capture->stats().toElement();
 }
 
 void DHCP6ExporterImpl::stopService() {
-    m_service->stopService();
+    stopCapture();
+    if (!m_service) { return; }
+    // service of configuration that wasn't applied is never started
+    if (m_service->getIOService()) {
+        m_service->stopService();
+        if (m_handover) { writeHandover(); }
+    }
     m_service.reset();
 }
 
+void DHCP6ExporterImpl::writeHandover() {
+    try {
+        auto state{m_service->handover()};
+        state.write(*m_handover);
+        LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_HANDOVER_WRITTEN)
+            .arg(m_service->connectionName())
+            .arg(m_handover->path)
+            .arg(state.switchUptimeSecs ? std::to_string(*state.switchUptimeSecs)
+                                        : "(none)")
+            .arg(state.ha ? state.ha->shadow.size() : 0);
+    } catch (const std::exception& ex) {
+        LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_HANDOVER_WRITE_FAILED)
+            .arg(m_handover->path)
+            .arg(ex.what());
+    }
+}
+
+void DHCP6ExporterImpl::stopCapture() {
+    if (!m_capture) { return; }
+    m_capture->stop();
+    m_capture.reset();
+}
+
+void DHCP6ExporterImpl::exportRoute(const RouteExport& route) {
+    if (m_capture) { m_capture->record(LeaseCapture::Event::EXPORT, route); }
+    m_service->exportRoute(route);
+}
+
+void DHCP6ExporterImpl::removeRoute(const RouteExport& route) {
+    if (m_capture) { m_capture->record(LeaseCapture::Event::REMOVE, route); }
+    m_service->removeRoute(route);
+}
+
+void DHCP6ExporterImpl::reclaimRoute(const RouteExport& route) {
+    if (m_capture) { m_capture->record(LeaseCapture::Event::RECLAIM, route); }
+    m_service->reclaimRoute(route);
+}
+
 // kea call this hook once per lease selection.
 // So, we have 2 call function: for IA_NA and IA_PD and etc
 void DHCP6ExporterImpl::handleLease6Select(CalloutHandle& handle) {
-    Pkt6Ptr    query;
-    Subnet6Ptr subnet;
-    Lease6Ptr  lease;
-    bool       fake_allocation{false};
+    SpanTracer::CalloutScope calloutSpan("kea.lease6_select");
+    bool fake_allocation{false};
+    handle.getArgument("fake_allocation", fake_allocation);
+    bool debugEnabled{DHCP6ExporterLogger.isDebugEnabled(DBGLVL_TRACE_BASIC)};
+    // SOLICIT without rapid commit, nothing to export
+    if (fake_allocation && !debugEnabled) { return; }
 
+    Pkt6Ptr   query;
+    Lease6Ptr lease;
     handle.getArgument("query6", query);
-    handle.getArgument("subnet6", subnet);
     handle.getArgument("lease6", lease);
-    handle.getArgument("fake_allocation", fake_allocation);
 
-    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL, DHCP6_EXPORTER_LEASE6_SELECT)
-        .arg(query->toText())
-        .arg(subnet->toText())
-        .arg(lease->toText())
-        .arg(fake_allocation);
+    if (debugEnabled) {
+        // subnet and IA options are needed only for logging
+        Subnet6Ptr subnet;
+        handle.getArgument("subnet6", subnet);
+        LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL, DHCP6_EXPORTER_LEASE6_SELECT)
+            .arg(query->toText())
+            .arg(subnet->toText())
+            .arg(lease->toText())
+            .arg(fake_allocation);
+        if (!fake_allocation) {
+            const auto& queryIA_NAOption{query->getOption(D6O_IA_NA)};
+            const auto& queryIA_PDOption{query->getOption(D6O_IA_PD)};
+            LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
+                      DHCP6_EXPORTER_LEASE6_SELECT_INSERT)
+                .arg(query->getTransid())
+                .arg(queryIA_NAOption ? queryIA_NAOption->toString() : "(null)")
+                .arg(queryIA_PDOption ? queryIA_PDOption->toString() : "(null)");
+        }
+    }
 
     // we receive lease6_select notification with `fake_allocation` == 0
     // when we in DHCPv6 REQUEST state
     if (fake_allocation == false) {
-        auto relayAddr{query->getRelay6LinkAddress(0)};
-        auto transactionId{query->getTransid()};
-
-        Option6IAPtr queryIA_PDOption;
-        {
-            auto queryIA_PDOptionRaw{query->getOption(D6O_IA_PD)};
-            if (queryIA_PDOptionRaw) {
-                queryIA_PDOption = dynamic_pointer_cast<Option6IA>(queryIA_PDOptionRaw);
-            }
-        }
-        Option6IAPtr queryIA_NAOption;
-        {
-            auto queryIA_NAOptionRaw{query->getOption(D6O_IA_NA)};
-            if (queryIA_NAOptionRaw) {
-                queryIA_NAOption = dynamic_pointer_cast<Option6IA>(queryIA_NAOptionRaw);
-            }
-        }
-
-        auto     leaseAddr{lease->addr_};
-        auto     leasePrefixLength{lease->prefixlen_};
-        auto     leaseType{lease->getType()};
-        uint32_t leaseIAID{lease->iaid_};
-        auto     leaseDUID{lease->duid_};
+        auto        transactionId{query->getTransid()};
+        auto        leaseAddr{lease->addr_};
+        auto        leasePrefixLength{lease->prefixlen_};
+        auto        leaseType{lease->getType()};
+        uint32_t    leaseIAID{lease->iaid_};
+        const auto& leaseDUID{lease->duid_};
 
-        LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_LEASE6_SELECT_INSERT)
-            .arg(transactionId)
-            .arg(queryIA_NAOption ? queryIA_NAOption->toString() : "(null)")
-            .arg(queryIA_PDOption ? queryIA_PDOption->toString() : "(null)");
         // extract info about options from lease
         switch (leaseType) {
             case isc::dhcp::Lease::TYPE_NA: {
-                RouteExport routeInfo{
-                    transactionId, leaseIAID, leaseDUID,
-                    IA_NAInfo{std::move(relayAddr), std::move(leaseAddr)}};
+                auto relayAddr{query->getRelay6LinkAddress(0)};
+                auto routeInfo{RouteExport::makeIA_NA(transactionId, leaseIAID, leaseDUID,
+                                                      relayAddr, leaseAddr)};
+                routeInfo.vrfId = m_service->subnetVrf(lease->subnet_id_);
 
                 LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
                           DHCP6_EXPORTER_LEASE6_SELECT_ALLOCATION_INFO)
                     .arg(routeInfo.toString());
                 // send router export to switch
-                m_service->exportRoute(routeInfo);
+                exportRoute(routeInfo);
             } break;
             case isc::dhcp::Lease::TYPE_PD: {
                 auto IA_NALease{
                     LeaseUtils::findIA_NALeaseByDUID_IAID(leaseDUID, leaseIAID)};
                 if (IA_NALease) {
-                    RouteExport routeInfo{transactionId, leaseIAID, leaseDUID,
-                                          IA_PDInfo{IA_NALease->addr_,
-                                                    std::move(leaseAddr),
-                                                    leasePrefixLength}};
+                    auto routeInfo{RouteExport::makeIA_PD(transactionId, leaseIAID,
+                                                          leaseDUID, IA_NALease->addr_,
+                                                          leaseAddr, leasePrefixLength)};
+                    routeInfo.vrfId = m_service->subnetVrf(lease->subnet_id_);
 
                     LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
                               DHCP6_EXPORTER_LEASE6_SELECT_ALLOCATION_INFO)
                         .arg(routeInfo.toString());
 
                     // send route export to the switch
-                    m_service->exportRoute(routeInfo);
+                    exportRoute(routeInfo);
                 } else {
                     LOG_ERROR(DHCP6ExporterLogger,
                               DHCP6_EXPORTER_LEASE6_SELECT_NO_IA_NA_FAILED)
@@ -130,6 +206,7 @@ void DHCP6ExporterImpl::handleLease6Select(CalloutHandle& handle) {
 }
 
 void DHCP6ExporterImpl::handleLease6Expire(CalloutHandle& handle) {
+    SpanTracer::CalloutScope calloutSpan("kea.lease6_expire");
     Lease6Ptr lease;
     bool      remove_lease;
 
@@ -161,12 +238,13 @@ void DHCP6ExporterImpl::handleLease6Expire(CalloutHandle& handle) {
                 .arg(activeAndExpiredLeasesSize);
 
             // if (activeAndExpiredLeasesSize == 1) {
-            RouteExport routeInfo{noneTransactionId, leaseIAID, leaseDUID,
-                                  IA_NAInfoFuzzyRemove{std::move(leaseAddr)}};
+            auto routeInfo{RouteExport::makeIA_NAFuzzyRemove(noneTransactionId, leaseIAID,
+                                                             leaseDUID, leaseAddr)};
+            routeInfo.vrfId = m_service->subnetVrf(lease->subnet_id_);
             LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
                       DHCP6_EXPORTER_LEASE6_EXPIRE_ALLOCATION_INFO)
                 .arg(routeInfo.toString());
-            m_service->removeRoute(routeInfo);
+            reclaimRoute(routeInfo);
             //}
         } break;
         case isc::dhcp::Lease::TYPE_PD: {
@@ -183,13 +261,22 @@ void DHCP6ExporterImpl::handleLease6Expire(CalloutHandle& handle) {
                 .arg(activeAndExpiredLeasesSize);
 
             // if (activeAndExpiredLeasesSize == 1) {
-            RouteExport routeInfo{
-                noneTransactionId, leaseIAID, leaseDUID,
-                IA_PDInfoFuzzyRemove{std::move(leaseAddr), leaseAddrPrefixLength}};
+            // try to find IA_NA lease for given DUID + iaid in lease database,
+            // otherwise IA_NA addr will be taken from the switch
+            Lease6Ptr leaseIA_NA{
+                LeaseUtils::findIA_NALeaseByDUID_IAID(leaseDUID, leaseIAID)};
+            auto      routeInfo{leaseIA_NA ? RouteExport::makeIA_PD(
+                                                 noneTransactionId, leaseIAID, leaseDUID,
+                                                 leaseIA_NA->addr_, leaseAddr,
+                                                 leaseAddrPrefixLength)
+                                           : RouteExport::makeIA_PDFuzzyRemove(
+                                                 noneTransactionId, leaseIAID, leaseDUID,
+                                                 leaseAddr, leaseAddrPrefixLength)};
+            routeInfo.vrfId = m_service->subnetVrf(lease->subnet_id_);
             LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
                       DHCP6_EXPORTER_LEASE6_EXPIRE_ALLOCATION_INFO)
                 .arg(routeInfo.toString());
-            m_service->removeRoute(routeInfo);
+            reclaimRoute(routeInfo);
             //}
         } break;
         case isc::dhcp::Lease::TYPE_TA:
@@ -198,6 +285,7 @@ void DHCP6ExporterImpl::handleLease6Expire(CalloutHandle& handle) {
 }
 
 void DHCP6ExporterImpl::handleLease6Release(CalloutHandle& handle) {
+    SpanTracer::CalloutScope calloutSpan("kea.lease6_release");
     Pkt6Ptr   query;
     Lease6Ptr lease;
 
@@ -207,24 +295,25 @@ void DHCP6ExporterImpl::handleLease6Release(CalloutHandle& handle) {
         .arg(query->toText())
         .arg(lease->toText());
 
-    auto     relayAddr{query->getRelay6LinkAddress(0)};
-    auto     transactionId{query->getTransid()};
-    auto     leaseAddr{lease->addr_};
-    auto     leasePrefixLength{lease->prefixlen_};
-    auto     leaseType{lease->getType()};
-    uint32_t leaseIAID{lease->iaid_};
-    auto     leaseDUID{lease->duid_};
+    auto        transactionId{query->getTransid()};
+    auto        leaseAddr{lease->addr_};
+    auto        leasePrefixLength{lease->prefixlen_};
+    auto        leaseType{lease->getType()};
+    uint32_t    leaseIAID{lease->iaid_};
+    const auto& leaseDUID{lease->duid_};
 
     switch (leaseType) {
         case isc::dhcp::Lease::TYPE_NA: {
-            RouteExport routeInfo{transactionId, leaseIAID, leaseDUID,
-                                  IA_NAInfo{std::move(relayAddr), std::move(leaseAddr)}};
+            auto relayAddr{query->getRelay6LinkAddress(0)};
+            auto routeInfo{RouteExport::makeIA_NA(transactionId, leaseIAID, leaseDUID,
+                                                  relayAddr, leaseAddr)};
+            routeInfo.vrfId = m_service->subnetVrf(lease->subnet_id_);
             LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
                       DHCP6_EXPORTER_LEASE6_RELEASE_ALLOCATION_INFO)
                 .arg(routeInfo.toString());
 
             // remove route export from the switch
-            m_service->removeRoute(routeInfo);
+            removeRoute(routeInfo);
         } break;
         case isc::dhcp::Lease::TYPE_PD: {
             // for IA_PD removal we need to know IA_NA addr that leased for client.
@@ -238,14 +327,15 @@ void DHCP6ExporterImpl::handleLease6Release(CalloutHandle& handle) {
                     .arg(leaseDUID ? leaseDUID->toText() : "(null)");
                 return;
             }
-            RouteExport routeInfo{
-                transactionId, leaseIAID, leaseDUID,
-                IA_PDInfo{leaseIA_NA->addr_, std::move(leaseAddr), leasePrefixLength}};
+            auto routeInfo{RouteExport::makeIA_PD(transactionId, leaseIAID, leaseDUID,
+                                                  leaseIA_NA->addr_, leaseAddr,
+                                                  leasePrefixLength)};
+            routeInfo.vrfId = m_service->subnetVrf(lease->subnet_id_);
             LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
                       DHCP6_EXPORTER_LEASE6_RELEASE_ALLOCATION_INFO)
                 .arg(routeInfo.toString());
             // remove route export from the switch
-            m_service->removeRoute(routeInfo);
+            removeRoute(routeInfo);
         } break;
         case isc::dhcp::Lease::TYPE_TA:
         case isc::dhcp::Lease::TYPE_V4: break;
@@ -253,6 +343,7 @@ void DHCP6ExporterImpl::handleLease6Release(CalloutHandle& handle) {
 }
 
 void DHCP6ExporterImpl::handleLease6Decline(CalloutHandle& handle) {
+    SpanTracer::CalloutScope calloutSpan("kea.lease6_decline");
     Pkt6Ptr   query;
     Lease6Ptr lease;
 
@@ -262,23 +353,24 @@ void DHCP6ExporterImpl::handleLease6Decline(CalloutHandle& handle) {
         .arg(query ? query->toText() : "(null)")
         .arg(query ? lease->toText() : "(null)");
 
-    auto     relayAddr{query->getRelay6LinkAddress(0)};
-    auto     transactionId{query->getTransid()};
-    auto     leaseAddr{lease->addr_};
-    auto     leasePrefixLength{lease->prefixlen_};
-    auto     leaseType{lease->getType()};
-    uint32_t leaseIAID{lease->iaid_};
-    auto     leaseDUID{lease->duid_};
+    auto        transactionId{query->getTransid()};
+    auto        leaseAddr{lease->addr_};
+    auto        leasePrefixLength{lease->prefixlen_};
+    auto        leaseType{lease->getType()};
+    uint32_t    leaseIAID{lease->iaid_};
+    const auto& leaseDUID{lease->duid_};
 
     switch (leaseType) {
         case isc::dhcp::Lease::TYPE_NA: {
-            RouteExport routeInfo{transactionId, leaseIAID, leaseDUID,
-                                  IA_NAInfo{std::move(relayAddr), std::move(leaseAddr)}};
+            auto relayAddr{query->getRelay6LinkAddress(0)};
+            auto routeInfo{RouteExport::makeIA_NA(transactionId, leaseIAID, leaseDUID,
+                                                  relayAddr, leaseAddr)};
+            routeInfo.vrfId = m_service->subnetVrf(lease->subnet_id_);
             LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
                       DHCP6_EXPORTER_LEASE6_DECLINE_ALLOCATION_INFO)
                 .arg(routeInfo.toString());
 
-            m_service->removeRoute(routeInfo);
+            removeRoute(routeInfo);
         } break;
         case isc::dhcp::Lease::TYPE_PD: {
             // for IA_PD removal we need to know IA_NA addr that leased for client.
@@ -292,72 +384,73 @@ void DHCP6ExporterImpl::handleLease6Decline(CalloutHandle& handle) {
                     .arg(leaseDUID ? leaseDUID->toText() : "(null)");
                 return;
             }
-            RouteExport routeInfo{
-                transactionId, leaseIAID, leaseDUID,
-                IA_PDInfo{leaseIA_NA->addr_, std::move(leaseAddr), leasePrefixLength}};
+            auto routeInfo{RouteExport::makeIA_PD(transactionId, leaseIAID, leaseDUID,
+                                                  leaseIA_NA->addr_, leaseAddr,
+                                                  leasePrefixLength)};
+            routeInfo.vrfId = m_service->subnetVrf(lease->subnet_id_);
             LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
                       DHCP6_EXPORTER_LEASE6_DECLINE_ALLOCATION_INFO)
                 .arg(routeInfo.toString());
 
-            m_service->removeRoute(routeInfo);
+            removeRoute(routeInfo);
         }
         case isc::dhcp::Lease::TYPE_TA:
         case isc::dhcp::Lease::TYPE_V4: break;
     }
 }
 
-using isc::hooks::NoSuchArgument;
-
 template<bool IsRebindProcess>
-void DHCP6ExporterImpl::handleRenewRebindProcess(Pkt6Ptr      query,
-                                                 Lease6Ptr    lease,
-                                                 Option6IAPtr iaOpt,
-                                                 bool         isIA_NA) {
-    auto     relayAddr{query->getRelay6LinkAddress(0)};
-    auto     transactionId{query->getTransid()};
-    auto     leaseAddr{lease->addr_};
-    auto     leaseAddrPrefixLength{lease->prefixlen_};
-    uint32_t clientIAID{lease->iaid_};
-    auto     clientDUID{lease->duid_};
+void DHCP6ExporterImpl::handleRenewRebindProcess(const Pkt6Ptr&   query,
+                                                 const Lease6Ptr& lease,
+                                                 bool             isIA_NA) {
+    auto        relayAddr{query->getRelay6LinkAddress(0)};
+    auto        transactionId{query->getTransid()};
+    auto        leaseAddr{lease->addr_};
+    auto        leaseAddrPrefixLength{lease->prefixlen_};
+    uint32_t    clientIAID{lease->iaid_};
+    const auto& clientDUID{lease->duid_};
 
     IOAddress queryOriginalAddr("::");
     uint8_t   queryOriginalPrefixLength{0};
     if (isIA_NA) {
-        Option6IAPtr queryIA_NAOption{
-            dynamic_pointer_cast<Option6IA>(query->getOption(D6O_IA_NA))};
-        auto queryIAAddrOptionRaw{queryIA_NAOption->getOption(D6O_IAADDR)};
-        if (!queryIAAddrOptionRaw) {
+        // get original IA_NA option from client query,
+        // raw pointer cast instead of extra `dynamic_pointer_cast` copies
+        const auto& queryIA_NAOption{query->getOption(D6O_IA_NA)};
+        const auto* queryIAAddrOption{
+            queryIA_NAOption ? dynamic_cast<const Option6IAAddr*>(
+                                   queryIA_NAOption->getOption(D6O_IAADDR).get())
+                             : nullptr};
+        if (!queryIAAddrOption) {
             isc_throw(isc::Unexpected, "failed to extract IAAddr from IA_NA option");
         }
-        // get original IA_NA option from client query
-        auto queryIAAddrOption{dynamic_pointer_cast<Option6IAAddr>(queryIAAddrOptionRaw)};
         queryOriginalAddr         = queryIAAddrOption->getAddress();
         queryOriginalPrefixLength = 128;
 
-        RouteExport oldRouteInfo{transactionId, clientIAID, clientDUID,
-                                 IA_NAInfo{relayAddr, std::move(queryOriginalAddr)}};
-        RouteExport newRouteInfo{transactionId, clientIAID, clientDUID,
-                                 IA_NAInfo{relayAddr, leaseAddr}};
+        auto oldRouteInfo{RouteExport::makeIA_NA(transactionId, clientIAID, clientDUID,
+                                                 relayAddr, queryOriginalAddr)};
+        auto newRouteInfo{RouteExport::makeIA_NA(transactionId, clientIAID, clientDUID,
+                                                 relayAddr, leaseAddr)};
+        oldRouteInfo.vrfId = newRouteInfo.vrfId = m_service->subnetVrf(lease->subnet_id_);
         // dhcpv6 change address for client, we need to handle that situation
         if (queryOriginalAddr != leaseAddr) {
-            m_service->removeRoute(oldRouteInfo);
+            removeRoute(oldRouteInfo);
         } else if constexpr (IsRebindProcess) {
             // a client sends a REBIND message to any available DHCPv6 Server is
             // sent after a DHCPv6 Client receives no response to a RENEW message.
             // For safety we just re-export new route
             // m_service->exportRoute(newRouteInfo);
         }
-        m_service->exportRoute(newRouteInfo);
+        exportRoute(newRouteInfo);
     } else {
-        Option6IAPtr queryIA_PDOption{
-            dynamic_pointer_cast<Option6IA>(query->getOption(D6O_IA_PD))};
-        auto queryIAPrefixOptionRaw{queryIA_PDOption->getOption(D6O_IAPREFIX)};
-        if (!queryIAPrefixOptionRaw) {
+        // get original IA_PD option from client query
+        const auto& queryIA_PDOption{query->getOption(D6O_IA_PD)};
+        const auto* queryIAPrefixOption{
+            queryIA_PDOption ? dynamic_cast<const Option6IAPrefix*>(
+                                   queryIA_PDOption->getOption(D6O_IAPREFIX).get())
+                             : nullptr};
+        if (!queryIAPrefixOption) {
             isc_throw(isc::Unexpected, "failed to extract IAPREFIX from IA_PD option");
         }
-        // get original IA_PD option from client query
-        auto queryIAPrefixOption{
-            dynamic_pointer_cast<Option6IAPrefix>(queryIAPrefixOptionRaw)};
         queryOriginalAddr         = queryIAPrefixOption->getAddress();
         queryOriginalPrefixLength = queryIAPrefixOption->getLength();
 
@@ -372,94 +465,71 @@ void DHCP6ExporterImpl::handleRenewRebindProcess(Pkt6Ptr      query,
             return;
         }
 
-        RouteExport oldRouteInfo{transactionId, clientIAID, clientDUID,
-                                 IA_PDInfo{relayAddr, std::move(queryOriginalAddr),
-                                           queryOriginalPrefixLength}};
-        RouteExport newRouteInfo{
-            transactionId, clientIAID, clientDUID,
-            IA_PDInfo{leaseIA_NA->addr_, leaseAddr, leaseAddrPrefixLength}};
+        auto oldRouteInfo{RouteExport::makeIA_PD(transactionId, clientIAID, clientDUID,
+                                                 leaseIA_NA->addr_, queryOriginalAddr,
+                                                 queryOriginalPrefixLength)};
+        auto newRouteInfo{RouteExport::makeIA_PD(transactionId, clientIAID, clientDUID,
+                                                 leaseIA_NA->addr_, leaseAddr,
+                                                 leaseAddrPrefixLength)};
+        oldRouteInfo.vrfId = newRouteInfo.vrfId = m_service->subnetVrf(lease->subnet_id_);
 
         // dhcpv6 change address for client, we need to handle that situation
         if (queryOriginalAddr != leaseAddr) {
-            m_service->removeRoute(oldRouteInfo);
-            m_service->exportRoute(newRouteInfo);
+            removeRoute(oldRouteInfo);
+            exportRoute(newRouteInfo);
         } else if constexpr (IsRebindProcess) {
             // a client sends a REBIND message to any available DHCPv6 Server is
             // sent after a DHCPv6 Client receives no response to a RENEW message.
             // For safety we just re-export new route
-            m_service->exportRoute(newRouteInfo);
+            exportRoute(newRouteInfo);
         }
     }
 }
 
 void DHCP6ExporterImpl::handleLease6Rebind(CalloutHandle& handle) {
-    Pkt6Ptr      query;
-    Lease6Ptr    lease;
-    Option6IAPtr ia_opt, tmp;
-    bool         isIA_NA{true}, isIA_PD{true};
+    SpanTracer::CalloutScope calloutSpan("kea.lease6_rebind");
+    Pkt6Ptr   query;
+    Lease6Ptr lease;
 
     handle.getArgument("query6", query);
     handle.getArgument("lease6", lease);
 
-    // IA_NA and IA_PD arguments are mutually exclusive
-    try {
-        handle.getArgument("ia_na", tmp);
-        if (!tmp) {
-            isIA_NA = false;
-        } else {
-            ia_opt = tmp;
-        }
-    } catch (const NoSuchArgument&) { isIA_NA = false; }
-
-    try {
-        handle.getArgument("ia_pd", tmp);
-        if (!tmp) {
-            isIA_PD = false;
-        } else {
-            ia_opt = tmp;
-        }
-    } catch (const NoSuchArgument&) { isIA_PD = false; }
-
-    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL, DHCP6_EXPORTER_LEASE6_REBIND)
-        .arg(query ? query->toText() : "(null)")
-        .arg(lease ? lease->toText() : "(null)")
-        .arg(ia_opt ? ia_opt->toText() : "(null)");
+    // Kea passes either "ia_na" or "ia_pd" according to the lease type,
+    // so lease type is enough and no missing argument is ever probed
+    bool isIA_NA{lease->getType() == Lease::TYPE_NA};
+
+    if (DHCP6ExporterLogger.isDebugEnabled(DBGLVL_TRACE_DETAIL)) {
+        Option6IAPtr iaOpt;
+        handle.getArgument(isIA_NA ? "ia_na" : "ia_pd", iaOpt);
+        LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL, DHCP6_EXPORTER_LEASE6_REBIND)
+            .arg(query ? query->toText() : "(null)")
+            .arg(lease->toText())
+            .arg(iaOpt ? iaOpt->toText() : "(null)");
+    }
 
-    handleRenewRebindProcess<true>(query, lease, ia_opt, isIA_NA);
+    handleRenewRebindProcess<true>(query, lease, isIA_NA);
 }
 
 void DHCP6ExporterImpl::handleLease6Renew(CalloutHandle& handle) {
-    Pkt6Ptr      query;
-    Lease6Ptr    lease;
-    Option6IAPtr ia_opt, tmp;
-    bool         isIA_NA{true}, isIA_PD{true};
+    SpanTracer::CalloutScope calloutSpan("kea.lease6_renew");
+    Pkt6Ptr   query;
+    Lease6Ptr lease;
 
     handle.getArgument("query6", query);
     handle.getArgument("lease6", lease);
 
-    // IA_NA and IA_PD arguments are mutually exclusive
-    try {
-        handle.getArgument("ia_na", tmp);
-        if (!tmp) {
-            isIA_NA = false;
-        } else {
-            ia_opt = tmp;
-        }
-    } catch (const NoSuchArgument&) { isIA_NA = false; }
-
-    try {
-        handle.getArgument("ia_pd", tmp);
-        if (!tmp) {
-            isIA_PD = false;
-        } else {
-            ia_opt = tmp;
-        }
-    } catch (const NoSuchArgument&) { isIA_PD = false; }
-
-    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL, DHCP6_EXPORTER_LEASE6_RENEW)
-        .arg(query ? query->toText() : "(null)")
-        .arg(lease ? lease->toText() : "(null)")
-        .arg(ia_opt ? ia_opt->toText() : "(null)");
+    // Kea passes either "ia_na" or "ia_pd" according to the lease type,
+    // so lease type is enough and no missing argument is ever probed
+    bool isIA_NA{lease->getType() == Lease::TYPE_NA};
+
+    if (DHCP6ExporterLogger.isDebugEnabled(DBGLVL_TRACE_DETAIL)) {
+        Option6IAPtr iaOpt;
+        handle.getArgument(isIA_NA ? "ia_na" : "ia_pd", iaOpt);
+        LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL, DHCP6_EXPORTER_LEASE6_RENEW)
+            .arg(query ? query->toText() : "(null)")
+            .arg(lease->toText())
+            .arg(iaOpt ? iaOpt->toText() : "(null)");
+    }
 
-    handleRenewRebindProcess<false>(query, lease, ia_opt, isIA_NA);
+    handleRenewRebindProcess<false>(query, lease, isIA_NA);
 }
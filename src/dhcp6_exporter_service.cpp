@@ -1,21 +1,113 @@
 #include "dhcp6_exporter_service.hpp"
 #include "lease_utils.hpp"
 #include "management_client.hpp"
+#include "prefix_set.hpp"
+#include "span_tracer.hpp"
+#include "trace_ring.hpp"
+#include <cc/dhcp_config_error.h>
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/lease_mgr_factory.h>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <sys/resource.h>
+#include <thread>
+#include <util/multi_threading_mgr.h>
 
-DHCP6ExporterService::DHCP6ExporterService(ConstElementPtr mgmtConnType,
-                                           ConstElementPtr mgmtConnParams) {
+DHCP6ExporterService::DHCP6ExporterService(const Params& params) : m_params(params) {
     string mgmtName;
     try {
-        mgmtName = mgmtConnType->stringValue();
+        mgmtName = params.connType->stringValue();
     } catch (const isc::data::TypeError& ex) {
         isc_throw(isc::Unexpected, "No value for connection type");
     }
 
-    m_client           = ManagementClient::init(mgmtName, mgmtConnParams);
-    m_heartbeatService = HeartbeatService::init(mgmtName, mgmtConnParams);
+    m_client           = ManagementClient::init(mgmtName, params.connParams);
+    m_heartbeatService = HeartbeatService::init(mgmtName, params.connParams);
+    if (params.subnetVrfs) { parseSubnetVrfs(params.subnetVrfs); }
+    m_flapDamper = createFlapDamper(params.flapDamping);
+    m_spool      = createSpool(params.spool);
+    m_ha         = createHA(params.ha);
+}
+
+std::unique_ptr<FlapDamper>
+    DHCP6ExporterService::createFlapDamper(ConstElementPtr config) {
+    if (!config) { return nullptr; }
+    return std::make_unique<FlapDamper>(
+        FlapDamper::Config::parseConfig(config),
+        [this](const RouteExport& route, bool remove) { forwardRoute(route, remove); });
+}
+
+std::unique_ptr<RouteSpool> DHCP6ExporterService::createSpool(ConstElementPtr config) {
+    if (!config) { return nullptr; }
+    return std::make_unique<RouteSpool>(
+        RouteSpool::Config::parseConfig(config),
+        [this](const RouteExport& route, bool remove) { sendRoute(route, remove); });
+}
+
+std::unique_ptr<HAOwnership> DHCP6ExporterService::createHA(ConstElementPtr config) {
+    if (!config) { return nullptr; }
+    return std::make_unique<HAOwnership>(
+        HAOwnership::Config::parseConfig(config),
+        [this](const RouteExport& route, bool remove) { spoolRoute(route, remove); },
+        [this](bool complete) {
+            // partner may have left the switch in any state
+            if (!complete) { resyncAll(); }
+        });
+}
+
+size_t DHCP6ExporterService::connectionHash() const {
+    // routes of subnet moved to another VRF live elsewhere on the switch
+    return ServiceHandover::hashParams(
+        {m_params.connType, m_params.connParams, m_params.subnetVrfs});
+}
+
+ServiceHandover DHCP6ExporterService::handover() {
+    ServiceHandover result;
+    result.connectionHash = connectionHash();
+    result.haHash         = ServiceHandover::hashParams({m_params.ha});
+    result.tlsSession     = m_client->tlsSession();
+    if (m_ha) { result.ha = m_ha->handover(); }
+    // routes of cancelled restore or resync may be missing on the switch, and
+    // server that didn't know its HA state didn't restore them
+    if (!m_interruptedJobs && (!result.ha || !result.ha->mode.empty())) {
+        result.switchUptimeSecs = m_heartbeatService->switchUptime();
+    }
+    return result;
+}
+
+bool DHCP6ExporterService::adopt(ServiceHandover&& handover) {
+    if (handover.connectionHash != connectionHash()) {
+        LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_HANDOVER_CONNECTION_CHANGED)
+            .arg(m_client->connectionName());
+        return false;
+    }
+    m_client->setTLSSession(handover.tlsSession);
+    size_t shadowLeases{0};
+    bool   shadowLost{false};
+    if (handover.ha) {
+        if (m_ha && handover.haHash == ServiceHandover::hashParams({m_params.ha}) &&
+            !handover.ha->mode.empty()) {
+            shadowLeases = handover.ha->shadow.size();
+            m_ha->adopt(std::move(*handover.ha));
+        } else if (!handover.ha->shadow.empty() || !handover.ha->complete) {
+            shadowLost = true;
+            if (m_ha) { m_ha->markShadowIncomplete(); }
+        }
+    }
+    // lost shadow operations are restored from lease database
+    if (handover.switchUptimeSecs && !shadowLost) {
+        m_heartbeatService->resumeFrom(*handover.switchUptimeSecs);
+    }
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_HANDOVER_ADOPTED)
+        .arg(m_client->connectionName())
+        .arg(handover.switchUptimeSecs && !shadowLost
+                 ? std::to_string(*handover.switchUptimeSecs)
+                 : "(none)")
+        .arg(!handover.tlsSession.empty())
+        .arg(shadowLeases);
+    return true;
 }
 
 void DHCP6ExporterService::setIOService(const IOServicePtr& io_service) {
@@ -24,6 +116,105 @@ void DHCP6ExporterService::setIOService(const IOServicePtr& io_service) {
 
 IOServicePtr DHCP6ExporterService::getIOService() { return m_ioService; }
 
+void DHCP6ExporterService::parseSubnetVrfs(ConstElementPtr config) {
+    using isc::data::Element;
+    if (config->getType() != Element::list) {
+        isc_throw(isc::ConfigError, "parameter \"subnet-vrfs\" must be a list");
+    }
+    std::vector<VrfId> vrfs;
+    for (const auto& entry : config->listValue()) {
+        auto subnetId{entry->getType() == Element::map ? entry->get("subnet-id")
+                                                       : ConstElementPtr()};
+        auto vrf{entry->getType() == Element::map ? entry->get("vrf")
+                                                  : ConstElementPtr()};
+        if (!subnetId || subnetId->getType() != Element::integer ||
+            subnetId->intValue() <= 0 ||
+            subnetId->intValue() > std::numeric_limits<uint32_t>::max()) {
+            isc_throw(isc::ConfigError, "entry of \"subnet-vrfs\" must have positive "
+                                        "integer \"subnet-id\"");
+        }
+        if (!vrf || vrf->getType() != Element::string || vrf->stringValue().empty()) {
+            isc_throw(isc::ConfigError,
+                      "entry of \"subnet-vrfs\" must have non-empty \"vrf\" string");
+        }
+        auto vrfId{VrfNames::intern(vrf->stringValue())};
+        auto [it, inserted]{m_subnetVrfs.try_emplace(
+            static_cast<isc::dhcp::SubnetID>(subnetId->intValue()), vrfId)};
+        if (!inserted) {
+            isc_throw(isc::ConfigError,
+                      "subnet " << it->first << " is listed twice in \"subnet-vrfs\"");
+        }
+        if (vrfId != DefaultVrfId &&
+            std::find(vrfs.begin(), vrfs.end(), vrfId) == vrfs.end()) {
+            vrfs.push_back(vrfId);
+        }
+    }
+    m_client->setExportVrfs(vrfs);
+}
+
+VrfId DHCP6ExporterService::subnetVrf(isc::dhcp::SubnetID subnetId) const {
+    auto it{m_subnetVrfs.find(subnetId)};
+    return it != m_subnetVrfs.end() ? it->second : DefaultVrfId;
+}
+
+std::optional<RouteExport>
+    DHCP6ExporterService::resolveLeaseRoute(const ManagementClient::HWAddrMap& mapping,
+                                            const Lease6Ptr&                  lease) {
+    // reclaimed and declined leases stay in database but have no route
+    if (lease->stateExpiredReclaimed() || lease->stateDeclined()) { return std::nullopt; }
+    auto leasePrefix{lease->addr_};
+    auto leasePrefixLength{lease->prefixlen_};
+    auto leaseIAID{lease->iaid_};
+    auto leaseDUID{lease->duid_};
+    switch (lease->getType()) {
+        case isc::dhcp::Lease::TYPE_NA: {
+            auto leaseHWAddr{lease->hwaddr_};
+            auto vlanIfId{NoInterfaceId};
+            if (leaseHWAddr) {
+                LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
+                          DHCP6_EXPORTER_NXOS_ROUTE_CHECK_HWADDR)
+                    .arg(m_client->connectionName())
+                    .arg(leaseHWAddr->toText());
+                vlanIfId = mapping.find(*leaseHWAddr);
+            }
+            if (vlanIfId == NoInterfaceId) {
+                LOG_ERROR(DHCP6ExporterLogger,
+                          DHCP6_EXPORTER_NXOS_ROUTE_REINIT_NO_HWADDR_FAILED)
+                    .arg(m_client->connectionName())
+                    .arg(lease->getType())
+                    .arg(leaseIAID)
+                    .arg(leaseDUID)
+                    .arg(leasePrefix.toText());
+                return std::nullopt;
+            }
+            auto route{RouteExport::makeIA_NAFast(0, leaseIAID, leaseDUID, vlanIfId,
+                                                  leasePrefix)};
+            route.vrfId = subnetVrf(lease->subnet_id_);
+            return route;
+        }
+        case isc::dhcp::Lease::TYPE_PD: {
+            // check for IA_NA lease in lease database
+            auto entry{LeaseUtils::findIA_NALeaseByDUID_IAID(leaseDUID, leaseIAID)};
+            if (!entry) {
+                LOG_ERROR(DHCP6ExporterLogger,
+                          DHCP6_EXPORTER_NXOS_ROUTE_REINIT_IA_NA_LEASE_FAILED)
+                    .arg(m_client->connectionName())
+                    .arg(leaseIAID)
+                    .arg(leaseDUID ? leaseDUID->toText() : "(null)")
+                    .arg(leasePrefix.toText() + "/" + std::to_string(leasePrefixLength));
+                return std::nullopt;
+            }
+            auto route{RouteExport::makeIA_PD(0, leaseIAID, leaseDUID, entry->addr_,
+                                              leasePrefix, leasePrefixLength)};
+            route.vrfId = subnetVrf(lease->subnet_id_);
+            return route;
+        }
+        case isc::dhcp::Lease::TYPE_TA:
+        case isc::dhcp::Lease::TYPE_V4: break;
+    }
+    return std::nullopt;
+}
+
 void DHCP6ExporterService::restoreLeasesFromLeaseDatabase(
     HeartbeatService::HandlerFailedCallback handlerFailed) {
     // for IA_NA leases we must receive mapping
@@ -40,7 +231,6 @@ void DHCP6ExporterService::restoreLeasesFromLeaseDatabase(
                           "empty pointer to map from HWAddr to Vlan interface");
             }
 
-            auto& leaseMgr{isc::dhcp::LeaseMgrFactory::instance()};
             auto& cfgMgr{isc::dhcp::CfgMgr::instance()};
             auto  currentConfigPtr{cfgMgr.getCurrentCfg()};
             if (!currentConfigPtr) {
@@ -55,100 +245,645 @@ void DHCP6ExporterService::restoreLeasesFromLeaseDatabase(
                 isc_throw(isc::Unexpected, "can't get subnet6 list");
             }
 
-            // get leases for every subnet
+            auto job{std::make_shared<RestoreJob>()};
+            job->mapping     = std::move(mapping);
+            job->maxInFlight = std::max<size_t>(m_client->maxBulkApplies(), 1);
+            job->startedAt   = RestoreJob::Clock::now();
             for (const auto& subnet : *subnet6CollectionPtr) {
-                auto                   subnetId{subnet->getID()};
-                auto                   leasesInSubnet{leaseMgr.getLeases6(subnetId)};
-                std::vector<Lease6Ptr> iaNaLeases;
-                // potentially, we can have equal number of IA_NA and IA_PD leases
-                iaNaLeases.reserve(leasesInSubnet.size() / 2);
-                // first phase: apply routes for IA_PD,
-                // collect hwaddr values for IA_NA into temporary struct
-                for (const auto& lease : leasesInSubnet) {
-                    auto leasePrefix{lease->addr_};
-                    auto leasePrefixLength{lease->prefixlen_};
-                    auto leaseIAID{lease->iaid_};
-                    auto leaseDUID{lease->duid_};
-                    auto leaseHWAddr{lease->hwaddr_};
-                    if (!leaseHWAddr) {
-                        isc_throw(isc::Unexpected,
-                                  "can't recover route for lease without HWAddr");
+                job->subnets.push_back(subnet->getID());
+            }
+            // lease backend is read by other threads only in multi-threading mode,
+            // otherwise leases are collected on IOService as one task
+            bool multiThreading{isc::util::MultiThreadingMgr::instance().getMode()};
+            {
+                std::unique_lock lock(m_restoreMutex);
+                m_restoreStats.restores++;
+                m_restoreStats.running = true;
+                if (multiThreading) {
+                    if (!m_restorePoolSize) {
+                        m_restorePoolSize = std::min<size_t>(
+                            std::max<size_t>(std::thread::hardware_concurrency(), 1),
+                            MaxRestoreWorkers);
+                        m_restorePool.start(m_restorePoolSize);
                     }
-                    switch (lease->getType()) {
-                        case isc::dhcp::Lease::TYPE_NA: {
-                            LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
-                                      DHCP6_EXPORTER_NXOS_ROUTE_CHECK_HWADDR)
-                                .arg(m_client->connectionName())
-                                .arg(leaseHWAddr->toText());
-                            auto item{mapping->find(*leaseHWAddr)};
-                            if (item != mapping->end()) {
-                                RouteExport routeInfo{
-                                    {},
-                                    leaseIAID,
-                                    leaseDUID,
-                                    IA_NAFast{item->second, leasePrefix}};
-                                m_client->sendRoutesToSwitch(routeInfo);
-                            } else {
-                                LOG_ERROR(
-                                    DHCP6ExporterLogger,
-                                    DHCP6_EXPORTER_NXOS_ROUTE_REINIT_NO_HWADDR_FAILED)
-                                    .arg(m_client->connectionName())
-                                    .arg(lease->getType())
-                                    .arg(leaseIAID)
-                                    .arg(leaseDUID)
-                                    .arg(leasePrefix.toText());
-                                continue;
-                            }
-                        } break;
-                        case isc::dhcp::Lease::TYPE_PD: {
-                            // check for IA_NA lease in lease database
-                            auto entry{LeaseUtils::findIA_NALeaseByDUID_IAID(leaseDUID,
-                                                                             leaseIAID)};
-                            if (entry) {
-                                RouteExport routeInfo{{},
-                                                      leaseIAID,
-                                                      leaseDUID,
-                                                      IA_PDInfo{entry->addr_, leasePrefix,
-                                                                leasePrefixLength}};
-                                m_client->sendRoutesToSwitch(routeInfo);
-                            } else {
-                                LOG_ERROR(
-                                    DHCP6ExporterLogger,
-                                    DHCP6_EXPORTER_NXOS_ROUTE_REINIT_IA_NA_LEASE_FAILED)
-                                    .arg(m_client->connectionName())
-                                    .arg(leaseIAID)
-                                    .arg(leaseDUID->toText())
-                                    .arg(leasePrefix.toText() + "/" +
-                                         std::to_string(leasePrefixLength));
-                            }
-                            return;
-                        } break;
-                        case isc::dhcp::Lease::TYPE_TA:
-                        case isc::dhcp::Lease::TYPE_V4: break;
+                    job->workers = std::max<size_t>(
+                        std::min(m_restorePoolSize, job->subnets.size()), 1);
+                }
+                // restore after another reload of the switch supersedes this one
+                if (m_restoreJob) { m_restoreJob->cancelled = true; }
+                m_restoreJob = job;
+            }
+            if (!multiThreading) {
+                m_ioService->post([this, job] {
+                    // service may be stopped while job is queued
+                    if (job->cancelled) { return; }
+                    collectRestoreRoutes(job);
+                    if (!job->cancelled) { finishRestoreCollection(job); }
+                });
+                return;
+            }
+            for (size_t i{0}; i < job->workers; ++i) {
+                m_restorePool.add(boost::make_shared<std::function<void()>>([this, job] {
+                    collectRestoreRoutes(job);
+                    if (++job->finishedWorkers < job->workers || job->cancelled) {
+                        return;
                     }
+                    m_ioService->post([this, job] {
+                        // service may be stopped while job is queued
+                        if (job->cancelled) { return; }
+                        finishRestoreCollection(job);
+                    });
+                }));
+            }
+        });
+}
+
+void DHCP6ExporterService::finishRestoreCollection(const RestoreJobPtr& job) {
+    {
+        std::unique_lock lock(job->mutex);
+        job->collected   = true;
+        job->collectedAt = RestoreJob::Clock::now();
+    }
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_RESTORE_ROUTES)
+        .arg(m_client->connectionName())
+        .arg(job->leases.load())
+        .arg(job->routes.load())
+        .arg(job->workers);
+    // restore is finished here if nothing is in flight
+    dispatchRestoreBatches(job);
+}
+
+void DHCP6ExporterService::collectRestoreRoutes(const RestoreJobPtr& job) {
+    auto& leaseMgr{isc::dhcp::LeaseMgrFactory::instance()};
+    auto  batch{std::make_shared<ManagementClient::Routes>()};
+    for (auto index{job->nextSubnet++}; index < job->subnets.size() && !job->cancelled;
+         index = job->nextSubnet++) {
+        auto subnetId{job->subnets[index]};
+        try {
+            auto leases{leaseMgr.getLeases6(subnetId)};
+            job->leases += leases.size();
+            for (const auto& lease : leases) {
+                auto route{resolveLeaseRoute(*job->mapping, lease)};
+                if (route) { batch->push_back(std::move(*route)); }
+            }
+        } catch (const std::exception& ex) {
+            LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_RESTORE_SUBNET_FAILED)
+                .arg(subnetId)
+                .arg(m_client->connectionName())
+                .arg(ex.what());
+        }
+        if (batch->size() >= RestoreBatchRoutes) {
+            queueRestoreBatch(job, std::move(batch));
+            batch = std::make_shared<ManagementClient::Routes>();
+        }
+    }
+    if (!batch->empty()) { queueRestoreBatch(job, std::move(batch)); }
+}
+
+void DHCP6ExporterService::queueRestoreBatch(const RestoreJobPtr&        job,
+                                             ManagementClient::RoutesPtr batch) {
+    job->routes += batch->size();
+    {
+        std::unique_lock lock(job->mutex);
+        job->batches.push_back(std::move(batch));
+    }
+    dispatchRestoreBatches(job);
+}
+
+void DHCP6ExporterService::dispatchRestoreBatches(const RestoreJobPtr& job) {
+    std::vector<ManagementClient::RoutesPtr> send;
+    bool                                     finished{false};
+    {
+        std::unique_lock lock(job->mutex);
+        while (job->inFlight < job->maxInFlight && !job->batches.empty()) {
+            if (job->firstAppliedAt == RestoreJob::Clock::time_point{}) {
+                job->firstAppliedAt = RestoreJob::Clock::now();
+            }
+            send.push_back(std::move(job->batches.front()));
+            job->batches.pop_front();
+            job->inFlight++;
+        }
+        if (job->collected && job->batches.empty() && !job->inFlight && !job->finished) {
+            job->finished = true;
+            finished      = true;
+        }
+    }
+    // handler may be called before `applyRoutesBulk` returns
+    for (auto& batch : send) {
+        m_client->applyRoutesBulk(std::move(batch), [this, job](const auto& result) {
+            {
+                std::unique_lock lock(job->mutex);
+                job->inFlight--;
+                job->result.applied += result.applied;
+                job->result.failed += result.failed;
+                job->result.requests += result.requests;
+                job->result.dispatched += result.dispatched;
+            }
+            dispatchRestoreBatches(job);
+        });
+    }
+    if (finished) { finishRestore(*job); }
+}
+
+void DHCP6ExporterService::finishRestore(RestoreJob& job) {
+    using Clock = RestoreJob::Clock;
+    auto toMs{[](Clock::duration duration) {
+        return static_cast<int64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+    }};
+    auto finishedAt{Clock::now()};
+    auto appliedFrom{job.firstAppliedAt == Clock::time_point{} ? job.collectedAt
+                                                                : job.firstAppliedAt};
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    RestoreStats stats;
+    {
+        std::unique_lock lock(m_restoreMutex);
+        m_restoreStats.running   = false;
+        m_restoreStats.leases    = job.leases;
+        m_restoreStats.routes    = job.routes;
+        m_restoreStats.collectMs = toMs(job.collectedAt - job.startedAt);
+        m_restoreStats.applyMs   = toMs(finishedAt - appliedFrom);
+        m_restoreStats.result    = job.result;
+        // kilobytes on Linux
+        m_restoreStats.peakRssKb = usage.ru_maxrss;
+        stats                    = m_restoreStats;
+    }
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_RESTORE_FINISHED)
+        .arg(m_client->connectionName())
+        .arg(stats.routes)
+        .arg(stats.result.applied)
+        .arg(stats.result.failed)
+        .arg(stats.result.dispatched)
+        .arg(stats.result.requests)
+        .arg(stats.collectMs)
+        .arg(stats.applyMs)
+        .arg(stats.routes * 1000 /
+             static_cast<size_t>(std::max<int64_t>(stats.applyMs, 1)))
+        .arg(stats.peakRssKb);
+}
+
+uint64_t DHCP6ExporterService::resyncSubnet(isc::dhcp::SubnetID subnetId) {
+    return startResync("subnet " + std::to_string(subnetId), /*diffWithSwitch=*/true,
+                       [subnetId] {
+                           return isc::dhcp::LeaseMgrFactory::instance().getLeases6(
+                               subnetId);
+                       });
+}
+
+uint64_t DHCP6ExporterService::resyncClient(const DuidPtr&                 duid,
+                                            const std::optional<uint32_t>& iaid) {
+    string scope{"duid " + duid->toText()};
+    if (iaid) { scope += " iaid " + std::to_string(*iaid); }
+    // one client is cheaper to re-export than to diff with full route table
+    return startResync(scope, /*diffWithSwitch=*/false, [duid, iaid] {
+        auto leases{isc::dhcp::LeaseMgrFactory::instance().getLeases6(*duid)};
+        if (iaid) {
+            leases.erase(std::remove_if(leases.begin(), leases.end(),
+                                        [&iaid](const Lease6Ptr& lease) {
+                                            return lease->iaid_ != *iaid;
+                                        }),
+                         leases.end());
+        }
+        return leases;
+    });
+}
+
+uint64_t DHCP6ExporterService::resyncAll() {
+    return startResync(
+        "all", /*diffWithSwitch=*/true,
+        [] { return isc::dhcp::LeaseMgrFactory::instance().getLeases6(); },
+        /*removeStale=*/m_client->ownsRoutes());
+}
+
+// static route read from the switch, nexthop is address or interface name
+static std::optional<RouteExport>
+    installedRouteToExport(const ManagementClient::InstalledRoute& installed) {
+    auto prefix{IPv6Prefix::fromText(installed.prefix)};
+    if (!prefix) { return std::nullopt; }
+    auto slash{installed.prefix.find('/')};
+    auto route{RouteExport::makeIA_NAFast(0, 0, nullptr, NoInterfaceId,
+                                          IOAddress(installed.prefix.substr(0, slash)))};
+    route.prefixLength = prefix->length;
+    route.vrfId        = installed.vrfId;
+    if (IPv6Prefix::fromText(installed.nexthop)) {
+        route.type    = RouteExportType::IA_PD;
+        route.nexthop = RouteAddress::fromIOAddress(IOAddress(installed.nexthop));
+    } else {
+        route.ifId = InterfaceNames::intern(installed.nexthop);
+    }
+    return route;
+}
+
+uint64_t DHCP6ExporterService::removeOwnedRoutes() {
+    if (!m_client->ownsRoutes()) {
+        isc_throw(isc::InvalidOperation,
+                  "routes of exporter can't be told apart without \"route-tag\"");
+    }
+    auto job{createResyncJob("owned routes")};
+    m_client->asyncGetInstalledRoutes(
+        [this, job](ManagementClient::InstalledRoutesPtr installed,
+                    bool                                connectionFailed) {
+            if (connectionFailed || !installed) {
+                failResync(*job, "can't get static routes from switch");
+                return;
+            }
+            auto routes{std::make_shared<ManagementClient::Routes>()};
+            routes->reserve(installed->size());
+            for (const auto& entry : *installed) {
+                auto route{installedRouteToExport(entry)};
+                if (route) {
+                    routes->push_back(*route);
+                } else {
+                    job->skipped++;
                 }
             }
+            job->unmatched = routes->size();
+            removeStaleRoutes(job, std::move(routes), /*finishJob=*/true);
         });
+    return job->id;
+}
+
+void DHCP6ExporterService::removeStaleRoutes(const std::shared_ptr<ResyncJob>& job,
+                                             ManagementClient::RoutesPtr routes,
+                                             bool                        finishJob) {
+    if (routes->empty()) {
+        if (finishJob) { job->state = ResyncState::FINISHED; }
+        return;
+    }
+    m_client->removeRoutesBulk(
+        routes, [this, job, finishJob](const ManagementClient::BulkApplyResult& result) {
+            job->removed += result.applied;
+            LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_RESYNC_STALE_REMOVED)
+                .arg(job->id)
+                .arg(m_client->connectionName())
+                .arg(result.applied)
+                .arg(result.failed);
+            if (!finishJob) { return; }
+            auto running{ResyncState::RUNNING};
+            job->state.compare_exchange_strong(running, ResyncState::FINISHED);
+        });
+}
+
+std::shared_ptr<DHCP6ExporterService::ResyncJob>
+    DHCP6ExporterService::createResyncJob(const string& scope) {
+    // partner with the same lease database resyncs the switch
+    if (m_ha && !m_ha->isFullStateOwner()) {
+        isc_throw(isc::InvalidOperation, "HA partner owns full state of the switch");
+    }
+    auto job{std::make_shared<ResyncJob>()};
+    job->scope = scope;
+    {
+        std::unique_lock lock(m_resyncMutex);
+        job->id = ++m_lastResyncId;
+        m_resyncJobs.push_back(job);
+        if (m_resyncJobs.size() > MaxResyncJobs) { m_resyncJobs.pop_front(); }
+    }
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_RESYNC_STARTED)
+        .arg(job->id)
+        .arg(m_client->connectionName())
+        .arg(scope);
+    return job;
+}
+
+uint64_t DHCP6ExporterService::startResync(const string&  scope,
+                                           bool           diffWithSwitch,
+                                           LeaseCollector collect,
+                                           bool           removeStale) {
+    auto job{createResyncJob(scope)};
+    job->removeStale         = removeStale;
+    job->removeStaleNexthops = m_client->ownsRoutes();
+    // handlers of the switch run on thread of the client, lease backend is read
+    // there only in multi-threading mode, otherwise leases are collected on
+    // IOService
+    auto resolve{[this, job, collect = std::move(collect)](
+                     ManagementClient::HWAddrMapPtr       mapping,
+                     ManagementClient::InstalledRoutesPtr routes) {
+        if (isc::util::MultiThreadingMgr::instance().getMode()) {
+            resolveResync(job, *mapping, routes.get(), collect);
+            return;
+        }
+        m_ioService->post([this, job, mapping, routes, collect] {
+            // service may be stopped while job is queued
+            if (job->state != ResyncState::RUNNING) { return; }
+            resolveResync(job, *mapping, routes.get(), collect);
+        });
+    }};
+    m_client->asyncGetHWAddrToInterfaceNameMapping(
+        [this, job, diffWithSwitch, resolve](ManagementClient::HWAddrMapPtr mapping,
+                                             bool connectionFailed) {
+            if (connectionFailed || !mapping) {
+                failResync(*job, "can't get neighbor table from switch");
+                return;
+            }
+            if (!diffWithSwitch) {
+                resolve(mapping, nullptr);
+                return;
+            }
+            m_client->asyncGetInstalledRoutes(
+                [this, job, mapping, resolve](ManagementClient::InstalledRoutesPtr routes,
+                                              bool connectionFailed) {
+                    if (connectionFailed || !routes) {
+                        failResync(*job, "can't get static routes from switch");
+                        return;
+                    }
+                    resolve(mapping, std::move(routes));
+                });
+        });
+    return job->id;
+}
+
+void DHCP6ExporterService::failResync(ResyncJob& job, const string& reason) {
+    job.state = ResyncState::FAILED;
+    LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_RESYNC_FAILED)
+        .arg(job.id)
+        .arg(m_client->connectionName())
+        .arg(reason);
+}
+
+void DHCP6ExporterService::resolveResync(
+    const std::shared_ptr<ResyncJob>&        job,
+    const ManagementClient::HWAddrMap&       mapping,
+    const ManagementClient::InstalledRoutes* installed,
+    const LeaseCollector&                    collect) {
+    auto routes{std::make_shared<std::vector<RouteExport>>()};
+    try {
+        auto leases{collect()};
+        job->leases = leases.size();
+        routes->reserve(leases.size());
+        for (const auto& lease : leases) {
+            auto route{resolveLeaseRoute(mapping, lease)};
+            if (route) {
+                routes->push_back(*route);
+            } else {
+                job->skipped++;
+            }
+        }
+    } catch (const std::exception& ex) {
+        failResync(*job, ex.what());
+        return;
+    }
+    auto stale{std::make_shared<ManagementClient::Routes>()};
+    if (installed) { *routes = filterInstalledRoutes(*job, *routes, *installed, *stale); }
+    job->routes = routes->size();
+    removeStaleRoutes(job, std::move(stale), /*finishJob=*/false);
+    resyncChunk(job, routes, 0);
+}
+
+// nexthop text of static route from the switch is address or interface name
+static bool isSameNexthop(const RouteExport&                      route,
+                          const ManagementClient::InstalledRoute& installed) {
+    if (route.vrfId != installed.vrfId) { return false; }
+    const auto& nexthop{installed.nexthop};
+    if (route.type == RouteExportType::IA_NAFast) {
+        return nexthop == InterfaceNames::name(route.ifId);
+    }
+    auto prefix{IPv6Prefix::fromText(nexthop)};
+    return prefix && *prefix == IPv6Prefix::fromAddress(route.nexthop, 128);
+}
+
+std::vector<RouteExport> DHCP6ExporterService::filterInstalledRoutes(
+    ResyncJob&                               job,
+    const std::vector<RouteExport>&          routes,
+    const ManagementClient::InstalledRoutes& installed,
+    ManagementClient::Routes&                stale) {
+    PrefixSet::Entries desiredEntries;
+    desiredEntries.reserve(routes.size());
+    for (size_t i = 0; i < routes.size(); ++i) {
+        desiredEntries.push_back(
+            {IPv6Prefix::fromAddress(routes[i].addr, routes[i].prefixLength),
+             static_cast<uint32_t>(i)});
+    }
+    PrefixSet::Entries installedEntries;
+    installedEntries.reserve(installed.size());
+    for (size_t i = 0; i < installed.size(); ++i) {
+        auto prefix{IPv6Prefix::fromText(installed[i].prefix)};
+        if (prefix) { installedEntries.push_back({*prefix, static_cast<uint32_t>(i)}); }
+    }
+    PrefixSet desired(std::move(desiredEntries));
+    PrefixSet switchRoutes(std::move(installedEntries));
+
+    // overlapping prefixes of different leases mean broken lease database
+    auto overlapping{desired.overlappingPairs(MaxReportedOverlaps)};
+    for (const auto& [covering, covered] : overlapping) {
+        job.overlaps++;
+        LOG_WARN(DHCP6ExporterLogger, DHCP6_EXPORTER_RESYNC_OVERLAPPING_PREFIXES)
+            .arg(job.id)
+            .arg(routes[covering->index].toString())
+            .arg(routes[covered->index].toString());
+    }
+
+    std::vector<RouteExport> missing;
+    PrefixSet::diff(
+        desired, switchRoutes,
+        [&](const PrefixSet::Entry& entry) { missing.push_back(routes[entry.index]); },
+        [&](const PrefixSet::Entry& entry) {
+            job.unmatched++;
+            if (!job.removeStale) { return; }
+            auto route{installedRouteToExport(installed[entry.index])};
+            if (route) { stale.push_back(*route); }
+        },
+        [&](PrefixSet::Iterator desiredBegin, PrefixSet::Iterator desiredEnd,
+            PrefixSet::Iterator switchBegin, PrefixSet::Iterator switchEnd) {
+            for (auto desiredIt{desiredBegin}; desiredIt != desiredEnd; ++desiredIt) {
+                const auto& route{routes[desiredIt->index]};
+                bool        present{std::any_of(
+                    switchBegin, switchEnd, [&](const PrefixSet::Entry& entry) {
+                        return isSameNexthop(route, installed[entry.index]);
+                    })};
+                if (present) {
+                    job.unchanged++;
+                } else {
+                    missing.push_back(route);
+                }
+            }
+            // nexthop of previous lease of the prefix, e.g. after the client moved
+            for (auto switchIt{switchBegin}; switchIt != switchEnd; ++switchIt) {
+                const auto& entry{installed[switchIt->index]};
+                bool        leased{std::any_of(
+                    desiredBegin, desiredEnd, [&](const PrefixSet::Entry& desiredEntry) {
+                        return isSameNexthop(routes[desiredEntry.index], entry);
+                    })};
+                if (leased) { continue; }
+                job.staleNexthops++;
+                if (!job.removeStaleNexthops) { continue; }
+                auto route{installedRouteToExport(entry)};
+                if (route) { stale.push_back(*route); }
+            }
+        });
+    return missing;
+}
+
+void DHCP6ExporterService::resyncChunk(
+    const std::shared_ptr<ResyncJob>&                      job,
+    const std::shared_ptr<const std::vector<RouteExport>>& routes,
+    size_t                                                 offset) {
+    auto end{std::min(offset + ResyncChunkSize, routes->size())};
+    for (auto i{offset}; i < end; ++i) { m_client->sendRoutesToSwitch((*routes)[i]); }
+    job->sent = end;
+    if (end < routes->size()) {
+        // let other handlers of IOService run between chunks
+        m_ioService->post([this, job, routes, end] {
+            // service may be stopped while chunk is queued
+            if (job->state != ResyncState::RUNNING) { return; }
+            resyncChunk(job, routes, end);
+        });
+        return;
+    }
+    job->state = ResyncState::FINISHED;
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_RESYNC_FINISHED)
+        .arg(job->id)
+        .arg(m_client->connectionName())
+        .arg(job->leases.load())
+        .arg(job->sent.load())
+        .arg(job->unchanged.load())
+        .arg(job->skipped.load());
+}
+
+const char* DHCP6ExporterService::resyncStateToString(ResyncState state) {
+    switch (state) {
+        case ResyncState::RUNNING: return "running";
+        case ResyncState::FINISHED: return "finished";
+        case ResyncState::FAILED: return "failed";
+        case ResyncState::CANCELLED: return "cancelled";
+    }
+    return "unknown";
+}
+
+isc::data::ElementPtr DHCP6ExporterService::resyncStatus() {
+    using isc::data::Element;
+    auto list{Element::createList()};
+    std::unique_lock lock(m_resyncMutex);
+    for (const auto& job : m_resyncJobs) {
+        auto element{Element::createMap()};
+        element->set("id", Element::create(static_cast<long long>(job->id)));
+        element->set("scope", Element::create(job->scope));
+        element->set("state", Element::create(resyncStateToString(job->state)));
+        element->set("leases", Element::create(static_cast<long long>(job->leases)));
+        element->set("skipped", Element::create(static_cast<long long>(job->skipped)));
+        element->set("unchanged",
+                     Element::create(static_cast<long long>(job->unchanged)));
+        element->set("routes", Element::create(static_cast<long long>(job->routes)));
+        element->set("sent", Element::create(static_cast<long long>(job->sent)));
+        element->set("unmatched",
+                     Element::create(static_cast<long long>(job->unmatched)));
+        element->set("overlaps", Element::create(static_cast<long long>(job->overlaps)));
+        element->set("stale-nexthops",
+                     Element::create(static_cast<long long>(job->staleNexthops)));
+        element->set("removed", Element::create(static_cast<long long>(job->removed)));
+        list->add(element);
+    }
+    return list;
+}
+
+isc::data::ElementPtr DHCP6ExporterService::restoreStats() {
+    using isc::data::Element;
+    RestoreStats stats;
+    {
+        std::unique_lock lock(m_restoreMutex);
+        stats = m_restoreStats;
+    }
+    auto element{Element::createMap()};
+    element->set("restores", Element::create(static_cast<long long>(stats.restores)));
+    element->set("running", Element::create(stats.running));
+    element->set("leases", Element::create(static_cast<long long>(stats.leases)));
+    element->set("routes", Element::create(static_cast<long long>(stats.routes)));
+    element->set("applied",
+                 Element::create(static_cast<long long>(stats.result.applied)));
+    element->set("failed", Element::create(static_cast<long long>(stats.result.failed)));
+    element->set("dispatched",
+                 Element::create(static_cast<long long>(stats.result.dispatched)));
+    element->set("requests",
+                 Element::create(static_cast<long long>(stats.result.requests)));
+    element->set("collect-ms", Element::create(static_cast<long long>(stats.collectMs)));
+    element->set("apply-ms", Element::create(static_cast<long long>(stats.applyMs)));
+    element->set("peak-rss-kb", Element::create(static_cast<long long>(stats.peakRssKb)));
+    return element;
+}
+
+isc::data::ElementPtr DHCP6ExporterService::workerPoolStats() {
+    auto element{isc::data::Element::createMap()};
+    if (auto stats{m_client->workerPoolStats()}) { element->set("management", stats); }
+    if (auto stats{m_heartbeatService->workerPoolStats()}) {
+        element->set("heartbeat", stats);
+    }
+    return element;
 }
 
 void DHCP6ExporterService::startService() {
-    // start ManagementClient for current `connection-type`
+    // start ManagementClient for current `connection-type`,
+    // its answered requests keep heartbeat service from probing the switch
+    m_client->setTrafficObserver([heartbeatService = m_heartbeatService](bool answered) {
+        heartbeatService->observeTraffic(answered);
+    });
     m_client->startClient(*m_ioService);
+    if (m_flapDamper) { m_flapDamper->start(*m_ioService); }
+    if (m_ha) { m_ha->start(*m_ioService); }
+    if (m_spool) {
+        m_spool->start(*m_ioService);
+        m_heartbeatService->setConnectionFailedHandler([this] { m_spool->pause(); });
+    }
+    // routes of previous load of the hook are still on the switch
+    m_heartbeatService->setConnectionResumedHandler([this] {
+        if (m_spool) { m_spool->resume(); }
+    });
     // start HeartbeatClient
     m_heartbeatService->setConnectionRestoredHandler(
         [this](HeartbeatService::HandlerFailedCallback handlerFailed) {
+            // spool is drained while restore runs, both end in state of lease database
+            if (m_spool) {
+                m_spool->resume();
+                handlerFailed = [this, handlerFailed] {
+                    m_spool->pause();
+                    handlerFailed();
+                };
+            }
+            // owner of switch writes restores routes for both servers
+            if (m_ha && !m_ha->isFullStateOwner()) {
+                LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_HA_RESTORE_SKIPPED)
+                    .arg(m_client->connectionName());
+                return;
+            }
             return restoreLeasesFromLeaseDatabase(std::move(handlerFailed));
         });
     m_heartbeatService->startService(*m_ioService);
 }
 
 void DHCP6ExporterService::stopService() {
+    if (m_ha) { m_ha->stop(); }
+    // held operations go to the switch before client is stopped
+    if (m_flapDamper) { m_flapDamper->stop(); }
+    // operations not sent yet are kept in spool file for the next start
+    if (m_spool) { m_spool->stop(); }
+    {
+        std::unique_lock lock(m_resyncMutex);
+        for (const auto& job : m_resyncJobs) {
+            auto running{ResyncState::RUNNING};
+            if (job->state.compare_exchange_strong(running, ResyncState::CANCELLED)) {
+                m_interruptedJobs = true;
+            }
+        }
+    }
+    {
+        std::unique_lock lock(m_restoreMutex);
+        if (m_restoreStats.running) { m_interruptedJobs = true; }
+        if (m_restoreJob) {
+            m_restoreJob->cancelled = true;
+            m_restoreJob.reset();
+        }
+        m_restoreStats.running = false;
+        m_restorePoolSize      = 0;
+    }
+    // workers leave subnet they read, pool is started again by the next restore
+    m_restorePool.stop();
     m_client->stopClient();
     m_heartbeatService->stopService();
 }
 
 void DHCP6ExporterService::exportRoute(const RouteExport& route) {
-    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_UPDATE_INFO_ON_DEVICE)
+    TraceRing::record(TraceEventType::EXPORT_ROUTE, route);
+    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
+              DHCP6_EXPORTER_UPDATE_INFO_ON_DEVICE)
         .arg(route.tid)
         .arg(route.iaid);
     LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC_DATA,
@@ -156,11 +891,18 @@ void DHCP6ExporterService::exportRoute(const RouteExport& route) {
         .arg(m_client->connectionName())
         .arg(route.toString());
 
-    m_client->sendRoutesToSwitch(route);
+    SpanTracer::attachRoute(route);
+    if (m_flapDamper) {
+        m_flapDamper->push(route, /*remove=*/false);
+    } else {
+        forwardRoute(route, /*remove=*/false);
+    }
 }
 
 void DHCP6ExporterService::removeRoute(const RouteExport& route) {
-    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_REMOVE_INFO_ON_DEVICE)
+    TraceRing::record(TraceEventType::REMOVE_ROUTE, route);
+    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
+              DHCP6_EXPORTER_REMOVE_INFO_ON_DEVICE)
         .arg(m_client->connectionName())
         .arg(route.tid)
         .arg(route.iaid);
@@ -169,5 +911,52 @@ void DHCP6ExporterService::removeRoute(const RouteExport& route) {
         .arg(m_client->connectionName())
         .arg(route.toString());
 
-    m_client->removeRoutesFromSwitch(route);
+    SpanTracer::attachRoute(route);
+    if (m_flapDamper) {
+        m_flapDamper->push(route, /*remove=*/true);
+    } else {
+        forwardRoute(route, /*remove=*/true);
+    }
+}
+
+void DHCP6ExporterService::reclaimRoute(const RouteExport& route) {
+    // load-balancing partners reclaim the same leases, primary sends removals
+    if (m_ha && m_ha->isOwner() && !m_ha->isFullStateOwner()) { return; }
+    removeRoute(route);
+}
+
+void DHCP6ExporterService::forwardRoute(const RouteExport& route, bool remove) {
+    if (m_ha && m_ha->push(route, remove)) { return; }
+    spoolRoute(route, remove);
+}
+
+void DHCP6ExporterService::spoolRoute(const RouteExport& route, bool remove) {
+    if (m_spool && m_spool->push(route, remove)) { return; }
+    sendRoute(route, remove);
+}
+
+void DHCP6ExporterService::sendRoute(const RouteExport& route, bool remove) {
+    auto spanStart{SpanTracer::now()};
+    if (remove) {
+        m_client->removeRoutesFromSwitch(route);
+        SpanTracer::record("exporter.remove_route", route, spanStart, SpanTracer::now());
+    } else {
+        m_client->sendRoutesToSwitch(route);
+        SpanTracer::record("exporter.export_route", route, spanStart, SpanTracer::now());
+    }
+}
+
+isc::data::ElementPtr DHCP6ExporterService::flapDampingStats() {
+    if (!m_flapDamper) { return isc::data::ElementPtr(); }
+    return m_flapDamper->stats().toElement();
+}
+
+isc::data::ElementPtr DHCP6ExporterService::spoolStats() {
+    if (!m_spool) { return isc::data::ElementPtr(); }
+    return m_spool->stats().toElement();
+}
+
+isc::data::ElementPtr DHCP6ExporterService::haStatus() {
+    if (!m_ha) { return isc::data::ElementPtr(); }
+    return m_ha->stats().toElement();
 }
@@ -0,0 +1,256 @@
+#include "flap_damper.hpp"
+#include "config_params.hpp"
+#include <asiolink/interval_timer.h>
+#include <cc/data.h>
+#include <cc/dhcp_config_error.h>
+#include <cmath>
+#include <cstring>
+#include <util/hash.h>
+#include <vector>
+
+using isc::data::Element;
+
+#define FIELD_ERROR_STR(field_name, what) \
+    "Field \"" field_name "\" in \"flap-damping\" " what
+
+// clients are swept for reuse and expiry once per second, not on every tick
+static constexpr std::chrono::seconds ClientsSweepInterval{1};
+
+FlapDamper::Config FlapDamper::Config::parseConfig(ConstElementPtr config) {
+    Config result;
+    if (config->getType() != Element::map) {
+        isc_throw(isc::ConfigError, "parameter \"flap-damping\" must be a map");
+    }
+    auto parse = [&](const char* name, size_t defaultValue) {
+        return parsePositiveInteger(config, "flap-damping", name, defaultValue);
+    };
+    auto parseDouble = [&](const char* name, double defaultValue) {
+        return static_cast<double>(parse(name, static_cast<size_t>(defaultValue)));
+    };
+    result.debounceIntervalMs  = parse("debounce-interval", result.debounceIntervalMs);
+    result.penalty             = parseDouble("penalty", result.penalty);
+    result.suppressThreshold   = parseDouble("suppress-threshold",
+                                             result.suppressThreshold);
+    result.reuseThreshold      = parseDouble("reuse-threshold", result.reuseThreshold);
+    result.halfLifeSecs        = parse("half-life", result.halfLifeSecs);
+    result.maxSuppressTimeSecs = parse("max-suppress-time", result.maxSuppressTimeSecs);
+    if (result.reuseThreshold >= result.suppressThreshold) {
+        isc_throw(isc::ConfigError,
+                  FIELD_ERROR_STR("reuse-threshold",
+                                  "must be less than \"suppress-threshold\""));
+    }
+    return result;
+}
+
+isc::data::ElementPtr FlapDamper::Stats::toElement() const {
+    auto element{Element::createMap()};
+    element->set("forwarded", Element::create(static_cast<long long>(forwarded)));
+    element->set("coalesced", Element::create(static_cast<long long>(coalesced)));
+    element->set("cancelled", Element::create(static_cast<long long>(cancelled)));
+    element->set("suppressed", Element::create(static_cast<long long>(suppressed)));
+    element->set("suppress-events",
+                 Element::create(static_cast<long long>(suppressEvents)));
+    element->set("held-operations",
+                 Element::create(static_cast<long long>(heldOperations)));
+    element->set("suppressed-clients",
+                 Element::create(static_cast<long long>(suppressedClients)));
+    element->set("tracked-clients",
+                 Element::create(static_cast<long long>(trackedClients)));
+    return element;
+}
+
+size_t FlapDamper::ClientKeyHash::operator()(const ClientKey& key) const {
+    // DUID hash is already well mixed
+    return static_cast<size_t>(key.duidHash ^
+                               (uint64_t{key.iaid} * 0x9e3779b97f4a7c15ULL));
+}
+
+bool FlapDamper::RouteKey::operator==(const RouteKey& other) const {
+    return duidHash == other.duidHash && addr == other.addr && iaid == other.iaid &&
+           prefixLength == other.prefixLength && isIA_NA == other.isIA_NA &&
+           vrfId == other.vrfId;
+}
+
+size_t FlapDamper::RouteKeyHash::operator()(const RouteKey& key) const {
+    std::array<uint8_t, 16 + 1 + sizeof(VrfId)> buffer;
+    auto it{std::copy(key.addr.bytes.begin(), key.addr.bytes.end(), buffer.begin())};
+    *it++ = key.prefixLength;
+    std::memcpy(&*it, &key.vrfId, sizeof(key.vrfId));
+    return isc::util::Hash64::hash(buffer.data(), buffer.size()) ^ key.duidHash;
+}
+
+FlapDamper::FlapDamper(const Config& config, const ForwardHandler& handler) :
+    m_config(config),
+    // BGP-style ceiling: penalty that decays to reuse threshold in max suppress time
+    m_maxPenalty(config.reuseThreshold *
+                 std::exp2(static_cast<double>(config.maxSuppressTimeSecs) /
+                           static_cast<double>(config.halfLifeSecs))),
+    m_forwardHandler(handler) {}
+
+void FlapDamper::start(IOService& io_service) {
+    m_lastClientsSweep = Clock::now();
+    m_timer = boost::make_shared<isc::asiolink::IntervalTimer>(io_service);
+    // held operations are released with at most quarter of window delay
+    m_timer->setup([this] { tick(); },
+                   std::max<size_t>(m_config.debounceIntervalMs / 4, 50));
+}
+
+void FlapDamper::stop() {
+    if (m_timer) { m_timer->cancel(); }
+    // switch must receive latest intent of every route, even if it was damped
+    std::vector<Operation> forward;
+    {
+        std::unique_lock lock(m_mutex);
+        for (const auto& [key, state] : m_routes) {
+            if (state.hasHeld && !(state.hasForwarded &&
+                                   isRepeated(state.held, state.forwarded))) {
+                forward.push_back(state.held);
+            }
+        }
+        m_stats.forwarded += forward.size();
+        m_stats.heldOperations    = 0;
+        m_stats.suppressedClients = 0;
+        m_routes.clear();
+        m_clients.clear();
+    }
+    for (const auto& op : forward) { m_forwardHandler(op.route, op.remove); }
+}
+
+void FlapDamper::decayPenalty(ClientState& client, Clock::time_point now) const {
+    if (client.penalty > 0) {
+        std::chrono::duration<double> elapsed{now - client.penaltyUpdatedAt};
+        client.penalty *=
+            std::exp2(-elapsed.count() / static_cast<double>(m_config.halfLifeSecs));
+    }
+    client.penaltyUpdatedAt = now;
+}
+
+bool FlapDamper::isRepeated(const Operation& held, const Operation& forwarded) {
+    if (held.remove != forwarded.remove) { return false; }
+    // export to another nexthop is a change, remove is a remove
+    return held.remove || (held.route.type == forwarded.route.type &&
+                           held.route.nexthop == forwarded.route.nexthop &&
+                           held.route.ifId == forwarded.route.ifId);
+}
+
+void FlapDamper::push(const RouteExport& route, bool remove) {
+    auto now{Clock::now()};
+    bool forwardNow{false};
+    {
+        std::unique_lock lock(m_mutex);
+        auto& client{m_clients[ClientKey{route.duidHash, route.iaid}]};
+        decayPenalty(client, now);
+        // export after removal is one flap of the client
+        if (!remove && client.lastRemove) {
+            client.penalty = std::min(client.penalty + m_config.penalty, m_maxPenalty);
+        }
+        client.lastRemove      = remove;
+        client.lastOperationAt = now;
+        if (!client.suppressed && client.penalty > m_config.suppressThreshold) {
+            client.suppressed   = true;
+            client.suppressedAt = now;
+            m_stats.suppressEvents++;
+            m_stats.suppressedClients++;
+            LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_FLAP_DAMPING_CLIENT_SUPPRESSED)
+                .arg(route.duidHash)
+                .arg(route.iaid)
+                .arg(static_cast<uint64_t>(client.penalty));
+        }
+
+        RouteKey key{route.duidHash,     route.addr,      route.iaid,
+                     route.prefixLength, route.isIA_NA(), route.vrfId};
+        auto [it, inserted]{m_routes.try_emplace(key)};
+        auto& state{it->second};
+        Operation op{route, remove};
+        if (!client.suppressed && !state.hasHeld &&
+            (inserted || now - state.forwardedAt >=
+                             std::chrono::milliseconds(m_config.debounceIntervalMs))) {
+            state.forwarded    = op;
+            state.forwardedAt  = now;
+            state.hasForwarded = true;
+            m_stats.forwarded++;
+            forwardNow = true;
+        } else {
+            if (state.hasHeld) {
+                m_stats.coalesced++;
+            } else {
+                state.hasHeld = true;
+                client.heldRoutes++;
+                m_stats.heldOperations++;
+            }
+            state.held = op;
+            if (client.suppressed) { m_stats.suppressed++; }
+        }
+    }
+    if (forwardNow) { m_forwardHandler(route, remove); }
+}
+
+void FlapDamper::tick() {
+    auto                   now{Clock::now()};
+    std::vector<Operation> forward;
+    {
+        std::unique_lock lock(m_mutex);
+        if (now - m_lastClientsSweep >= ClientsSweepInterval) {
+            sweepClients(now);
+            m_lastClientsSweep = now;
+        }
+
+        const std::chrono::milliseconds debounceInterval{m_config.debounceIntervalMs};
+        for (auto it{m_routes.begin()}; it != m_routes.end();) {
+            auto& [key, state]{*it};
+            bool windowPassed{!state.hasForwarded ||
+                              now - state.forwardedAt >= debounceInterval};
+            if (!state.hasHeld) {
+                it = windowPassed ? m_routes.erase(it) : std::next(it);
+                continue;
+            }
+            auto& client{m_clients[ClientKey{key.duidHash, key.iaid}]};
+            if (windowPassed && !client.suppressed) {
+                state.hasHeld = false;
+                client.heldRoutes--;
+                m_stats.heldOperations--;
+                if (state.hasForwarded && isRepeated(state.held, state.forwarded)) {
+                    m_stats.cancelled++;
+                } else {
+                    state.forwarded    = state.held;
+                    state.forwardedAt  = now;
+                    state.hasForwarded = true;
+                    m_stats.forwarded++;
+                    forward.push_back(state.held);
+                }
+            }
+            ++it;
+        }
+    }
+    for (const auto& op : forward) { m_forwardHandler(op.route, op.remove); }
+}
+
+void FlapDamper::sweepClients(Clock::time_point now) {
+    const std::chrono::seconds halfLife{m_config.halfLifeSecs};
+    for (auto it{m_clients.begin()}; it != m_clients.end();) {
+        auto& [key, client]{*it};
+        decayPenalty(client, now);
+        if (client.suppressed && client.penalty < m_config.reuseThreshold) {
+            client.suppressed = false;
+            m_stats.suppressedClients--;
+            LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_FLAP_DAMPING_CLIENT_REUSED)
+                .arg(key.duidHash)
+                .arg(key.iaid)
+                .arg(std::chrono::duration_cast<std::chrono::seconds>(
+                         now - client.suppressedAt)
+                         .count());
+        }
+        // client is forgotten when its flaps are decayed and it's quiet
+        bool expired{!client.suppressed && !client.heldRoutes &&
+                     client.penalty < m_config.penalty / 16 &&
+                     now - client.lastOperationAt >= halfLife};
+        it = expired ? m_clients.erase(it) : std::next(it);
+    }
+}
+
+FlapDamper::Stats FlapDamper::stats() {
+    std::unique_lock lock(m_mutex);
+    auto             result{m_stats};
+    result.trackedClients = m_clients.size();
+    return result;
+}
@@ -0,0 +1,252 @@
+#include "ha_ownership.hpp"
+#include "config_params.hpp"
+#include <asiolink/interval_timer.h>
+#include <cc/command_interpreter.h>
+#include <cc/data.h>
+#include <cc/dhcp_config_error.h>
+#include <config/command_mgr.h>
+
+using isc::data::Element;
+
+#define FIELD_ERROR_STR(field_name, what) "Field \"" field_name "\" in \"ha\" " what
+
+// empty if `name` is missing or isn't a string
+static string stringField(const ConstElementPtr& map, const char* name) {
+    if (!map || map->getType() != Element::map) { return string(); }
+    auto element{map->get(name)};
+    if (!element || element->getType() != Element::string) { return string(); }
+    return element->stringValue();
+}
+
+HAOwnership::Config HAOwnership::Config::parseConfig(ConstElementPtr config) {
+    Config result;
+    if (config->getType() != Element::map) {
+        isc_throw(isc::ConfigError, "parameter \"ha\" must be a map");
+    }
+    auto serverName{config->get("server-name")};
+    if (serverName) {
+        if (serverName->getType() != Element::string ||
+            serverName->stringValue().empty()) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("server-name", "must be a non-empty string"));
+        }
+        result.serverName = serverName->stringValue();
+    }
+    result.pollIntervalMs =
+        parsePositiveInteger(config, "ha", "poll-interval", result.pollIntervalMs);
+    result.shadowLimit =
+        parsePositiveInteger(config, "ha", "shadow-limit", result.shadowLimit);
+    return result;
+}
+
+isc::data::ElementPtr HAOwnership::Stats::toElement() const {
+    auto element{Element::createMap()};
+    element->set("mode", Element::create(mode));
+    element->set("role", Element::create(role));
+    element->set("state", Element::create(state));
+    element->set("owner", Element::create(owner));
+    element->set("full-state-owner", Element::create(fullStateOwner));
+    element->set("takeovers", Element::create(static_cast<long long>(takeovers)));
+    element->set("releases", Element::create(static_cast<long long>(releases)));
+    element->set("shadowed", Element::create(static_cast<long long>(shadowed)));
+    element->set("replayed", Element::create(static_cast<long long>(replayed)));
+    element->set("shadow-leases", Element::create(static_cast<long long>(shadowLeases)));
+    element->set("overflowed", Element::create(overflowed));
+    return element;
+}
+
+HAOwnership::HAOwnership(const Config&          config,
+                         const ForwardHandler&  forwardHandler,
+                         const TakeoverHandler& takeoverHandler) :
+    m_config(config), m_forwardHandler(forwardHandler),
+    m_takeoverHandler(takeoverHandler) {}
+
+void HAOwnership::start(IOService& io_service) {
+    poll();
+    m_timer = boost::make_shared<isc::asiolink::IntervalTimer>(io_service);
+    m_timer->setup([this] { poll(); }, m_config.pollIntervalMs);
+}
+
+void HAOwnership::stop() {
+    if (m_timer) { m_timer->cancel(); }
+}
+
+bool HAOwnership::push(const RouteExport& route, bool remove) {
+    if (m_owner) { return false; }
+    std::unique_lock lock(m_mutex);
+    // ownership may be taken while lock was acquired
+    if (m_owner) { return false; }
+    m_stats.shadowed++;
+    auto key{RouteLeaseKey::fromRoute(route)};
+    auto it{m_shadow.find(key)};
+    if (it != m_shadow.end()) {
+        it->second = {route, remove};
+    } else if (m_shadow.size() < m_config.shadowLimit) {
+        m_shadow.emplace(key, Operation{route, remove});
+    } else if (!m_stats.overflowed) {
+        m_stats.overflowed = true;
+        LOG_WARN(DHCP6ExporterLogger, DHCP6_EXPORTER_HA_SHADOW_OVERFLOW)
+            .arg(m_config.shadowLimit);
+    }
+    return true;
+}
+
+void HAOwnership::markShadowIncomplete() {
+    std::unique_lock lock(m_mutex);
+    m_stats.overflowed = true;
+}
+
+HAOwnership::Handover HAOwnership::handover() {
+    std::unique_lock lock(m_mutex);
+    Handover         result{m_stats.mode, m_stats.role, m_stats.state};
+    result.complete = !m_stats.overflowed;
+    result.shadow.reserve(m_shadow.size());
+    for (const auto& [key, op] : m_shadow) { result.shadow.push_back(op); }
+    return result;
+}
+
+void HAOwnership::adopt(Handover&& handover) {
+    std::unique_lock lock(m_mutex);
+    m_stats.mode       = std::move(handover.mode);
+    m_stats.role       = std::move(handover.role);
+    m_stats.state      = std::move(handover.state);
+    m_stats.overflowed = !handover.complete;
+    m_owner            = ownsWrites(m_stats.mode, m_stats.role, m_stats.state);
+    m_fullStateOwner   = ownsFullState(m_stats.mode, m_stats.role, m_stats.state);
+    for (auto& op : handover.shadow) {
+        if (m_shadow.size() >= m_config.shadowLimit) {
+            m_stats.overflowed = true;
+            break;
+        }
+        m_shadow.insert_or_assign(RouteLeaseKey::fromRoute(op.route), std::move(op));
+    }
+}
+
+HAOwnership::Stats HAOwnership::stats() {
+    std::unique_lock lock(m_mutex);
+    auto             result{m_stats};
+    result.owner          = m_owner;
+    result.fullStateOwner = m_fullStateOwner;
+    result.shadowLeases   = m_shadow.size();
+    return result;
+}
+
+void HAOwnership::poll() {
+    string mode;
+    string role;
+    string state;
+    try {
+        // HA hooks library extends answer of `status-get` in `command_processed`
+        auto answer{isc::config::CommandMgr::instance().processCommand(
+            isc::config::createCommand("status-get"))};
+        int  rcode{isc::config::CONTROL_RESULT_ERROR};
+        auto args{isc::config::parseAnswer(rcode, answer)};
+        if (rcode != isc::config::CONTROL_RESULT_SUCCESS) {
+            isc_throw(isc::Unexpected, "status-get failed: " << answer->str());
+        }
+        auto relationships{args ? args->get("high-availability") : ConstElementPtr()};
+        if (!relationships || relationships->getType() != Element::list ||
+            relationships->empty()) {
+            mode = "standalone";
+        }
+        for (size_t i = 0; mode.empty() && i < relationships->size(); ++i) {
+            auto relationship{relationships->get(i)};
+            auto servers{relationship->get("ha-servers")};
+            auto local{servers ? servers->get("local") : ConstElementPtr()};
+            if (!m_config.serverName.empty() &&
+                stringField(local, "server-name") != m_config.serverName) {
+                continue;
+            }
+            mode  = stringField(relationship, "ha-mode");
+            role  = stringField(local, "role");
+            state = stringField(local, "state");
+        }
+        if (mode.empty()) {
+            isc_throw(isc::NotFound,
+                      "no HA relationship of server \"" << m_config.serverName << "\"");
+        }
+    } catch (const std::exception& ex) {
+        LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_HA_STATUS_FAILED).arg(ex.what());
+        return;
+    }
+
+    size_t replayed{0};
+    bool   complete{true};
+    bool   takeover{false};
+    {
+        std::unique_lock lock(m_mutex);
+        bool             wasOwner{m_owner};
+        bool             initial{m_stats.mode.empty()};
+        complete = !m_stats.overflowed;
+        replayed = updateState(mode, role, state);
+        takeover = !initial && !wasOwner && m_owner;
+    }
+    if (!takeover) { return; }
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_HA_TAKEOVER).arg(replayed).arg(complete);
+    m_takeoverHandler(complete);
+}
+
+size_t HAOwnership::updateState(const string& mode,
+                                const string& role,
+                                const string& state) {
+    if (mode == m_stats.mode && role == m_stats.role && state == m_stats.state) {
+        return 0;
+    }
+    bool wasOwner{m_owner};
+    bool owner{ownsWrites(mode, role, state)};
+    bool initial{m_stats.mode.empty()};
+    m_stats.mode     = mode;
+    m_stats.role     = role;
+    m_stats.state    = state;
+    m_fullStateOwner = ownsFullState(mode, role, state);
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_HA_STATE_CHANGED)
+        .arg(mode)
+        .arg(role.empty() ? "(none)" : role)
+        .arg(state.empty() ? "(none)" : state)
+        .arg(owner);
+    if (owner == wasOwner) { return 0; }
+    size_t replayed{0};
+    if (owner) {
+        // Shadowing goes on until replay is handed to spool: packet thread with
+        // newer operation of the same lease waits for `m_mutex` in `push`, so
+        // stale replayed operation can't overwrite it on the switch
+        for (const auto& [key, op] : m_shadow) { m_forwardHandler(op.route, op.remove); }
+        replayed = m_shadow.size();
+        m_stats.replayed += replayed;
+        if (!initial) { m_stats.takeovers++; }
+    } else {
+        m_stats.releases++;
+    }
+    m_shadow.clear();
+    m_stats.overflowed = false;
+    m_owner            = owner;
+    return replayed;
+}
+
+bool HAOwnership::ownsWrites(const string& mode,
+                             const string& role,
+                             const string& state) {
+    if (mode == "standalone") { return true; }
+    // this server serves alone
+    if (state == "partner-down" || state == "partner-in-maintenance") { return true; }
+    // both servers answer their share of clients, partner never sees these leases
+    if (mode == "load-balancing" &&
+        (state == "load-balancing" || state == "communication-recovery" ||
+         state == "terminated")) {
+        return true;
+    }
+    if (state == "hot-standby" || state == "passive-backup" ||
+        state == "communication-recovery" || state == "terminated") {
+        return role == "primary";
+    }
+    // waiting, syncing, ready, backup, in-maintenance
+    return false;
+}
+
+bool HAOwnership::ownsFullState(const string& mode,
+                                const string& role,
+                                const string& state) {
+    if (!ownsWrites(mode, role, state)) { return false; }
+    return mode == "standalone" || state == "partner-down" ||
+           state == "partner-in-maintenance" || role == "primary";
+}
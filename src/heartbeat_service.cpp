@@ -1,10 +1,20 @@
 #include "heartbeat_service.hpp"
 #include "nxos_heartbeat_service.hpp"
 #include "nxos_management_client.hpp"
+#include "nxos_rest_management_client.hpp"
+#ifdef NXOS_DHCP6_EXPORTER_GNMI
+    #include "nxos_gnmi_management_client.hpp"
+#endif
 
 HeartbeatServicePtr HeartbeatService::init(const string&   mgmtName,
                                            ConstElementPtr mgmtConnParams) {
-    if (mgmtName == NXOSManagementClient::name()) {
+    // REST and gNMI clients use same NX-API endpoint for heartbeat
+    if (mgmtName == NXOSManagementClient::name() ||
+        mgmtName == NXOSRestManagementClient::name()
+#ifdef NXOS_DHCP6_EXPORTER_GNMI
+        || mgmtName == NXOSGnmiManagementClient::name()
+#endif
+    ) {
         return std::static_pointer_cast<HeartbeatService>(
             std::make_shared<NXOSHeartbeatService>(mgmtConnParams));
     }
@@ -13,6 +23,8 @@ HeartbeatServicePtr HeartbeatService::init(const string&   mgmtName,
                   mgmtName + "\"");
 }
 
+isc::data::ElementPtr HeartbeatService::workerPoolStats() const { return {}; }
+
 HeartbeatService::ConnectionRestoredHandler
     HeartbeatService::getConnectionRestoredHandler() const {
     return connectionRestoredHandler;
@@ -30,3 +42,12 @@ void HeartbeatService::setConnectionFailedHandler(
     const ConnectionFailedHandler& handler) {
     connectionFailedHandler = handler;
 }
+
+HeartbeatService::ConnectionResumedHandler
+    HeartbeatService::getConnectionResumedHandler() const {
+    return connectionResumedHandler;
+}
+void HeartbeatService::setConnectionResumedHandler(
+    const ConnectionResumedHandler& handler) {
+    connectionResumedHandler = handler;
+}
@@ -0,0 +1,102 @@
+#include "hwaddr_map.hpp"
+#include <dhcp/hwaddr.h>
+
+static constexpr size_t MacLength{6};
+
+static inline int hexDigitValue(char c) {
+    if (c >= '0' && c <= '9') { return c - '0'; }
+    if (c >= 'a' && c <= 'f') { return c - 'a' + 10; }
+    if (c >= 'A' && c <= 'F') { return c - 'A' + 10; }
+    return -1;
+}
+
+bool HWAddrInterfaceMap::parseCiscoMac(std::string_view rawMac, MacKey& key) {
+    // "f6a5.486e.8aad": three groups of four hex digits
+    if (rawMac.size() != 14 || rawMac[4] != '.' || rawMac[9] != '.') { return false; }
+    MacKey result{0};
+    for (size_t i = 0; i < rawMac.size(); ++i) {
+        if (i == 4 || i == 9) { continue; }
+        auto value{hexDigitValue(rawMac[i])};
+        if (value < 0) { return false; }
+        result = (result << 4) | static_cast<MacKey>(value);
+    }
+    key = result;
+    return true;
+}
+
+bool HWAddrInterfaceMap::toMacKey(const isc::dhcp::HWAddr& hwAddr, MacKey& key) {
+    if (hwAddr.hwaddr_.size() != MacLength) { return false; }
+    MacKey result{0};
+    for (auto byte : hwAddr.hwaddr_) { result = (result << 8) | byte; }
+    key = result;
+    return true;
+}
+
+size_t HWAddrInterfaceMap::slotIndex(MacKey key) const {
+    // low bits of MAC are NIC-specific, mix them with vendor part
+    key ^= key >> 29;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 32;
+    return static_cast<size_t>(key) & (m_slots.size() - 1);
+}
+
+void HWAddrInterfaceMap::reserve(size_t count) {
+    // keep load factor at most 1/2
+    size_t capacity{16};
+    while (capacity < count * 2) { capacity <<= 1; }
+    if (capacity > m_slots.size()) { rehash(capacity); }
+}
+
+void HWAddrInterfaceMap::rehash(size_t capacity) {
+    std::vector<Slot> oldSlots(capacity, Slot{EmptyKey, NoInterfaceId});
+    oldSlots.swap(m_slots);
+    m_size = 0;
+    for (const auto& slot : oldSlots) {
+        if (slot.key != EmptyKey) { insert(slot.key, slot.ifId); }
+    }
+}
+
+void HWAddrInterfaceMap::insert(MacKey key, InterfaceId ifId) {
+    if ((m_size + 1) * 2 > m_slots.size()) {
+        rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+    }
+    for (auto index{slotIndex(key)};; index = (index + 1) & (m_slots.size() - 1)) {
+        auto& slot{m_slots[index]};
+        if (slot.key == EmptyKey) {
+            slot = {key, ifId};
+            ++m_size;
+            return;
+        }
+        if (slot.key == key) {
+            slot.ifId = ifId;
+            return;
+        }
+    }
+}
+
+InterfaceId HWAddrInterfaceMap::find(MacKey key) const {
+    if (m_slots.empty()) { return NoInterfaceId; }
+    for (auto index{slotIndex(key)};; index = (index + 1) & (m_slots.size() - 1)) {
+        const auto& slot{m_slots[index]};
+        if (slot.key == EmptyKey) { return NoInterfaceId; }
+        if (slot.key == key) { return slot.ifId; }
+    }
+}
+
+InterfaceId HWAddrInterfaceMap::find(const isc::dhcp::HWAddr& hwAddr) const {
+    MacKey key;
+    if (!toMacKey(hwAddr, key)) { return NoInterfaceId; }
+    return find(key);
+}
+
+bool isVlanInterfaceName(std::string_view ifName) {
+    constexpr std::string_view VlanPrefix{"vlan"};
+    if (ifName.size() <= VlanPrefix.size()) { return false; }
+    for (size_t i = 0; i < VlanPrefix.size(); ++i) {
+        if ((ifName[i] | 0x20) != VlanPrefix[i]) { return false; }
+    }
+    for (size_t i = VlanPrefix.size(); i < ifName.size(); ++i) {
+        if (ifName[i] < '0' || ifName[i] > '9') { return false; }
+    }
+    return true;
+}
@@ -0,0 +1,341 @@
+#include "jsonrpc/stream_parser.hpp"
+#include <charconv>
+
+JsonStreamParser::JsonStreamParser(Handler& handler) : m_handler(handler) {}
+
+bool JsonStreamParser::fail(const char* what) {
+    if (m_error.empty()) {
+        m_error = string(what) + " at offset " + std::to_string(m_offset);
+    }
+    return false;
+}
+
+static inline bool isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool isLiteralChar(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' ||
+           c == '.' || c == 'E';
+}
+
+static inline int hexDigitValue(char c) {
+    if (c >= '0' && c <= '9') { return c - '0'; }
+    if (c >= 'a' && c <= 'f') { return c - 'a' + 10; }
+    if (c >= 'A' && c <= 'F') { return c - 'A' + 10; }
+    return -1;
+}
+
+bool JsonStreamParser::feed(const char* data, size_t size) {
+    if (!m_error.empty()) { return false; }
+    for (size_t i = 0; i < size; ++i, ++m_offset) {
+        char c{data[i]};
+        switch (m_token) {
+            case Token::STRING: {
+                if (c == '"') {
+                    finishString();
+                } else if (c == '\\') {
+                    m_token = Token::STRING_ESCAPE;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    return fail("control character inside string");
+                } else {
+                    m_buffer += c;
+                }
+                if (m_buffer.size() > MaxTokenSize) { return fail("string is too long"); }
+                continue;
+            }
+            case Token::STRING_ESCAPE: {
+                m_token = Token::STRING;
+                switch (c) {
+                    case '"':
+                    case '\\':
+                    case '/': m_buffer += c; break;
+                    case 'b': m_buffer += '\b'; break;
+                    case 'f': m_buffer += '\f'; break;
+                    case 'n': m_buffer += '\n'; break;
+                    case 'r': m_buffer += '\r'; break;
+                    case 't': m_buffer += '\t'; break;
+                    case 'u': {
+                        m_token           = Token::STRING_UNICODE;
+                        m_codePoint       = 0;
+                        m_codePointDigits = 0;
+                    } break;
+                    default: return fail("invalid escape sequence");
+                }
+                continue;
+            }
+            case Token::STRING_UNICODE: {
+                auto value{hexDigitValue(c)};
+                if (value < 0) { return fail("invalid unicode escape"); }
+                m_codePoint = (m_codePoint << 4) | static_cast<uint32_t>(value);
+                if (++m_codePointDigits == 4) {
+                    appendCodePoint();
+                    m_token = Token::STRING;
+                }
+                continue;
+            }
+            case Token::LITERAL: {
+                if (isLiteralChar(c)) {
+                    m_buffer += c;
+                    if (m_buffer.size() > MaxTokenSize) {
+                        return fail("literal is too long");
+                    }
+                    continue;
+                }
+                if (!finishLiteral()) { return false; }
+                // current char ends literal and is handled below
+            } break;
+            case Token::NONE: break;
+        }
+        if (isWhitespace(c)) { continue; }
+        if (!parseStructural(c)) { return false; }
+    }
+    return true;
+}
+
+bool JsonStreamParser::parseStructural(char c) {
+    switch (m_expect) {
+        case Expect::VALUE:
+        case Expect::VALUE_OR_END: {
+            if (c == '{') {
+                m_stack.push_back(Container::OBJECT);
+                m_expect = Expect::KEY_OR_END;
+                m_handler.onStartObject();
+            } else if (c == '[') {
+                m_stack.push_back(Container::ARRAY);
+                m_expect = Expect::VALUE_OR_END;
+                m_handler.onStartArray();
+            } else if (c == '"') {
+                m_token      = Token::STRING;
+                m_tokenIsKey = false;
+            } else if (c == ']' && m_expect == Expect::VALUE_OR_END) {
+                m_stack.pop_back();
+                m_handler.onEndArray();
+                valueDone();
+            } else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' ||
+                       c == 'n') {
+                m_token = Token::LITERAL;
+                m_buffer.assign(1, c);
+            } else {
+                return fail("unexpected character, value expected");
+            }
+        } break;
+        case Expect::KEY_OR_END:
+        case Expect::KEY: {
+            if (c == '"') {
+                m_token      = Token::STRING;
+                m_tokenIsKey = true;
+            } else if (c == '}' && m_expect == Expect::KEY_OR_END) {
+                m_stack.pop_back();
+                m_handler.onEndObject();
+                valueDone();
+            } else {
+                return fail("unexpected character, key expected");
+            }
+        } break;
+        case Expect::COLON: {
+            if (c != ':') { return fail("':' expected"); }
+            m_expect = Expect::VALUE;
+        } break;
+        case Expect::COMMA_OR_END: {
+            auto container{m_stack.back()};
+            if (c == ',') {
+                m_expect = container == Container::OBJECT ? Expect::KEY : Expect::VALUE;
+            } else if (c == '}' && container == Container::OBJECT) {
+                m_stack.pop_back();
+                m_handler.onEndObject();
+                valueDone();
+            } else if (c == ']' && container == Container::ARRAY) {
+                m_stack.pop_back();
+                m_handler.onEndArray();
+                valueDone();
+            } else {
+                return fail("',' or end of container expected");
+            }
+        } break;
+        case Expect::DONE: return fail("unexpected data after end of document");
+    }
+    return true;
+}
+
+void JsonStreamParser::finishString() {
+    m_token = Token::NONE;
+    if (m_tokenIsKey) {
+        m_handler.onKey(m_buffer);
+        m_expect = Expect::COLON;
+    } else {
+        m_handler.onString(m_buffer);
+        valueDone();
+    }
+    m_buffer.clear();
+}
+
+bool JsonStreamParser::finishLiteral() {
+    m_token = Token::NONE;
+    bool valid{m_buffer == "true" || m_buffer == "false" || m_buffer == "null"};
+    if (!valid) {
+        double value;
+        auto [ptr, ec]{std::from_chars(m_buffer.data(), m_buffer.data() + m_buffer.size(),
+                                       value)};
+        valid = ec == std::errc() && ptr == m_buffer.data() + m_buffer.size();
+    }
+    if (!valid) { return fail("invalid literal"); }
+    m_handler.onLiteral(m_buffer);
+    m_buffer.clear();
+    valueDone();
+    return true;
+}
+
+void JsonStreamParser::appendCodePoint() {
+    auto codePoint{m_codePoint};
+    if (codePoint >= 0xd800 && codePoint <= 0xdbff) {
+        // wait for low surrogate
+        m_highSurrogate = codePoint;
+        return;
+    }
+    if (codePoint >= 0xdc00 && codePoint <= 0xdfff && m_highSurrogate) {
+        codePoint = 0x10000 + ((m_highSurrogate - 0xd800) << 10) + (codePoint - 0xdc00);
+    }
+    m_highSurrogate = 0;
+    if (codePoint < 0x80) {
+        m_buffer += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        m_buffer += static_cast<char>(0xc0 | (codePoint >> 6));
+        m_buffer += static_cast<char>(0x80 | (codePoint & 0x3f));
+    } else if (codePoint < 0x10000) {
+        m_buffer += static_cast<char>(0xe0 | (codePoint >> 12));
+        m_buffer += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        m_buffer += static_cast<char>(0x80 | (codePoint & 0x3f));
+    } else {
+        m_buffer += static_cast<char>(0xf0 | (codePoint >> 18));
+        m_buffer += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+        m_buffer += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        m_buffer += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+}
+
+void JsonStreamParser::valueDone() {
+    m_expect = m_stack.empty() ? Expect::DONE : Expect::COMMA_OR_END;
+}
+
+bool JsonStreamParser::finish() {
+    if (!m_error.empty()) { return false; }
+    // top-level number has no terminating character
+    if (m_token == Token::LITERAL && m_stack.empty() && !finishLiteral()) {
+        return false;
+    }
+    if (m_token != Token::NONE || m_expect != Expect::DONE) {
+        return fail("unexpected end of document");
+    }
+    return true;
+}
+
+void JsonStreamParser::reset() {
+    m_stack.clear();
+    m_expect          = Expect::VALUE;
+    m_token           = Token::NONE;
+    m_tokenIsKey      = false;
+    m_codePoint       = 0;
+    m_highSurrogate   = 0;
+    m_codePointDigits = 0;
+    m_offset          = 0;
+    m_buffer.clear();
+    m_error.clear();
+}
+
+JsonRpcStreamReader::JsonRpcStreamReader(JsonStreamParser::Handler& bodyHandler) :
+    m_body(bodyHandler), m_parser(*this) {}
+
+void JsonRpcStreamReader::startContainer(bool isObject) {
+    if (!forwarding() && m_pendingKey == PendingKey::BODY) { m_bodyDepth = m_depth + 1; }
+    ++m_depth;
+    if (forwarding()) {
+        isObject ? m_body.onStartObject() : m_body.onStartArray();
+    } else if (isObject && m_pendingKey == PendingKey::RESULT) {
+        m_resultDepth = m_depth;
+    } else if (isObject && m_pendingKey == PendingKey::ERROR) {
+        m_errorDepth = m_depth;
+    }
+    m_pendingKey = PendingKey::NONE;
+}
+
+void JsonRpcStreamReader::endContainer(bool isObject) {
+    if (forwarding()) {
+        isObject ? m_body.onEndObject() : m_body.onEndArray();
+        if (m_depth == m_bodyDepth) { m_bodyDepth = -1; }
+    } else if (m_depth == m_resultDepth) {
+        m_resultDepth = -1;
+    } else if (m_depth == m_errorDepth) {
+        m_errorDepth = -1;
+    }
+    --m_depth;
+}
+
+void JsonRpcStreamReader::onKey(std::string_view key) {
+    if (forwarding()) {
+        m_body.onKey(key);
+        return;
+    }
+    m_pendingKey = PendingKey::NONE;
+    if (m_depth == m_resultDepth) {
+        if (key == "body") { m_pendingKey = PendingKey::BODY; }
+    } else if (m_depth == m_errorDepth) {
+        if (key == "code") {
+            m_pendingKey = PendingKey::CODE;
+        } else if (key == "message") {
+            m_pendingKey = PendingKey::MESSAGE;
+        }
+    } else if (m_resultDepth < 0 && m_errorDepth < 0) {
+        if (key == "result") {
+            m_pendingKey = PendingKey::RESULT;
+            m_results++;
+        } else if (key == "error") {
+            m_pendingKey = PendingKey::ERROR;
+            m_sawError   = true;
+        }
+    }
+}
+
+void JsonRpcStreamReader::onString(std::string_view value) {
+    if (forwarding() || m_pendingKey == PendingKey::BODY) {
+        m_body.onString(value);
+    } else if (m_pendingKey == PendingKey::MESSAGE || m_pendingKey == PendingKey::ERROR) {
+        m_errorMessage = value;
+    }
+    m_pendingKey = PendingKey::NONE;
+}
+
+void JsonRpcStreamReader::onLiteral(std::string_view value) {
+    if (forwarding() || m_pendingKey == PendingKey::BODY) {
+        m_body.onLiteral(value);
+    } else if (m_pendingKey == PendingKey::CODE) {
+        std::from_chars(value.data(), value.data() + value.size(), m_errorCode);
+    }
+    m_pendingKey = PendingKey::NONE;
+}
+
+void JsonRpcStreamReader::finish() {
+    if (!m_parser.finish()) {
+        throw JsonRpcException(JsonRpcException::PARSE_ERROR,
+                               "invalid JSON response from server: " + m_parser.error());
+    }
+    if (m_sawError) { throw JsonRpcException(m_errorCode, m_errorMessage); }
+    if (!m_results) {
+        throw JsonRpcException(
+            JsonRpcException::INTERNAL_ERROR,
+            R"(invalid server response: neither "result" nor "error" fields found)");
+    }
+}
+
+void JsonRpcStreamReader::reset() {
+    m_parser.reset();
+    m_depth       = 0;
+    m_resultDepth = -1;
+    m_bodyDepth   = -1;
+    m_errorDepth  = -1;
+    m_pendingKey  = PendingKey::NONE;
+    m_results     = 0;
+    m_sawError    = false;
+    m_errorCode   = JsonRpcException::INTERNAL_ERROR;
+    m_errorMessage.clear();
+}
@@ -53,6 +53,48 @@ ConstElementPtr JsonRpcUtils::createRequestFromCommands(
     return Element::fromJSON(array.dump());
 }
 
+static void appendJsonString(string& out, std::string_view value) {
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    const char* Hex{"0123456789abcdef"};
+                    out += "\\u00";
+                    out += Hex[(c >> 4) & 0xf];
+                    out += Hex[c & 0xf];
+                } else {
+                    out += c;
+                }
+            }
+        }
+    }
+    out += '"';
+}
+
+void JsonRpcUtils::encodeRequestFromCommands(
+    string& out, std::initializer_list<std::pair<int, std::string_view>> commands) {
+    // same layout as `createRequestFromCommands`, but without intermediate objects
+    out.clear();
+    out += '[';
+    for (const auto& [id, command] : commands) { appendRequestCommand(out, id, command); }
+    out += ']';
+}
+
+void JsonRpcUtils::appendRequestCommand(string& out, int id, std::string_view command) {
+    if (!out.empty() && out.back() != '[') { out += ','; }
+    out += R"({"id":)";
+    out += std::to_string(id);
+    out += R"(,"jsonrpc":"2.0","method":"cli","params":{"cmd":)";
+    appendJsonString(out, command);
+    out += R"(,"version":1}})";
+}
+
 static inline string toString(const IdType& id) {
     return std::visit(
         [](auto&& arg) {
@@ -69,6 +111,13 @@ static inline string toString(const IdType& id) {
 
 std::vector<JsonRpcResponse> JsonRpcUtils::handleResponse(const string& response) {
     std::vector<JsonRpcResponse> result;
+    handleResponse(response, result);
+    return result;
+}
+
+void JsonRpcUtils::handleResponse(const string&                 response,
+                                  std::vector<JsonRpcResponse>& result) {
+    result.clear();
     auto                         validator{[&result](const json& inner) {
         IdType id;
         bool   hasIdKey{false};
@@ -100,7 +149,7 @@ std::vector<JsonRpcResponse> JsonRpcUtils::handleResponse(const string& response
         // sometimes inside response we have a array with one object,
         // here we handle that case
         if (parsed.is_array()) {
-            auto inner{parsed[0]};
+            const auto& inner{parsed[0]};
             auto innerArrSize{inner.size()};
             if (innerArrSize) {
                 if (inner[0].is_array()) {
@@ -117,5 +166,4 @@ std::vector<JsonRpcResponse> JsonRpcUtils::handleResponse(const string& response
                                std::string("invalid JSON response from server: ") +
                                    e.what());
     }
-    return result;
 }
@@ -0,0 +1,185 @@
+#include "lease_capture.hpp"
+#include <asiolink/interval_timer.h>
+#include <cc/data.h>
+#include <cc/dhcp_config_error.h>
+#include <chrono>
+#include <cstring>
+
+using isc::data::Element;
+
+#define FIELD_ERROR_STR(field_name, what) "Field \"" field_name "\" in \"capture\" " what
+
+// events buffered in memory are written at least once per interval
+static constexpr size_t FlushIntervalMs{1000};
+// buffer is written by thread of event that fills it
+static constexpr size_t BufferSize{64 * 1024};
+
+LeaseCapture::Config LeaseCapture::Config::parseConfig(ConstElementPtr config) {
+    Config result;
+    if (config->getType() != Element::map) {
+        isc_throw(isc::ConfigError, "parameter \"capture\" must be a map");
+    }
+    auto path{config->get("path")};
+    if (!path || path->getType() != Element::string || path->stringValue().empty()) {
+        isc_throw(isc::ConfigError,
+                  FIELD_ERROR_STR("path", "must be a non-empty string"));
+    }
+    result.path = path->stringValue();
+    auto maxSize{config->get("max-size")};
+    if (maxSize) {
+        if (maxSize->getType() != Element::integer || maxSize->intValue() <= 0) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("max-size",
+                                      "must be a non-zero non-negative integer"));
+        }
+        result.maxSize = static_cast<size_t>(maxSize->intValue());
+    }
+    return result;
+}
+
+isc::data::ElementPtr LeaseCapture::Stats::toElement() const {
+    auto element{Element::createMap()};
+    element->set("capturing", Element::create(capturing));
+    element->set("events", Element::create(static_cast<long long>(events)));
+    element->set("dropped", Element::create(static_cast<long long>(dropped)));
+    element->set("file-bytes", Element::create(static_cast<long long>(fileBytes)));
+    return element;
+}
+
+LeaseCapture::LeaseCapture(const Config& config) : m_config(config) {
+    // appends always go to the end
+    m_file = std::fopen(m_config.path.c_str(), "a+b");
+    if (!m_file) {
+        isc_throw(isc::ConfigError, "failed to open capture file: " << m_config.path);
+    }
+    std::fseek(m_file, 0, SEEK_END);
+    m_stats.fileBytes = static_cast<uint64_t>(std::ftell(m_file));
+    if (m_stats.fileBytes == 0) {
+        m_buffer.append(Magic, sizeof(Magic));
+    } else {
+        char magic[sizeof(Magic)];
+        std::fseek(m_file, 0, SEEK_SET);
+        if (std::fread(magic, 1, sizeof(magic), m_file) != sizeof(magic) ||
+            std::memcmp(magic, Magic, sizeof(magic)) != 0) {
+            std::fclose(m_file);
+            isc_throw(isc::ConfigError, "not a capture file: " << m_config.path);
+        }
+    }
+    m_buffer.reserve(BufferSize + RouteRecord::MaxSize + sizeof(int64_t));
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_CAPTURE_OPENED)
+        .arg(m_config.path)
+        .arg(m_stats.fileBytes);
+}
+
+LeaseCapture::~LeaseCapture() {
+    std::unique_lock lock(m_mutex);
+    flush();
+    std::fclose(m_file);
+}
+
+void LeaseCapture::start(IOService& io_service) {
+    m_timer = boost::make_shared<isc::asiolink::IntervalTimer>(io_service);
+    m_timer->setup(
+        [this] {
+            std::unique_lock lock(m_mutex);
+            flush();
+        },
+        FlushIntervalMs);
+}
+
+void LeaseCapture::stop() {
+    if (m_timer) { m_timer->cancel(); }
+    std::unique_lock lock(m_mutex);
+    flush();
+}
+
+void LeaseCapture::record(Event event, const RouteExport& route) {
+    auto timeUs{std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::system_clock::now().time_since_epoch())
+                    .count()};
+    std::unique_lock lock(m_mutex);
+    if (!m_stats.capturing) {
+        m_stats.dropped++;
+        return;
+    }
+    auto size{m_buffer.size()};
+    m_buffer.append(reinterpret_cast<const char*>(&timeUs), sizeof(timeUs));
+    if (!RouteRecord::append(m_buffer, route, static_cast<uint8_t>(event))) {
+        m_buffer.resize(size);
+        m_stats.dropped++;
+        return;
+    }
+    if (m_stats.fileBytes + m_buffer.size() > m_config.maxSize) {
+        m_buffer.resize(size);
+        m_stats.capturing = false;
+        m_stats.dropped++;
+        LOG_WARN(DHCP6ExporterLogger, DHCP6_EXPORTER_CAPTURE_LIMIT_REACHED)
+            .arg(m_config.path)
+            .arg(m_stats.events);
+        flush();
+        return;
+    }
+    m_stats.events++;
+    if (m_buffer.size() >= BufferSize) { flush(); }
+}
+
+LeaseCapture::Stats LeaseCapture::stats() {
+    std::unique_lock lock(m_mutex);
+    auto             result{m_stats};
+    result.fileBytes += m_buffer.size();
+    return result;
+}
+
+void LeaseCapture::flush() {
+    if (m_buffer.empty()) { return; }
+    bool written{std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) ==
+                     m_buffer.size() &&
+                 std::fflush(m_file) == 0};
+    if (!written) {
+        LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_CAPTURE_WRITE_FAILED)
+            .arg(m_config.path)
+            .arg(std::strerror(errno));
+        // replay stops at partial event, events after it would be lost anyway
+        m_stats.capturing = false;
+        std::clearerr(m_file);
+        std::fseek(m_file, 0, SEEK_END);
+        m_stats.fileBytes = static_cast<uint64_t>(std::ftell(m_file));
+    } else {
+        m_stats.fileBytes += m_buffer.size();
+    }
+    m_buffer.clear();
+}
+
+LeaseCaptureReader::LeaseCaptureReader(const string& path) {
+    m_file = std::fopen(path.c_str(), "rb");
+    if (!m_file) {
+        isc_throw(isc::BadValue, "failed to open capture file: "
+                                     << path << ": " << std::strerror(errno));
+    }
+    char magic[sizeof(LeaseCapture::Magic)];
+    if (std::fread(magic, 1, sizeof(magic), m_file) != sizeof(magic) ||
+        std::memcmp(magic, LeaseCapture::Magic, sizeof(magic)) != 0) {
+        std::fclose(m_file);
+        isc_throw(isc::BadValue, "not a capture file: " << path);
+    }
+}
+
+LeaseCaptureReader::~LeaseCaptureReader() { std::fclose(m_file); }
+
+bool LeaseCaptureReader::next(LeaseCapture::Record& record) {
+    uint16_t size{0};
+    if (std::fread(&record.timeUs, sizeof(record.timeUs), 1, m_file) != 1 ||
+        std::fread(&size, sizeof(size), 1, m_file) != 1 ||
+        size < RouteRecord::FixedSize || size > RouteRecord::MaxSize) {
+        return false;
+    }
+    char payload[RouteRecord::MaxSize];
+    if (std::fread(payload, 1, size, m_file) != size) { return false; }
+    uint8_t event;
+    if (!RouteRecord::parse(payload, size, record.route, event) ||
+        event > static_cast<uint8_t>(LeaseCapture::Event::RECLAIM)) {
+        return false;
+    }
+    record.event = static_cast<LeaseCapture::Event>(event);
+    return true;
+}
@@ -1,6 +1,9 @@
 #include "management_client.hpp"
 #include "nxos_management_client.hpp"
-#include <util/hash.h>
+#include "nxos_rest_management_client.hpp"
+#ifdef NXOS_DHCP6_EXPORTER_GNMI
+    #include "nxos_gnmi_management_client.hpp"
+#endif
 
 ManagementClientPtr ManagementClient::init(const string&   mgmtName,
                                            ConstElementPtr mgmtConnParams) {
@@ -8,11 +11,30 @@ ManagementClientPtr ManagementClient::init(const string&   mgmtName,
         return std::static_pointer_cast<ManagementClient>(
             std::make_shared<NXOSManagementClient>(mgmtConnParams));
     }
+    if (mgmtName == NXOSRestManagementClient::name()) {
+        return std::static_pointer_cast<ManagementClient>(
+            std::make_shared<NXOSRestManagementClient>(mgmtConnParams));
+    }
+#ifdef NXOS_DHCP6_EXPORTER_GNMI
+    if (mgmtName == NXOSGnmiManagementClient::name()) {
+        return std::static_pointer_cast<ManagementClient>(
+            std::make_shared<NXOSGnmiManagementClient>(mgmtConnParams));
+    }
+#endif
     isc_throw(isc::InvalidParameter,
               "Failed to find management client with name \"" + mgmtName + "\"");
 }
 
-// hash ignore any usage of "source" parameter
-size_t ManagementClient::HWAddrHashHelper::operator()(const isc::dhcp::HWAddr& hwAddr) const {
-    return isc::util::Hash64::hash(hwAddr.hwaddr_.data(), hwAddr.hwaddr_.size());
+isc::data::ElementPtr ManagementClient::workerPoolStats() const { return {}; }
+
+void ManagementClient::applyRoutesBulk(RoutesPtr               routes,
+                                       const BulkApplyHandler& handler) {
+    for (const auto& route : *routes) { sendRoutesToSwitch(route); }
+    if (handler) { handler({0, 0, routes->size(), routes->size()}); }
+}
+
+void ManagementClient::removeRoutesBulk(RoutesPtr               routes,
+                                        const BulkApplyHandler& handler) {
+    for (const auto& route : *routes) { removeRoutesFromSwitch(route); }
+    if (handler) { handler({0, 0, routes->size(), routes->size()}); }
 }
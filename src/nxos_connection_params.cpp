@@ -1,8 +1,12 @@
 #include "nxos_connection_params.hpp"
 #include "common.hpp"
+#include <algorithm>
 #include <cc/data.h>
 #include <cc/dhcp_config_error.h>
+#include <cctype>
 #include <exceptions/exceptions.h>
+#include <limits>
+#include <unistd.h>
 
 using isc::data::Element;
 using isc::http::BasicHttpAuth;
@@ -10,6 +14,10 @@ using isc::http::BasicHttpAuth;
 #define FIELD_ERROR_STR(field_name, what) \
     "Field \"" field_name "\" in \"connection-params\" " what
 
+static inline bool isReadableFile(const string& path) {
+    return access(path.c_str(), R_OK) == 0;
+}
+
 NXOSConnectionConfigParams
     NXOSConnectionConfigParams::parseConfig(ConstElementPtr& mgmtConnParams) {
     if (!mgmtConnParams) {
@@ -41,12 +49,218 @@ NXOSConnectionConfigParams
             isc_throw(isc::ConfigError,
                       FIELD_ERROR_STR("heartbeat-interval", "must be a integer"));
         }
+        if (heartbeatIntervalElement->intValue() <= 0) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("heartbeat-interval",
+                                      "must be a non-zero non-negative integer"));
+        }
+        intervalTimer = heartbeatIntervalElement->intValue();
+    }
+
+    // uptime of the switch is sampled for reload detection at own cadence,
+    // heartbeat probe doesn't need it while route traffic proves liveness
+    size_t uptimeInterval{60};
+    auto   uptimeIntervalElement{mgmtConnParams->find("uptime-interval")};
+    if (uptimeIntervalElement) {
+        if (uptimeIntervalElement->getType() != Element::integer) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("uptime-interval", "must be a integer"));
+        }
+        if (uptimeIntervalElement->intValue() <= 0) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("uptime-interval",
+                                      "must be a non-zero non-negative integer"));
+        }
+        uptimeInterval = uptimeIntervalElement->intValue();
+    }
+
+    // answered route requests count as heartbeat
+    bool passiveHealth{true};
+    auto passiveHealthElement{mgmtConnParams->find("passive-health")};
+    if (passiveHealthElement) {
+        if (passiveHealthElement->getType() != Element::boolean) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("passive-health", "must be a boolean"));
+        }
+        passiveHealth = passiveHealthElement->boolValue();
+    }
+
+    // batching of route operations, used only by "nxos-rest" connection type
+    size_t batchSize{64};
+    auto   batchSizeElement{mgmtConnParams->find("batch-size")};
+    if (batchSizeElement) {
+        if (batchSizeElement->getType() != Element::integer) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("batch-size", "must be a integer"));
+        }
+        if (batchSizeElement->intValue() <= 0) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("batch-size",
+                                      "must be a non-zero non-negative integer"));
+        }
+        batchSize = batchSizeElement->intValue();
+    }
+
+    size_t batchIntervalMs{100};
+    auto   batchIntervalElement{mgmtConnParams->find("batch-interval")};
+    if (batchIntervalElement) {
+        if (batchIntervalElement->getType() != Element::integer) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("batch-interval", "must be a integer"));
+        }
+        if (batchIntervalElement->intValue() <= 0) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("batch-interval",
+                                      "must be a non-zero non-negative integer"));
+        }
+        batchIntervalMs = batchIntervalElement->intValue();
+    }
+
+    // gNMI port on the same host, used only by "nxos-gnmi" connection type
+    size_t gnmiPort{50051};
+    auto   gnmiPortElement{mgmtConnParams->find("gnmi-port")};
+    if (gnmiPortElement) {
+        if (gnmiPortElement->getType() != Element::integer) {
+            isc_throw(isc::ConfigError, FIELD_ERROR_STR("gnmi-port", "must be a integer"));
+        }
+        if (gnmiPortElement->intValue() <= 0 || gnmiPortElement->intValue() > 65535) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("gnmi-port", "must be a valid port number"));
+        }
+        gnmiPort = gnmiPortElement->intValue();
+    }
+
+    // CLI commands in one JSON-RPC request of bulk restore
+    size_t bulkChunkSize{500};
+    auto   bulkChunkSizeElement{mgmtConnParams->find("bulk-chunk-size")};
+    if (bulkChunkSizeElement) {
+        if (bulkChunkSizeElement->getType() != Element::integer) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("bulk-chunk-size", "must be a integer"));
+        }
+        if (bulkChunkSizeElement->intValue() <= 0) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("bulk-chunk-size",
+                                      "must be a non-zero non-negative integer"));
+        }
+        bulkChunkSize = bulkChunkSizeElement->intValue();
+    }
+
+    // bulk applies in flight, each of them has one chunk in flight
+    size_t bulkMaxInFlight{2};
+    auto   bulkMaxInFlightElement{mgmtConnParams->find("bulk-max-in-flight")};
+    if (bulkMaxInFlightElement) {
+        if (bulkMaxInFlightElement->getType() != Element::integer) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("bulk-max-in-flight", "must be a integer"));
+        }
+        if (bulkMaxInFlightElement->intValue() <= 0) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("bulk-max-in-flight",
+                                      "must be a non-zero non-negative integer"));
+        }
+        bulkMaxInFlight = bulkMaxInFlightElement->intValue();
+    }
+
+    // ownership of installed routes, reads of the switch are limited to tagged routes
+    std::optional<uint32_t> routeTag;
+    auto                    routeTagElement{mgmtConnParams->find("route-tag")};
+    if (routeTagElement) {
+        if (routeTagElement->getType() != Element::integer) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("route-tag", "must be a integer"));
+        }
+        if (routeTagElement->intValue() <= 0 ||
+            routeTagElement->intValue() > std::numeric_limits<uint32_t>::max()) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("route-tag", "must be in range [1, 4294967295]"));
+        }
+        routeTag = static_cast<uint32_t>(routeTagElement->intValue());
+    }
+
+    std::optional<string> routeName;
+    auto                  routeNameElement{mgmtConnParams->find("route-name")};
+    if (routeNameElement) {
+        if (routeNameElement->getType() != Element::string) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("route-name", "must be a string"));
+        }
+        routeName = routeNameElement->stringValue();
+        // name is a single word of CLI command
+        if (routeName->empty() || routeName->size() > 50 ||
+            std::any_of(routeName->begin(), routeName->end(),
+                        [](unsigned char c) { return !std::isgraph(c); })) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("route-name",
+                                      "must be 1 to 50 characters without spaces"));
+        }
+    }
+
+    // "asio" sends requests through non-blocking engine, "httplib" is default
+    bool asyncEngine{false};
+    auto httpEngineElement{mgmtConnParams->find("http-engine")};
+    if (httpEngineElement) {
+        if (httpEngineElement->getType() != Element::string) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("http-engine", "must be a string"));
+        }
+        auto httpEngine{httpEngineElement->stringValue()};
+        if (httpEngine != "httplib" && httpEngine != "asio") {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("http-engine", "must be \"httplib\" or \"asio\""));
+        }
+        asyncEngine = httpEngine == "asio";
+    }
+
+    // connections to switch opened by asio engine
+    size_t maxConnections{64};
+    auto   maxConnectionsElement{mgmtConnParams->find("max-connections")};
+    if (maxConnectionsElement) {
+        if (maxConnectionsElement->getType() != Element::integer) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("max-connections", "must be a integer"));
+        }
+        if (maxConnectionsElement->intValue() <= 0) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("max-connections",
+                                      "must be a non-zero non-negative integer"));
+        }
+        maxConnections = maxConnectionsElement->intValue();
     }
-    intervalTimer = heartbeatIntervalElement->intValue();
-    if (intervalTimer <= 0) {
+
+    // worker threads of blocking requests, pool grows from min to max
+    // while requests are queued
+    size_t maxThreads{4};
+    auto   maxThreadsElement{mgmtConnParams->find("max-threads")};
+    if (maxThreadsElement) {
+        if (maxThreadsElement->getType() != Element::integer) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("max-threads", "must be a integer"));
+        }
+        if (maxThreadsElement->intValue() <= 0) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("max-threads",
+                                      "must be a non-zero non-negative integer"));
+        }
+        maxThreads = maxThreadsElement->intValue();
+    }
+    size_t minThreads{1};
+    auto   minThreadsElement{mgmtConnParams->find("min-threads")};
+    if (minThreadsElement) {
+        if (minThreadsElement->getType() != Element::integer) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("min-threads", "must be a integer"));
+        }
+        if (minThreadsElement->intValue() <= 0) {
+            isc_throw(isc::ConfigError,
+                      FIELD_ERROR_STR("min-threads",
+                                      "must be a non-zero non-negative integer"));
+        }
+        minThreads = minThreadsElement->intValue();
+    }
+    if (minThreads > maxThreads) {
         isc_throw(isc::ConfigError,
-                  FIELD_ERROR_STR("heartbeat-interval",
-                                  "must be a non-zero non-negative integer"));
+                  FIELD_ERROR_STR("min-threads", "must not exceed \"max-threads\""));
     }
 
     auto credentialsParamsElement{mgmtConnParams->find("credentials")};
@@ -85,8 +299,9 @@ NXOSConnectionConfigParams
 
     std::optional<string> cert_file;
     std::optional<string> key_file;
+    std::optional<string> ca_file;
 
-    if (url.getScheme() == isc::http::Url::HTTPS) {
+    if (connInfo.url.getScheme() == isc::http::Url::HTTPS) {
         auto credentialsCertificateElementIt{credentialsParams.find("certificate")};
         if (credentialsCertificateElementIt == credentialsParams.end()) {
             isc_throw(isc::ConfigError,
@@ -97,23 +312,62 @@ NXOSConnectionConfigParams
             isc_throw(isc::ConfigError,
                       FIELD_ERROR_STR("certificate", "must be a string"));
         }
-
-        // TODO: check file for cert
+        cert_file = credentialsCertificateElement->stringValue();
+        if (!isReadableFile(*cert_file)) {
+            isc_throw(isc::ConfigError,
+                      string(FIELD_ERROR_STR("certificate", "must be a readable file")) +
+                          ": " + *cert_file);
+        }
 
         auto credentialsKeyfileElementIt{credentialsParams.find("keyfile")};
         if (credentialsKeyfileElementIt == credentialsParams.end()) {
             isc_throw(isc::ConfigError, FIELD_ERROR_STR("keyfile", "must not be null"));
         }
-        auto credentialsKeyfileElement{credentialsCertificateElementIt->second};
+        auto credentialsKeyfileElement{credentialsKeyfileElementIt->second};
         if (credentialsKeyfileElement->getType() != Element::string) {
             isc_throw(isc::ConfigError, FIELD_ERROR_STR("keyfile", "must be a string"));
         }
+        key_file = credentialsKeyfileElement->stringValue();
+        if (!isReadableFile(*key_file)) {
+            isc_throw(isc::ConfigError,
+                      string(FIELD_ERROR_STR("keyfile", "must be a readable file")) +
+                          ": " + *key_file);
+        }
 
-        // TODO: check file for keyfile
+        // without CA file server certificate is not verified,
+        // NX-OS uses self-signed certificate by default
+        auto credentialsCaFileElementIt{credentialsParams.find("ca-file")};
+        if (credentialsCaFileElementIt != credentialsParams.end()) {
+            auto credentialsCaFileElement{credentialsCaFileElementIt->second};
+            if (credentialsCaFileElement->getType() != Element::string) {
+                isc_throw(isc::ConfigError,
+                          FIELD_ERROR_STR("ca-file", "must be a string"));
+            }
+            ca_file = credentialsCaFileElement->stringValue();
+            if (!isReadableFile(*ca_file)) {
+                isc_throw(isc::ConfigError,
+                          string(FIELD_ERROR_STR("ca-file", "must be a readable file")) +
+                              ": " + *ca_file);
+            }
+        }
     }
     return {std::move(connInfo),
             {std::move(auth)},
             std::move(cert_file),
             std::move(key_file),
-            intervalTimer};
+            std::move(ca_file),
+            intervalTimer,
+            batchSize,
+            batchIntervalMs,
+            gnmiPort,
+            bulkChunkSize,
+            asyncEngine,
+            maxConnections,
+            minThreads,
+            maxThreads,
+            uptimeInterval,
+            passiveHealth,
+            bulkMaxInFlight,
+            std::move(routeTag),
+            std::move(routeName)};
 }
@@ -0,0 +1,264 @@
+#include "nxos_gnmi_management_client.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <fstream>
+#include <github.com/openconfig/gnmi/proto/gnmi/gnmi.grpc.pb.h>
+#include <grpcpp/grpcpp.h>
+#include <nlohmann/json.hpp>
+#include <sstream>
+
+using nlohmann::json;
+
+static const string GnmiOrigin{"device"};
+
+// one channel for all requests, gRPC multiplexes calls over single HTTP/2 connection
+class NXOSGnmiChannel {
+  public:
+    std::unique_ptr<gnmi::gNMI::Stub> stub;
+    string                            username;
+    string                            password;
+
+    // request, response and context must outlive the async call
+    template <typename Request, typename Response>
+    struct Call {
+        grpc::ClientContext context;
+        Request             request;
+        Response            response;
+    };
+
+    template <typename Request, typename Response>
+    std::shared_ptr<Call<Request, Response>> createCall() const {
+        auto call{std::make_shared<Call<Request, Response>>()};
+        call->context.AddMetadata("username", username);
+        call->context.AddMetadata("password", password);
+        return call;
+    }
+};
+
+static string readFileContents(const string& path) {
+    std::ifstream      file(path);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+NXOSGnmiManagementClient::NXOSGnmiManagementClient(ConstElementPtr mgmtConnParams) :
+    NXOSManagementClient(mgmtConnParams),
+    m_batcher(m_params.batchSize, m_params.batchIntervalMs,
+              [this](RouteBatcher::OperationsPtr ops) { sendBatch(ops); }) {}
+
+NXOSGnmiManagementClient::~NXOSGnmiManagementClient() = default;
+
+string NXOSGnmiManagementClient::gnmiTarget() const {
+    return m_params.connInfo.url.getStrippedHostname() + ":" +
+           std::to_string(m_params.gnmiPort);
+}
+
+void NXOSGnmiManagementClient::startClient(IOService& io_service) {
+    NXOSManagementClient::startClient(io_service);
+
+    std::shared_ptr<grpc::ChannelCredentials> credentials;
+    if (m_params.connInfo.url.getScheme() == isc::http::Url::HTTPS) {
+        grpc::SslCredentialsOptions sslOptions;
+        if (m_params.ca_file) {
+            sslOptions.pem_root_certs = readFileContents(*m_params.ca_file);
+        }
+        sslOptions.pem_private_key = readFileContents(*m_params.key_file);
+        sslOptions.pem_cert_chain  = readFileContents(*m_params.cert_file);
+        credentials                = grpc::SslCredentials(sslOptions);
+    } else {
+        credentials = grpc::InsecureChannelCredentials();
+    }
+
+    // basic auth secret has form "login:password"
+    const auto& secret{m_params.auth.auth->getSecret()};
+    auto        delimiterPos{secret.find(':')};
+
+    auto channel{std::make_shared<NXOSGnmiChannel>()};
+    channel->stub = gnmi::gNMI::NewStub(grpc::CreateChannel(gnmiTarget(), credentials));
+    channel->username = secret.substr(0, delimiterPos);
+    channel->password = secret.substr(delimiterPos + 1);
+    m_channel = std::move(channel);
+
+    m_batcher.start(io_service);
+}
+
+void NXOSGnmiManagementClient::stopClient() {
+    m_batcher.stop();
+    NXOSManagementClient::stopClient();
+}
+
+void NXOSGnmiManagementClient::applyRouteOnSwitch(const RouteExport& route) {
+    m_batcher.push({route, /*remove=*/false, /*clearNDCache=*/false});
+}
+
+void NXOSGnmiManagementClient::removeRouteOnSwitch(const RouteExport& route,
+                                                   bool               clearNDCache) {
+    m_batcher.push({route, /*remove=*/true, clearNDCache});
+}
+
+using PathElemKeys = std::initializer_list<std::pair<string, string>>;
+
+static void addPathElem(gnmi::Path* path, const string& name, PathElemKeys keys = {}) {
+    auto* elem{path->add_elem()};
+    elem->set_name(name);
+    for (const auto& [key, value] : keys) { (*elem->mutable_key())[key] = value; }
+}
+
+// /System/ipv6-items/inst-items/dom-items/Dom-list[name=<vrf>]/rt-items
+static void fillRoutesPath(gnmi::Path* path, VrfId vrfId) {
+    path->set_origin(GnmiOrigin);
+    addPathElem(path, "System");
+    addPathElem(path, "ipv6-items");
+    addPathElem(path, "inst-items");
+    addPathElem(path, "dom-items");
+    addPathElem(path, "Dom-list", {{"name", VrfNames::name(vrfId)}});
+    addPathElem(path, "rt-items");
+}
+
+// VRF of `Dom-list` key of the path, nullopt if path has no such element
+static std::optional<VrfId> vrfOfPath(const gnmi::Path& path) {
+    for (const auto& elem : path.elem()) {
+        if (elem.name() != "Dom-list") { continue; }
+        auto it{elem.key().find("name")};
+        if (it != elem.key().end()) { return VrfNames::intern(it->second); }
+    }
+    return std::nullopt;
+}
+
+// nexthop of route is address (IA_PD) or vlan interface (IA_NA)
+static json createNexthopKeys(const RouteExport& route) {
+    if (route.type == RouteExportType::IA_PD) {
+        return {{"nhAddr", route.nexthop.toText() + "/128"},
+                {"nhIf", "unspecified"},
+                {"nhVrf", VrfNames::name(route.vrfId)},
+                {"object", 0}};
+    }
+    // device model uses lowercase interface names
+    string nhIf{InterfaceNames::name(route.ifId)};
+    std::transform(nhIf.begin(), nhIf.end(), nhIf.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return {{"nhAddr", "::/128"},
+            {"nhIf", nhIf},
+            {"nhVrf", VrfNames::name(route.vrfId)},
+            {"object", 0}};
+}
+
+void NXOSGnmiManagementClient::sendBatch(RouteBatcher::OperationsPtr ops) {
+    auto channel{m_channel};
+    if (!channel) { return; }
+
+    auto call{channel->createCall<gnmi::SetRequest, gnmi::SetResponse>()};
+    for (const auto& op : *ops) {
+        auto nexthopKeys{createNexthopKeys(op.route)};
+        auto prefix{op.route.prefixText()};
+        if (op.remove) {
+            // delete only nexthop, same as "no ipv6 route <src> <dst>"
+            auto* path{call->request.add_delete_()};
+            fillRoutesPath(path, op.route.vrfId);
+            addPathElem(path, "Route-list", {{"prefix", prefix}});
+            addPathElem(path, "nh-items");
+            addPathElem(path, "Nexthop-list",
+                        {{"nhAddr", nexthopKeys["nhAddr"].get<string>()},
+                         {"nhIf", nexthopKeys["nhIf"].get<string>()},
+                         {"nhVrf", nexthopKeys["nhVrf"].get<string>()},
+                         {"object", "0"}});
+        } else {
+            auto* update{call->request.add_update()};
+            fillRoutesPath(update->mutable_path(), op.route.vrfId);
+            addPathElem(update->mutable_path(), "Route-list", {{"prefix", prefix}});
+            // owner marks of the route
+            if (m_params.routeTag) { nexthopKeys["tag"] = *m_params.routeTag; }
+            if (m_params.routeName) { nexthopKeys["rtname"] = *m_params.routeName; }
+            json value{{"prefix", prefix},
+                       {"nh-items", {{"Nexthop-list", json::array({nexthopKeys})}}}};
+            update->mutable_val()->set_json_ietf_val(value.dump());
+        }
+    }
+
+    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC, DHCP6_EXPORTER_NXOS_GNMI_BATCH_SEND)
+        .arg(connectionName())
+        .arg(ops->size());
+    // gNMI Set is applied as one transaction, so result is common for all operations
+    channel->stub->async()->Set(&call->context, &call->request, &call->response,
+                                [this, call, ops](grpc::Status status) {
+                                    string reason;
+                                    if (!status.ok()) {
+                                        reason = "gNMI Set failed: code " +
+                                                 std::to_string(status.error_code()) +
+                                                 ": " + status.error_message();
+                                    }
+                                    handleBatchResult(ops, reason);
+                                });
+}
+
+void NXOSGnmiManagementClient::asyncGetInstalledRoutes(
+    const InstalledRoutesHandler& handler) {
+    auto channel{m_channel};
+    if (!channel) {
+        if (handler) { handler(std::make_shared<InstalledRoutes>(), true); }
+        return;
+    }
+
+    // one path per VRF, VRF of update is taken from `Dom-list` key of its path
+    auto call{channel->createCall<gnmi::GetRequest, gnmi::GetResponse>()};
+    fillRoutesPath(call->request.add_path(), DefaultVrfId);
+    for (auto vrfId : m_exportVrfs) { fillRoutesPath(call->request.add_path(), vrfId); }
+    call->request.set_encoding(gnmi::JSON_IETF);
+    call->request.set_type(gnmi::GetRequest::CONFIG);
+
+    channel->stub->async()->Get(
+        &call->context, &call->request, &call->response,
+        [this, call, handler](grpc::Status status) {
+            InstalledRoutes routes;
+            bool            connectionOrEarlyValidationFailed{!status.ok()};
+            if (!status.ok()) {
+                LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_GNMI_GET_FAILED)
+                    .arg(connectionName())
+                    .arg(status.error_message());
+            }
+            try {
+                for (const auto& notification : call->response.notification()) {
+                    auto notificationVrf{vrfOfPath(notification.prefix())};
+                    for (const auto& update : notification.update()) {
+                        auto vrfId{vrfOfPath(update.path())
+                                       .value_or(notificationVrf.value_or(DefaultVrfId))};
+                        auto value{json::parse(update.val().json_ietf_val())};
+                        if (!value.contains("Route-list")) { continue; }
+                        for (const auto& route : value.at("Route-list")) {
+                            string prefix{route.at("prefix")};
+                            if (!route.contains("nh-items")) { continue; }
+                            for (const auto& nexthop :
+                                 route.at("nh-items").at("Nexthop-list")) {
+                                if (m_params.routeTag &&
+                                    nexthop.value("tag", uint32_t{0}) !=
+                                        *m_params.routeTag) {
+                                    continue;
+                                }
+                                string nhIf{nexthop.at("nhIf")};
+                                string nhAddr{nexthop.at("nhAddr")};
+                                if (nhIf != "unspecified") {
+                                    routes.push_back({prefix, std::move(nhIf), vrfId});
+                                } else {
+                                    // report address in same form as CLI does
+                                    routes.push_back({prefix,
+                                                      nhAddr.substr(0, nhAddr.find('/')),
+                                                      vrfId});
+                                }
+                            }
+                        }
+                    }
+                }
+            } catch (const std::exception& ex) {
+                LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_RESPONSE_PARSE_ERROR)
+                    .arg(connectionName())
+                    .arg("Route-list")
+                    .arg(ex.what());
+                connectionOrEarlyValidationFailed = true;
+            }
+            if (handler) {
+                handler(std::make_shared<InstalledRoutes>(std::move(routes)),
+                        connectionOrEarlyValidationFailed);
+            }
+        });
+}
@@ -3,30 +3,47 @@
 #include "log.hpp"
 #include "nxos/nxos_structs.hpp"
 #include <asiolink/interval_timer.h>
+#include <utility>
 
 NXOSHeartbeatService::NXOSHeartbeatService(ConstElementPtr mgmtConnParams) :
     m_params(NXOSConnectionConfigParams::parseConfig(mgmtConnParams)) {}
 
 void NXOSHeartbeatService::startService(IOService& io_service) {
-    m_httpClient = boost::make_shared<NXOSHttpClient>(/*mt=*/true /*, poolSize*/);
+    // one uptime request per interval, single thread is enough
+    m_httpClient = boost::make_shared<NXOSHttpClient>(/*mt=*/true, /*maxThreads=*/1);
     m_httpClient->addBasicAuth(m_params.auth.auth);
+    if (m_params.connInfo.url.getScheme() == isc::http::Url::HTTPS) {
+        m_httpClient->setTLSInfo(boost::make_shared<TLSInfo>(
+            TLSInfo{*m_params.cert_file, *m_params.key_file, m_params.ca_file}));
+    }
     m_httpClient->startClient(io_service);
 
     m_timer              = boost::make_shared<isc::asiolink::IntervalTimer>(io_service);
     m_prevLostConnection = true;
     m_prevUptimeSecs     = 0;
+    m_lastUptimeAt       = {};
     m_timer->setup([this] { heartbeatLoop(); }, m_params.heartbeatIntervalSecs * 1000);
 }
 
 void NXOSHeartbeatService::stopService() {
     m_httpClient->stopClient();
     m_timer->cancel();
+    std::unique_lock lock(m_heartbeatMutex);
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_HEARTBEAT_STATS)
+        .arg(connectionName())
+        .arg(m_probes)
+        .arg(m_suppressedProbes);
 }
 
 string NXOSHeartbeatService::connectionName() const {
     return m_params.connInfo.url.toText();
 }
 
+isc::data::ElementPtr NXOSHeartbeatService::workerPoolStats() const {
+    if (!m_httpClient) { return {}; }
+    return m_httpClient->getPoolStats().toElement();
+}
+
 static const string EndpointName{"/ins"};
 
 using namespace NXOSResponse;
@@ -80,12 +97,48 @@ bool NXOSHeartbeatService::checkForFailedConnectionOrRPCResponse(
     return false;
 }
 
+void NXOSHeartbeatService::observeTraffic(bool answered) {
+    (answered ? m_lastAnsweredAt : m_lastFailedAt) =
+        Clock::now().time_since_epoch().count();
+}
+
+bool NXOSHeartbeatService::probeNeeded() {
+    std::unique_lock lock(m_heartbeatMutex);
+    auto             now{Clock::now()};
+    if (m_params.passiveHealth && !m_prevLostConnection &&
+        now - m_lastUptimeAt < std::chrono::seconds(m_params.uptimeIntervalSecs)) {
+        Clock::time_point answeredAt{Clock::duration(m_lastAnsweredAt.load())};
+        Clock::time_point failedAt{Clock::duration(m_lastFailedAt.load())};
+        // failed request makes the switch suspect until it's confirmed by probe
+        if (now - answeredAt < std::chrono::seconds(m_params.heartbeatIntervalSecs) &&
+            failedAt <= answeredAt) {
+            m_suppressedProbes++;
+            return false;
+        }
+    }
+    m_probes++;
+    return true;
+}
+
+std::optional<size_t> NXOSHeartbeatService::switchUptime() {
+    std::unique_lock lock(m_heartbeatMutex);
+    // uptime is reset by restore until the next probe
+    if (m_prevLostConnection || m_prevUptimeSecs == 0) { return std::nullopt; }
+    return m_prevUptimeSecs;
+}
+
+void NXOSHeartbeatService::resumeFrom(size_t uptimeSecs) {
+    std::unique_lock lock(m_heartbeatMutex);
+    m_resumeUptimeSecs = uptimeSecs;
+}
+
 void NXOSHeartbeatService::handlerFailedCallback() {
     std::unique_lock lock(m_heartbeatMutex);
     m_prevLostConnection = true;
 }
 
 void NXOSHeartbeatService::heartbeatLoop() {
+    if (!probeNeeded()) { return; }
     m_httpClient->sendRequest(
         m_params.connInfo.url, EndpointName, {},
         JsonRpcUtils::createRequestFromCommands(1, createUptimeCommand()),
@@ -101,10 +154,25 @@ void NXOSHeartbeatService::heartbeatLoop() {
                     .arg(connectionName());
                 if (connectionFailedHandler) { connectionFailedHandler(); }
                 m_prevLostConnection = true;
+                m_resumeUptimeSecs.reset();
                 return;
             }
 
             size_t uptimeSecondsNew{getUptimeSecondsFromResponse(uptime)};
+            m_lastUptimeAt = Clock::now();
+            auto resumeUptimeSecs{std::exchange(m_resumeUptimeSecs, std::nullopt)};
+            if (m_prevLostConnection && resumeUptimeSecs &&
+                uptimeSecondsNew >= *resumeUptimeSecs && connectionResumedHandler) {
+                // routes of previous load are still on the switch
+                LOG_INFO(DHCP6ExporterLogger,
+                         DHCP6_EXPORTER_NXOS_HEARTBEAT_RESUMED_CONNECTION)
+                    .arg(connectionName())
+                    .arg(uptimeSecondsNew);
+                connectionResumedHandler();
+                m_prevUptimeSecs     = uptimeSecondsNew;
+                m_prevLostConnection = false;
+                return;
+            }
             if (m_prevLostConnection || (uptimeSecondsNew < m_prevUptimeSecs) /*||
                 (uptimeSecondsNew < m_prevUptimeSecs + m_params.heartbeatIntervalSecs)*/) {
                 // stop timer and regenerate static routes from dhcpv6 lease database
@@ -1,17 +1,48 @@
 #include "nxos_http_client.hpp"
+#include "async_http_engine.hpp"
+#include "jsonrpc/stream_parser.hpp"
+#include "span_tracer.hpp"
+#include <atomic>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/post.hpp>
+#include <cc/data.h>
+#include <chrono>
+#include <condition_variable>
 #include <httplib.h>
+#include <optional>
+#include <thread>
+#include <unordered_map>
 
-using httplib::Client;
-using httplib::SSLClient;
+using httplib::ClientImpl;
 using isc::http::BasicHttpAuthPtr;
 using std::unique_lock;
 
+namespace {
+    // response of streaming request, parsed by the thread that receives it
+    struct StreamState {
+        JsonRpcStreamReader reader;
+        size_t              receivedBytes{0};
+        bool                parseFailed{false};
+
+        explicit StreamState(JsonStreamParser::Handler& bodyHandler) :
+            reader(bodyHandler) {}
+
+        bool receive(const char* data, size_t size) {
+            receivedBytes += size;
+            // stop transfer of malformed response, error is reported by `reader`
+            parseFailed = !reader.feed(data, size);
+            return !parseFailed;
+        }
+    };
+}    // namespace
+
 class NXOSHttpClientImpl {
   public:
-    explicit NXOSHttpClientImpl(bool mt_enabled, size_t threadPoolSize) :
+    NXOSHttpClientImpl(bool mt_enabled, size_t maxThreads, size_t minThreads) :
+        m_ioService(new IOService()),
         m_mtEnabled(mt_enabled),
-        m_poolSize(threadPoolSize),
-        m_ioService(new IOService()) {}
+        m_minThreads(std::max<size_t>(std::min(minThreads, maxThreads), 1)),
+        m_maxThreads(std::max<size_t>(maxThreads, 1)) {}
     ~NXOSHttpClientImpl();
 
     void startClient(IOService& ioService);
@@ -20,6 +51,24 @@ class NXOSHttpClientImpl {
 
     void setBasicAuth(const BasicHttpAuthPtr& auth);
 
+    void setTLSInfo(const TLSInfoPtr& tlsInfo);
+
+    void enableAsyncEngine(size_t maxConnections) {
+        m_asyncMaxConnections = maxConnections;
+    }
+
+    void setOutcomeObserver(const NXOSHttpClient::OutcomeObserver& observer) {
+        m_outcomeObserver = observer;
+    }
+
+    NXOSHttpClient::TLSStats getTLSStats() const;
+
+    string tlsSession() const;
+
+    void setTLSSession(const string& session);
+
+    NXOSHttpClient::PoolStats getPoolStats();
+
     void sendRequest(const Url&                              url,
                      const string&                           uri,
                      const TLSInfoPtr&                       tlsContext,
@@ -27,65 +76,202 @@ class NXOSHttpClientImpl {
                      NXOSHttpClient::ResponseHandlerCallback responseHandler,
                      int                                     timeout);
 
+    void sendRequest(NXOSHttpClient::RequestContext& context);
+
+    void sendRawRequest(const Url&                                 url,
+                        NXOSHttpClient::Method                     method,
+                        const string&                              uri,
+                        const NXOSHttpClient::Headers&             headers,
+                        const string&                              body,
+                        const string&                              contentType,
+                        NXOSHttpClient::RawResponseHandlerCallback responseHandler,
+                        int                                        timeout);
+
+    void sendStreamingRequest(const Url&                               url,
+                              const string&                            uri,
+                              ConstElementPtr                          requestBody,
+                              NXOSHttpClient::StreamBodyHandlerPtr     bodyHandler,
+                              NXOSHttpClient::StreamCompletionCallback completionHandler,
+                              int                                      timeout);
+
   private:
     enum ThreadState { RUNNING, STOPPED };
 
+    using ClientPtr = std::unique_ptr<ClientImpl>;
+    using WorkGuard =
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+    using PoolClock = std::chrono::steady_clock;
+
+    // threads above minimum exit after this time without a handler
+    static constexpr std::chrono::seconds WorkerIdleTimeout{30};
+
   private:
     IOServicePtr     m_ioService;
     bool             m_mtEnabled;
     BasicHttpAuthPtr m_basicAuth;
 
-    std::vector<boost::shared_ptr<std::thread>> m_threadPool;
-    std::mutex                                  m_mutexThreadPool;
-    std::condition_variable                     m_cv;
-    int                                         m_runningThreads{0};
-    int                                         m_pausedThreads{0};
-    int                                         m_exitedThreads{0};
-    size_t                                      m_poolSize;
-    ThreadState                                 m_threadsState{STOPPED};
+    TLSInfoPtr         m_tlsInfo;
+    mutable std::mutex m_tlsInfoMutex;
+    // HTTPS requests always go through `m_asyncEngine`, so all connections share
+    // one TLS context. Plain HTTP JSON-RPC and raw requests use it when enabled
+    size_t                           m_asyncMaxConnections{0};
+    std::unique_ptr<AsyncHttpEngine> m_asyncEngine;
+    // TLS stats of stopped engines
+    NXOSHttpClient::TLSStats m_asyncStoppedStats;
+    // session of stopped engine or set before start, guarded by `m_tlsInfoMutex`
+    string m_tlsSession;
+    NXOSHttpClient::OutcomeObserver m_outcomeObserver;
+    // idle keep-alive connections, at most one per worker thread
+    std::unordered_map<string, std::vector<ClientPtr>> m_idleClients;
+    std::mutex                                         m_idleClientsMutex;
+
+    // keeps `run_one_for` of idle threads waiting instead of returning at once
+    std::optional<WorkGuard> m_workGuard;
+    // running threads by id, exited threads wait for join in `m_exitedThreads`
+    std::unordered_map<std::thread::id, std::thread> m_threadPool;
+    std::vector<std::thread>                         m_exitedThreads;
+    std::mutex                                       m_mutexThreadPool;
+    std::condition_variable                          m_cv;
+    size_t                                           m_minThreads;
+    size_t                                           m_maxThreads;
+    ThreadState                                      m_threadsState{STOPPED};
+
+    // counters of `PoolStats`, thread time is integral of pool size over time
+    std::atomic<size_t>   m_threadCount{0};
+    std::atomic<size_t>   m_busyThreads{0};
+    std::atomic<size_t>   m_queuedTasks{0};
+    std::atomic<uint64_t> m_tasks{0};
+    std::atomic<uint64_t> m_busyNs{0};
+    size_t                m_peakThreads{0};
+    uint64_t              m_threadsStarted{0};
+    uint64_t              m_threadsParked{0};
+    uint64_t              m_threadNs{0};
+    PoolClock::time_point m_poolSizeChangedAt;
 
   private:
-    ThreadState getThreadsState() { return m_threadsState; }
-    void        setThreadsState(ThreadState newState);
+    void setThreadsState(ThreadState newState);
 
     void threadLoop();
+
+    // following methods are called with locked `m_mutexThreadPool`
+    void startThread();
+
+    void updateThreadTime(PoolClock::time_point now);
+
+    // blocking request on worker thread, pool grows if no thread is idle
+    template<typename Task>
+    void postTask(Task&& task);
+
+    // request goes through `m_asyncEngine` instead of worker thread.
+    // TLS info of request is used only if client has no own
+    bool useAsyncEngine(const Url& url, const TLSInfoPtr& requestTLSInfo = {});
+
+    ClientPtr acquireClient(const Url& url, int timeout);
+
+    void releaseClient(const Url& url, ClientPtr client);
+
+    // validate JSON-RPC response of `context` and pass it to its owner
+    void completeRequest(NXOSHttpClient::RequestContext& context);
+
+    void observeOutcome(NXOSHttpClient::ResponseError responseError,
+                        NXOSHttpClient::StatusCode    statusCode);
+
+    void completeStreamingRequest(
+        const Url&                                      url,
+        StreamState&                                    state,
+        NXOSHttpClient::ResponseError                   responseError,
+        NXOSHttpClient::StatusCode                      statusCode,
+        const NXOSHttpClient::StreamCompletionCallback& completionHandler);
+
+    // blocking plain HTTP request
+    NXOSHttpClient::ResponseError performRequest(const Url&                     url,
+                                                 NXOSHttpClient::Method         method,
+                                                 const string&                  uri,
+                                                 const NXOSHttpClient::Headers& headers,
+                                                 const string&                  body,
+                                                 const string&                  contentType,
+                                                 int                            timeout,
+                                                 NXOSHttpClient::StatusCode&    statusCode,
+                                                 string&                        responseBody,
+                                                 const httplib::ContentReceiver* receiver = nullptr);
 };
 
-void NXOSHttpClientImpl::threadLoop() {
-    bool done{false};
-    while (!done) {
-        switch (getThreadsState()) {
-            case ThreadState::RUNNING: {
-                {
-                    unique_lock lock(m_mutexThreadPool);
-                    m_runningThreads++;
-                    // If We're all running notify main thread.
-                    if (m_runningThreads == m_poolSize) { m_cv.notify_all(); }
-                }
-                try {
-                    // Run the IOService.
-                    m_ioService->run();
-                } catch (...) {
-                    // Catch all exceptions.
-                    // Logging is not available.
-                }
-                {
-                    unique_lock lock(m_mutexThreadPool);
-                    m_runningThreads--;
-                }
-            } break;
+void NXOSHttpClientImpl::updateThreadTime(PoolClock::time_point now) {
+    std::chrono::nanoseconds elapsed{now - m_poolSizeChangedAt};
+    m_threadNs += static_cast<uint64_t>(elapsed.count()) * m_threadPool.size();
+    m_poolSizeChangedAt = now;
+}
+
+void NXOSHttpClientImpl::startThread() {
+    updateThreadTime(PoolClock::now());
+    std::thread thread([this] { threadLoop(); });
+    auto        id{thread.get_id()};
+    m_threadPool.emplace(id, std::move(thread));
+    m_threadCount = m_threadPool.size();
+    m_peakThreads = std::max(m_peakThreads, m_threadPool.size());
+    m_threadsStarted++;
+}
 
-            case ThreadState::STOPPED: {
-                done = true;
-            } break;
+void NXOSHttpClientImpl::threadLoop() {
+    auto& ioContext{m_ioService->getInternalIOService()};
+    while (true) {
+        size_t executed{0};
+        try {
+            // idle thread sleeps in the reactor until handler or timeout
+            executed = ioContext.run_one_for(WorkerIdleTimeout);
+        } catch (...) {
+            // Catch all exceptions.
+            // Logging is not available.
+            executed = 1;
+        }
+        if (ioContext.stopped()) { break; }
+        if (!executed) {
+            unique_lock lock(m_mutexThreadPool);
+            if (m_threadsState == ThreadState::RUNNING &&
+                m_threadPool.size() > m_minThreads) {
+                m_threadsParked++;
+                break;
+            }
         }
     }
 
-    unique_lock lck(m_mutexThreadPool);
-    m_exitedThreads++;
+    unique_lock lock(m_mutexThreadPool);
+    updateThreadTime(PoolClock::now());
+    auto it{m_threadPool.find(std::this_thread::get_id())};
+    m_exitedThreads.push_back(std::move(it->second));
+    m_threadPool.erase(it);
+    m_threadCount = m_threadPool.size();
 
     // If we've all exited, notify main.
-    if (m_exitedThreads == m_threadPool.size()) { m_cv.notify_all(); }
+    if (m_threadPool.empty()) { m_cv.notify_all(); }
+}
+
+template<typename Task>
+void NXOSHttpClientImpl::postTask(Task&& task) {
+    auto queued{++m_queuedTasks};
+    // asio keeps the handler in recycled memory, unlike std::function of IOService
+    boost::asio::post(m_ioService->getInternalIOService(),
+                      [this, task = std::forward<Task>(task)]() mutable {
+                          m_queuedTasks--;
+                          m_busyThreads++;
+                          auto startedAt{PoolClock::now()};
+                          task();
+                          std::chrono::nanoseconds busy{PoolClock::now() - startedAt};
+                          m_busyNs += static_cast<uint64_t>(busy.count());
+                          m_tasks++;
+                          m_busyThreads--;
+                      });
+    // thread started but not yet running counts as idle, so a burst of requests
+    // doesn't start more threads than it has requests
+    if (queued + m_busyThreads <= m_threadCount) { return; }
+    unique_lock lock(m_mutexThreadPool);
+    if (m_threadsState == ThreadState::RUNNING && m_threadPool.size() < m_maxThreads &&
+        m_queuedTasks + m_busyThreads > m_threadPool.size()) {
+        startThread();
+    }
+    // parked threads are joined by the next one growing the pool
+    for (auto& thread : m_exitedThreads) { thread.join(); }
+    m_exitedThreads.clear();
 }
 
 void NXOSHttpClientImpl::setThreadsState(ThreadState newState) {
@@ -95,46 +281,108 @@ void NXOSHttpClientImpl::setThreadsState(ThreadState newState) {
     switch (m_threadsState) {
         case ThreadState::RUNNING: {
             m_ioService->restart();
+            m_workGuard.emplace(m_ioService->getInternalIOService().get_executor());
 
-            // While we have fewer threads than we should, make more.
-            while (m_threadPool.size() < m_poolSize) {
-                auto t = boost::make_shared<std::thread>([this] { threadLoop(); });
-                m_threadPool.push_back(t);
-            }
-
-            // Main thread waits here until all threads are running.
-            m_cv.wait(main_lck,
-                      [&]() { return (m_runningThreads == m_threadPool.size()); });
-
-            m_exitedThreads = 0;
+            m_poolSizeChangedAt = PoolClock::now();
+            while (m_threadPool.size() < m_minThreads) { startThread(); }
         } break;
 
         case ThreadState::STOPPED: {
-            // Stop IOService.
+            m_workGuard.reset();
+            // Stop IOService. Handlers may post requests, which locks the pool
+            main_lck.unlock();
             if (!m_ioService->stopped()) {
                 try {
                     m_ioService->poll();
                 } catch (...) {}
                 m_ioService->stop();
             }
+            main_lck.lock();
 
             // Main thread waits here until all threads have exited.
-            m_cv.wait(main_lck,
-                      [&]() { return (m_exitedThreads == m_threadPool.size()); });
+            m_cv.wait(main_lck, [&]() { return m_threadPool.empty(); });
 
-            for (auto const& thread : m_threadPool) { thread->join(); }
+            for (auto& thread : m_exitedThreads) { thread.join(); }
+            m_exitedThreads.clear();
 
-            m_threadPool.clear();
+            // close persistent connections
+            std::unique_lock clientsLock(m_idleClientsMutex);
+            m_idleClients.clear();
         } break;
     }
 }
 
+NXOSHttpClient::PoolStats NXOSHttpClientImpl::getPoolStats() {
+    unique_lock               lock(m_mutexThreadPool);
+    NXOSHttpClient::PoolStats stats;
+    updateThreadTime(PoolClock::now());
+    stats.threads        = m_threadPool.size();
+    stats.minThreads     = m_minThreads;
+    stats.maxThreads     = m_maxThreads;
+    stats.peakThreads    = m_peakThreads;
+    stats.busyThreads    = m_busyThreads;
+    stats.queuedTasks    = m_queuedTasks;
+    stats.tasks          = m_tasks;
+    stats.threadsStarted = m_threadsStarted;
+    stats.threadsParked  = m_threadsParked;
+    if (m_threadNs) {
+        stats.utilization =
+            static_cast<double>(m_busyNs) / static_cast<double>(m_threadNs);
+    }
+    return stats;
+}
+
+isc::data::ElementPtr NXOSHttpClient::PoolStats::toElement() const {
+    using isc::data::Element;
+    auto element{Element::createMap()};
+    element->set("threads", Element::create(static_cast<long long>(threads)));
+    element->set("min-threads", Element::create(static_cast<long long>(minThreads)));
+    element->set("max-threads", Element::create(static_cast<long long>(maxThreads)));
+    element->set("peak-threads", Element::create(static_cast<long long>(peakThreads)));
+    element->set("busy-threads", Element::create(static_cast<long long>(busyThreads)));
+    element->set("queued-tasks", Element::create(static_cast<long long>(queuedTasks)));
+    element->set("tasks", Element::create(static_cast<long long>(tasks)));
+    element->set("threads-started",
+                 Element::create(static_cast<long long>(threadsStarted)));
+    element->set("threads-parked",
+                 Element::create(static_cast<long long>(threadsParked)));
+    element->set("utilization", Element::create(utilization));
+    return element;
+}
+
 void NXOSHttpClientImpl::startClient(IOService& ioService) {
+    if (!m_asyncEngine) {
+        // without async mode engine carries only HTTPS, one connection per thread
+        m_asyncEngine = std::make_unique<AsyncHttpEngine>(
+            m_ioService->getInternalIOService(),
+            m_asyncMaxConnections ? m_asyncMaxConnections : m_maxThreads);
+        m_asyncEngine->setBasicAuth(m_basicAuth);
+        std::unique_lock lock(m_tlsInfoMutex);
+        if (m_tlsInfo) {
+            m_asyncEngine->setTLSInfo(*m_tlsInfo);
+            m_asyncEngine->setTLSSession(m_tlsSession);
+        }
+    }
     // TODO: handle single-threaded environment and use supplied `ioService`
     setThreadsState(ThreadState::RUNNING);
 }
 
-void NXOSHttpClientImpl::stopClient() { setThreadsState(ThreadState::STOPPED); }
+void NXOSHttpClientImpl::stopClient() {
+    // requests in flight are cancelled while threads still run
+    if (m_asyncEngine) { m_asyncEngine->stop(); }
+    setThreadsState(ThreadState::STOPPED);
+    if (m_asyncEngine) {
+        auto stats{m_asyncEngine->getTLSStats()};
+        m_asyncStoppedStats.connectionsOpened += stats.connectionsOpened;
+        m_asyncStoppedStats.fullHandshakes += stats.fullHandshakes;
+        m_asyncStoppedStats.resumedHandshakes += stats.resumedHandshakes;
+        std::unique_lock lock(m_tlsInfoMutex);
+        if (auto session{m_asyncEngine->tlsSession()}; !session.empty()) {
+            m_tlsSession = std::move(session);
+        }
+        m_asyncEngine.reset();
+    }
+}
 
 NXOSHttpClientImpl::~NXOSHttpClientImpl() { setThreadsState(ThreadState::STOPPED); }
 
@@ -173,6 +421,122 @@ static inline NXOSHttpClient::ResponseError
     }
 }
 
+bool NXOSHttpClientImpl::useAsyncEngine(const Url&        url,
+                                        const TLSInfoPtr& requestTLSInfo) {
+    if (!m_asyncEngine) { return false; }
+    if (url.getScheme() != Url::Scheme::HTTPS) { return m_asyncMaxConnections != 0; }
+    if (!requestTLSInfo) { return true; }
+    std::unique_lock lock(m_tlsInfoMutex);
+    if (!m_tlsInfo) {
+        try {
+            m_asyncEngine->setTLSInfo(*requestTLSInfo);
+            m_tlsInfo = requestTLSInfo;
+        } catch (const std::exception& ex) {
+            // engine answers with SSL_LOADING_CERTS
+            LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_UPDATE_INFO_COMMUNICATION_FAILED)
+                .arg(url.toText())
+                .arg(ex.what());
+        }
+    }
+    return true;
+}
+
+NXOSHttpClientImpl::ClientPtr NXOSHttpClientImpl::acquireClient(const Url& url,
+                                                                int        timeout) {
+    {
+        std::unique_lock lock(m_idleClientsMutex);
+        auto&            idle{m_idleClients[url.toText()]};
+        if (!idle.empty()) {
+            auto client{std::move(idle.back())};
+            idle.pop_back();
+            return client;
+        }
+    }
+
+    auto client{std::make_unique<ClientImpl>(url.getStrippedHostname(), url.getPort())};
+    client->set_keep_alive(true);
+    client->set_connection_timeout(timeout);
+    if (m_basicAuth) {
+        const string& secret{m_basicAuth->getSecret()};
+        // Extract the password part (substring from the position after the
+        // colon to the end)
+        auto pos{secret.find(':')};
+        if (pos != string::npos) {
+            string login    = secret.substr(0, pos);
+            string password = secret.substr(pos + 1);
+            client->set_basic_auth(login, password);
+        }
+    }
+    return client;
+}
+
+void NXOSHttpClientImpl::releaseClient(const Url& url, ClientPtr client) {
+    std::unique_lock lock(m_idleClientsMutex);
+    auto&            idle{m_idleClients[url.toText()]};
+    if (idle.size() < m_maxThreads) { idle.push_back(std::move(client)); }
+}
+
+NXOSHttpClient::ResponseError
+    NXOSHttpClientImpl::performRequest(const Url&                      url,
+                                       NXOSHttpClient::Method          method,
+                                       const string&                   uri,
+                                       const NXOSHttpClient::Headers&  headers,
+                                       const string&                   body,
+                                       const string&                   contentType,
+                                       int                             timeout,
+                                       NXOSHttpClient::StatusCode&     statusCode,
+                                       string&                         responseBody,
+                                       const httplib::ContentReceiver* receiver) {
+    const auto& connectionName{url.toText()};
+    // HTTPS goes through `m_asyncEngine`, which exists only while client runs
+    if (url.getScheme() == Url::Scheme::HTTPS) { return NXOSHttpClient::CANCELED; }
+
+    httplib::Headers requestHeaders;
+    for (const auto& [name, value] : headers) { requestHeaders.emplace(name, value); }
+
+    auto client{acquireClient(url, timeout)};
+    httplib::Result response;
+    if (receiver) {
+        // body is passed to `receiver` chunk by chunk and never collected
+        httplib::Request request;
+        request.method  = method == NXOSHttpClient::Method::GET ? "GET" : "POST";
+        request.path    = uri;
+        request.headers = std::move(requestHeaders);
+        if (method == NXOSHttpClient::Method::POST) {
+            request.body = body;
+            request.set_header("Content-Type", contentType);
+        }
+        request.content_receiver = [receiver](const char* data, size_t dataLength,
+                                              uint64_t /*offset*/, uint64_t /*total*/) {
+            return (*receiver)(data, dataLength);
+        };
+        response = client->send(request);
+    } else if (method == NXOSHttpClient::Method::GET) {
+        response = client->Get(uri, requestHeaders);
+    } else {
+        response = client->Post(uri, requestHeaders, body, contentType);
+    }
+    if (!response) {
+        LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_UPDATE_INFO_COMMUNICATION_FAILED)
+            .arg(connectionName)
+            .arg(httplib::to_string(response.error()));
+        // connection is broken, don't return it to the pool
+        auto responseError{HttplibErrorToNXOSHttpClientMapper(response.error())};
+        observeOutcome(responseError, 0);
+        return responseError;
+    }
+    statusCode = HttplibStatusCodeToNXOSHttpClientMapper(
+        static_cast<httplib::StatusCode>(response->status));
+    observeOutcome(NXOSHttpClient::SUCCESS, statusCode);
+    responseBody = std::move(response->body);
+    releaseClient(url, std::move(client));
+
+    if (receiver) { return NXOSHttpClient::SUCCESS; }
+    LOG_DEBUG(DHCP6ExporterRequestLogger, DBGLVL_TRACE_DETAIL, DHCP6_EXPORTER_LOG_RESPONSE)
+        .arg(responseBody);
+    return NXOSHttpClient::SUCCESS;
+}
+
 void NXOSHttpClientImpl::sendRequest(
     const Url&                              url,
     const string&                           endpointName,
@@ -180,83 +544,322 @@ void NXOSHttpClientImpl::sendRequest(
     ConstElementPtr                         requestBody,
     NXOSHttpClient::ResponseHandlerCallback responseHandler,
     int                                     timeout) {
-    m_ioService->post([this, responseHandler, url, tlsContext, timeout, endpointName,
-                       requestBody] {
-        const auto& connectionName{url.toText()};
-        bool        isHttpsScheme{url.getScheme() == Url::Scheme::HTTPS};
-        if (isHttpsScheme) {
-            if (!tlsContext) {
-                isc_throw(isc::NotImplemented,
-                          "https tls context not implemented for requests");
-            }
-        } else {
-            Client cli(url.getStrippedHostname(), url.getPort());
-            cli.set_connection_timeout(timeout);
-            if (m_basicAuth) {
-                const string& secret{m_basicAuth->getSecret()};
-                // Extract the password part (substring from the position after the
-                // colon to the end)
-                auto pos{secret.find(':')};
-                if (pos != string::npos) {
-                    string login    = secret.substr(0, pos);
-                    string password = secret.substr(pos + 1);
-                    cli.set_basic_auth(login, password);
+    if (useAsyncEngine(url, tlsContext)) {
+        m_asyncEngine->send(
+            url,
+            {NXOSHttpClient::Method::POST, endpointName, requestBody->str(),
+             "application/json-rpc", {}, timeout},
+            [this, url, responseHandler](NXOSHttpClient::ResponseError responseError,
+                                         NXOSHttpClient::StatusCode    statusCode,
+                                         string&                       body) {
+                observeOutcome(responseError, statusCode);
+                std::vector<JsonRpcResponse> jsonRpcResponseRaw;
+                JsonRpcExceptionPtr          jsonRpcException;
+                if (responseError == NXOSHttpClient::SUCCESS) {
+                    try {
+                        jsonRpcResponseRaw = validateResponse(body);
+                    } catch (const JsonRpcException& ex) {
+                        LOG_ERROR(DHCP6ExporterLogger,
+                                  DHCP6_EXPORTER_JSON_RPC_VALIDATE_ERROR)
+                            .arg(url.toText())
+                            .arg(ex.what());
+                        jsonRpcException = boost::make_shared<JsonRpcException>(ex);
+                    }
+                }
+                if (responseHandler) {
+                    responseHandler(boost::make_shared<std::vector<JsonRpcResponse>>(
+                                        std::move(jsonRpcResponseRaw)),
+                                    responseError, statusCode, jsonRpcException);
                 }
+            });
+        return;
+    }
+    postTask([this, responseHandler, url, timeout, endpointName, requestBody] {
+        std::vector<JsonRpcResponse> jsonRpcResponseRaw;
+        NXOSHttpClient::StatusCode   responseStatusCode{200};
+        JsonRpcExceptionPtr          jsonRpcException;
+        string                       responseBody;
+
+        auto responseError{performRequest(url, NXOSHttpClient::Method::POST, endpointName,
+                                          {}, requestBody->str(), "application/json-rpc",
+                                          timeout, responseStatusCode, responseBody)};
+        if (responseError == NXOSHttpClient::SUCCESS) {
+            try {
+                jsonRpcResponseRaw = validateResponse(responseBody);
+            } catch (const JsonRpcException& ex) {
+                LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_JSON_RPC_VALIDATE_ERROR)
+                    .arg(url.toText())
+                    .arg(ex.what());
+                // give exception object back to response handler
+                jsonRpcException = boost::make_shared<JsonRpcException>(ex);
             }
+        }
+        if (responseHandler) {
+            responseHandler(boost::make_shared<std::vector<JsonRpcResponse>>(
+                                std::move(jsonRpcResponseRaw)),
+                            responseError, responseStatusCode, jsonRpcException);
+        }
+    });
+}
 
-            std::vector<JsonRpcResponse>  jsonRpcResponseRaw;
-            NXOSHttpClient::ResponseError responseError{
-                NXOSHttpClient::ResponseError::SUCCESS};
-            NXOSHttpClient::StatusCode responseStatusCode{200};
-            JsonRpcExceptionPtr        jsonRpcException;
-
-            auto response{
-                cli.Post(endpointName, requestBody->str(), "application/json-rpc")};
-            if (!response) {
-                LOG_ERROR(DHCP6ExporterLogger,
-                          DHCP6_EXPORTER_UPDATE_INFO_COMMUNICATION_FAILED)
-                    .arg(connectionName)
-                    .arg(httplib::to_string(response.error()));
-                responseError = HttplibErrorToNXOSHttpClientMapper(response.error());
+void NXOSHttpClientImpl::completeRequest(NXOSHttpClient::RequestContext& context) {
+    if (context.responseError == NXOSHttpClient::SUCCESS) {
+        try {
+            if (context.responseBody.empty()) {
+                throw JsonRpcException(JsonRpcException::INTERNAL_ERROR,
+                                       "no body found in the response");
+            }
+            if (context.validateOnly) {
+                static JsonNullHandler ignoredBody;
+                if (!context.validator) { context.validator.emplace(ignoredBody); }
+                context.validator->reset();
+                context.validator->feed(context.responseBody.data(),
+                                        context.responseBody.size());
+                context.validator->finish();
+                context.results = context.validator->results();
             } else {
-                responseStatusCode = HttplibStatusCodeToNXOSHttpClientMapper(
-                    static_cast<httplib::StatusCode>(response->status));
-                string responseBody = response->body;
-                try {
-                    LOG_DEBUG(DHCP6ExporterRequestLogger, DBGLVL_TRACE_DETAIL,
-                              DHCP6_EXPORTER_LOG_RESPONSE)
-                        .arg(responseBody);
-
-                    jsonRpcResponseRaw = validateResponse(responseBody);
-                } catch (const JsonRpcException& ex) {
-                    LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_JSON_RPC_VALIDATE_ERROR)
-                        .arg(connectionName)
-                        .arg(ex.what());
-                    // give exception object back to response handler
-                    jsonRpcException = boost::make_shared<JsonRpcException>(ex);
-                }
+                JsonRpcUtils::handleResponse(context.responseBody, context.responses);
+                context.results = context.responses.size();
             }
-run_handler:
+        } catch (const JsonRpcException& ex) {
+            LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_JSON_RPC_VALIDATE_ERROR)
+                .arg(context.url->toText())
+                .arg(ex.what());
+            // give exception object back to context owner
+            context.exception = ex;
+        }
+    }
+    context.onComplete();
+}
+
+void NXOSHttpClientImpl::observeOutcome(NXOSHttpClient::ResponseError responseError,
+                                        NXOSHttpClient::StatusCode    statusCode) {
+    if (!m_outcomeObserver || responseError == NXOSHttpClient::CANCELED) { return; }
+    m_outcomeObserver(responseError == NXOSHttpClient::SUCCESS && statusCode >= 200 &&
+                      statusCode < 300);
+}
+
+void NXOSHttpClientImpl::sendRequest(NXOSHttpClient::RequestContext& context) {
+    if (useAsyncEngine(*context.url)) {
+        // request waits for free connection inside engine, not in worker queue
+        context.startedAt  = SpanTracer::now();
+        context.statusCode = 200;
+        context.results    = 0;
+        context.responses.clear();
+        context.exception.reset();
+        m_asyncEngine->send(
+            *context.url,
+            {NXOSHttpClient::Method::POST, *context.uri, {}, {}, {}, context.timeout,
+             {}, &context.requestBody},
+            [this, contextPtr = &context](NXOSHttpClient::ResponseError responseError,
+                                          NXOSHttpClient::StatusCode    statusCode,
+                                          string&                       body) {
+                auto& context{*contextPtr};
+                observeOutcome(responseError, statusCode);
+                context.responseError = responseError;
+                context.statusCode    = statusCode;
+                context.responseBody.swap(body);
+                completeRequest(context);
+            });
+        return;
+    }
+    // handler captures only two pointers, no allocation per request
+    postTask([this, contextPtr = &context] {
+        auto& context{*contextPtr};
+        context.startedAt  = SpanTracer::now();
+        context.statusCode = 200;
+        context.results    = 0;
+        context.responses.clear();
+        context.exception.reset();
+
+        context.responseError = performRequest(
+            *context.url, NXOSHttpClient::Method::POST, *context.uri, {},
+            context.requestBody, "application/json-rpc", context.timeout,
+            context.statusCode, context.responseBody);
+        completeRequest(context);
+    });
+}
+
+void NXOSHttpClientImpl::sendRawRequest(
+    const Url&                                 url,
+    NXOSHttpClient::Method                     method,
+    const string&                              uri,
+    const NXOSHttpClient::Headers&             headers,
+    const string&                              body,
+    const string&                              contentType,
+    NXOSHttpClient::RawResponseHandlerCallback responseHandler,
+    int                                        timeout) {
+    if (useAsyncEngine(url)) {
+        m_asyncEngine->send(
+            url, {method, uri, body, contentType, headers, timeout},
+            [this, responseHandler](NXOSHttpClient::ResponseError responseError,
+                                    NXOSHttpClient::StatusCode    statusCode,
+                                    string&                       responseBody) {
+                observeOutcome(responseError, statusCode);
+                if (responseHandler) {
+                    responseHandler(responseBody, responseError, statusCode);
+                }
+            });
+        return;
+    }
+    postTask(
+        [this, responseHandler, url, method, uri, headers, body, contentType, timeout] {
+            NXOSHttpClient::StatusCode responseStatusCode{200};
+            string                     responseBody;
+
+            auto responseError{performRequest(url, method, uri, headers, body,
+                                              contentType, timeout, responseStatusCode,
+                                              responseBody)};
             if (responseHandler) {
-                responseHandler(boost::make_shared<std::vector<JsonRpcResponse>>(
-                                    std::move(jsonRpcResponseRaw)),
-                                responseError, responseStatusCode, jsonRpcException);
+                responseHandler(responseBody, responseError, responseStatusCode);
             }
-        }
+        });
+}
+
+void NXOSHttpClientImpl::sendStreamingRequest(
+    const Url&                               url,
+    const string&                            uri,
+    ConstElementPtr                          requestBody,
+    NXOSHttpClient::StreamBodyHandlerPtr     bodyHandler,
+    NXOSHttpClient::StreamCompletionCallback completionHandler,
+    int                                      timeout) {
+    auto state{std::make_shared<StreamState>(*bodyHandler)};
+    if (useAsyncEngine(url)) {
+        AsyncHttpEngine::Request request{NXOSHttpClient::Method::POST,
+                                         uri,
+                                         requestBody->str(),
+                                         "application/json-rpc",
+                                         {},
+                                         timeout};
+        request.receiver = [state](const char* data, size_t size) {
+            return state->receive(data, size);
+        };
+        m_asyncEngine->send(
+            url, std::move(request),
+            [this, url, state, bodyHandler, completionHandler](
+                NXOSHttpClient::ResponseError responseError,
+                NXOSHttpClient::StatusCode statusCode, string& /*body*/) {
+                observeOutcome(responseError, statusCode);
+                completeStreamingRequest(url, *state, responseError, statusCode,
+                                         completionHandler);
+            });
+        return;
+    }
+    postTask([this, url, uri, requestBody, bodyHandler, state, completionHandler,
+              timeout] {
+        NXOSHttpClient::StatusCode responseStatusCode{200};
+        string                     responseBody;
+
+        auto receiver{httplib::ContentReceiver([&state](const char* data, size_t size) {
+            return state->receive(data, size);
+        })};
+        auto responseError{performRequest(url, NXOSHttpClient::Method::POST, uri, {},
+                                          requestBody->str(), "application/json-rpc",
+                                          timeout, responseStatusCode, responseBody,
+                                          &receiver)};
+        completeStreamingRequest(url, *state, responseError, responseStatusCode,
+                                 completionHandler);
     });
 }
 
+void NXOSHttpClientImpl::completeStreamingRequest(
+    const Url&                                      url,
+    StreamState&                                    state,
+    NXOSHttpClient::ResponseError                   responseError,
+    NXOSHttpClient::StatusCode                      statusCode,
+    const NXOSHttpClient::StreamCompletionCallback& completionHandler) {
+    JsonRpcExceptionPtr jsonRpcException;
+    if (state.parseFailed) { responseError = NXOSHttpClient::SUCCESS; }
+    if (responseError == NXOSHttpClient::SUCCESS) {
+        try {
+            if (!state.receivedBytes) {
+                throw JsonRpcException(JsonRpcException::INTERNAL_ERROR,
+                                       "no body found in the response");
+            }
+            state.reader.finish();
+        } catch (const JsonRpcException& ex) {
+            LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_JSON_RPC_VALIDATE_ERROR)
+                .arg(url.toText())
+                .arg(ex.what());
+            // give exception object back to completion handler
+            jsonRpcException = boost::make_shared<JsonRpcException>(ex);
+        }
+    }
+    if (completionHandler) {
+        completionHandler(responseError, statusCode, jsonRpcException);
+    }
+}
+
 void NXOSHttpClientImpl::setBasicAuth(const BasicHttpAuthPtr& auth) {
     if (auth) { m_basicAuth = auth; }
 }
 
-NXOSHttpClient::NXOSHttpClient(bool mt_enabled, size_t threadPoolSize) :
-    m_impl(new NXOSHttpClientImpl(mt_enabled, threadPoolSize)) {}
+void NXOSHttpClientImpl::setTLSInfo(const TLSInfoPtr& tlsInfo) {
+    if (!tlsInfo) { return; }
+    std::unique_lock lock(m_tlsInfoMutex);
+    // connections of previous credentials aren't reused
+    if (m_asyncEngine) { m_asyncEngine->setTLSInfo(*tlsInfo); }
+    m_tlsInfo = tlsInfo;
+}
+
+NXOSHttpClient::TLSStats NXOSHttpClientImpl::getTLSStats() const {
+    auto stats{m_asyncStoppedStats};
+    if (m_asyncEngine) {
+        auto engineStats{m_asyncEngine->getTLSStats()};
+        stats.connectionsOpened += engineStats.connectionsOpened;
+        stats.fullHandshakes += engineStats.fullHandshakes;
+        stats.resumedHandshakes += engineStats.resumedHandshakes;
+    }
+    return stats;
+}
+
+string NXOSHttpClientImpl::tlsSession() const {
+    std::unique_lock lock(m_tlsInfoMutex);
+    if (m_asyncEngine) {
+        if (auto session{m_asyncEngine->tlsSession()}; !session.empty()) {
+            return session;
+        }
+    }
+    return m_tlsSession;
+}
+
+void NXOSHttpClientImpl::setTLSSession(const string& session) {
+    std::unique_lock lock(m_tlsInfoMutex);
+    m_tlsSession = session;
+    if (m_asyncEngine) { m_asyncEngine->setTLSSession(session); }
+}
+
+NXOSHttpClient::NXOSHttpClient(bool mt_enabled, size_t maxThreads, size_t minThreads) :
+    m_impl(new NXOSHttpClientImpl(mt_enabled, maxThreads, minThreads)) {}
 
 void NXOSHttpClient::addBasicAuth(const BasicHttpAuthPtr& auth) {
     m_impl->setBasicAuth(auth);
 }
 
+void NXOSHttpClient::setTLSInfo(const TLSInfoPtr& tlsInfo) { m_impl->setTLSInfo(tlsInfo); }
+
+void NXOSHttpClient::enableAsyncEngine(size_t maxConnections) {
+    m_impl->enableAsyncEngine(maxConnections);
+}
+
+NXOSHttpClient::TLSStats NXOSHttpClient::getTLSStats() const {
+    return m_impl->getTLSStats();
+}
+
+string NXOSHttpClient::tlsSession() const { return m_impl->tlsSession(); }
+
+void NXOSHttpClient::setTLSSession(const string& session) {
+    m_impl->setTLSSession(session);
+}
+
+NXOSHttpClient::PoolStats NXOSHttpClient::getPoolStats() const {
+    return m_impl->getPoolStats();
+}
+
+void NXOSHttpClient::setOutcomeObserver(const OutcomeObserver& observer) {
+    m_impl->setOutcomeObserver(observer);
+}
+
 void NXOSHttpClient::startClient(IOService& ioService) { m_impl->startClient(ioService); }
 
 void NXOSHttpClient::stopClient() { m_impl->stopClient(); }
@@ -270,6 +873,39 @@ void NXOSHttpClient::sendRequest(const Url&                              url,
     m_impl->sendRequest(url, uri, tlsContext, requestBody, responseHandler, timeout);
 }
 
+void NXOSHttpClient::sendRequest(const Url&      url,
+                                 const string&   uri,
+                                 RequestContext& context,
+                                 int             timeout) {
+    context.url     = &url;
+    context.uri     = &uri;
+    context.timeout = timeout;
+    context.sentAt  = SpanTracer::now();
+    m_impl->sendRequest(context);
+}
+
+void NXOSHttpClient::sendRawRequest(const Url&                 url,
+                                    Method                     method,
+                                    const string&              uri,
+                                    const Headers&             headers,
+                                    const string&              body,
+                                    const string&              contentType,
+                                    RawResponseHandlerCallback responseHandler,
+                                    int                        timeout) {
+    m_impl->sendRawRequest(url, method, uri, headers, body, contentType, responseHandler,
+                           timeout);
+}
+
+void NXOSHttpClient::sendStreamingRequest(const Url&               url,
+                                          const string&            uri,
+                                          ConstElementPtr          requestBody,
+                                          StreamBodyHandlerPtr     bodyHandler,
+                                          StreamCompletionCallback completionHandler,
+                                          int                      timeout) {
+    m_impl->sendStreamingRequest(url, uri, requestBody, bodyHandler, completionHandler,
+                                 timeout);
+}
+
 string NXOSHttpClient::ResponseErrorToString(NXOSHttpClient::ResponseError error) {
     // in case of changes in httplib errors, change this function
     httplib::Error httplibError{static_cast<httplib::Error>(error)};
@@ -1,10 +1,12 @@
 #include "nxos_management_client.hpp"
 #include "dhcp/hwaddr.h"
+#include "jsonrpc/stream_parser.hpp"
 #include "jsonrpc/utils.hpp"
-#include "lease_utils.hpp"
 #include "log.hpp"
 #include "nxos/nxos_structs.hpp"
 #include "post_request_jsonrpc.hpp"
+#include "span_tracer.hpp"
+#include "trace_ring.hpp"
 #include <algorithm>
 #include <asiolink/asio_wrapper.h>
 #include <asiolink/crypto_tls.h>
@@ -18,7 +20,7 @@
 #include <http/basic_auth.h>
 #include <http/client.h>
 #include <httplib.h>
-#include <regex>
+#include <unordered_set>
 
 using isc::data::ConstElementPtr;
 using isc::data::Element;
@@ -27,27 +29,50 @@ using isc::dhcp::LeaseMgrFactory;
 using isc::http::BasicHttpAuth;
 using isc::http::BasicHttpAuthPtr;
 
-static const std::regex VlanIfRegex("(vlan)(\\d+)",
-                                    std::regex_constants::icase |
-                                        std::regex_constants::ECMAScript);
-
-static inline bool isValidVlanName(const string& ifName) {
-    return std::regex_match(ifName, VlanIfRegex);
-}
-
 NXOSManagementClient::NXOSManagementClient(ConstElementPtr mgmtConnParams) :
     m_params(NXOSConnectionConfigParams::parseConfig(mgmtConnParams)) {}
 
 void NXOSManagementClient::startClient(IOService& io_service) {
+    m_httpClient = boost::make_shared<NXOSHttpClient>(/*mt=*/true, m_params.maxThreads,
+                                                      m_params.minThreads);
+    m_httpClient->addBasicAuth(m_params.auth.auth);
     if (m_params.connInfo.url.getScheme() == isc::http::Url::HTTPS) {
-        isc_throw(isc::NotImplemented, "https tls context init not implemented");
+        m_httpClient->setTLSInfo(boost::make_shared<TLSInfo>(
+            TLSInfo{*m_params.cert_file, *m_params.key_file, m_params.ca_file}));
+        m_httpClient->setTLSSession(m_tlsSession);
     }
-    m_httpClient = boost::make_shared<NXOSHttpClient>(/*mt=*/true /*poolSize*/);
-    m_httpClient->addBasicAuth(m_params.auth.auth);
+    if (m_params.asyncEngine) {
+        m_httpClient->enableAsyncEngine(m_params.maxConnections);
+    }
+    if (m_trafficObserver) { m_httpClient->setOutcomeObserver(m_trafficObserver); }
     m_httpClient->startClient(io_service);
 }
 
-void NXOSManagementClient::stopClient() { m_httpClient->stopClient(); }
+void NXOSManagementClient::stopClient() {
+    m_httpClient->stopClient();
+    if (m_params.connInfo.url.getScheme() == isc::http::Url::HTTPS) {
+        m_tlsSession = m_httpClient->tlsSession();
+        auto stats{m_httpClient->getTLSStats()};
+        LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_TLS_STATS)
+            .arg(connectionName())
+            .arg(stats.connectionsOpened)
+            .arg(stats.fullHandshakes)
+            .arg(stats.resumedHandshakes);
+    }
+    auto poolStats{m_httpClient->getPoolStats()};
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_WORKER_POOL_STATS)
+        .arg(connectionName())
+        .arg(poolStats.tasks)
+        .arg(poolStats.peakThreads)
+        .arg(poolStats.threadsStarted)
+        .arg(poolStats.threadsParked)
+        .arg(poolStats.utilization);
+}
+
+isc::data::ElementPtr NXOSManagementClient::workerPoolStats() const {
+    if (!m_httpClient) { return {}; }
+    return m_httpClient->getPoolStats().toElement();
+}
 
 string NXOSManagementClient::connectionName() const {
     return m_params.connInfo.url.toText();
@@ -57,150 +82,172 @@ static const string EndpointName{"/ins"};
 
 using namespace NXOSResponse;
 
-static string createApplyRouteIpv6Command(const string& srcSubnet,
-                                          const string& dstAddr) {
-    const string Ipv6RouteCommandPrefix{"ipv6 route "};
-    return Ipv6RouteCommandPrefix + srcSubnet + " " + dstAddr;
+// commands are written into buffers of pooled request context,
+// so their text is created only when request is sent
+static void createApplyRouteIpv6Command(string&                           out,
+                                        const RouteExport&                route,
+                                        const NXOSConnectionConfigParams& params) {
+    out.assign("ipv6 route ");
+    route.appendPrefixText(out);
+    out += ' ';
+    route.appendNexthopText(out);
+    // owner marks of the route
+    if (params.routeName) {
+        out += " name ";
+        out += *params.routeName;
+    }
+    if (params.routeTag) {
+        out += " tag ";
+        out += std::to_string(*params.routeTag);
+    }
+}
+
+static void createRemoveRouteIpv6Command(string& out, const RouteExport& route) {
+    out.assign("no ipv6 route ");
+    route.appendPrefixText(out);
+    out += ' ';
+    route.appendNexthopText(out);
+}
+
+static void createRemoveNDCacheEntryIpv6Command(string& out, const string& vlanIfName) {
+    out.assign("clear ipv6 neighbor ");
+    out += vlanIfName;
+    out += " force-delete";
+}
+
+static void createVrfContextCommand(string& out, VrfId vrfId) {
+    out.assign("vrf context ");
+    out += VrfNames::name(vrfId);
+}
+
+// show commands of non-default VRF name it at the end
+static void appendVrfScope(string& out, VrfId vrfId) {
+    if (vrfId == DefaultVrfId) { return; }
+    out += " vrf ";
+    out += VrfNames::name(vrfId);
+}
+
+// route commands of non-default VRF are entered under its context with id 1,
+// ND cache command isn't VRF-scoped and goes last. `vrfCommand` is buffer
+// of the context command
+static void encodeRouteRequest(string&          out,
+                               string&          vrfCommand,
+                               VrfId            vrfId,
+                               std::string_view command,
+                               std::string_view ndCacheCommand = {}) {
+    out.assign("[");
+    int id{1};
+    if (vrfId != DefaultVrfId) {
+        createVrfContextCommand(vrfCommand, vrfId);
+        JsonRpcUtils::appendRequestCommand(out, id++, vrfCommand);
+    }
+    JsonRpcUtils::appendRequestCommand(out, id++, command);
+    if (!ndCacheCommand.empty()) {
+        JsonRpcUtils::appendRequestCommand(out, id++, ndCacheCommand);
+    }
+    out += ']';
 }
 
-static string createMappingVlanAddrToVlanIdCommand(const string& vlanAddr) {
-    const string Ipv6RouteVlanAddrCommandPrefix{"show ipv6 route "};
-    return Ipv6RouteVlanAddrCommandPrefix + vlanAddr;
+// interface names are unique across VRFs, so neighbors of all VRFs share one map
+static string createShowIPv6NeighbourCommand(bool allVrfs) {
+    return allVrfs ? "show ipv6 neighbor vrf all" : "show ipv6 neighbor";
 }
 
-static string createShowIPv6NeighbourCommand() { return "show ipv6 neighbor"; }
+static string createShowIPv6StaticRoutesCommand(bool allVrfs) {
+    return allVrfs ? "show ipv6 route static vrf all" : "show ipv6 route static";
+}
+
+// lookup of single address must resolve into exactly one path.
+// Returns nullptr when switch has no route for the address
+static const RowPath* findSingleRoutePath(const RouteLookupResponse& routeLookup) {
+    if (routeLookup.table_vrf.size() != 1) {
+        isc_throw(isc::BadValue,
+                  "field \"TABLE_vrf\" of response does not contain exactly 1 item");
+    }
+    const auto& vrfRow{routeLookup.table_vrf[0]};
+    if (vrfRow.table_addrf.size() != 1) {
+        isc_throw(isc::BadValue,
+                  "field \"TABLE_addrf\" of response does not contain exactly 1 item");
+    }
+    const auto& addrfRow{vrfRow.table_addrf[0]};
+    if (!addrfRow.table_prefix.has_value() || addrfRow.table_prefix->empty()) {
+        return nullptr;
+    }
+    // just use first match
+    const auto& prefixRow{addrfRow.table_prefix->front()};
+    if (prefixRow.table_path.size() != 1) {
+        isc_throw(isc::BadValue, "field \"TABLE_path\" does not contain exactly 1 item");
+    }
+    return &prefixRow.table_path[0];
+}
+
+// address of "show ipv6 route <addr>" command
+static string lookupAddressText(const RouteExport& route, bool relayLookup) {
+    string address;
+    if (relayLookup) {
+        route.nexthop.appendText(address);
+        address += "/128";
+    } else {
+        route.appendPrefixText(address);
+    }
+    return address;
+}
+
+static const char* lookupAddressType(const RouteExport& route, bool relayLookup) {
+    return relayLookup ? "RELAY_ADDRESS" : route.toDHCPv6IATypeString();
+}
+
+NXOSManagementClient::RouteRequestContext*
+    NXOSManagementClient::acquireRequestContext(const RouteExport& route,
+                                                RouteRequestStage  stage,
+                                                bool               remove) {
+    auto* context{m_requestPool.acquire()};
+    context->owner  = this;
+    context->route  = route;
+    context->stage  = stage;
+    context->remove = remove;
+    // results of configuration commands are ignored
+    context->validateOnly =
+        stage == RouteRequestStage::APPLY || stage == RouteRequestStage::REMOVE;
+    return context;
+}
+
+void NXOSManagementClient::startRouteLookup(const RouteExport& route,
+                                            RouteRequestStage  stage,
+                                            bool               remove) {
+    auto* context{acquireRequestContext(route, stage, remove)};
+    context->command.assign("show ipv6 route ");
+    if (stage == RouteRequestStage::LOOKUP_RELAY_VLAN) {
+        route.nexthop.appendText(context->command);
+        context->command += "/128";
+    } else {
+        route.appendPrefixText(context->command);
+    }
+    appendVrfScope(context->command, route.vrfId);
+    JsonRpcUtils::encodeRequestFromCommands(context->requestBody,
+                                            {{1, context->command}});
+    m_httpClient->sendRequest(m_params.connInfo.url, EndpointName, *context);
+}
 
 void NXOSManagementClient::sendRoutesToSwitch(const RouteExport& route) {
-    auto dhcpv6TypeStr{route.toDHCPv6IATypeString()};
     try {
-        if (std::holds_alternative<IA_NAInfo>(route.routeInfo)) {
-            const auto& iaNAInfo{std::get<IA_NAInfo>(route.routeInfo)};
-            string      linkAddrStr{iaNAInfo.srcVlanAddr.toText() + "/128"};
-            string      iaNAAddrStr{iaNAInfo.ia_naAddr.toText() + "/128"};
-
-            // get mapping vlan addr -> vlan id
-            // if we handle IA_NA lease we need to receive mapping
-            // from link-addr to vlan id
-
-            string linkAddrType{"RELAY_ADDRESS"};
-            asyncLookupAddressInternal(
-                linkAddrStr, linkAddrType,
-                [this, iaNAAddrStr, linkAddrStr,
-                 dhcpv6TypeStr](const RouteLookupResponse& routeLookup) {
-                    string vlanIfName;
-                    try {
-                        // we know that link-address maps to one vlan.
-                        // Otherwise, this is a error condition
-                        if (routeLookup.table_vrf.size() != 1) {
-                            isc_throw(
-                                isc::BadValue,
-                                "field \"TABLE_vrf\" of response does not contain exactly 1 item");
-                        }
-                        const auto& vrfRow{routeLookup.table_vrf[0]};
-                        if (vrfRow.table_addrf.size() != 1) {
-                            isc_throw(
-                                isc::BadValue,
-                                "field \"TABLE_addrf\" of response does not contain exactly 1 item");
-                        }
-                        const auto& addrfRow{vrfRow.table_addrf[0]};
-                        if (!addrfRow.table_prefix.has_value() &&
-                            addrfRow.table_prefix->size() != 1) {
-                            isc_throw(
-                                isc::BadValue,
-                                "field \"TABLE_prefix\" does not contain exactly 1 item");
-                        }
-                        const auto& prefixRow{(*addrfRow.table_prefix)[0]};
-                        const auto& ipprefix{prefixRow.ipprefix};
-                        if (prefixRow.table_path.size() != 1) {
-                            isc_throw(
-                                isc::BadValue,
-                                "field \"TABLE_path\" does not contain exactly 1 item");
-                        }
-
-                        const auto& ifnames{prefixRow.table_path[0].ifname};
-                        auto        resultIt{std::find_if(
-                            ifnames.begin(), ifnames.end(),
-                            [](const auto& ifname) { return ifname.has_value(); })};
-                        if (resultIt == ifnames.end()) {
-                            isc_throw(isc::BadValue, "vlan interface id is empty");
-                        }
-                        vlanIfName = **resultIt;
-                    } catch (const isc::BadValue& ex) {
-                        LOG_ERROR(DHCP6ExporterLogger,
-                                  DHCP6_EXPORTER_NXOS_RESPONSE_VLAN_ADDR_MAPPING_ERROR)
-                            .arg(connectionName())
-                            .arg(ex.what());
-                        return;
-                    } catch (const std::exception& ex) {
-                        LOG_ERROR(DHCP6ExporterLogger,
-                                  DHCP6_EXPORTER_NXOS_RESPONSE_PARSE_ERROR)
-                            .arg(connectionName())
-                            .arg(RouteLookupResponse::name())
-                            .arg(ex.what());
-                        return;
-                    }
-                    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
-                              DHCP6_EXPORTER_NXOS_RESPONSE_VLAN_ADDR_MAPPING_TRACE_DATA)
-                        .arg(connectionName())
-                        .arg(linkAddrStr)
-                        .arg(vlanIfName);
-
-                    // after we receive vlanIfName, send actual route
-                    m_httpClient->sendRequest(
-                        m_params.connInfo.url, EndpointName,
-                        {},    // TODO: correct handle tls
-                        JsonRpcUtils::createRequestFromCommands(
-                            1, createApplyRouteIpv6Command(iaNAAddrStr, vlanIfName)),
-                        [this, iaNAAddrStr, vlanIfName,
-                         dhcpv6TypeStr](JsonRpcResponsePtr            response,
-                                        NXOSHttpClient::ResponseError responseError,
-                                        NXOSHttpClient::StatusCode    statusCode,
-                                        JsonRpcExceptionPtr           jsonRpcException) {
-                            handleRouteApply(dhcpv6TypeStr, response, iaNAAddrStr,
-                                             vlanIfName, responseError, statusCode,
-                                             jsonRpcException);
-                        });
-                });
-        } else if (std::holds_alternative<IA_NAFast>(route.routeInfo)) {
-            const auto& iaNAInfo{std::get<IA_NAFast>(route.routeInfo)};
-            string      vlanIfName{iaNAInfo.srcVlanIfName};
-            string      iaNAAddrStr{iaNAInfo.ia_naAddr.toText() + "/128"};
-            // we have all required info, just send route
-            m_httpClient->sendRequest(
-                m_params.connInfo.url, EndpointName, {},    // TODO: correct handle tls
-                JsonRpcUtils::createRequestFromCommands(
-                    1, createApplyRouteIpv6Command(iaNAAddrStr, vlanIfName)),
-                [this, iaNAAddrStr, vlanIfName,
-                 dhcpv6TypeStr](JsonRpcResponsePtr            response,
-                                NXOSHttpClient::ResponseError responseError,
-                                NXOSHttpClient::StatusCode    statusCode,
-                                JsonRpcExceptionPtr           jsonRpcException) {
-                    handleRouteApply(dhcpv6TypeStr, response, iaNAAddrStr, vlanIfName,
-                                     responseError, statusCode, jsonRpcException);
-                });
-        } else if (std::holds_alternative<IA_PDInfo>(route.routeInfo)) {
-            const auto& iaPDInfo{std::get<IA_PDInfo>(route.routeInfo)};
-            string      srcIA_PDSubnetStr{iaPDInfo.ia_pdPrefix.toText() + "/" +
-                                     std::to_string(iaPDInfo.ia_pdLength)};
-            string      dstIA_NAAddrStr{iaPDInfo.dstIa_naAddr.toText()};
-
-            m_httpClient->sendRequest(
-                m_params.connInfo.url, EndpointName, {},
-                JsonRpcUtils::createRequestFromCommands(
-                    1, createApplyRouteIpv6Command(srcIA_PDSubnetStr, dstIA_NAAddrStr)),
-                [this, srcIA_PDSubnetStr, dstIA_NAAddrStr,
-                 dhcpv6TypeStr](JsonRpcResponsePtr            response,
-                                NXOSHttpClient::ResponseError responseError,
-                                NXOSHttpClient::StatusCode    statusCode,
-                                JsonRpcExceptionPtr           jsonRpcException) {
-                    handleRouteApply(dhcpv6TypeStr, response, srcIA_PDSubnetStr,
-                                     dstIA_NAAddrStr, responseError, statusCode,
-                                     jsonRpcException);
-                });
-        } else {
-            isc_throw(isc::NotImplemented, "not implemented IA route info");
+        switch (route.type) {
+            case RouteExportType::IA_NA: {
+                // get mapping vlan addr -> vlan id
+                // if we handle IA_NA lease we need to receive mapping
+                // from link-addr to vlan id
+                startRouteLookup(route, RouteRequestStage::LOOKUP_RELAY_VLAN,
+                                 /*remove=*/false);
+            } break;
+            case RouteExportType::IA_NAFast:
+            case RouteExportType::IA_PD: {
+                // we have all required info, just send route
+                applyRouteOnSwitch(route);
+            } break;
+            default: {
+                isc_throw(isc::NotImplemented, "not implemented IA route info");
+            }
         }
-
     } catch (const std::exception& ex) {
         LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_ROUTE_APPLY_UNKNOWN_ERROR)
             .arg(connectionName())
@@ -208,417 +255,795 @@ void NXOSManagementClient::sendRoutesToSwitch(const RouteExport& route) {
     }
 }
 
-static string createRemoveRouteIpv6Command(const string& srcSubnet,
-                                           const string& dstAddr) {
-    const string Ipv6RouteCommandPrefix{"no ipv6 route "};
-    return Ipv6RouteCommandPrefix + srcSubnet + " " + dstAddr;
+const char* NXOSManagementClient::RouteRequestContext::spanName() const {
+    switch (stage) {
+        case Stage::LOOKUP_RELAY_VLAN: return "nxos.lookup_relay_vlan";
+        case Stage::LOOKUP_VLAN: return "nxos.lookup_vlan";
+        case Stage::LOOKUP_NEXTHOP: return "nxos.lookup_nexthop";
+        case Stage::APPLY: return "nxos.apply";
+        case Stage::REMOVE: return "nxos.remove";
+    }
+    return "nxos.request";
 }
 
-static string createRemoveNDCacheEntryIpv6Command(const string& vlanIfName) {
-    const string Ipv6RemoveNDCacheEntryPrefix{"clear ipv6 neighbor "};
-    const string ForceDeleteSuffix{" force-delete"};
-    return Ipv6RemoveNDCacheEntryPrefix + vlanIfName + ForceDeleteSuffix;
+void NXOSManagementClient::handleRouteRequest(RouteRequestContext& context) {
+    if (context.sentAt) {
+        // time in worker queue and round trip of the request itself
+        SpanTracer::record("nxos.queue", context.route, context.sentAt,
+                           context.startedAt);
+        SpanTracer::record(context.spanName(), context.route,
+                           context.startedAt, SpanTracer::now(), context.statusCode,
+                           context.responseError != NXOSHttpClient::SUCCESS ||
+                               context.exception.has_value());
+    }
+    switch (context.stage) {
+        case RouteRequestStage::APPLY: {
+            handleRouteApply(context.route, context);
+            m_requestPool.release(&context);
+        } break;
+        case RouteRequestStage::REMOVE: {
+            handleRouteRemove(context.route, context);
+            m_requestPool.release(&context);
+        } break;
+        default: {
+            auto resolvedRoute{resolveRouteLookup(context)};
+            bool remove{context.remove};
+            // context is free before next stage, so next stage reuses it
+            m_requestPool.release(&context);
+            if (!resolvedRoute) { return; }
+            if (!remove) {
+                applyRouteOnSwitch(*resolvedRoute);
+            } else {
+                // for IA_NA route also remove IPv6 ND cache entry for interface
+                bool clearNDCache{resolvedRoute->type == RouteExportType::IA_NAFast};
+                removeRouteOnSwitch(*resolvedRoute, clearNDCache);
+            }
+        } break;
+    }
 }
 
-void NXOSManagementClient::asyncLookupAddressInternal(
-    const string&                       lookupAddrStr,
-    const string&                       lookupAddrType,
-    const AddressLookupHandlerInternal& responseHandler) {
-    m_httpClient->sendRequest(
-        m_params.connInfo.url, EndpointName, {},
-        JsonRpcUtils::createRequestFromCommands(
-            1, createMappingVlanAddrToVlanIdCommand(lookupAddrStr)),
-        [this, responseHandler, lookupAddrStr, lookupAddrType](
-            JsonRpcResponsePtr response, NXOSHttpClient::ResponseError responseError,
-            NXOSHttpClient::StatusCode statusCode, JsonRpcExceptionPtr jsonRpcException) {
-            RouteLookupResponse routeLookup;
-            try {
-                if (!response || (response && response->empty())) {
-                    isc_throw(isc::Unexpected, "received empty response");
-                }
-                // because we request only 1 command,
-                // so it's safe to just access first item of response
-                const auto& routeLookupRaw{response->front().result["body"]};
-                LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
-                          DHCP6_EXPORTER_NXOS_RESPONSE_ADDR_LOOKUP_RECEIVED)
-                    .arg(connectionName())
-                    .arg(lookupAddrStr)
-                    .arg(lookupAddrType);
-                LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
-                          DHCP6_EXPORTER_NXOS_RESPONSE_ADDR_LOOKUP_RECEIVED_TRACE_DATA)
-                    .arg(connectionName())
-                    .arg(lookupAddrStr)
-                    .arg(lookupAddrType)
-                    .arg(routeLookupRaw.dump());
+std::optional<RouteExport>
+    NXOSManagementClient::resolveRouteLookup(const RouteRequestContext& context) {
+    RouteLookupResponse routeLookup;
+    bool relayLookup{context.stage == RouteRequestStage::LOOKUP_RELAY_VLAN};
+    try {
+        if (context.exception) { throw *context.exception; }
+        if (context.responses.empty()) {
+            isc_throw(isc::Unexpected, "received empty response");
+        }
+        // because we request only 1 command,
+        // so it's safe to just access first item of response
+        const auto& routeLookupRaw{context.responses.front().result["body"]};
+        LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
+                  DHCP6_EXPORTER_NXOS_RESPONSE_ADDR_LOOKUP_RECEIVED)
+            .arg(connectionName())
+            .arg(lookupAddressText(context.route, relayLookup))
+            .arg(lookupAddressType(context.route, relayLookup));
+        LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
+                  DHCP6_EXPORTER_NXOS_RESPONSE_ADDR_LOOKUP_RECEIVED_TRACE_DATA)
+            .arg(connectionName())
+            .arg(lookupAddressText(context.route, relayLookup))
+            .arg(lookupAddressType(context.route, relayLookup))
+            .arg(routeLookupRaw.dump());
+
+        routeLookup = routeLookupRaw.get<RouteLookupResponse>();
+    } catch (const std::exception& ex) {
+        LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_RESPONSE_PARSE_ERROR)
+            .arg(connectionName())
+            .arg(RouteLookupResponse::name())
+            .arg(ex.what());
+        return std::nullopt;
+    }
 
-                routeLookup = routeLookupRaw.get<RouteLookupResponse>();
-            } catch (const std::exception& ex) {
-                LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_RESPONSE_PARSE_ERROR)
+    auto resolvedRoute{context.route};
+    try {
+        // we know that address maps to one path.
+        // Otherwise, this is a error condition
+        const auto* path{findSingleRoutePath(routeLookup)};
+        if (context.stage == RouteRequestStage::LOOKUP_NEXTHOP) {
+            if (!path) {
+                // nothing we can remove
+                LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
+                          DHCP6_EXPORTER_NXOS_RESPONSE_FAILED)
+                    .arg(context.route.toDHCPv6IATypeString())
                     .arg(connectionName())
-                    .arg(RouteLookupResponse::name())
-                    .arg(ex.what());
-                return;
+                    .arg(lookupAddressText(context.route, relayLookup));
+                return std::nullopt;
             }
-            if (responseHandler) { responseHandler(routeLookup); }
-        });
-}
-
-// convert mac-address from format "f6a5.486e.8aad"
-// into "f6:a5:48:6e:8a:ad" that compatible with Kea HWAddr
-static isc::dhcp::HWAddr fromRawCiscoString(const string& rawMac) {
-    std::string mac;
-    {
-        for (size_t i = 0, cnt = 0; i < rawMac.length(); ++i) {
-            if (rawMac[i] == '.') { continue; }
-            if (cnt > 0 && cnt % 2 == 0) { mac += ':'; }
-            mac += rawMac[i];
-            ++cnt;
+            // find first ROW_path that have "ipnexthop" field
+            const auto& ipnexthop{path->ipnexthop};
+            auto        resultIt{std::find_if(
+                ipnexthop.begin(), ipnexthop.end(),
+                [](const auto& nexthop) { return nexthop.has_value(); })};
+            if (resultIt == ipnexthop.end()) {
+                isc_throw(isc::BadValue, "can't find IA_NA address");
+            }
+            resolvedRoute.type = RouteExportType::IA_PD;
+            resolvedRoute.nexthop =
+                RouteAddress::fromIOAddress(isc::asiolink::IOAddress(**resultIt));
+        } else {
+            if (!path) { isc_throw(isc::BadValue, "field \"TABLE_prefix\" is empty"); }
+            // IA_NA addr may also be routed through non-vlan interfaces
+            bool        vlanOnly{context.stage == RouteRequestStage::LOOKUP_VLAN};
+            const auto& ifnames{path->ifname};
+            auto        resultIt{std::find_if(
+                ifnames.begin(), ifnames.end(), [vlanOnly](const auto& ifname) {
+                    return ifname.has_value() &&
+                           (!vlanOnly || isVlanInterfaceName(*ifname));
+                })};
+            if (resultIt == ifnames.end()) {
+                isc_throw(isc::BadValue, "can't find vlan interface id");
+            }
+            resolvedRoute.type    = RouteExportType::IA_NAFast;
+            resolvedRoute.ifId    = InterfaceNames::intern(**resultIt);
+            resolvedRoute.nexthop = {};
         }
+    } catch (const std::exception& ex) {
+        LOG_ERROR(DHCP6ExporterLogger,
+                  DHCP6_EXPORTER_NXOS_RESPONSE_VLAN_ADDR_MAPPING_ERROR)
+            .arg(connectionName())
+            .arg(ex.what());
+        return std::nullopt;
     }
-    return isc::dhcp::HWAddr::fromText(mac);
+
+    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
+              DHCP6_EXPORTER_NXOS_RESPONSE_IA_TYPE_ADDR_MAPPING_TRACE_DATA)
+        .arg(lookupAddressType(context.route, relayLookup))
+        .arg(connectionName())
+        .arg(lookupAddressText(context.route, relayLookup))
+        .arg(resolvedRoute.nexthopText());
+    return resolvedRoute;
 }
 
+namespace {
+    // NX-OS puts single row as object and many rows as array, same is true
+    // for table itself, so row is any object one level below `ROW_*` key
+    struct TableRowTracker {
+        std::string_view rowKey;
+        // depth of object which holds `rowKey`
+        int keyDepth{-1};
+        // depth of current row object, -1 outside of row
+        int rowDepth{-1};
+
+        void onKey(int depth, std::string_view key) {
+            if (key == rowKey) {
+                keyDepth = depth;
+            } else if (depth == keyDepth) {
+                keyDepth = -1;
+            }
+        }
+
+        bool startObject(int depth) {
+            if (keyDepth < 0 || depth != keyDepth + 1) { return false; }
+            rowDepth = depth;
+            return true;
+        }
+
+        bool endObject(int depth) {
+            if (depth == keyDepth) { keyDepth = -1; }
+            if (depth != rowDepth) { return false; }
+            rowDepth = -1;
+            return true;
+        }
+
+        bool inRow(int depth) const { return depth == rowDepth; }
+    };
+
+    // "show ipv6 neighbor" body is consumed while it is received: no rows are
+    // stored, MAC is decoded directly into integer and interface name is interned
+    class NeighborTableStreamHandler : public JsonStreamParser::Handler {
+      public:
+        HWAddrInterfaceMap map;
+
+      public:
+        void onStartObject() override {
+            ++m_depth;
+            if (m_adj.startObject(m_depth)) {
+                m_ifName.clear();
+                m_hasMac = false;
+            }
+            m_field = Field::NONE;
+        }
+
+        void onEndObject() override {
+            if (m_adj.endObject(m_depth)) { ingestRow(); }
+            --m_depth;
+            m_field = Field::NONE;
+        }
+
+        void onStartArray() override { m_field = Field::NONE; }
+
+        void onEndArray() override {}
+
+        void onKey(std::string_view key) override {
+            m_adj.onKey(m_depth, key);
+            m_field = Field::NONE;
+            if (!m_adj.inRow(m_depth)) { return; }
+            if (key == "intf-out") {
+                m_field = Field::INTF_OUT;
+            } else if (key == "mac") {
+                m_field = Field::MAC;
+            }
+        }
+
+        void onString(std::string_view value) override {
+            if (m_field == Field::INTF_OUT) {
+                m_ifName.assign(value);
+            } else if (m_field == Field::MAC) {
+                m_hasMac = HWAddrInterfaceMap::parseCiscoMac(value, m_mac);
+            }
+            m_field = Field::NONE;
+        }
+
+        void onLiteral(std::string_view /*value*/) override { m_field = Field::NONE; }
+
+      private:
+        enum class Field : uint8_t { NONE, INTF_OUT, MAC };
+
+        TableRowTracker            m_adj{"ROW_adj"};
+        int                        m_depth{0};
+        Field                      m_field{Field::NONE};
+        string                     m_ifName;
+        HWAddrInterfaceMap::MacKey m_mac{0};
+        bool                       m_hasMac{false};
+        // neighbors are grouped by interface, so most rows hit previous name
+        string      m_lastIfName;
+        InterfaceId m_lastIfId{NoInterfaceId};
+
+      private:
+        void ingestRow() {
+            if (!m_hasMac || !isVlanInterfaceName(m_ifName)) { return; }
+            if (m_lastIfId == NoInterfaceId || m_ifName != m_lastIfName) {
+                m_lastIfId   = InterfaceNames::intern(m_ifName);
+                m_lastIfName = m_ifName;
+            }
+            map.insert(m_mac, m_lastIfId);
+        }
+    };
+
+    // "show ipv6 route static" body is consumed while it is received,
+    // only installed routes are kept. With owner tag only paths with this tag
+    // are kept, CLI of NX-OS can't filter static routes by tag.
+    // With "vrf all" only default VRF and VRFs of export are kept
+    class StaticRouteStreamHandler : public JsonStreamParser::Handler {
+      public:
+        ManagementClient::InstalledRoutes routes;
+
+      public:
+        StaticRouteStreamHandler(std::optional<uint32_t> ownerTag,
+                                 std::vector<VrfId>      exportVrfs) :
+            m_exportVrfs(std::move(exportVrfs)) {
+            if (ownerTag) { m_ownerTag = std::to_string(*ownerTag); }
+        }
+
+        void onStartObject() override {
+            ++m_depth;
+            if (m_vrf.startObject(m_depth)) {
+                m_vrfId = DefaultVrfId;
+            } else if (m_prefix.startObject(m_depth)) {
+                m_ipprefix.clear();
+                m_nexthops.clear();
+            } else if (m_path.startObject(m_depth)) {
+                m_ipnexthop.clear();
+                m_ifname.clear();
+                m_tag.clear();
+            }
+            m_field = Field::NONE;
+        }
+
+        void onEndObject() override {
+            if (m_path.endObject(m_depth)) {
+                // route to interface has no nexthop address
+                const auto& nexthop{m_ipnexthop.empty() ? m_ifname : m_ipnexthop};
+                if (!nexthop.empty() && (!m_ownerTag || *m_ownerTag == m_tag)) {
+                    m_nexthops.push_back(nexthop);
+                }
+            }
+            if (m_prefix.endObject(m_depth) && !m_ipprefix.empty() && isExportVrf()) {
+                for (auto& nexthop : m_nexthops) {
+                    routes.push_back({m_ipprefix, std::move(nexthop), m_vrfId});
+                }
+            }
+            m_vrf.endObject(m_depth);
+            --m_depth;
+            m_field = Field::NONE;
+        }
+
+        void onStartArray() override { m_field = Field::NONE; }
+
+        void onEndArray() override {}
+
+        void onKey(std::string_view key) override {
+            m_vrf.onKey(m_depth, key);
+            m_prefix.onKey(m_depth, key);
+            m_path.onKey(m_depth, key);
+            m_field = Field::NONE;
+            if (m_vrf.inRow(m_depth)) {
+                if (key == "vrf-name-out") { m_field = Field::VRF_NAME; }
+            } else if (m_prefix.inRow(m_depth)) {
+                if (key == "ipprefix") { m_field = Field::IPPREFIX; }
+            } else if (m_path.inRow(m_depth)) {
+                if (key == "ipnexthop") {
+                    m_field = Field::IPNEXTHOP;
+                } else if (key == "ifname") {
+                    m_field = Field::IFNAME;
+                } else if (key == "tag") {
+                    m_field = Field::TAG;
+                }
+            }
+        }
+
+        void onString(std::string_view value) override {
+            switch (m_field) {
+                case Field::VRF_NAME: m_vrfId = VrfNames::intern(string(value)); break;
+                case Field::IPPREFIX: m_ipprefix.assign(value); break;
+                case Field::IPNEXTHOP: m_ipnexthop.assign(value); break;
+                case Field::IFNAME: m_ifname.assign(value); break;
+                case Field::TAG: m_tag.assign(value); break;
+                case Field::NONE: break;
+            }
+            m_field = Field::NONE;
+        }
+
+        void onLiteral(std::string_view value) override {
+            // tag is a number in some NX-OS releases
+            if (m_field == Field::TAG) { m_tag.assign(value); }
+            m_field = Field::NONE;
+        }
+
+      private:
+        enum class Field : uint8_t { NONE, VRF_NAME, IPPREFIX, IPNEXTHOP, IFNAME, TAG };
+
+        TableRowTracker     m_vrf{"ROW_vrf"};
+        TableRowTracker     m_prefix{"ROW_prefix"};
+        TableRowTracker     m_path{"ROW_path"};
+        int                 m_depth{0};
+        Field               m_field{Field::NONE};
+        string              m_ipprefix;
+        string              m_ipnexthop;
+        string              m_ifname;
+        string              m_tag;
+        std::vector<string> m_nexthops;
+        // empty if all static routes are kept
+        std::optional<string> m_ownerTag;
+        std::vector<VrfId>    m_exportVrfs;
+        VrfId                 m_vrfId{DefaultVrfId};
+
+      private:
+        bool isExportVrf() const {
+            return m_vrfId == DefaultVrfId ||
+                   std::find(m_exportVrfs.begin(), m_exportVrfs.end(), m_vrfId) !=
+                       m_exportVrfs.end();
+        }
+    };
+}    // namespace
+
 void NXOSManagementClient::asyncGetHWAddrToInterfaceNameMapping(
     const HWAddrMappingHandler& handler) {
-    m_httpClient->sendRequest(
-        m_params.connInfo.url, EndpointName, {},
-        JsonRpcUtils::createRequestFromCommands(1, createShowIPv6NeighbourCommand()),
-        [this, handler](
-            JsonRpcResponsePtr response, NXOSHttpClient::ResponseError responseError,
-            NXOSHttpClient::StatusCode statusCode, JsonRpcExceptionPtr jsonRpcException) {
-            NeighborLookupResponse neighborLookup;
-            HWAddrMap              map;
-            bool                   connectionOrEarlyValidationFailed{false};
+    auto neighbors{boost::make_shared<NeighborTableStreamHandler>()};
+    m_httpClient->sendStreamingRequest(
+        m_params.connInfo.url, EndpointName,
+        JsonRpcUtils::createRequestFromCommands(
+            1, createShowIPv6NeighbourCommand(!m_exportVrfs.empty())),
+        neighbors,
+        [this, handler, neighbors](NXOSHttpClient::ResponseError responseError,
+                                   NXOSHttpClient::StatusCode    statusCode,
+                                   JsonRpcExceptionPtr           jsonRpcException) {
+            bool connectionOrEarlyValidationFailed{false};
             if (responseError == NXOSHttpClient::ResponseError::SUCCESS &&
-                statusCode == 200) {
-                try {
-                    if (jsonRpcException) { throw *jsonRpcException; }
-                    // because we request only 1 command,
-                    // so it's safe to just access first item of response
-                    const auto& neighborLookupRaw{response->front().result["body"]};
-                    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
-                              DHCP6_EXPORTER_NXOS_RESPONSE_NEIGHBOR_LOOKUP_RECEIVED)
-                        .arg(connectionName());
-                    LOG_DEBUG(
-                        DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
-                        DHCP6_EXPORTER_NXOS_RESPONSE_NEIGHBOR_LOOKUP_RECEIVED_TRACE_DATA)
-                        .arg(connectionName())
-                        .arg(neighborLookupRaw.dump());
-
-                    neighborLookup = neighborLookupRaw.get<NeighborLookupResponse>();
-                } catch (const std::exception& ex) {
+                statusCode == 200 && !jsonRpcException) {
+                LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
+                          DHCP6_EXPORTER_NXOS_RESPONSE_NEIGHBOR_LOOKUP_RECEIVED)
+                    .arg(connectionName());
+            } else {
+                if (jsonRpcException) {
                     LOG_ERROR(DHCP6ExporterLogger,
                               DHCP6_EXPORTER_NXOS_RESPONSE_PARSE_ERROR)
                         .arg(connectionName())
-                        .arg(decltype(neighborLookup)::name())
-                        .arg(ex.what());
-                    connectionOrEarlyValidationFailed = true;
-                }
-
-                for (const auto& vrf : neighborLookup.table_vrf) {
-                    for (const auto& afi : vrf.table_afi) {
-                        for (const auto& adj : afi.table_adj) {
-                            for (const auto& object : adj.table_object) {
-                                const auto& rawMac{object.mac};
-                                const auto& ifName{object.intf_out};
-                                if (isValidVlanName(ifName)) {
-                                    map[fromRawCiscoString(rawMac)] = ifName;
-                                }
-                            }
-                        }
-                    }
+                        .arg(NeighborLookupResponse::name())
+                        .arg(jsonRpcException->what());
                 }
-            } else {
                 connectionOrEarlyValidationFailed = true;
             }
             if (handler) {
-                handler(std::make_shared<HWAddrMap>(std::move(map)),
+                handler(std::make_shared<HWAddrMap>(std::move(neighbors->map)),
                         connectionOrEarlyValidationFailed);
             }
         });
 }
 
-void NXOSManagementClient::removeRoutesFromSwitch(const RouteExport& route) {
-    auto dhcpv6TypeStr{route.toDHCPv6IATypeString()};
-    if (std::holds_alternative<IA_NAInfo>(route.routeInfo)) {
-        const auto& iaNAInfo{std::get<IA_NAInfo>(route.routeInfo)};
-        string      linkAddrStr{iaNAInfo.srcVlanAddr.toText() + "/128"};
-        string      iaNAAddrStr{iaNAInfo.ia_naAddr.toText() + "/128"};
-        // For IA_NA route we request info about vlan id from relay address.
-        // After this we remove route src: IA_NA, dst: received vlan id
-
-        // get mapping vlan addr -> vlan id
-        // if we handle IA_NA lease we need to receive mapping
-        // from link-addr to vlan id
-        string linkAddrType{"RELAY_ADDRESS"};
-        asyncLookupAddressInternal(
-            linkAddrStr, linkAddrType,
-            [this, iaNAAddrStr, linkAddrStr,
-             dhcpv6TypeStr](const RouteLookupResponse& routeLookup) {
-                string vlanIfName;
-                try {
-                    // we know that link-address maps to one vlan.
-                    // Otherwise, this is a error condition
-                    if (routeLookup.table_vrf.size() != 1) {
-                        isc_throw(
-                            isc::BadValue,
-                            "field \"TABLE_vrf\" of response does not contain exactly 1 item");
-                    }
-                    const auto& vrfRow{routeLookup.table_vrf[0]};
-                    if (vrfRow.table_addrf.size() != 1) {
-                        isc_throw(
-                            isc::BadValue,
-                            "field \"TABLE_addrf\" of response does not contain exactly 1 item");
-                    }
-                    const auto& addrfRow{vrfRow.table_addrf[0]};
-                    if (!addrfRow.table_prefix.has_value() &&
-                        addrfRow.table_prefix->size() != 1) {
-                        isc_throw(
-                            isc::BadValue,
-                            "field \"TABLE_prefix\" does not contain exactly 1 item");
-                    }
-                    const auto& prefixRow{(*addrfRow.table_prefix)[0]};
-                    const auto& ipprefix{prefixRow.ipprefix};
-                    if (prefixRow.table_path.size() != 1) {
-                        isc_throw(isc::BadValue,
-                                  "field \"TABLE_path\" does not contain exactly 1 item");
-                    }
-
-                    const auto& ifnames{prefixRow.table_path[0].ifname};
-                    auto        resultIt{std::find_if(
-                        ifnames.begin(), ifnames.end(),
-                        [](const auto& ifname) { return ifname.has_value(); })};
-                    if (resultIt == ifnames.end()) {
-                        isc_throw(isc::BadValue, "vlan interface id is empty");
-                    }
-                    vlanIfName = **resultIt;
-
-                } catch (const isc::BadValue& ex) {
-                    LOG_ERROR(DHCP6ExporterLogger,
-                              DHCP6_EXPORTER_NXOS_RESPONSE_VLAN_ADDR_MAPPING_ERROR)
-                        .arg(connectionName())
-                        .arg(ex.what());
-                    return;
-                } catch (const std::exception& ex) {
+void NXOSManagementClient::asyncGetInstalledRoutes(const InstalledRoutesHandler& handler) {
+    auto staticRoutes{
+        boost::make_shared<StaticRouteStreamHandler>(m_params.routeTag, m_exportVrfs)};
+    m_httpClient->sendStreamingRequest(
+        m_params.connInfo.url, EndpointName,
+        JsonRpcUtils::createRequestFromCommands(
+            1, createShowIPv6StaticRoutesCommand(!m_exportVrfs.empty())),
+        staticRoutes,
+        [this, handler, staticRoutes](NXOSHttpClient::ResponseError responseError,
+                                      NXOSHttpClient::StatusCode    statusCode,
+                                      JsonRpcExceptionPtr           jsonRpcException) {
+            bool connectionOrEarlyValidationFailed{false};
+            if (responseError != NXOSHttpClient::ResponseError::SUCCESS ||
+                statusCode != 200 || jsonRpcException) {
+                if (jsonRpcException) {
                     LOG_ERROR(DHCP6ExporterLogger,
                               DHCP6_EXPORTER_NXOS_RESPONSE_PARSE_ERROR)
                         .arg(connectionName())
                         .arg(RouteLookupResponse::name())
-                        .arg(ex.what());
-                    return;
-                }
-                LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
-                          DHCP6_EXPORTER_NXOS_RESPONSE_VLAN_ADDR_MAPPING_TRACE_DATA)
-                    .arg(connectionName())
-                    .arg(linkAddrStr)
-                    .arg(vlanIfName);
-
-                // after we receive vlanIfName, remove route
-                // also remove IPv6 ND cache entry for interface
-                m_httpClient->sendRequest(
-                    m_params.connInfo.url, EndpointName,
-                    {},    // TODO: correct handle tls
-                    JsonRpcUtils::createRequestFromCommands(
-                        {{1, createRemoveRouteIpv6Command(iaNAAddrStr, vlanIfName)},
-                         {2, createRemoveNDCacheEntryIpv6Command(vlanIfName)}}),
-                    [this, iaNAAddrStr, vlanIfName,
-                     dhcpv6TypeStr](JsonRpcResponsePtr            response,
-                                    NXOSHttpClient::ResponseError responseError,
-                                    NXOSHttpClient::StatusCode    statusCode,
-                                    JsonRpcExceptionPtr           jsonRpcException) {
-                        handleRouteRemove(dhcpv6TypeStr, response, iaNAAddrStr,
-                                          vlanIfName, responseError, statusCode,
-                                          jsonRpcException);
-                    });
-            });
-    } else if (std::holds_alternative<IA_PDInfo>(route.routeInfo)) {
-        const auto& iaPDInfo{std::get<IA_PDInfo>(route.routeInfo)};
-        string      srcIA_PDSubnetStr{iaPDInfo.ia_pdPrefix.toText() + "/" +
-                                 std::to_string(iaPDInfo.ia_pdLength)};
-        string      dstIA_NAAddrStr{iaPDInfo.dstIa_naAddr.toText()};
-
-        // now, send remove route request
-        m_httpClient->sendRequest(
-            m_params.connInfo.url, EndpointName, {},
-            JsonRpcUtils::createRequestFromCommands(
-                1, createRemoveRouteIpv6Command(srcIA_PDSubnetStr, dstIA_NAAddrStr)),
-            [this, dstIA_NAAddrStr, srcIA_PDSubnetStr, dhcpv6TypeStr](
-                JsonRpcResponsePtr response, NXOSHttpClient::ResponseError responseError,
-                NXOSHttpClient::StatusCode statusCode,
-                JsonRpcExceptionPtr        jsonRpcException) {
-                handleRouteRemove(dhcpv6TypeStr, response, srcIA_PDSubnetStr,
-                                  dstIA_NAAddrStr, responseError, statusCode,
-                                  jsonRpcException);
-            });
-    } else if (std::holds_alternative<IA_NAInfoFuzzyRemove>(route.routeInfo)) {
-        const auto& iaNAInfoFuzzy{std::get<IA_NAInfoFuzzyRemove>(route.routeInfo)};
-        string      iaNAAddrStr{iaNAInfoFuzzy.ia_naAddr.toText() + "/128"};
-
-        asyncLookupAddressInternal(
-            iaNAAddrStr, dhcpv6TypeStr,
-            [this, iaNAAddrStr, dhcpv6TypeStr](const RouteLookupResponse& response) {
-                if (response.table_vrf.size() != 1) {
-                    isc_throw(
-                        isc::BadValue,
-                        "field \"TABLE_vrf\" of response does not contain exactly 1 item");
-                }
-                const auto& vrfRow{response.table_vrf[0]};
-                if (vrfRow.table_addrf.size() != 1) {
-                    isc_throw(
-                        isc::BadValue,
-                        "field \"TABLE_addrf\" of response does not contain exactly 1 item");
-                }
-                const auto& addrfRow{vrfRow.table_addrf[0]};
-                if (!addrfRow.table_prefix.has_value() &&
-                    addrfRow.table_prefix->size() != 1) {
-                    isc_throw(isc::BadValue,
-                              "field \"TABLE_prefix\" does not contain exactly 1 item");
-                }
-                const auto& prefixRow{(*addrfRow.table_prefix)[0]};
-                const auto& ipprefix{prefixRow.ipprefix};
-                if (prefixRow.table_path.size() != 1) {
-                    isc_throw(isc::BadValue,
-                              "field \"TABLE_path\" does not contain exactly 1 item");
+                        .arg(jsonRpcException->what());
                 }
+                connectionOrEarlyValidationFailed = true;
+            }
+            if (handler) {
+                auto routes{std::make_shared<InstalledRoutes>(
+                    std::move(staticRoutes->routes))};
+                handler(routes, connectionOrEarlyValidationFailed);
+            }
+        });
+}
 
-                const auto& cont{prefixRow.table_path[0].ifname};
-                auto        resultIt{
-                    std::find_if(cont.begin(), cont.end(), [](const auto& ifname) {
-                        return ifname.has_value() && isValidVlanName(*ifname);
-                    })};
-                if (resultIt == cont.end()) {
-                    isc_throw(isc::BadValue, "can't find vlan interface id");
-                }
-                string vlanIfName{**resultIt};
+void NXOSManagementClient::removeRoutesFromSwitch(const RouteExport& route) {
+    switch (route.type) {
+        case RouteExportType::IA_NA: {
+            // For IA_NA route we request info about vlan id from relay address.
+            // After this we remove route src: IA_NA, dst: received vlan id
+            startRouteLookup(route, RouteRequestStage::LOOKUP_RELAY_VLAN,
+                             /*remove=*/true);
+        } break;
+        case RouteExportType::IA_NAFast: {
+            removeRouteOnSwitch(route, /*clearNDCache=*/true);
+        } break;
+        case RouteExportType::IA_PD: {
+            removeRouteOnSwitch(route, /*clearNDCache=*/false);
+        } break;
+        case RouteExportType::IA_NAFuzzyRemove: {
+            startRouteLookup(route, RouteRequestStage::LOOKUP_VLAN, /*remove=*/true);
+        } break;
+        case RouteExportType::IA_PDFuzzyRemove: {
+            // IA_NA lease lookup is done by caller, so only switch lookup is left
+            startRouteLookup(route, RouteRequestStage::LOOKUP_NEXTHOP, /*remove=*/true);
+        } break;
+    }
+}
+
+void NXOSManagementClient::applyRouteOnSwitch(const RouteExport& route) {
+    auto* context{
+        acquireRequestContext(route, RouteRequestStage::APPLY, /*remove=*/false)};
+    createApplyRouteIpv6Command(context->command, route, m_params);
+    encodeRouteRequest(context->requestBody, context->vrfCommand, route.vrfId,
+                       context->command);
+    m_httpClient->sendRequest(m_params.connInfo.url, EndpointName, *context);
+}
+
+void NXOSManagementClient::removeRouteOnSwitch(const RouteExport& route,
+                                               bool               clearNDCache) {
+    auto* context{
+        acquireRequestContext(route, RouteRequestStage::REMOVE, /*remove=*/true)};
+    createRemoveRouteIpv6Command(context->command, route);
+    if (clearNDCache) {
+        // for IA_NA route also remove IPv6 ND cache entry for interface
+        createRemoveNDCacheEntryIpv6Command(context->ndCacheCommand,
+                                            InterfaceNames::name(route.ifId));
+        encodeRouteRequest(context->requestBody, context->vrfCommand, route.vrfId,
+                           context->command, context->ndCacheCommand);
+    } else {
+        encodeRouteRequest(context->requestBody, context->vrfCommand, route.vrfId,
+                           context->command);
+    }
+    m_httpClient->sendRequest(m_params.connInfo.url, EndpointName, *context);
+}
 
-                LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
-                          DHCP6_EXPORTER_NXOS_RESPONSE_IA_TYPE_ADDR_MAPPING_TRACE_DATA)
-                    .arg(dhcpv6TypeStr)
+void NXOSManagementClient::handleBatchResult(const RouteBatcher::OperationsPtr& ops,
+                                             const string& failureReason) {
+    std::vector<std::pair<int, string>> commands;
+    std::unordered_set<InterfaceId>     interfaces;
+    for (const auto& op : *ops) {
+        if (!failureReason.empty()) {
+            TraceRing::record(op.remove ? TraceEventType::ROUTE_REMOVE_FAILED
+                                        : TraceEventType::ROUTE_APPLY_FAILED,
+                              op.route);
+            LOG_ERROR(DHCP6ExporterLogger,
+                      op.remove ? DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_REMOVE_FAILED
+                                : DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_APPLY_FAILED)
+                .arg(connectionName())
+                .arg(op.route.toDHCPv6IATypeString())
+                .arg(op.route.prefixText())
+                .arg(op.route.nexthopText())
+                .arg(failureReason);
+            continue;
+        }
+        TraceRing::record(op.remove ? TraceEventType::ROUTE_REMOVE_SUCCESS
+                                    : TraceEventType::ROUTE_APPLY_SUCCESS,
+                          op.route);
+        LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
+                  op.remove ? DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_REMOVE_SUCCESS
+                            : DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_APPLY_SUCCESS)
+            .arg(connectionName())
+            .arg(op.route.toDHCPv6IATypeString())
+            .arg(op.route.prefixText())
+            .arg(op.route.nexthopText());
+        if (op.remove && op.clearNDCache && interfaces.insert(op.route.ifId).second) {
+            string command;
+            createRemoveNDCacheEntryIpv6Command(command,
+                                                InterfaceNames::name(op.route.ifId));
+            commands.emplace_back(commands.size() + 1, std::move(command));
+        }
+    }
+    if (commands.empty()) { return; }
+    m_httpClient->sendRequest(
+        m_params.connInfo.url, EndpointName, {},
+        JsonRpcUtils::createRequestFromCommands(commands),
+        [this](JsonRpcResponsePtr response, NXOSHttpClient::ResponseError responseError,
+               NXOSHttpClient::StatusCode statusCode,
+               JsonRpcExceptionPtr        jsonRpcException) {
+            if (responseError != NXOSHttpClient::ResponseError::SUCCESS) {
+                LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_ND_CLEAR_FAILED)
+                    .arg(connectionName())
+                    .arg(NXOSHttpClient::ResponseErrorToString(responseError));
+            } else if (jsonRpcException) {
+                LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_ND_CLEAR_FAILED)
                     .arg(connectionName())
-                    .arg(iaNAAddrStr)
-                    .arg(vlanIfName);
-
-                // after we receive vlanIfName, remove route
-                // also remove IPv6 ND cache entry for interface
-                m_httpClient->sendRequest(
-                    m_params.connInfo.url, EndpointName,
-                    {},    // TODO: correct handle tls
-                    JsonRpcUtils::createRequestFromCommands(
-                        {{1, createRemoveRouteIpv6Command(iaNAAddrStr, vlanIfName)},
-                         {2, createRemoveNDCacheEntryIpv6Command(vlanIfName)}}),
-                    [this, iaNAAddrStr, vlanIfName,
-                     dhcpv6TypeStr](JsonRpcResponsePtr            response,
-                                    NXOSHttpClient::ResponseError responseError,
-                                    NXOSHttpClient::StatusCode    statusCode,
-                                    JsonRpcExceptionPtr           jsonRpcException) {
-                        handleRouteRemove(dhcpv6TypeStr, response, iaNAAddrStr,
-                                          vlanIfName, responseError, statusCode,
-                                          jsonRpcException);
-                    });
-            });
-    } else if (std::holds_alternative<IA_PDInfoFuzzyRemove>(route.routeInfo)) {
-        const auto& iaPDInfo{std::get<IA_PDInfoFuzzyRemove>(route.routeInfo)};
-        string      srcIA_PDSubnetStr{iaPDInfo.ia_pdPrefix.toText() + "/" +
-                                 std::to_string(iaPDInfo.ia_pdLength)};
-        auto        duid{route.duid};
-        auto        iaid{route.iaid};
-
-        // try to find IA_NA lease for given DUID + iaid in lease database
-        {
-            Lease6Ptr leaseIA_NA{LeaseUtils::findIA_NALeaseByDUID_IAID(duid, iaid)};
-            if (leaseIA_NA) {
-                auto dstIaNAAddrStr{leaseIA_NA->addr_.toText() + "/128"};
-                m_httpClient->sendRequest(
-                    m_params.connInfo.url, EndpointName,
-                    {},    // TODO: correct handle tls
-                    JsonRpcUtils::createRequestFromCommands(
-                        1,
-                        createRemoveRouteIpv6Command(srcIA_PDSubnetStr, dstIaNAAddrStr)),
-                    [this, dstIaNAAddrStr, srcIA_PDSubnetStr,
-                     dhcpv6TypeStr](JsonRpcResponsePtr            response,
-                                    NXOSHttpClient::ResponseError responseError,
-                                    NXOSHttpClient::StatusCode    statusCode,
-                                    JsonRpcExceptionPtr           jsonRpcException) {
-                        handleRouteRemove(dhcpv6TypeStr, response, srcIA_PDSubnetStr,
-                                          dstIaNAAddrStr, responseError, statusCode,
-                                          jsonRpcException);
-                    });
-                return;
+                    .arg(jsonRpcException->what());
             }
+        });
+}
+
+// request body of bulk chunk is kept below this size even with large chunk size
+static constexpr size_t MaxBulkRequestBytes{512 * 1024};
+// switch applies whole chunk before it answers
+static constexpr int BulkRequestTimeoutMs{60000};
+
+void NXOSManagementClient::applyRoutesBulk(RoutesPtr               routes,
+                                           const BulkApplyHandler& handler) {
+    startBulkApply(std::move(routes), /*remove=*/false, handler);
+}
+
+void NXOSManagementClient::removeRoutesBulk(RoutesPtr               routes,
+                                            const BulkApplyHandler& handler) {
+    startBulkApply(std::move(routes), /*remove=*/true, handler);
+}
+
+// route is a single CLI command, others need switch lookup first
+static bool isBulkRoute(const RouteExport& route) {
+    return route.type == RouteExportType::IA_PD ||
+           route.type == RouteExportType::IA_NAFast;
+}
+
+void NXOSManagementClient::startBulkApply(RoutesPtr               routes,
+                                          bool                    remove,
+                                          const BulkApplyHandler& handler) {
+    auto bulk{std::make_shared<BulkApply>()};
+    bool vrfScoped{std::any_of(routes->begin(), routes->end(), [](const auto& route) {
+        return route.vrfId != DefaultVrfId;
+    })};
+    if (vrfScoped || !std::all_of(routes->begin(), routes->end(), isBulkRoute)) {
+        // routes that need lookup go through common path before chunks are built,
+        // so rewind after failed command never sends them again
+        auto bulkRoutes{std::make_shared<Routes>()};
+        bulkRoutes->reserve(routes->size());
+        for (const auto& route : *routes) {
+            if (isBulkRoute(route)) {
+                bulkRoutes->push_back(route);
+                continue;
+            }
+            if (remove) {
+                removeRoutesFromSwitch(route);
+            } else {
+                sendRoutesToSwitch(route);
+            }
+            bulk->result.dispatched++;
         }
-        // fallback to switch lookup
-        asyncLookupAddressInternal(
-            srcIA_PDSubnetStr, dhcpv6TypeStr,
-            [this, srcIA_PDSubnetStr,
-             dhcpv6TypeStr](const RouteLookupResponse& response) {
-                if (response.table_vrf.size() != 1) {
-                    isc_throw(
-                        isc::BadValue,
-                        "field \"TABLE_vrf\" of response does not contain exactly 1 item");
-                }
-                const auto& vrfRow{response.table_vrf[0]};
-                if (vrfRow.table_addrf.size() != 1) {
-                    isc_throw(
-                        isc::BadValue,
-                        "field \"TABLE_addrf\" of response does not contain exactly 1 item");
-                }
-                const auto& addrfRow{vrfRow.table_addrf[0]};
-                if (!addrfRow.table_prefix.has_value() &&
-                    addrfRow.table_prefix->size() != 1) {
-                    // nothing we can remove
-                    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
-                              DHCP6_EXPORTER_NXOS_RESPONSE_FAILED)
-                        .arg(dhcpv6TypeStr)
-                        .arg(connectionName())
-                        .arg(srcIA_PDSubnetStr);
-                    return;
-                } else {
-                    // just use first match
-                    const auto& prefixRow{(*addrfRow.table_prefix)[0]};
-                    const auto& ipprefix{prefixRow.ipprefix};
-                    if (prefixRow.table_path.size() != 1) {
-                        isc_throw(isc::BadValue,
-                                  "field \"TABLE_path\" does not contain exactly 1 item");
-                    }
-                    // find first ROW_path that have "ipnexthop" field
-                    const auto& ipnexthop{prefixRow.table_path[0].ipnexthop};
-                    auto        resultIt{std::find_if(
-                        ipnexthop.begin(), ipnexthop.end(),
-                        [](const auto& nexthop) { return nexthop.has_value(); })};
-                    if (resultIt == ipnexthop.end()) {
-                        isc_throw(isc::BadValue, "can't find IA_NA address");
-                    }
-                    string iaNAAddrStr{**resultIt};
-
-                    LOG_DEBUG(
-                        DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
-                        DHCP6_EXPORTER_NXOS_RESPONSE_IA_TYPE_ADDR_MAPPING_TRACE_DATA)
-                        .arg(dhcpv6TypeStr)
-                        .arg(connectionName())
-                        .arg(srcIA_PDSubnetStr)
-                        .arg(iaNAAddrStr);
-
-                    // after we receive IA_NA addr, remove route
-                    m_httpClient->sendRequest(
-                        m_params.connInfo.url, EndpointName,
-                        {},    // TODO: correct handle tls
-                        JsonRpcUtils::createRequestFromCommands(
-                            1,
-                            createRemoveRouteIpv6Command(srcIA_PDSubnetStr, iaNAAddrStr)),
-                        [this, iaNAAddrStr, srcIA_PDSubnetStr,
-                         dhcpv6TypeStr](JsonRpcResponsePtr            response,
-                                        NXOSHttpClient::ResponseError responseError,
-                                        NXOSHttpClient::StatusCode    statusCode,
-                                        JsonRpcExceptionPtr           jsonRpcException) {
-                            handleRouteRemove(dhcpv6TypeStr, response, srcIA_PDSubnetStr,
-                                              iaNAAddrStr, responseError, statusCode,
-                                              jsonRpcException);
-                        });
-                }
-            });
+        // chunk holds routes of one VRF, so routes of a VRF go one after another
+        if (vrfScoped) {
+            std::stable_sort(bulkRoutes->begin(), bulkRoutes->end(),
+                             [](const RouteExport& lhs, const RouteExport& rhs) {
+                                 return lhs.vrfId < rhs.vrfId;
+                             });
+        }
+        routes = std::move(bulkRoutes);
+    }
+    bulk->routes    = std::move(routes);
+    bulk->remove    = remove;
+    bulk->handler   = handler;
+    bulk->startedAt = std::chrono::steady_clock::now();
+    bulk->chunkRoutes.reserve(m_params.bulkChunkSize);
+    sendBulkChunk(bulk);
+}
+
+void NXOSManagementClient::sendBulkChunk(const BulkApplyPtr& bulk) {
+    const auto& routes{*bulk->routes};
+    auto&       body{bulk->requestBody};
+    bulk->chunkRoutes.clear();
+    bulk->chunkVrf = DefaultVrfId;
+    body.assign("[");
+    string command;
+    while (bulk->offset < routes.size() &&
+           bulk->chunkRoutes.size() < m_params.bulkChunkSize) {
+        const auto& route{routes[bulk->offset]};
+        if (!bulk->chunkRoutes.empty() && route.vrfId != bulk->chunkVrf) { break; }
+        if (bulk->remove) {
+            createRemoveRouteIpv6Command(command, route);
+        } else {
+            createApplyRouteIpv6Command(command, route, m_params);
+        }
+        // command is escaped into at most twice of its size plus envelope
+        if (!bulk->chunkRoutes.empty() &&
+            body.size() + 2 * command.size() + 96 > MaxBulkRequestBytes) {
+            break;
+        }
+        if (bulk->chunkRoutes.empty() && route.vrfId != DefaultVrfId) {
+            // routes of the chunk are entered under context of their VRF
+            string vrfCommand;
+            createVrfContextCommand(vrfCommand, route.vrfId);
+            JsonRpcUtils::appendRequestCommand(body, 1, vrfCommand);
+            bulk->chunkVrf = route.vrfId;
+        }
+        JsonRpcUtils::appendRequestCommand(
+            body, static_cast<int>(bulk->chunkRoutes.size() + chunkCommandOffset(*bulk)),
+            command);
+        bulk->chunkRoutes.push_back(bulk->offset++);
+    }
+    body += ']';
+    if (bulk->chunkRoutes.empty()) {
+        finishBulkApply(bulk);
+        return;
+    }
+
+    bulk->chunks++;
+    bulk->result.requests++;
+    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
+              DHCP6_EXPORTER_NXOS_BULK_CHUNK_SEND)
+        .arg(connectionName())
+        .arg(bulk->chunks)
+        .arg(bulk->chunkRoutes.size());
+    m_httpClient->sendRawRequest(
+        m_params.connInfo.url, NXOSHttpClient::Method::POST, EndpointName, {}, body,
+        "application/json-rpc",
+        [this, bulk](const string&                 responseBody,
+                     NXOSHttpClient::ResponseError responseError,
+                     NXOSHttpClient::StatusCode    statusCode) {
+            handleBulkChunk(bulk, responseBody, responseError, statusCode);
+        },
+        BulkRequestTimeoutMs);
+}
+
+// error text of failed CLI command, NX-API puts reason of the switch into "data.msg"
+static string getCommandErrorText(const json& error) {
+    string text{error.is_object() && error.contains("message") &&
+                        error["message"].is_string()
+                    ? error["message"].get<string>()
+                    : error.dump()};
+    if (error.is_object() && error.contains("data") && error["data"].is_object() &&
+        error["data"].contains("msg") && error["data"]["msg"].is_string()) {
+        text += ": " + error["data"]["msg"].get<string>();
+    }
+    return text;
+}
+
+void NXOSManagementClient::handleBulkChunk(const BulkApplyPtr&           bulk,
+                                           const string&                 responseBody,
+                                           NXOSHttpClient::ResponseError responseError,
+                                           NXOSHttpClient::StatusCode    statusCode) {
+    const auto& routes{*bulk->routes};
+    const auto& chunkRoutes{bulk->chunkRoutes};
+    if (responseError != NXOSHttpClient::ResponseError::SUCCESS) {
+        // switch is unreachable, next restore starts from the beginning
+        auto notApplied{chunkRoutes.size() + routes.size() - bulk->offset};
+        LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_BULK_ABORTED)
+            .arg(connectionName())
+            .arg(bulk->chunks)
+            .arg(notApplied)
+            .arg(NXOSHttpClient::ResponseErrorToString(responseError));
+        bulk->result.failed += notApplied;
+        finishBulkApply(bulk);
+        return;
+    }
+
+    // command results by position in chunk, NX-API returns single object
+    // for request with one command
+    std::vector<std::optional<string>> errors(chunkRoutes.size());
+    std::vector<bool>                  answered(chunkRoutes.size(), false);
+    string                             chunkError;
+    std::optional<string>              vrfError;
+    auto                               commandOffset{chunkCommandOffset(*bulk)};
+    auto response{json::parse(responseBody, nullptr, /*allow_exceptions=*/false)};
+    if (response.is_object()) { response = json::array({std::move(response)}); }
+    if (!response.is_array()) {
+        chunkError = "invalid response, status code " + std::to_string(statusCode);
     } else {
-        isc_throw(isc::NotImplemented, "not implemented IA route info");
+        for (const auto& item : response) {
+            if (!item.is_object() || !item.contains("id") ||
+                !item["id"].is_number_integer()) {
+                continue;
+            }
+            auto id{item["id"].get<int64_t>()};
+            if (commandOffset > 1 && id == 1) {
+                if (item.contains("error")) {
+                    vrfError = getCommandErrorText(item["error"]);
+                }
+                continue;
+            }
+            if (id < static_cast<int64_t>(commandOffset) ||
+                static_cast<size_t>(id) >= chunkRoutes.size() + commandOffset) {
+                continue;
+            }
+            auto position{static_cast<size_t>(id) - commandOffset};
+            answered[position] = true;
+            if (item.contains("error")) {
+                errors[position] = getCommandErrorText(item["error"]);
+            }
+        }
+        if (std::find(answered.begin(), answered.end(), true) == answered.end()) {
+            // whole request is rejected, e.g. by authentication
+            chunkError = "no command results, status code " + std::to_string(statusCode);
+        }
+    }
+    // switch stops on failed "vrf context", none of routes is applied
+    if (vrfError) { chunkError = "vrf context failed: " + *vrfError; }
+
+    size_t chunkFailed{0};
+    string firstFailure;
+    for (size_t position = 0; position < chunkRoutes.size(); ++position) {
+        const auto& route{routes[chunkRoutes[position]]};
+        if (answered[position] && !errors[position]) {
+            bulk->result.applied++;
+            TraceRing::record(bulk->remove ? TraceEventType::ROUTE_REMOVE_SUCCESS
+                                           : TraceEventType::ROUTE_APPLY_SUCCESS,
+                              route, statusCode);
+            LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
+                      bulk->remove ? DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_REMOVE_SUCCESS
+                                   : DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_APPLY_SUCCESS)
+                .arg(connectionName())
+                .arg(route.toDHCPv6IATypeString())
+                .arg(route.prefixText())
+                .arg(route.nexthopText());
+            continue;
+        }
+        if (!answered[position] && chunkFailed && chunkError.empty()) {
+            // switch stops on first failed command, rest of chunk is sent again
+            bulk->offset = chunkRoutes[position];
+            break;
+        }
+        string reason{errors[position]   ? *errors[position]
+                      : chunkError.empty() ? string("no response for command")
+                                           : chunkError};
+        if (!chunkFailed++) { firstFailure = route.prefixText() + ": " + reason; }
+        bulk->result.failed++;
+        TraceRing::record(bulk->remove ? TraceEventType::ROUTE_REMOVE_FAILED
+                                       : TraceEventType::ROUTE_APPLY_FAILED,
+                          route, statusCode);
+        LOG_ERROR(DHCP6ExporterLogger,
+                  bulk->remove ? DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_REMOVE_FAILED
+                               : DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_APPLY_FAILED)
+            .arg(connectionName())
+            .arg(route.toDHCPv6IATypeString())
+            .arg(route.prefixText())
+            .arg(route.nexthopText())
+            .arg(reason);
+    }
+    if (chunkFailed) {
+        LOG_WARN(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_BULK_CHUNK_FAILED)
+            .arg(connectionName())
+            .arg(bulk->chunks)
+            .arg(chunkFailed)
+            .arg(chunkRoutes.size())
+            .arg(firstFailure);
     }
+    sendBulkChunk(bulk);
+}
+
+void NXOSManagementClient::finishBulkApply(const BulkApplyPtr& bulk) {
+    auto elapsed{std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - bulk->startedAt)};
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_BULK_FINISHED)
+        .arg(connectionName())
+        .arg(bulk->result.applied)
+        .arg(bulk->result.failed)
+        .arg(bulk->result.dispatched)
+        .arg(bulk->chunks)
+        .arg(elapsed.count());
+    if (bulk->handler) { bulk->handler(bulk->result); }
 }
 
 bool NXOSManagementClient::clientConnectHandler(const boost::system::error_code& ec,
@@ -633,27 +1058,23 @@ void NXOSManagementClient::clientCloseHandler(int tcpNativeFd) {
     }
 }
 
-void NXOSManagementClient::handleRouteApply(const string&      routeAddrTypeStr,
-                                            JsonRpcResponsePtr response,
-                                            const string&      src,
-                                            const string&      dst,
-                                            NXOSHttpClient::ResponseError responseError,
-                                            NXOSHttpClient::StatusCode    statusCode,
-                                            JsonRpcExceptionPtr jsonRpcException) {
+void NXOSManagementClient::handleRouteApply(
+    const RouteExport& route, const NXOSHttpClient::RequestContext& context) {
     try {
-        if (responseError != NXOSHttpClient::ResponseError::SUCCESS) {
+        if (context.responseError != NXOSHttpClient::ResponseError::SUCCESS) {
             isc_throw(isc::Unexpected,
                       ("error while sending response to the switch: {" +
-                       NXOSHttpClient::ResponseErrorToString(responseError) + "}"));
+                       NXOSHttpClient::ResponseErrorToString(context.responseError) +
+                       "}"));
         }
-        switch (statusCode) {
+        switch (context.statusCode) {
             case 200: {
                 // command executed successfully
             } break;
             case 401: {
                 // unauthorized, maybe wrong credentials
-                if (jsonRpcException) {
-                    throw *jsonRpcException;
+                if (context.exception) {
+                    throw *context.exception;
                 } else {
                     isc_throw(isc::Unexpected, "unauthorized request");
                 }
@@ -663,59 +1084,58 @@ void NXOSManagementClient::handleRouteApply(const string&      routeAddrTypeStr,
                 // (can't remove non-existent route). In most cases we can just ignore it
             }
             default: {
-                if (jsonRpcException) { throw *jsonRpcException; }
+                if (context.exception) { throw *context.exception; }
             } break;
         }
-        if (!response || (response && response->empty())) {
+        if (!context.results) {
             isc_throw(isc::Unexpected, "response must be not empty");
         }
         // we can fully ignore contents of the response
     } catch (const std::exception& ex) {
+        TraceRing::record(TraceEventType::ROUTE_APPLY_FAILED, route, context.statusCode);
         LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_APPLY_FAILED)
             .arg(connectionName())
-            .arg(routeAddrTypeStr)
-            .arg(src)
-            .arg(dst)
+            .arg(route.toDHCPv6IATypeString())
+            .arg(route.prefixText())
+            .arg(route.nexthopText())
             .arg(ex.what());
         LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
                   DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_APPLY_FAILED_TRACE_DATA)
             .arg(connectionName())
-            .arg(routeAddrTypeStr)
-            .arg(src)
-            .arg(dst)
+            .arg(route.toDHCPv6IATypeString())
+            .arg(route.prefixText())
+            .arg(route.nexthopText())
             .arg(ex.what())
-            .arg(NXOSHttpClient::ResponseErrorToString(responseError))
-            .arg(statusCode);
+            .arg(NXOSHttpClient::ResponseErrorToString(context.responseError))
+            .arg(context.statusCode);
         return;
     }
-    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_APPLY_SUCCESS)
+    TraceRing::record(TraceEventType::ROUTE_APPLY_SUCCESS, route, context.statusCode);
+    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
+              DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_APPLY_SUCCESS)
         .arg(connectionName())
-        .arg(routeAddrTypeStr)
-        .arg(src)
-        .arg(dst);
-}
-
-void NXOSManagementClient::handleRouteRemove(const string&      routeAddrTypeStr,
-                                             JsonRpcResponsePtr response,
-                                             const string&      src,
-                                             const string&      dst,
-                                             NXOSHttpClient::ResponseError responseError,
-                                             NXOSHttpClient::StatusCode    statusCode,
-                                             JsonRpcExceptionPtr jsonRpcException) {
+        .arg(route.toDHCPv6IATypeString())
+        .arg(route.prefixText())
+        .arg(route.nexthopText());
+}
+
+void NXOSManagementClient::handleRouteRemove(
+    const RouteExport& route, const NXOSHttpClient::RequestContext& context) {
     try {
-        if (responseError != NXOSHttpClient::ResponseError::SUCCESS) {
+        if (context.responseError != NXOSHttpClient::ResponseError::SUCCESS) {
             isc_throw(isc::Unexpected,
                       ("error while sending response to the switch: {" +
-                       NXOSHttpClient::ResponseErrorToString(responseError) + "}"));
+                       NXOSHttpClient::ResponseErrorToString(context.responseError) +
+                       "}"));
         }
-        switch (statusCode) {
+        switch (context.statusCode) {
             case 200: {
                 // command executed successfully
             } break;
             case 401: {
                 // unauthorized, maybe wrong credentials
-                if (jsonRpcException) {
-                    throw *jsonRpcException;
+                if (context.exception) {
+                    throw *context.exception;
                 } else {
                     isc_throw(isc::Unexpected, "unauthorized request");
                 }
@@ -725,37 +1145,41 @@ void NXOSManagementClient::handleRouteRemove(const string&      routeAddrTypeStr
                 // (can't remove non-existent route). In most cases we can just ignore it
             }
             default: {
-                if (jsonRpcException) { throw *jsonRpcException; }
+                if (context.exception) { throw *context.exception; }
             } break;
         }
-        if (!response || (response && response->empty())) {
+        if (!context.results) {
             isc_throw(isc::Unexpected, "response must be not empty");
         }
         // we can fully ignore contents of the response
-        // for remove route handler we can expect two response:
-        // 1. status of actual route removal
-        // 2. status of remove IPv6 ND entry from cache
+        // for remove route handler we can expect up to three responses:
+        // 1. status of "vrf context" for route of non-default VRF
+        // 2. status of actual route removal
+        // 3. status of remove IPv6 ND entry from cache
     } catch (const std::exception& ex) {
+        TraceRing::record(TraceEventType::ROUTE_REMOVE_FAILED, route, context.statusCode);
         LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_REMOVE_FAILED)
             .arg(connectionName())
-            .arg(routeAddrTypeStr)
-            .arg(src)
-            .arg(dst)
+            .arg(route.toDHCPv6IATypeString())
+            .arg(route.prefixText())
+            .arg(route.nexthopText())
             .arg(ex.what());
         LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_DETAIL,
                   DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_REMOVE_FAILED_TRACE_DATA)
             .arg(connectionName())
-            .arg(routeAddrTypeStr)
-            .arg(src)
-            .arg(dst)
+            .arg(route.toDHCPv6IATypeString())
+            .arg(route.prefixText())
+            .arg(route.nexthopText())
             .arg(ex.what())
-            .arg(NXOSHttpClient::ResponseErrorToString(responseError))
-            .arg(statusCode);
+            .arg(NXOSHttpClient::ResponseErrorToString(context.responseError))
+            .arg(context.statusCode);
         return;
     }
-    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_REMOVE_SUCCESS)
+    TraceRing::record(TraceEventType::ROUTE_REMOVE_SUCCESS, route, context.statusCode);
+    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC,
+              DHCP6_EXPORTER_NXOS_RESPONSE_ROUTE_REMOVE_SUCCESS)
         .arg(connectionName())
-        .arg(routeAddrTypeStr)
-        .arg(src)
-        .arg(dst);
+        .arg(route.toDHCPv6IATypeString())
+        .arg(route.prefixText())
+        .arg(route.nexthopText());
 }
@@ -0,0 +1,331 @@
+#include "nxos_rest_management_client.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <map>
+#include <nlohmann/json.hpp>
+
+using nlohmann::json;
+
+static const string LoginEndpointName{"/api/aaaLogin.json"};
+static const string RoutesEndpointName{"/api/mo/sys/ipv6/inst/dom-default.json"};
+// parent of `ipv6Dom` of every VRF
+static const string InstanceEndpointName{"/api/mo/sys/ipv6/inst.json"};
+static const string InstalledRoutesQuery{
+    "?query-target=children&target-subtree-class=ipv6Route&rsp-subtree=children"};
+static const string AllVrfsInstalledRoutesQuery{
+    "?query-target=subtree&target-subtree-class=ipv6Route&rsp-subtree=children"};
+static const string JsonContentType{"application/json"};
+
+NXOSRestManagementClient::NXOSRestManagementClient(ConstElementPtr mgmtConnParams) :
+    NXOSManagementClient(mgmtConnParams),
+    m_batcher(m_params.batchSize, m_params.batchIntervalMs,
+              [this](RouteOperationsPtr ops) { sendBatch(ops); }) {}
+
+void NXOSRestManagementClient::startClient(IOService& io_service) {
+    NXOSManagementClient::startClient(io_service);
+    m_batcher.start(io_service);
+}
+
+void NXOSRestManagementClient::stopClient() {
+    m_batcher.stop();
+    NXOSManagementClient::stopClient();
+}
+
+// nexthop of route is address (IA_PD) or vlan interface (IA_NA)
+static json createNexthopAttributes(const RouteExport& route) {
+    if (route.type == RouteExportType::IA_PD) {
+        return {{"nhAddr", route.nexthop.toText() + "/128"},
+                {"nhIf", "unspecified"},
+                {"nhVrf", VrfNames::name(route.vrfId)},
+                {"object", "0"}};
+    }
+    // DME uses lowercase interface names
+    string nhIf{InterfaceNames::name(route.ifId)};
+    std::transform(nhIf.begin(), nhIf.end(), nhIf.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return {{"nhAddr", "::/128"},
+            {"nhIf", nhIf},
+            {"nhVrf", VrfNames::name(route.vrfId)},
+            {"object", "0"}};
+}
+
+// all operations are placed into one `ipv6Dom` subtree,
+// operations with same prefix are grouped into one `ipv6Route` object
+using RouteNexthops = std::vector<std::pair<string, json>>;
+
+static json createRouteBatchRequest(const RouteNexthops& nexthops) {
+    json                               routes = json::array();
+    std::unordered_map<string, size_t> routeIndex;
+    for (const auto& [prefix, nexthop] : nexthops) {
+        auto [it, inserted]{routeIndex.try_emplace(prefix, routes.size())};
+        if (inserted) {
+            routes.push_back(
+                {{"ipv6Route",
+                  {{"attributes", {{"prefix", prefix}}}, {"children", json::array()}}}});
+        }
+        routes[it->second]["ipv6Route"]["children"].push_back(nexthop);
+    }
+    return {{"ipv6Dom", {{"children", std::move(routes)}}}};
+}
+
+void NXOSRestManagementClient::applyRouteOnSwitch(const RouteExport& route) {
+    m_batcher.push({route, /*remove=*/false, /*clearNDCache=*/false});
+}
+
+void NXOSRestManagementClient::removeRouteOnSwitch(const RouteExport& route,
+                                                   bool               clearNDCache) {
+    m_batcher.push({route, /*remove=*/true, clearNDCache});
+}
+
+// operations of non-default VRFs go into `ipv6Dom` of every VRF under `ipv6Inst`,
+// so batch is still one request and one transaction
+static json createVrfRouteBatchRequest(const std::map<VrfId, RouteNexthops>& doms) {
+    json children = json::array();
+    for (const auto& [vrfId, nexthops] : doms) {
+        auto dom{createRouteBatchRequest(nexthops)};
+        dom["ipv6Dom"]["attributes"] = {{"name", VrfNames::name(vrfId)}};
+        children.push_back(std::move(dom));
+    }
+    return {{"ipv6Inst", {{"children", std::move(children)}}}};
+}
+
+// VRF of DME object from its dn "sys/ipv6/inst/dom-<vrf>/rt-[<prefix>]"
+static string vrfNameFromDn(const json& attributes) {
+    static constexpr std::string_view DomPrefix{"/dom-"};
+    string dn{attributes.value("dn", string())};
+    auto   start{dn.find(DomPrefix)};
+    if (start == string::npos) { return VrfNames::DefaultName; }
+    start += DomPrefix.size();
+    return dn.substr(start, dn.find('/', start) - start);
+}
+
+void NXOSRestManagementClient::sendBatch(RouteOperationsPtr ops) {
+    std::map<VrfId, RouteNexthops> doms;
+    for (const auto& op : *ops) {
+        auto attributes{createNexthopAttributes(op.route)};
+        if (op.remove) {
+            attributes["status"] = "deleted";
+        } else {
+            // owner marks of the route
+            if (m_params.routeTag) {
+                attributes["tag"] = std::to_string(*m_params.routeTag);
+            }
+            if (m_params.routeName) { attributes["rtname"] = *m_params.routeName; }
+        }
+        doms[op.route.vrfId].emplace_back(
+            op.route.prefixText(), json{{"ipv6Nexthop", {{"attributes", attributes}}}});
+    }
+    bool        defaultOnly{doms.size() == 1 && doms.begin()->first == DefaultVrfId};
+    const auto& endpoint{defaultOnly ? RoutesEndpointName : InstanceEndpointName};
+    auto        body{defaultOnly ? createRouteBatchRequest(doms.begin()->second).dump()
+                                 : createVrfRouteBatchRequest(doms).dump()};
+
+    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC, DHCP6_EXPORTER_NXOS_REST_BATCH_SEND)
+        .arg(connectionName())
+        .arg(ops->size());
+    sendAuthenticatedRequest(NXOSHttpClient::Method::POST, endpoint, body,
+                             [this, ops](const string&                 responseBody,
+                                         NXOSHttpClient::ResponseError responseError,
+                                         NXOSHttpClient::StatusCode    statusCode) {
+                                 handleBatchResponse(ops, responseBody, responseError,
+                                                     statusCode);
+                             });
+}
+
+// DME error response: {"imdata":[{"error":{"attributes":{"code":..,"text":..}}}]}
+static string getErrorTextFromResponse(const string& responseBody) {
+    auto response{json::parse(responseBody, nullptr, /*allow_exceptions=*/false)};
+    if (response.is_discarded()) { return {}; }
+    try {
+        return response.at("imdata").at(0).at("error").at("attributes").at("text");
+    } catch (const json::exception&) { return {}; }
+}
+
+void NXOSRestManagementClient::handleBatchResponse(
+    RouteOperationsPtr            ops,
+    const string&                 responseBody,
+    NXOSHttpClient::ResponseError responseError,
+    NXOSHttpClient::StatusCode    statusCode) {
+    string reason;
+    if (responseError != NXOSHttpClient::ResponseError::SUCCESS) {
+        reason = "error while sending response to the switch: {" +
+                 NXOSHttpClient::ResponseErrorToString(responseError) + "}";
+    } else if (statusCode != 200) {
+        // DME applies whole subtree in one transaction, so all operations failed
+        reason = "status code " + std::to_string(statusCode);
+        auto errorText{getErrorTextFromResponse(responseBody)};
+        if (!errorText.empty()) { reason += ": " + errorText; }
+    }
+
+    handleBatchResult(ops, reason);
+}
+
+void NXOSRestManagementClient::asyncGetInstalledRoutes(
+    const InstalledRoutesHandler& handler) {
+    // DME filters nexthops by owner tag on the switch,
+    // routes of all VRFs are read from the whole subtree of `ipv6Inst`
+    bool allVrfs{!m_exportVrfs.empty()};
+    auto query{allVrfs ? InstanceEndpointName + AllVrfsInstalledRoutesQuery
+                       : RoutesEndpointName + InstalledRoutesQuery};
+    if (m_params.routeTag) {
+        query += "&rsp-subtree-filter=eq(ipv6Nexthop.tag,%22" +
+                 std::to_string(*m_params.routeTag) + "%22)";
+    }
+    sendAuthenticatedRequest(
+        NXOSHttpClient::Method::GET, query, {},
+        [this, handler](const string&                 responseBody,
+                        NXOSHttpClient::ResponseError responseError,
+                        NXOSHttpClient::StatusCode    statusCode) {
+            InstalledRoutes routes;
+            bool            connectionOrEarlyValidationFailed{false};
+            if (responseError == NXOSHttpClient::ResponseError::SUCCESS &&
+                statusCode == 200) {
+                try {
+                    auto response{json::parse(responseBody)};
+                    for (const auto& item : response.at("imdata")) {
+                        const auto& route{item.at("ipv6Route")};
+                        string      prefix{route.at("attributes").at("prefix")};
+                        if (!route.contains("children")) { continue; }
+                        auto vrfId{
+                            VrfNames::intern(vrfNameFromDn(route.at("attributes")))};
+                        if (vrfId != DefaultVrfId &&
+                            std::find(m_exportVrfs.begin(), m_exportVrfs.end(), vrfId) ==
+                                m_exportVrfs.end()) {
+                            continue;
+                        }
+                        for (const auto& child : route.at("children")) {
+                            if (!child.contains("ipv6Nexthop")) { continue; }
+                            const auto& attributes{
+                                child.at("ipv6Nexthop").at("attributes")};
+                            if (m_params.routeTag &&
+                                attributes.value("tag", string()) !=
+                                    std::to_string(*m_params.routeTag)) {
+                                continue;
+                            }
+                            string      nhIf{attributes.at("nhIf")};
+                            string      nhAddr{attributes.at("nhAddr")};
+                            if (nhIf != "unspecified") {
+                                routes.push_back({prefix, std::move(nhIf), vrfId});
+                            } else {
+                                // report address in same form as CLI does
+                                auto slashPos{nhAddr.find('/')};
+                                routes.push_back(
+                                    {prefix, nhAddr.substr(0, slashPos), vrfId});
+                            }
+                        }
+                    }
+                } catch (const std::exception& ex) {
+                    LOG_ERROR(DHCP6ExporterLogger,
+                              DHCP6_EXPORTER_NXOS_RESPONSE_PARSE_ERROR)
+                        .arg(connectionName())
+                        .arg("ipv6Route")
+                        .arg(ex.what());
+                    connectionOrEarlyValidationFailed = true;
+                }
+            } else {
+                connectionOrEarlyValidationFailed = true;
+            }
+            if (handler) {
+                handler(std::make_shared<InstalledRoutes>(std::move(routes)),
+                        connectionOrEarlyValidationFailed);
+            }
+        });
+}
+
+void NXOSRestManagementClient::sendAuthenticatedRequest(
+    NXOSHttpClient::Method                            method,
+    const string&                                     uri,
+    const string&                                     body,
+    const NXOSHttpClient::RawResponseHandlerCallback& handler,
+    bool                                              reloginOnAuthFailure) {
+    withToken([this, method, uri, body, handler, reloginOnAuthFailure](
+                  const string& token, NXOSHttpClient::ResponseError loginError,
+                  NXOSHttpClient::StatusCode loginStatusCode) {
+        if (token.empty()) {
+            if (handler) { handler({}, loginError, loginStatusCode); }
+            return;
+        }
+        m_httpClient->sendRawRequest(
+            m_params.connInfo.url, method, uri, {{"Cookie", "APIC-cookie=" + token}},
+            body, JsonContentType,
+            [this, method, uri, body, handler, reloginOnAuthFailure, token](
+                const string& responseBody, NXOSHttpClient::ResponseError responseError,
+                NXOSHttpClient::StatusCode statusCode) {
+                bool authFailed{responseError == NXOSHttpClient::ResponseError::SUCCESS &&
+                                (statusCode == 401 || statusCode == 403)};
+                if (authFailed && reloginOnAuthFailure) {
+                    // token expired, login again and repeat request
+                    invalidateToken(token);
+                    sendAuthenticatedRequest(method, uri, body, handler,
+                                             /*reloginOnAuthFailure=*/false);
+                    return;
+                }
+                if (handler) { handler(responseBody, responseError, statusCode); }
+            });
+    });
+}
+
+void NXOSRestManagementClient::withToken(const TokenHandler& handler) {
+    {
+        std::unique_lock lock(m_tokenMutex);
+        if (!m_token.empty()) {
+            auto token{m_token};
+            lock.unlock();
+            handler(token, NXOSHttpClient::ResponseError::SUCCESS, 200);
+            return;
+        }
+    }
+
+    // basic auth secret has form "login:password"
+    const auto& secret{m_params.auth.auth->getSecret()};
+    auto        delimiterPos{secret.find(':')};
+    json        loginRequest{{"aaaUser",
+                              {{"attributes",
+                                {{"name", secret.substr(0, delimiterPos)},
+                                 {"pwd", secret.substr(delimiterPos + 1)}}}}}};
+    m_httpClient->sendRawRequest(
+        m_params.connInfo.url, NXOSHttpClient::Method::POST, LoginEndpointName, {},
+        loginRequest.dump(), JsonContentType,
+        [this, handler](const string&                 responseBody,
+                        NXOSHttpClient::ResponseError responseError,
+                        NXOSHttpClient::StatusCode    statusCode) {
+            string token;
+            if (responseError != NXOSHttpClient::ResponseError::SUCCESS) {
+                LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_REST_LOGIN_FAILED)
+                    .arg(connectionName())
+                    .arg(NXOSHttpClient::ResponseErrorToString(responseError));
+            } else if (statusCode != 200) {
+                LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_REST_LOGIN_FAILED)
+                    .arg(connectionName())
+                    .arg("status code " + std::to_string(statusCode));
+            } else {
+                try {
+                    auto response{json::parse(responseBody)};
+                    response.at("imdata")
+                        .at(0)
+                        .at("aaaLogin")
+                        .at("attributes")
+                        .at("token")
+                        .get_to(token);
+                    std::unique_lock lock(m_tokenMutex);
+                    m_token = token;
+                } catch (const std::exception& ex) {
+                    LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_NXOS_REST_LOGIN_FAILED)
+                        .arg(connectionName())
+                        .arg(ex.what());
+                    token.clear();
+                }
+            }
+            if (token.empty() && statusCode == 200) {
+                // treat broken login response as unauthorized
+                statusCode = 401;
+            }
+            handler(token, responseError, statusCode);
+        });
+}
+
+void NXOSRestManagementClient::invalidateToken(const string& token) {
+    std::unique_lock lock(m_tokenMutex);
+    // token may be already refreshed by another request
+    if (m_token == token) { m_token.clear(); }
+}
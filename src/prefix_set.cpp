@@ -0,0 +1,130 @@
+#include "prefix_set.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <charconv>
+
+IPv6Prefix IPv6Prefix::fromAddress(const RouteAddress& addr, uint8_t length) {
+    IPv6Prefix result;
+    for (size_t i = 0; i < 8; ++i) {
+        result.high = (result.high << 8) | addr.bytes[i];
+        result.low  = (result.low << 8) | addr.bytes[i + 8];
+    }
+    result.length = 128;
+    return result.truncate(std::min<uint8_t>(length, 128));
+}
+
+std::optional<IPv6Prefix> IPv6Prefix::fromText(std::string_view text) {
+    auto    slash{text.find('/')};
+    uint8_t length{128};
+    if (slash != std::string_view::npos) {
+        auto lengthText{text.substr(slash + 1)};
+        auto [ptr, ec]{std::from_chars(lengthText.data(),
+                                       lengthText.data() + lengthText.size(), length)};
+        if (ec != std::errc() || ptr != lengthText.data() + lengthText.size() ||
+            length > 128) {
+            return std::nullopt;
+        }
+        text = text.substr(0, slash);
+    }
+    char address[INET6_ADDRSTRLEN];
+    if (text.size() >= sizeof(address)) { return std::nullopt; }
+    text.copy(address, text.size());
+    address[text.size()] = '\0';
+    RouteAddress addr;
+    if (inet_pton(AF_INET6, address, addr.bytes.data()) != 1) { return std::nullopt; }
+    return fromAddress(addr, length);
+}
+
+IPv6Prefix IPv6Prefix::truncate(uint8_t newLength) const {
+    IPv6Prefix result{high, low, newLength};
+    if (newLength < 64) {
+        result.high = newLength ? high & (~uint64_t{0} << (64 - newLength)) : 0;
+        result.low  = 0;
+    } else if (newLength < 128) {
+        result.low = newLength > 64 ? low & (~uint64_t{0} << (128 - newLength)) : 0;
+    }
+    return result;
+}
+
+string IPv6Prefix::toText() const {
+    RouteAddress addr;
+    for (size_t i = 0; i < 8; ++i) {
+        addr.bytes[i]     = static_cast<uint8_t>(high >> (56 - 8 * i));
+        addr.bytes[i + 8] = static_cast<uint8_t>(low >> (56 - 8 * i));
+    }
+    string result;
+    addr.appendText(result);
+    result += '/';
+    result += std::to_string(length);
+    return result;
+}
+
+PrefixSet::PrefixSet(Entries entries) : m_entries(std::move(entries)) {
+    std::sort(m_entries.begin(), m_entries.end(), [](const Entry& lhs, const Entry& rhs) {
+        return lhs.prefix < rhs.prefix ||
+               (lhs.prefix == rhs.prefix && lhs.index < rhs.index);
+    });
+    for (const auto& entry : m_entries) { m_lengths.set(entry.prefix.length); }
+}
+
+PrefixSet::Iterator PrefixSet::lowerBound(const IPv6Prefix& prefix) const {
+    return std::lower_bound(m_entries.begin(), m_entries.end(), prefix,
+                            [](const Entry& entry, const IPv6Prefix& value) {
+                                return entry.prefix < value;
+                            });
+}
+
+PrefixSet::Iterator PrefixSet::prefixEnd(Iterator it, Iterator end) {
+    auto prefix{it->prefix};
+    while (it != end && it->prefix == prefix) { ++it; }
+    return it;
+}
+
+std::pair<PrefixSet::Iterator, PrefixSet::Iterator>
+    PrefixSet::equalRange(const IPv6Prefix& prefix) const {
+    auto first{lowerBound(prefix)};
+    if (first == m_entries.end() || !(first->prefix == prefix)) { return {first, first}; }
+    return {first, prefixEnd(first, m_entries.end())};
+}
+
+bool PrefixSet::contains(const IPv6Prefix& prefix) const {
+    if (!m_lengths.test(prefix.length)) { return false; }
+    auto [first, last]{equalRange(prefix)};
+    return first != last;
+}
+
+const PrefixSet::Entry* PrefixSet::longestMatch(const IPv6Prefix& prefix) const {
+    // one binary search per prefix length present in the set,
+    // route tables have only a few of them
+    for (int length = prefix.length; length >= 0; --length) {
+        if (!m_lengths.test(static_cast<size_t>(length))) { continue; }
+        auto [first, last]{equalRange(prefix.truncate(static_cast<uint8_t>(length)))};
+        if (first != last) { return &*first; }
+    }
+    return nullptr;
+}
+
+bool PrefixSet::overlaps(const IPv6Prefix& prefix) const {
+    if (longestMatch(prefix)) { return true; }
+    // covered prefixes start right after position of `prefix`
+    auto it{lowerBound(prefix)};
+    return it != m_entries.end() && prefix.contains(it->prefix);
+}
+
+std::vector<std::pair<const PrefixSet::Entry*, const PrefixSet::Entry*>>
+    PrefixSet::overlappingPairs(size_t limit) const {
+    std::vector<std::pair<const Entry*, const Entry*>> result;
+    // chain of entries covering current one, at most 129 deep plus duplicates
+    std::vector<const Entry*> covering;
+    for (const auto& entry : m_entries) {
+        while (!covering.empty() && !covering.back()->prefix.contains(entry.prefix)) {
+            covering.pop_back();
+        }
+        for (const auto* parent : covering) {
+            if (result.size() == limit) { return result; }
+            result.emplace_back(parent, &entry);
+        }
+        covering.push_back(&entry);
+    }
+    return result;
+}
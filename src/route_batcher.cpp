@@ -0,0 +1,69 @@
+#include "route_batcher.hpp"
+#include <algorithm>
+#include <asiolink/interval_timer.h>
+#include <util/hash.h>
+
+RouteBatcher::RouteBatcher(size_t              batchSize,
+                           size_t              batchIntervalMs,
+                           const FlushHandler& handler) :
+    m_batchSize(batchSize), m_batchIntervalMs(batchIntervalMs), m_flushHandler(handler) {}
+
+bool RouteBatcher::RouteKey::operator==(const RouteKey& other) const {
+    return addr == other.addr && nexthop == other.nexthop && ifId == other.ifId &&
+           prefixLength == other.prefixLength && vrfId == other.vrfId;
+}
+
+size_t RouteBatcher::RouteKeyHash::operator()(const RouteKey& key) const {
+    std::array<uint8_t, 2 * 16 + sizeof(InterfaceId) + sizeof(VrfId) + 1> buffer;
+    auto it{std::copy(key.addr.bytes.begin(), key.addr.bytes.end(), buffer.begin())};
+    it = std::copy(key.nexthop.bytes.begin(), key.nexthop.bytes.end(), it);
+    it = std::copy_n(reinterpret_cast<const uint8_t*>(&key.ifId), sizeof(key.ifId), it);
+    it = std::copy_n(reinterpret_cast<const uint8_t*>(&key.vrfId), sizeof(key.vrfId), it);
+    *it = key.prefixLength;
+    return isc::util::Hash64::hash(buffer.data(), buffer.size());
+}
+
+void RouteBatcher::start(IOService& io_service) {
+    m_timer = boost::make_shared<isc::asiolink::IntervalTimer>(io_service);
+    m_timer->setup([this] { flush(); }, m_batchIntervalMs);
+}
+
+void RouteBatcher::stop() {
+    if (m_timer) { m_timer->cancel(); }
+    // don't lose route changes collected since last timer tick
+    flush();
+}
+
+void RouteBatcher::push(Operation&& op) {
+    OperationsPtr batch;
+    {
+        std::unique_lock lock(m_batchMutex);
+        RouteKey key{op.route.addr, op.route.nexthop, op.route.ifId,
+                     op.route.prefixLength, op.route.vrfId};
+        auto [it, inserted]{m_pendingIndex.try_emplace(key, m_pendingOps.size())};
+        if (inserted) {
+            m_pendingOps.push_back(std::move(op));
+        } else {
+            m_pendingOps[it->second] = std::move(op);
+        }
+        if (m_pendingOps.size() >= m_batchSize) { batch = takePendingOperations(); }
+    }
+    if (batch && m_flushHandler) { m_flushHandler(batch); }
+}
+
+void RouteBatcher::flush() {
+    OperationsPtr batch;
+    {
+        std::unique_lock lock(m_batchMutex);
+        if (m_pendingOps.empty()) { return; }
+        batch = takePendingOperations();
+    }
+    if (m_flushHandler) { m_flushHandler(batch); }
+}
+
+RouteBatcher::OperationsPtr RouteBatcher::takePendingOperations() {
+    auto batch{std::make_shared<Operations>(std::move(m_pendingOps))};
+    m_pendingOps.clear();
+    m_pendingIndex.clear();
+    return batch;
+}
@@ -1,45 +1,323 @@
 #include "route_export.hpp"
-#include <type_traits>
+#include <arpa/inet.h>
+#include <cstring>
+#include <deque>
+#include <dhcp/duid.h>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <util/hash.h>
 
-string RouteExport::toString() const {
-    auto infoStr{std::visit(
-        [](auto&& info) {
-            using T = std::decay_t<decltype(info)>;
-
-            if constexpr (std::is_same_v<T, IA_NAInfo>) {
-                return "srcVlanAddr=" + info.srcVlanAddr.toText() +
-                       ", ia_naAddr=" + info.ia_naAddr.toText();
-            } else if constexpr (std::is_same_v<T, IA_PDInfo>) {
-                return "dstIa_naAddr=" + info.dstIa_naAddr.toText() +
-                       ", ia_pdPrefix=" + info.ia_pdPrefix.toText() + ", " +
-                       "ia_pdLength=" + std::to_string(info.ia_pdLength);
-            } else if constexpr (std::is_same_v<T, IA_NAInfoFuzzyRemove>) {
-                return "ia_naAddr=" + info.ia_naAddr.toText();
-            } else if constexpr (std::is_same_v<T, IA_PDInfoFuzzyRemove>) {
-                return "ia_pdPrefix=" + info.ia_pdPrefix.toText() + ", " +
-                       "ia_pdLength=" + std::to_string(info.ia_pdLength);
-            } else if constexpr (std::is_same_v<T, IA_NAFast>) {
-                return "srcVlanIfName=" + info.srcVlanIfName +
-                       ", ia_naAddr=" + info.ia_naAddr.toText();
+RouteAddress RouteAddress::fromIOAddress(const IOAddress& addr) {
+    RouteAddress result{};
+    if (addr.isV6()) { result.bytes = addr.getAddress().to_v6().to_bytes(); }
+    return result;
+}
+
+IOAddress RouteAddress::toIOAddress() const {
+    return IOAddress::fromBytes(AF_INET6, bytes.data());
+}
+
+string RouteAddress::toText() const {
+    string result;
+    appendText(result);
+    return result;
+}
+
+void RouteAddress::appendText(string& out) const {
+    char buffer[INET6_ADDRSTRLEN];
+    inet_ntop(AF_INET6, bytes.data(), buffer, sizeof(buffer));
+    out += buffer;
+}
+
+namespace {
+    // id 0 is reserved, names get ids from 1
+    template<typename Id>
+    struct NamesTable {
+        std::shared_mutex              mutex;
+        std::unordered_map<string, Id> ids;
+        // deque keeps references to names valid on growth
+        std::deque<string> names;
+
+        Id intern(const string& name) {
+            {
+                std::shared_lock lock(mutex);
+                auto             it{ids.find(name)};
+                if (it != ids.end()) { return it->second; }
             }
-        },
-        routeInfo)};
+            std::unique_lock lock(mutex);
+            auto [it, inserted]{ids.try_emplace(name, static_cast<Id>(names.size() + 1))};
+            if (inserted) { names.push_back(name); }
+            return it->second;
+        }
+
+        // nullptr for reserved or unknown id
+        const string* name(Id id) {
+            std::shared_lock lock(mutex);
+            if (id == 0 || id > names.size()) { return nullptr; }
+            return &names[id - 1];
+        }
+    };
+
+    NamesTable<InterfaceId>& interfaceNamesTable() {
+        static NamesTable<InterfaceId> table;
+        return table;
+    }
+
+    NamesTable<VrfId>& vrfNamesTable() {
+        static NamesTable<VrfId> table;
+        return table;
+    }
+}    // namespace
+
+InterfaceId InterfaceNames::intern(const string& name) {
+    return interfaceNamesTable().intern(name);
+}
+
+const string& InterfaceNames::name(InterfaceId id) {
+    static const string NoInterfaceName;
+    const auto*         name{interfaceNamesTable().name(id)};
+    return name ? *name : NoInterfaceName;
+}
+
+const string VrfNames::DefaultName{"default"};
+
+VrfId VrfNames::intern(const string& name) {
+    if (name.empty() || name == DefaultName) { return DefaultVrfId; }
+    return vrfNamesTable().intern(name);
+}
+
+const string& VrfNames::name(VrfId id) {
+    const auto* name{vrfNamesTable().name(id)};
+    return name ? *name : DefaultName;
+}
+
+uint64_t RouteExport::hashDUID(const isc::dhcp::DuidPtr& duid) {
+    if (!duid) { return 0; }
+    const auto& duidBytes{duid->getDuid()};
+    return isc::util::Hash64::hash(duidBytes.data(), duidBytes.size());
+}
+
+RouteExport RouteExport::makeIA_NA(uint32_t                  tid,
+                                   uint32_t                  iaid,
+                                   const isc::dhcp::DuidPtr& duid,
+                                   const IOAddress&          srcVlanAddr,
+                                   const IOAddress&          ia_naAddr) {
+    return {tid,
+            iaid,
+            hashDUID(duid),
+            RouteExportType::IA_NA,
+            128,
+            NoInterfaceId,
+            RouteAddress::fromIOAddress(ia_naAddr),
+            RouteAddress::fromIOAddress(srcVlanAddr),
+            DefaultVrfId};
+}
+
+RouteExport RouteExport::makeIA_PD(uint32_t                  tid,
+                                   uint32_t                  iaid,
+                                   const isc::dhcp::DuidPtr& duid,
+                                   const IOAddress&          dstIa_naAddr,
+                                   const IOAddress&          ia_pdPrefix,
+                                   uint8_t                   ia_pdLength) {
+    return {tid,
+            iaid,
+            hashDUID(duid),
+            RouteExportType::IA_PD,
+            ia_pdLength,
+            NoInterfaceId,
+            RouteAddress::fromIOAddress(ia_pdPrefix),
+            RouteAddress::fromIOAddress(dstIa_naAddr),
+            DefaultVrfId};
+}
+
+RouteExport RouteExport::makeIA_NAFuzzyRemove(uint32_t                  tid,
+                                              uint32_t                  iaid,
+                                              const isc::dhcp::DuidPtr& duid,
+                                              const IOAddress&          ia_naAddr) {
+    return {tid,
+            iaid,
+            hashDUID(duid),
+            RouteExportType::IA_NAFuzzyRemove,
+            128,
+            NoInterfaceId,
+            RouteAddress::fromIOAddress(ia_naAddr),
+            {},
+            DefaultVrfId};
+}
+
+RouteExport RouteExport::makeIA_PDFuzzyRemove(uint32_t                  tid,
+                                              uint32_t                  iaid,
+                                              const isc::dhcp::DuidPtr& duid,
+                                              const IOAddress&          ia_pdPrefix,
+                                              uint8_t                   ia_pdLength) {
+    return {tid,
+            iaid,
+            hashDUID(duid),
+            RouteExportType::IA_PDFuzzyRemove,
+            ia_pdLength,
+            NoInterfaceId,
+            RouteAddress::fromIOAddress(ia_pdPrefix),
+            {},
+            DefaultVrfId};
+}
+
+RouteExport RouteExport::makeIA_NAFast(uint32_t                  tid,
+                                       uint32_t                  iaid,
+                                       const isc::dhcp::DuidPtr& duid,
+                                       InterfaceId               srcVlanIf,
+                                       const IOAddress&          ia_naAddr) {
+    return {tid,
+            iaid,
+            hashDUID(duid),
+            RouteExportType::IA_NAFast,
+            128,
+            srcVlanIf,
+            RouteAddress::fromIOAddress(ia_naAddr),
+            {},
+            DefaultVrfId};
+}
+
+bool RouteExport::isIA_NA() const {
+    return type == RouteExportType::IA_NA || type == RouteExportType::IA_NAFuzzyRemove ||
+           type == RouteExportType::IA_NAFast;
+}
+
+string RouteExport::prefixText() const {
+    string result;
+    appendPrefixText(result);
+    return result;
+}
+
+string RouteExport::nexthopText() const {
+    string result;
+    appendNexthopText(result);
+    return result;
+}
+
+void RouteExport::appendPrefixText(string& out) const {
+    addr.appendText(out);
+    out += '/';
+    // prefix length has at most 3 digits
+    if (prefixLength >= 100) { out += static_cast<char>('0' + prefixLength / 100); }
+    if (prefixLength >= 10) { out += static_cast<char>('0' + prefixLength / 10 % 10); }
+    out += static_cast<char>('0' + prefixLength % 10);
+}
+
+void RouteExport::appendNexthopText(string& out) const {
+    if (type == RouteExportType::IA_NAFast) {
+        out += InterfaceNames::name(ifId);
+    } else {
+        nexthop.appendText(out);
+    }
+}
+
+string RouteExport::toString() const {
+    string infoStr;
+    switch (type) {
+        case RouteExportType::IA_NA: {
+            infoStr = "srcVlanAddr=" + nexthop.toText() + ", ia_naAddr=" + addr.toText();
+        } break;
+        case RouteExportType::IA_PD: {
+            infoStr = "dstIa_naAddr=" + nexthop.toText() + ", ia_pdPrefix=" +
+                      addr.toText() + ", " +
+                      "ia_pdLength=" + std::to_string(prefixLength);
+        } break;
+        case RouteExportType::IA_NAFuzzyRemove: {
+            infoStr = "ia_naAddr=" + addr.toText();
+        } break;
+        case RouteExportType::IA_PDFuzzyRemove: {
+            infoStr = "ia_pdPrefix=" + addr.toText() + ", " +
+                      "ia_pdLength=" + std::to_string(prefixLength);
+        } break;
+        case RouteExportType::IA_NAFast: {
+            infoStr = "srcVlanIfName=" + InterfaceNames::name(ifId) +
+                      ", ia_naAddr=" + addr.toText();
+        } break;
+    }
+    if (vrfId != DefaultVrfId) { infoStr += ", vrf=" + VrfNames::name(vrfId); }
     return "transid=" + std::to_string(tid) + ", " + "iaid=" + std::to_string(iaid) +
            ", " + infoStr;
 }
 
-string RouteExport::toDHCPv6IATypeString() const {
-    return std::visit(
-        [](auto&& info) {
-            using T = std::decay_t<decltype(info)>;
-            if constexpr (std::is_same_v<T, IA_NAInfo> ||
-                          std::is_same_v<T, IA_NAInfoFuzzyRemove> ||
-                          std::is_same_v<T, IA_NAFast>) {
-                return "IA_NA";
-            } else if constexpr (std::is_same_v<T, IA_PDInfo> ||
-                                 std::is_same_v<T, IA_PDInfoFuzzyRemove>) {
-                return "IA_PD";
-            }
-        },
-        routeInfo);
+const char* RouteExport::toDHCPv6IATypeString() const {
+    return isIA_NA() ? "IA_NA" : "IA_PD";
+}
+
+RouteLeaseKey RouteLeaseKey::fromRoute(const RouteExport& route) {
+    return {route.duidHash,     route.addr,      route.iaid,
+            route.prefixLength, route.isIA_NA(), route.vrfId};
+}
+
+size_t RouteLeaseKeyHash::operator()(const RouteLeaseKey& key) const {
+    return isc::util::Hash64::hash(key.addr.bytes.data(), key.addr.bytes.size()) ^
+           key.duidHash ^
+           (uint64_t{key.vrfId} << 40 | uint64_t{key.iaid} << 8 | key.prefixLength);
+}
+
+namespace {
+    template<typename T>
+    void appendValue(string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    const char* readValue(const char* in, T& value) {
+        std::memcpy(&value, in, sizeof(value));
+        return in + sizeof(value);
+    }
+}    // namespace
+
+bool RouteRecord::append(string& out, const RouteExport& route, uint8_t flag) {
+    // interface and VRF ids are local to the process, names are stored instead
+    string names;
+    if (route.ifId != NoInterfaceId) { names = InterfaceNames::name(route.ifId); }
+    if (route.vrfId != DefaultVrfId) {
+        names += '\0';
+        names += VrfNames::name(route.vrfId);
+    }
+    if (names.size() > MaxNamesSize) {
+        LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_ROUTE_RECORD_NAMES_TOO_LONG)
+            .arg(names.size())
+            .arg(MaxNamesSize)
+            .arg(route.toString());
+        return false;
+    }
+    appendValue(out, static_cast<uint16_t>(FixedSize + names.size()));
+    appendValue(out, flag);
+    appendValue(out, static_cast<uint8_t>(route.type));
+    appendValue(out, route.prefixLength);
+    appendValue(out, route.tid);
+    appendValue(out, route.iaid);
+    appendValue(out, route.duidHash);
+    appendValue(out, route.addr.bytes);
+    appendValue(out, route.nexthop.bytes);
+    out += names;
+    return true;
+}
+
+bool RouteRecord::parse(const char*  payload,
+                        size_t       size,
+                        RouteExport& route,
+                        uint8_t&     flag) {
+    if (size < FixedSize || size > MaxSize) { return false; }
+    uint8_t type;
+    auto*   in{readValue(payload, flag)};
+    in = readValue(in, type);
+    if (type > static_cast<uint8_t>(RouteExportType::IA_NAFast)) { return false; }
+    route.type = static_cast<RouteExportType>(type);
+    in         = readValue(in, route.prefixLength);
+    in         = readValue(in, route.tid);
+    in         = readValue(in, route.iaid);
+    in         = readValue(in, route.duidHash);
+    in         = readValue(in, route.addr.bytes);
+    in         = readValue(in, route.nexthop.bytes);
+    std::string_view names(in, size - FixedSize);
+    auto             vrfPos{names.find('\0')};
+    auto             ifName{names.substr(0, vrfPos)};
+    route.ifId  = ifName.empty() ? NoInterfaceId : InterfaceNames::intern(string(ifName));
+    route.vrfId = vrfPos == std::string_view::npos
+                      ? DefaultVrfId
+                      : VrfNames::intern(string(names.substr(vrfPos + 1)));
+    return true;
 }
@@ -0,0 +1,252 @@
+#include "route_spool.hpp"
+#include "config_params.hpp"
+#include <algorithm>
+#include <asiolink/interval_timer.h>
+#include <cc/data.h>
+#include <cc/dhcp_config_error.h>
+#include <cstring>
+#include <unistd.h>
+#include <unordered_set>
+#include <vector>
+
+using isc::data::Element;
+
+#define FIELD_ERROR_STR(field_name, what) "Field \"" field_name "\" in \"spool\" " what
+
+// drain rate is spread over ticks, so the switch doesn't receive bursts
+static constexpr size_t DrainTickMs{100};
+
+RouteSpool::Config RouteSpool::Config::parseConfig(ConstElementPtr config) {
+    Config result;
+    if (config->getType() != Element::map) {
+        isc_throw(isc::ConfigError, "parameter \"spool\" must be a map");
+    }
+    auto path{config->get("path")};
+    if (!path || path->getType() != Element::string || path->stringValue().empty()) {
+        isc_throw(isc::ConfigError,
+                  FIELD_ERROR_STR("path", "must be a non-empty string"));
+    }
+    result.path        = path->stringValue();
+    result.memoryLimit =
+        parsePositiveInteger(config, "spool", "memory-limit", result.memoryLimit);
+    result.drainRate =
+        parsePositiveInteger(config, "spool", "drain-rate", result.drainRate);
+    return result;
+}
+
+isc::data::ElementPtr RouteSpool::Stats::toElement() const {
+    auto element{Element::createMap()};
+    element->set("paused", Element::create(paused));
+    element->set("queued", Element::create(static_cast<long long>(queued)));
+    element->set("spooled", Element::create(static_cast<long long>(spooled)));
+    element->set("spilled", Element::create(static_cast<long long>(spilled)));
+    element->set("compacted", Element::create(static_cast<long long>(compacted)));
+    element->set("dropped", Element::create(static_cast<long long>(dropped)));
+    element->set("drained", Element::create(static_cast<long long>(drained)));
+    element->set("file-bytes", Element::create(static_cast<long long>(fileBytes)));
+    return element;
+}
+
+RouteSpool::RouteSpool(const Config& config, const ForwardHandler& handler) :
+    m_config(config), m_forwardHandler(handler) {
+    // appends always go to the end, reads seek to `m_readOffset`
+    m_file = std::fopen(m_config.path.c_str(), "a+b");
+    if (!m_file) {
+        isc_throw(isc::ConfigError, "failed to open spool file: " << m_config.path);
+    }
+    std::fseek(m_file, 0, SEEK_END);
+    m_fileSize = std::ftell(m_file);
+
+    // count operations left by previous run, partial record of interrupted
+    // write is cut off
+    Operation op;
+    while (readOperation(op)) { m_stats.spooled++; }
+    if (m_readOffset < m_fileSize) {
+        LOG_WARN(DHCP6ExporterLogger, DHCP6_EXPORTER_SPOOL_CORRUPTED)
+            .arg(m_config.path)
+            .arg(m_readOffset)
+            .arg(m_fileSize - m_readOffset);
+        std::fflush(m_file);
+        if (ftruncate(fileno(m_file), m_readOffset) == 0) { m_fileSize = m_readOffset; }
+    }
+    m_readOffset = 0;
+    LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_SPOOL_OPENED)
+        .arg(m_config.path)
+        .arg(m_stats.spooled);
+}
+
+RouteSpool::~RouteSpool() {
+    if (m_file) { std::fclose(m_file); }
+}
+
+void RouteSpool::start(IOService& io_service) {
+    m_timer = boost::make_shared<isc::asiolink::IntervalTimer>(io_service);
+    m_timer->setup([this] { tick(); }, DrainTickMs);
+}
+
+void RouteSpool::stop() {
+    if (m_timer) { m_timer->cancel(); }
+    std::unique_lock lock(m_mutex);
+    if (m_readOffset >= m_fileSize) { resetFile(); }
+    // already drained part of file is sent again after restart,
+    // route operations are idempotent on the switch
+    if (!m_memory.empty()) { spill(); }
+}
+
+void RouteSpool::pause() {
+    std::unique_lock lock(m_mutex);
+    m_paused = true;
+}
+
+void RouteSpool::resume() {
+    std::unique_lock lock(m_mutex);
+    m_paused = false;
+    if (!empty()) {
+        LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_SPOOL_DRAIN_STARTED)
+            .arg(m_config.path)
+            .arg(m_memory.size())
+            .arg(m_stats.spooled);
+    }
+}
+
+bool RouteSpool::push(const RouteExport& route, bool remove) {
+    std::unique_lock lock(m_mutex);
+    if (!m_paused && !m_sending && empty()) { return false; }
+    m_memory.push_back({route, remove});
+    if (m_memory.size() >= m_config.memoryLimit) { spill(); }
+    return true;
+}
+
+bool RouteSpool::empty() const { return m_memory.empty() && m_readOffset >= m_fileSize; }
+
+void RouteSpool::tick() {
+    auto budget{std::max<size_t>(m_config.drainRate * DrainTickMs / 1000, 1)};
+    std::vector<Operation> send;
+    {
+        std::unique_lock lock(m_mutex);
+        if (m_paused || empty()) { return; }
+        while (send.size() < budget) {
+            Operation op;
+            if (m_readOffset < m_fileSize) {
+                if (readOperation(op)) {
+                    m_stats.spooled--;
+                    send.push_back(op);
+                    continue;
+                }
+                LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_SPOOL_CORRUPTED)
+                    .arg(m_config.path)
+                    .arg(m_readOffset)
+                    .arg(m_fileSize - m_readOffset);
+                m_stats.dropped += m_stats.spooled;
+                m_stats.spooled = 0;
+                resetFile();
+                continue;
+            }
+            if (m_memory.empty()) { break; }
+            send.push_back(m_memory.front());
+            m_memory.pop_front();
+        }
+        // file is reused from its start once everything in it is drained
+        if (m_fileSize && m_readOffset >= m_fileSize) { resetFile(); }
+        m_stats.drained += send.size();
+        if (empty()) {
+            LOG_INFO(DHCP6ExporterLogger, DHCP6_EXPORTER_SPOOL_DRAINED)
+                .arg(m_config.path)
+                .arg(m_stats.drained);
+        }
+        m_sending++;
+    }
+    for (const auto& op : send) { m_forwardHandler(op.route, op.remove); }
+    std::unique_lock lock(m_mutex);
+    m_sending--;
+}
+
+void RouteSpool::spill() {
+    // the latest operation of every lease, in order of these operations
+    std::unordered_set<RouteLeaseKey, RouteLeaseKeyHash> seen;
+    std::vector<const Operation*>                         latest;
+    for (auto it{m_memory.rbegin()}; it != m_memory.rend(); ++it) {
+        if (seen.insert(RouteLeaseKey::fromRoute(it->route)).second) {
+            latest.push_back(&*it);
+        }
+    }
+    string buffer;
+    size_t written{0};
+    buffer.reserve(latest.size() * (RouteRecord::FixedSize + 16));
+    for (auto it{latest.rbegin()}; it != latest.rend(); ++it) {
+        if (appendRecord(buffer, **it)) { written++; }
+    }
+
+    std::fseek(m_file, 0, SEEK_END);
+    bool flushed{std::fwrite(buffer.data(), 1, buffer.size(), m_file) == buffer.size() &&
+                 std::fflush(m_file) == 0 && fsync(fileno(m_file)) == 0};
+    if (!flushed) {
+        LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_SPOOL_WRITE_FAILED)
+            .arg(m_config.path)
+            .arg(std::strerror(errno))
+            .arg(m_memory.size());
+        // part of records may be written, file is cut back to the last whole one
+        std::clearerr(m_file);
+        if (ftruncate(fileno(m_file), m_fileSize) != 0) {
+            m_stats.dropped += m_stats.spooled;
+            m_stats.spooled = 0;
+            resetFile();
+        }
+        m_stats.dropped += m_memory.size();
+        m_memory.clear();
+        return;
+    }
+    m_fileSize += static_cast<long>(buffer.size());
+    m_stats.spooled += written;
+    m_stats.spilled += written;
+    m_stats.dropped += latest.size() - written;
+    m_stats.compacted += m_memory.size() - latest.size();
+    LOG_DEBUG(DHCP6ExporterLogger, DBGLVL_TRACE_BASIC, DHCP6_EXPORTER_SPOOL_SPILLED)
+        .arg(m_config.path)
+        .arg(written)
+        .arg(m_memory.size() - latest.size());
+    m_memory.clear();
+}
+
+bool RouteSpool::appendRecord(string& out, const Operation& op) {
+    return RouteRecord::append(out, op.route, static_cast<uint8_t>(op.remove));
+}
+
+bool RouteSpool::readOperation(Operation& op) {
+    uint16_t size{0};
+    if (m_fileSize - m_readOffset < static_cast<long>(sizeof(size))) { return false; }
+    std::fseek(m_file, m_readOffset, SEEK_SET);
+    if (std::fread(&size, sizeof(size), 1, m_file) != 1 ||
+        size < RouteRecord::FixedSize || size > RouteRecord::MaxSize ||
+        m_fileSize - m_readOffset < static_cast<long>(sizeof(size) + size)) {
+        return false;
+    }
+    char payload[RouteRecord::MaxSize];
+    if (std::fread(payload, 1, size, m_file) != size) { return false; }
+    uint8_t remove;
+    if (!RouteRecord::parse(payload, size, op.route, remove)) { return false; }
+    op.remove = remove != 0;
+    m_readOffset += static_cast<long>(sizeof(size) + size);
+    return true;
+}
+
+void RouteSpool::resetFile() {
+    std::fflush(m_file);
+    if (ftruncate(fileno(m_file), 0) != 0) {
+        LOG_ERROR(DHCP6ExporterLogger, DHCP6_EXPORTER_SPOOL_WRITE_FAILED)
+            .arg(m_config.path)
+            .arg(std::strerror(errno))
+            .arg(0);
+    }
+    m_readOffset = 0;
+    m_fileSize   = 0;
+}
+
+RouteSpool::Stats RouteSpool::stats() {
+    std::unique_lock lock(m_mutex);
+    auto             result{m_stats};
+    result.paused    = m_paused;
+    result.queued    = m_memory.size();
+    result.fileBytes = static_cast<uint64_t>(m_fileSize);
+    return result;
+}
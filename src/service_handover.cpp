@@ -0,0 +1,231 @@
+#include "service_handover.hpp"
+#include "config_params.hpp"
+#include <cc/data.h>
+#include <cc/dhcp_config_error.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using isc::data::Element;
+
+#define FIELD_ERROR_STR(field_name, what) "Field \"" field_name "\" in \"handover\" " what
+
+namespace {
+    int64_t nowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void appendBlock(string& out, const string& block) {
+        auto size{static_cast<uint32_t>(block.size())};
+        out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        out += block;
+    }
+
+    // returns false if `data` ends before the block
+    bool readBlock(const string& data, size_t& offset, string& block) {
+        uint32_t size{0};
+        if (data.size() - offset < sizeof(size)) { return false; }
+        std::memcpy(&size, data.data() + offset, sizeof(size));
+        offset += sizeof(size);
+        if (data.size() - offset < size) { return false; }
+        block.assign(data, offset, size);
+        offset += size;
+        return true;
+    }
+
+    int64_t intField(const ConstElementPtr& map, const char* name) {
+        auto field{map->get(name)};
+        if (!field || field->getType() != Element::integer) {
+            isc_throw(isc::BadValue, "no integer \"" << name << "\" in header");
+        }
+        return field->intValue();
+    }
+
+    string stringField(const ConstElementPtr& map, const char* name) {
+        auto field{map->get(name)};
+        if (!field || field->getType() != Element::string) {
+            isc_throw(isc::BadValue, "no string \"" << name << "\" in header");
+        }
+        return field->stringValue();
+    }
+
+    void discard(const string& path, const string& reason) {
+        LOG_WARN(DHCP6ExporterLogger, DHCP6_EXPORTER_HANDOVER_DISCARDED)
+            .arg(path)
+            .arg(reason);
+    }
+}    // namespace
+
+ServiceHandover::Config ServiceHandover::Config::parseConfig(ConstElementPtr config) {
+    Config result;
+    if (config->getType() != Element::map) {
+        isc_throw(isc::ConfigError, "parameter \"handover\" must be a map");
+    }
+    auto path{config->get("path")};
+    if (!path || path->getType() != Element::string || path->stringValue().empty()) {
+        isc_throw(isc::ConfigError,
+                  FIELD_ERROR_STR("path", "must be a non-empty string"));
+    }
+    result.path     = path->stringValue();
+    result.maxAgeMs =
+        parsePositiveInteger(config, "handover", "max-age", result.maxAgeMs);
+    return result;
+}
+
+size_t ServiceHandover::hashParams(std::initializer_list<ConstElementPtr> params) {
+    string text;
+    for (const auto& param : params) {
+        text += param ? param->str() : "null";
+        text += '\n';
+    }
+    return std::hash<string>{}(text);
+}
+
+void ServiceHandover::write(const Config& config) const {
+    auto header{Element::createMap()};
+    header->set("pid", Element::create(static_cast<long long>(getpid())));
+    header->set("written-at", Element::create(static_cast<long long>(nowMs())));
+    header->set("connection-hash",
+                Element::create(static_cast<long long>(connectionHash)));
+    header->set("ha-hash", Element::create(static_cast<long long>(haHash)));
+    if (switchUptimeSecs) {
+        header->set("switch-uptime",
+                    Element::create(static_cast<long long>(*switchUptimeSecs)));
+    }
+    string records;
+    if (ha) {
+        auto haState{Element::createMap()};
+        haState->set("mode", Element::create(ha->mode));
+        haState->set("role", Element::create(ha->role));
+        haState->set("state", Element::create(ha->state));
+        bool complete{ha->complete};
+        for (const auto& op : ha->shadow) {
+            // lease of unstored operation is resynced on takeover
+            if (!RouteRecord::append(records, op.route,
+                                     static_cast<uint8_t>(op.remove))) {
+                complete = false;
+            }
+        }
+        haState->set("complete", Element::create(complete));
+        header->set("ha", haState);
+    }
+    string data(Magic, sizeof(Magic));
+    appendBlock(data, header->str());
+    appendBlock(data, tlsSession);
+    data += records;
+
+    // state of previous unload is never left behind for the next load
+    std::remove(config.path.c_str());
+    auto tmpPath{config.path + ".tmp"};
+    // file holds TLS session secret
+    int fd{::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600)};
+    if (fd < 0) {
+        isc_throw(isc::Unexpected, "failed to open " << tmpPath << ": "
+                                                     << std::strerror(errno));
+    }
+    size_t written{0};
+    while (written < data.size()) {
+        auto size{::write(fd, data.data() + written, data.size() - written)};
+        if (size < 0 && errno == EINTR) { continue; }
+        if (size <= 0) { break; }
+        written += static_cast<size_t>(size);
+    }
+    bool flushed{written == data.size() && fsync(fd) == 0};
+    int  error{errno};
+    ::close(fd);
+    if (!flushed || std::rename(tmpPath.c_str(), config.path.c_str()) != 0) {
+        if (flushed) { error = errno; }
+        std::remove(tmpPath.c_str());
+        isc_throw(isc::Unexpected, "failed to write " << config.path << ": "
+                                                      << std::strerror(error));
+    }
+}
+
+std::optional<ServiceHandover> ServiceHandover::take(const Config& config) {
+    std::FILE* file{std::fopen(config.path.c_str(), "rb")};
+    if (!file) {
+        if (errno != ENOENT) { discard(config.path, std::strerror(errno)); }
+        return std::nullopt;
+    }
+    string data;
+    char   buffer[64 * 1024];
+    size_t size;
+    while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.append(buffer, size);
+    }
+    std::fclose(file);
+    // state is handed over once, failed load starts the next one cold
+    std::remove(config.path.c_str());
+
+    ServiceHandover result;
+    try {
+        if (data.size() < sizeof(Magic) ||
+            std::memcmp(data.data(), Magic, sizeof(Magic)) != 0) {
+            isc_throw(isc::BadValue, "not a handover file");
+        }
+        size_t offset{sizeof(Magic)};
+        string headerText;
+        if (!readBlock(data, offset, headerText) ||
+            !readBlock(data, offset, result.tlsSession)) {
+            isc_throw(isc::BadValue, "file is truncated");
+        }
+        auto header{Element::fromJSON(headerText)};
+        if (header->getType() != Element::map) {
+            isc_throw(isc::BadValue, "header is not a map");
+        }
+        // file of previous run of the server describes the switch as it was
+        // before restart
+        if (intField(header, "pid") != getpid()) {
+            isc_throw(isc::BadValue, "file was written by another process");
+        }
+        auto ageMs{nowMs() - intField(header, "written-at")};
+        if (ageMs < 0 || static_cast<size_t>(ageMs) > config.maxAgeMs) {
+            isc_throw(isc::BadValue, "file was written " << ageMs << " ms ago");
+        }
+        result.connectionHash = static_cast<size_t>(intField(header, "connection-hash"));
+        result.haHash         = static_cast<size_t>(intField(header, "ha-hash"));
+        if (header->get("switch-uptime")) {
+            result.switchUptimeSecs =
+                static_cast<size_t>(intField(header, "switch-uptime"));
+        }
+        auto haState{header->get("ha")};
+        if (haState) {
+            auto complete{haState->get("complete")};
+            if (!complete || complete->getType() != Element::boolean) {
+                isc_throw(isc::BadValue, "no boolean \"complete\" in header");
+            }
+            HAOwnership::Handover ha{stringField(haState, "mode"),
+                                     stringField(haState, "role"),
+                                     stringField(haState, "state")};
+            ha.complete = complete->boolValue();
+            while (offset < data.size()) {
+                uint16_t recordSize{0};
+                if (data.size() - offset < sizeof(recordSize)) { break; }
+                std::memcpy(&recordSize, data.data() + offset, sizeof(recordSize));
+                offset += sizeof(recordSize);
+                HAOwnership::Operation op;
+                uint8_t                remove{0};
+                if (data.size() - offset < recordSize ||
+                    !RouteRecord::parse(data.data() + offset, recordSize, op.route,
+                                        remove)) {
+                    break;
+                }
+                offset += recordSize;
+                op.remove = remove != 0;
+                ha.shadow.push_back(std::move(op));
+            }
+            // operations after corrupted record are lost
+            if (offset != data.size()) { ha.complete = false; }
+            result.ha = std::move(ha);
+        }
+    } catch (const std::exception& ex) {
+        discard(config.path, ex.what());
+        return std::nullopt;
+    }
+    return result;
+}
@@ -0,0 +1,271 @@
+#include "span_tracer.hpp"
+#include "version.hpp"
+#include <cc/data.h>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+
+std::atomic<bool> SpanTracer::s_enabled{false};
+
+namespace {
+    // spans of one OTLP line
+    constexpr size_t MaxBatchSpans{64};
+    // buffered spans are written at least once per second while traffic flows
+    constexpr uint64_t MaxBatchAgeNs{1'000'000'000};
+
+    struct SpanSink {
+        std::mutex            mutex;
+        FILE*                 file{nullptr};
+        string                batch;
+        size_t                batchSpans{0};
+        uint64_t              batchStart{0};
+        std::atomic<uint64_t> sampleThreshold{0};
+    };
+
+    SpanSink& spanSink() {
+        static SpanSink sink;
+        return sink;
+    }
+
+    thread_local SpanTracer::CalloutScope* currentCalloutScope{nullptr};
+
+    inline uint64_t mix64(uint64_t value) {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ULL;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebULL;
+        value ^= value >> 31;
+        return value;
+    }
+
+    struct TraceId {
+        uint64_t high;
+        uint64_t low;
+
+        bool operator==(const TraceId& other) const {
+            return high == other.high && low == other.low;
+        }
+    };
+
+    inline TraceId traceIdOf(const RouteExport& route) {
+        return {route.duidHash, (uint64_t{route.tid} << 32) | route.iaid};
+    }
+
+    inline uint64_t rootSpanIdOf(const TraceId& traceId) {
+        // zero span id is invalid in OTLP
+        return mix64(traceId.high ^ mix64(traceId.low)) | 1;
+    }
+
+    uint64_t randomSpanId() {
+        thread_local uint64_t state{
+            mix64(static_cast<uint64_t>(
+                      std::chrono::steady_clock::now().time_since_epoch().count()) ^
+                  reinterpret_cast<uintptr_t>(&state))};
+        state += 0x9e3779b97f4a7c15ULL;
+        return mix64(state) | 1;
+    }
+
+    void appendHex(string& out, uint64_t value) {
+        constexpr char Digits[]{"0123456789abcdef"};
+        for (int shift = 60; shift >= 0; shift -= 4) {
+            out += Digits[(value >> shift) & 0xf];
+        }
+    }
+
+    void appendIntAttribute(string& out, const char* key, int64_t value) {
+        out += R"({"key":")";
+        out += key;
+        out += R"(","value":{"intValue":")";
+        out += std::to_string(value);
+        out += R"("}},)";
+    }
+
+    void appendStringAttribute(string& out, const char* key, const string& value) {
+        // values are addresses, hex and fixed names, no escaping is needed
+        out += R"({"key":")";
+        out += key;
+        out += R"(","value":{"stringValue":")";
+        out += value;
+        out += R"("}},)";
+    }
+
+    // caller holds sink mutex
+    void writeBatch(SpanSink& sink) {
+        if (!sink.batchSpans || !sink.file) { return; }
+        string line;
+        line.reserve(sink.batch.size() + 256);
+        line += R"({"resourceSpans":[{"resource":{"attributes":[)";
+        line += R"({"key":"service.name","value":{"stringValue":"kea-dhcp6"}}]},)";
+        line += R"("scopeSpans":[{"scope":{"name":"nxos_dhcp6_exporter","version":")";
+        line += DHCP6_EXPORTER_VERSION;
+        line += R"("},"spans":[)";
+        line += sink.batch;
+        line += "]}]}]}\n";
+        std::fwrite(line.data(), 1, line.size(), sink.file);
+        std::fflush(sink.file);
+        sink.batch.clear();
+        sink.batchSpans = 0;
+    }
+}    // namespace
+
+void SpanTracer::configure(ConstElementPtr config) {
+    using isc::data::Element;
+    shutdown();
+    if (!config) { return; }
+    if (config->getType() != Element::map) {
+        isc_throw(isc::BadValue, "parameter \"tracing\" must be a map");
+    }
+    auto fileParam{config->get("file")};
+    if (!fileParam || fileParam->getType() != Element::string) {
+        isc_throw(isc::BadValue, "parameter \"tracing.file\" must be a string");
+    }
+    double sampleRatio{1.0};
+    auto   sampleRatioParam{config->get("sample-ratio")};
+    if (sampleRatioParam) {
+        if (sampleRatioParam->getType() == Element::real) {
+            sampleRatio = sampleRatioParam->doubleValue();
+        } else if (sampleRatioParam->getType() == Element::integer) {
+            sampleRatio = static_cast<double>(sampleRatioParam->intValue());
+        } else {
+            isc_throw(isc::BadValue,
+                      "parameter \"tracing.sample-ratio\" must be a number");
+        }
+        if (sampleRatio < 0.0 || sampleRatio > 1.0) {
+            isc_throw(isc::BadValue,
+                      "parameter \"tracing.sample-ratio\" must be in range [0, 1]");
+        }
+    }
+    if (sampleRatio == 0.0) { return; }
+
+    auto& sink{spanSink()};
+    auto  filename{fileParam->stringValue()};
+    auto* file{std::fopen(filename.c_str(), "a")};
+    if (!file) { isc_throw(isc::BadValue, "failed to open tracing file: " << filename); }
+
+    std::unique_lock lock(sink.mutex);
+    sink.file = file;
+    sink.sampleThreshold.store(
+        sampleRatio >= 1.0 ? UINT64_MAX
+                           : static_cast<uint64_t>(sampleRatio * 18446744073709551616.0),
+        std::memory_order_relaxed);
+    s_enabled.store(true, std::memory_order_release);
+}
+
+void SpanTracer::shutdown() {
+    auto&            sink{spanSink()};
+    std::unique_lock lock(sink.mutex);
+    s_enabled.store(false, std::memory_order_release);
+    writeBatch(sink);
+    if (sink.file) {
+        std::fclose(sink.file);
+        sink.file = nullptr;
+    }
+}
+
+uint64_t SpanTracer::now() {
+    if (!enabled()) { return 0; }
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+bool SpanTracer::sampled(const RouteExport& route) {
+    if (!enabled()) { return false; }
+    auto traceId{traceIdOf(route)};
+    return mix64(traceId.high ^ traceId.low) <=
+           spanSink().sampleThreshold.load(std::memory_order_relaxed);
+}
+
+void SpanTracer::attachRoute(const RouteExport& route) {
+    auto* scope{currentCalloutScope};
+    if (!scope || !scope->m_start || scope->m_routesSize == CalloutScope::MaxRoutes) {
+        return;
+    }
+    scope->m_routes[scope->m_routesSize++] = route;
+}
+
+void SpanTracer::record(const char*        name,
+                        const RouteExport& route,
+                        uint64_t           start,
+                        uint64_t           end,
+                        int32_t            httpStatus,
+                        bool               error) {
+    if (!start || !sampled(route)) { return; }
+    recordSpan(name, route, start, end, /*root=*/false, httpStatus, error);
+}
+
+void SpanTracer::recordSpan(const char*        name,
+                            const RouteExport& route,
+                            uint64_t           start,
+                            uint64_t           end,
+                            bool               root,
+                            int32_t            httpStatus,
+                            bool               error) {
+    auto traceId{traceIdOf(route)};
+    auto rootSpanId{rootSpanIdOf(traceId)};
+
+    string span;
+    span.reserve(640);
+    span += R"({"traceId":")";
+    appendHex(span, traceId.high);
+    appendHex(span, traceId.low);
+    span += R"(","spanId":")";
+    appendHex(span, root ? rootSpanId : randomSpanId());
+    if (!root) {
+        span += R"(","parentSpanId":")";
+        appendHex(span, rootSpanId);
+    }
+    span += R"(","name":")";
+    span += name;
+    span += R"(","kind":1,"startTimeUnixNano":")";
+    span += std::to_string(start);
+    span += R"(","endTimeUnixNano":")";
+    span += std::to_string(end);
+    span += R"(","attributes":[)";
+    appendIntAttribute(span, "dhcp.transaction_id", route.tid);
+    appendIntAttribute(span, "dhcp.iaid", route.iaid);
+    string duidHash;
+    appendHex(duidHash, route.duidHash);
+    appendStringAttribute(span, "dhcp.duid_hash", duidHash);
+    appendStringAttribute(span, "route.type", route.toDHCPv6IATypeString());
+    appendStringAttribute(span, "route.prefix", route.prefixText());
+    if (httpStatus) { appendIntAttribute(span, "http.response.status_code", httpStatus); }
+    // drop trailing comma of the last attribute
+    span.back() = ']';
+    span += error ? R"(,"status":{"code":2}})" : "}";
+
+    auto&            sink{spanSink()};
+    std::unique_lock lock(sink.mutex);
+    if (!sink.file) { return; }
+    if (sink.batchSpans) {
+        sink.batch += ',';
+    } else {
+        sink.batchStart = end;
+    }
+    sink.batch += span;
+    sink.batchSpans++;
+    if (sink.batchSpans >= MaxBatchSpans || end - sink.batchStart >= MaxBatchAgeNs) {
+        writeBatch(sink);
+    }
+}
+
+SpanTracer::CalloutScope::CalloutScope(const char* name) :
+    m_name(name), m_start(SpanTracer::now()), m_previous(currentCalloutScope) {
+    currentCalloutScope = this;
+}
+
+SpanTracer::CalloutScope::~CalloutScope() {
+    currentCalloutScope = m_previous;
+    if (!m_start) { return; }
+    auto end{SpanTracer::now()};
+    for (size_t i = 0; i < m_routesSize; ++i) {
+        const auto& route{m_routes[i]};
+        // renew with changed address gives two routes of the same trace
+        bool duplicate{false};
+        for (size_t j = 0; j < i; ++j) {
+            duplicate = duplicate || traceIdOf(m_routes[j]) == traceIdOf(route);
+        }
+        if (duplicate || !SpanTracer::sampled(route)) { continue; }
+        SpanTracer::recordSpan(m_name, route, m_start, end, /*root=*/true, 0, false);
+    }
+}
@@ -0,0 +1,126 @@
+#include "trace_ring.hpp"
+#include <cc/data.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+struct TraceRing::Registry {
+    std::mutex                         mutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+    // rings of exited threads
+    std::vector<Ring*> free;
+    uint32_t           nextThreadIndex{0};
+};
+
+TraceRing::Registry& TraceRing::registry() {
+    static Registry registry;
+    return registry;
+}
+
+TraceRing::Ring& TraceRing::threadRing() {
+    // elastic pools recreate threads, so ring goes back to registry on thread exit
+    struct Owner {
+        Ring* ring{nullptr};
+
+        Owner() {
+            auto&            rings{registry()};
+            std::unique_lock lock(rings.mutex);
+            if (rings.free.empty()) {
+                rings.rings.push_back(std::make_shared<Ring>());
+                ring = rings.rings.back().get();
+            } else {
+                ring = rings.free.back();
+                rings.free.pop_back();
+            }
+            // events keep index of the thread that recorded them
+            ring->threadIndex = rings.nextThreadIndex++;
+        }
+
+        ~Owner() {
+            auto&            rings{registry()};
+            std::unique_lock lock(rings.mutex);
+            rings.free.push_back(ring);
+        }
+    };
+
+    thread_local Owner owner;
+    return *owner.ring;
+}
+
+void TraceRing::record(TraceEventType type, const RouteExport& route, int32_t result) {
+    auto& ring{threadRing()};
+    auto  index{ring.head.load(std::memory_order_relaxed)};
+    auto& slot{ring.slots[index & (Capacity - 1)]};
+
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event.timestamp = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+    slot.event.threadIndex = ring.threadIndex;
+    slot.event.type        = type;
+    slot.event.result      = result;
+    slot.event.route       = route;
+    slot.sequence.store(index + 1, std::memory_order_release);
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> TraceRing::dump(size_t limit) {
+    std::vector<TraceEvent> events;
+    auto&                   rings{registry()};
+    std::unique_lock        lock(rings.mutex);
+    for (const auto& ringPtr : rings.rings) {
+        const auto& ring{*ringPtr};
+        auto        head{ring.head.load(std::memory_order_acquire)};
+        auto        first{head > Capacity ? head - Capacity : 0};
+        for (auto index{first}; index < head; ++index) {
+            const auto& slot{ring.slots[index & (Capacity - 1)]};
+            if (slot.sequence.load(std::memory_order_acquire) != index + 1) { continue; }
+            TraceEvent event;
+            std::memcpy(&event, &slot.event, sizeof(event));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // slot was reused by writer while it was copied
+            if (slot.sequence.load(std::memory_order_relaxed) != index + 1) { continue; }
+            events.push_back(event);
+        }
+    }
+    lock.unlock();
+
+    std::sort(events.begin(), events.end(),
+              [](const TraceEvent& lhs, const TraceEvent& rhs) {
+                  return lhs.timestamp < rhs.timestamp;
+              });
+    if (events.size() > limit) {
+        events.erase(events.begin(), events.end() - static_cast<ptrdiff_t>(limit));
+    }
+    return events;
+}
+
+const char* TraceRing::typeToString(TraceEventType type) {
+    switch (type) {
+        case TraceEventType::EXPORT_ROUTE: return "export-route";
+        case TraceEventType::REMOVE_ROUTE: return "remove-route";
+        case TraceEventType::ROUTE_APPLY_SUCCESS: return "route-apply-success";
+        case TraceEventType::ROUTE_APPLY_FAILED: return "route-apply-failed";
+        case TraceEventType::ROUTE_REMOVE_SUCCESS: return "route-remove-success";
+        case TraceEventType::ROUTE_REMOVE_FAILED: return "route-remove-failed";
+    }
+    return "unknown";
+}
+
+isc::data::ElementPtr TraceRing::toElement(const TraceEvent& event) {
+    using isc::data::Element;
+    auto element{Element::createMap()};
+    element->set("timestamp", Element::create(static_cast<long long>(event.timestamp)));
+    element->set("thread", Element::create(static_cast<long long>(event.threadIndex)));
+    element->set("event", Element::create(typeToString(event.type)));
+    element->set("tid", Element::create(static_cast<long long>(event.route.tid)));
+    element->set("iaid", Element::create(static_cast<long long>(event.route.iaid)));
+    element->set("route-type", Element::create(event.route.toDHCPv6IATypeString()));
+    element->set("prefix", Element::create(event.route.prefixText()));
+    element->set("nexthop", Element::create(event.route.nexthopText()));
+    if (event.result) { element->set("result", Element::create(event.result)); }
+    return element;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+// Minimal assertions of test executables, failed check ends the test
+// with exit status 1 so CTest reports it
+#define CHECK(condition)                                                             \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition \
+                      << "\n";                                                       \
+            std::exit(1);                                                            \
+        }                                                                            \
+    } while (false)
+
+#define CHECK_EQ(actual, expected)                                                   \
+    do {                                                                             \
+        const auto& checkActual{actual};                                             \
+        const auto& checkExpected{expected};                                         \
+        if (!(checkActual == checkExpected)) {                                       \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #actual    \
+                      << " == " #expected ", " << checkActual                        \
+                      << " != " << checkExpected << "\n";                            \
+            std::exit(1);                                                            \
+        }                                                                            \
+    } while (false)
+
+// polls `condition` until it holds or `timeout` passes,
+// requests of the client are answered on other threads
+inline bool waitFor(const std::function<bool()>& condition,
+                    std::chrono::milliseconds    timeout = std::chrono::seconds(10)) {
+    auto deadline{std::chrono::steady_clock::now() + timeout};
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() >= deadline) { return false; }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
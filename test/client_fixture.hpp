@@ -0,0 +1,158 @@
+#pragma once
+#include "management_client.hpp"
+#include "mock_switch.hpp"
+#include <asiolink/io_service.h>
+#include <atomic>
+#include <cc/data.h>
+#include <cstdlib>
+#include <dhcp/duid.h>
+#include <log/logger_support.h>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+
+// Pieces shared by tests and benchmarks which drive clients of the library
+// against `MockSwitch`
+
+inline void initTestLogger(const char* name, bool verbose = false) {
+    isc::log::initLogger(name, verbose ? isc::log::DEBUG : isc::log::WARN,
+                         verbose ? isc::log::MAX_DEBUG_LEVEL : 0);
+}
+
+// IOService of the server, run on own thread until destroyed
+class IOThread {
+  public:
+    IOThread() :
+        m_io(boost::make_shared<isc::asiolink::IOService>()),
+        m_thread([io = m_io] { io->run(); }) {}
+
+    ~IOThread() { stop(); }
+
+    isc::asiolink::IOService& io() { return *m_io; }
+
+    isc::asiolink::IOServicePtr ioPtr() { return m_io; }
+
+    void stop() {
+        if (!m_thread.joinable()) { return; }
+        m_io->stop();
+        m_thread.join();
+    }
+
+  private:
+    isc::asiolink::IOServicePtr m_io;
+    std::thread                 m_thread;
+};
+
+// directory under $TMPDIR removed with its files when destroyed
+class TempDir {
+  public:
+    TempDir() {
+        const char* base{std::getenv("TMPDIR")};
+        string      pattern{string(base ? base : "/tmp") + "/nxos-exporter-XXXXXX"};
+        if (!mkdtemp(pattern.data())) {
+            throw std::runtime_error("failed to create temporary directory");
+        }
+        m_path = pattern;
+    }
+
+    ~TempDir() { std::system(("rm -rf '" + m_path + "'").c_str()); }
+
+    const string& path() const { return m_path; }
+
+    string file(const string& name) const { return m_path + "/" + name; }
+
+  private:
+    string m_path;
+};
+
+// "connection-params" of client of `mock`. HTTPS client gets self-signed
+// certificate written to `dir`, the mock doesn't verify it
+inline isc::data::ElementPtr mockConnectionParams(const MockSwitch& mock,
+                                                  const TempDir&    dir,
+                                                  const string&     engine = "httplib") {
+    auto params{isc::data::Element::createMap()};
+    params->set("host", isc::data::Element::create(mock.url()));
+    params->set("http-engine", isc::data::Element::create(engine));
+    auto credentials{isc::data::Element::createMap()};
+    credentials->set("login", isc::data::Element::create("admin"));
+    credentials->set("password", isc::data::Element::create("admin"));
+    if (mock.url().rfind("https", 0) == 0) {
+        auto certPath{dir.file("client.pem")};
+        auto keyPath{dir.file("client.key")};
+        if (access(certPath.c_str(), R_OK) != 0) {
+            MockSwitch::writeSelfSignedCertificate(certPath, keyPath);
+        }
+        credentials->set("certificate", isc::data::Element::create(certPath));
+        credentials->set("keyfile", isc::data::Element::create(keyPath));
+    }
+    params->set("credentials", credentials);
+    return params;
+}
+
+// `index` added to `base` at bit of prefix `length`, i.e. `index`-th prefix
+// of that length after `base`
+inline IOAddress offsetAddress(const IOAddress& base, uint64_t index, int length) {
+    auto bytes{base.toBytes()};
+    int  bit{128 - length};
+    // index is added from the byte holding lowest bit of the prefix upwards
+    uint64_t carry{index << (bit % 8)};
+    for (int byte = 15 - bit / 8; byte >= 0 && carry; --byte) {
+        carry += bytes[byte];
+        bytes[byte] = static_cast<uint8_t>(carry & 0xff);
+        carry >>= 8;
+    }
+    return IOAddress::fromBytes(AF_INET6, bytes.data());
+}
+
+inline isc::dhcp::DuidPtr indexedDuid(uint32_t index) {
+    // DUID-LL of MAC 02:00:00:00:00:00 + index
+    std::vector<uint8_t> duid{0x00, 0x03, 0x00, 0x01, 0x02, 0x00, 0, 0, 0, 0};
+    for (int byte = 0; byte < 4; ++byte) {
+        duid[9 - byte] = static_cast<uint8_t>(index >> (8 * byte));
+    }
+    return boost::make_shared<isc::dhcp::DUID>(duid);
+}
+
+// `count` IA_PD routes of distinct clients: /56 prefixes from 2001:db8:1000::
+// via IA_NA addresses from 2001:db8:100::/64, like leases of one vlan
+inline std::vector<RouteExport> makePdRoutes(size_t count) {
+    const IOAddress          prefixBase{"2001:db8:1000::"};
+    const IOAddress          addressBase{"2001:db8:100::"};
+    std::vector<RouteExport> routes;
+    routes.reserve(count);
+    for (uint32_t index = 0; index < count; ++index) {
+        auto address{offsetAddress(addressBase, index + 16, 128)};
+        auto prefix{offsetAddress(prefixBase, index, 56)};
+        routes.push_back(
+            RouteExport::makeIA_PD(index, 1, indexedDuid(index), address, prefix, 56));
+    }
+    return routes;
+}
+
+// outcomes of client requests, see `ManagementClient::setTrafficObserver`
+class TrafficCounter {
+  public:
+    ManagementClient::TrafficObserver observer() {
+        return [this](bool answered) { (answered ? m_answered : m_unanswered)++; };
+    }
+
+    uint64_t answered() const { return m_answered; }
+
+    uint64_t unanswered() const { return m_unanswered; }
+
+    uint64_t total() const { return m_answered + m_unanswered; }
+
+    // false if fewer than `count` requests finished before `timeout`
+    bool waitTotal(uint64_t count, std::chrono::milliseconds timeout) const {
+        auto deadline{std::chrono::steady_clock::now() + timeout};
+        while (total() < count) {
+            if (std::chrono::steady_clock::now() >= deadline) { return false; }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+  private:
+    std::atomic<uint64_t> m_answered{0};
+    std::atomic<uint64_t> m_unanswered{0};
+};
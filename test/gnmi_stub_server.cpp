@@ -0,0 +1,211 @@
+#include "gnmi_stub_server.hpp"
+#include <algorithm>
+#include <nlohmann/json.hpp>
+
+using nlohmann::json;
+
+namespace {
+    // value of `key` of element `name` of the path, empty if path has none
+    string pathKey(const gnmi::Path& path, const string& name, const string& key) {
+        for (const auto& elem : path.elem()) {
+            if (elem.name() != name) { continue; }
+            auto it{elem.key().find(key)};
+            return it != elem.key().end() ? it->second : string();
+        }
+        return {};
+    }
+
+    bool hasElem(const gnmi::Path& path, const string& name) {
+        return std::any_of(path.elem().begin(), path.elem().end(),
+                           [&](const auto& elem) { return elem.name() == name; });
+    }
+
+    // nexthop in CLI form kept by the mock, "vlan100" of device model is "Vlan100"
+    string cliNexthop(const string& nhAddr, const string& nhIf) {
+        if (nhIf.empty() || nhIf == "unspecified") {
+            return nhAddr.substr(0, nhAddr.find('/'));
+        }
+        string name{nhIf};
+        name[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(name[0])));
+        return name;
+    }
+
+    string modelInterfaceName(string name) {
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        return name;
+    }
+
+    bool isAddress(const string& nexthop) { return nexthop.find(':') != string::npos; }
+
+    int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // "Route-list" of `vrf` in JSON_IETF, nexthops of a prefix are one entry
+    json routeList(const std::vector<MockSwitch::Route>& routes, const string& vrf) {
+        std::map<string, json> byPrefix;
+        for (const auto& route : routes) {
+            if (route.vrf != vrf) { continue; }
+            bool address{isAddress(route.nexthop)};
+            auto nhIf{address ? "unspecified" : modelInterfaceName(route.nexthop)};
+            json nexthop{{"nhAddr", address ? route.nexthop + "/128" : "::/128"},
+                         {"nhIf", nhIf},
+                         {"nhVrf", vrf},
+                         {"object", 0}};
+            if (!route.tag.empty()) { nexthop["tag"] = std::stoul(route.tag); }
+            if (!route.name.empty()) { nexthop["rtname"] = route.name; }
+            auto& entry{byPrefix[route.prefix]};
+            if (entry.is_null()) {
+                entry = {{"prefix", route.prefix},
+                         {"nh-items", {{"Nexthop-list", json::array()}}}};
+            }
+            entry["nh-items"]["Nexthop-list"].push_back(std::move(nexthop));
+        }
+        json list = json::array();
+        for (auto& [prefix, entry] : byPrefix) { list.push_back(std::move(entry)); }
+        return list;
+    }
+}    // namespace
+
+GnmiStubServer::GnmiStubServer(MockSwitch& mock) : m_mock(mock) {}
+
+GnmiStubServer::~GnmiStubServer() { stop(); }
+
+void GnmiStubServer::start() {
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &m_port);
+    builder.RegisterService(this);
+    m_server = builder.BuildAndStart();
+    if (!m_server || m_port == 0) {
+        throw std::runtime_error("failed to start gNMI stub server");
+    }
+}
+
+void GnmiStubServer::stop() {
+    if (!m_server) { return; }
+    m_server->Shutdown();
+    m_server->Wait();
+    m_server.reset();
+}
+
+GnmiStubServer::Stats GnmiStubServer::stats() const {
+    std::unique_lock lock(m_mutex);
+    return m_stats;
+}
+
+grpc::Status GnmiStubServer::Set(grpc::ServerContext*    context,
+                                 const gnmi::SetRequest* request,
+                                 gnmi::SetResponse*      response) {
+    if (!authorized(*context)) {
+        return fail(grpc::StatusCode::UNAUTHENTICATED, "invalid credentials");
+    }
+    // Set is one transaction, nothing is applied if any path is invalid
+    std::vector<MockSwitch::Route> deletes;
+    std::vector<MockSwitch::Route> updates;
+    try {
+        for (const auto& path : request->delete_()) {
+            MockSwitch::Route route{pathKey(path, "Dom-list", "name"),
+                                    pathKey(path, "Route-list", "prefix"),
+                                    cliNexthop(pathKey(path, "Nexthop-list", "nhAddr"),
+                                               pathKey(path, "Nexthop-list", "nhIf")),
+                                    {},
+                                    {}};
+            if (route.vrf.empty() || route.prefix.empty() || route.nexthop.empty()) {
+                return fail(grpc::StatusCode::INVALID_ARGUMENT,
+                            "delete path must name nexthop of route");
+            }
+            deletes.push_back(std::move(route));
+        }
+        for (const auto& update : request->update()) {
+            auto vrf{pathKey(update.path(), "Dom-list", "name")};
+            if (vrf.empty() || !hasElem(update.path(), "Route-list")) {
+                return fail(grpc::StatusCode::INVALID_ARGUMENT,
+                            "update path must name route");
+            }
+            auto value{json::parse(update.val().json_ietf_val())};
+            auto prefix{value.at("prefix").get<string>()};
+            for (const auto& nexthop : value.at("nh-items").at("Nexthop-list")) {
+                MockSwitch::Route route{vrf, prefix,
+                                        cliNexthop(nexthop.at("nhAddr").get<string>(),
+                                                   nexthop.at("nhIf").get<string>()),
+                                        {}, nexthop.value("rtname", string())};
+                if (nexthop.contains("tag")) {
+                    route.tag = std::to_string(nexthop.at("tag").get<uint32_t>());
+                }
+                updates.push_back(std::move(route));
+            }
+        }
+    } catch (const json::exception& ex) {
+        return fail(grpc::StatusCode::INVALID_ARGUMENT, ex.what());
+    }
+
+    // deletes of a Set are processed before its updates
+    for (const auto& route : deletes) {
+        m_mock.removeRoute(route.prefix, route.nexthop, route.vrf);
+    }
+    for (const auto& route : updates) { m_mock.setRoute(route); }
+
+    response->set_timestamp(nowNs());
+    for (const auto& path : request->delete_()) {
+        auto* result{response->add_response()};
+        *result->mutable_path() = path;
+        result->set_op(gnmi::UpdateResult::DELETE);
+    }
+    for (const auto& update : request->update()) {
+        auto* result{response->add_response()};
+        *result->mutable_path() = update.path();
+        result->set_op(gnmi::UpdateResult::UPDATE);
+    }
+    std::unique_lock lock(m_mutex);
+    m_stats.sets++;
+    m_stats.deletes += static_cast<uint64_t>(request->delete__size());
+    m_stats.updates += static_cast<uint64_t>(request->update_size());
+    return grpc::Status::OK;
+}
+
+grpc::Status GnmiStubServer::Get(grpc::ServerContext*    context,
+                                 const gnmi::GetRequest* request,
+                                 gnmi::GetResponse*      response) {
+    if (!authorized(*context)) {
+        return fail(grpc::StatusCode::UNAUTHENTICATED, "invalid credentials");
+    }
+    if (request->encoding() != gnmi::JSON_IETF) {
+        return fail(grpc::StatusCode::UNIMPLEMENTED, "only JSON_IETF is supported");
+    }
+    auto routes{m_mock.routes()};
+    for (const auto& path : request->path()) {
+        auto vrf{pathKey(path, "Dom-list", "name")};
+        if (vrf.empty() || !hasElem(path, "rt-items")) {
+            return fail(grpc::StatusCode::UNIMPLEMENTED,
+                        "only rt-items of a VRF are served");
+        }
+        auto* notification{response->add_notification()};
+        notification->set_timestamp(nowNs());
+        auto* update{notification->add_update()};
+        *update->mutable_path() = path;
+        json value{{"Route-list", routeList(routes, vrf)}};
+        update->mutable_val()->set_json_ietf_val(value.dump());
+    }
+    std::unique_lock lock(m_mutex);
+    m_stats.gets++;
+    return grpc::Status::OK;
+}
+
+bool GnmiStubServer::authorized(const grpc::ServerContext& context) {
+    const auto& metadata{context.client_metadata()};
+    auto        matches{[&](const char* key, const string& expected) {
+        auto it{metadata.find(key)};
+        return it != metadata.end() &&
+               string(it->second.data(), it->second.size()) == expected;
+    }};
+    return matches("username", "admin") && matches("password", "admin");
+}
+
+grpc::Status GnmiStubServer::fail(grpc::StatusCode code, const string& message) {
+    std::unique_lock lock(m_mutex);
+    m_stats.failedRequests++;
+    return grpc::Status(code, message);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "mock_switch.hpp"
+#include <github.com/openconfig/gnmi/proto/gnmi/gnmi.grpc.pb.h>
+#include <grpcpp/grpcpp.h>
+
+// gNMI server on loopback for tests of "nxos-gnmi" client. Set and Get of
+// static routes under device model "rt-items" are served from route table of
+// `MockSwitch`, which answers NX-API lookups and heartbeat of the same client.
+// Plain HTTP/2 without TLS, credentials are "admin"/"admin" metadata
+class GnmiStubServer : public gnmi::gNMI::Service {
+  public:
+    struct Stats {
+        uint64_t sets{0};
+        uint64_t gets{0};
+        // paths of all Set requests
+        uint64_t updates{0};
+        uint64_t deletes{0};
+        uint64_t failedRequests{0};
+    };
+
+  public:
+    explicit GnmiStubServer(MockSwitch& mock);
+    ~GnmiStubServer() override;
+    GnmiStubServer(const GnmiStubServer&)            = delete;
+    GnmiStubServer& operator=(const GnmiStubServer&) = delete;
+
+    // binds any free port, throws std::runtime_error on failure
+    void start();
+
+    void stop();
+
+    int port() const { return m_port; }
+
+    Stats stats() const;
+
+    grpc::Status Set(grpc::ServerContext*    context,
+                     const gnmi::SetRequest* request,
+                     gnmi::SetResponse*      response) override;
+
+    grpc::Status Get(grpc::ServerContext*    context,
+                     const gnmi::GetRequest* request,
+                     gnmi::GetResponse*      response) override;
+
+  private:
+    MockSwitch&                   m_mock;
+    std::unique_ptr<grpc::Server> m_server;
+    int                           m_port{0};
+
+    mutable std::mutex m_mutex;
+    Stats              m_stats;
+
+  private:
+    static bool authorized(const grpc::ServerContext& context);
+
+    // counts failed request and returns its status
+    grpc::Status fail(grpc::StatusCode code, const string& message);
+};
@@ -0,0 +1,712 @@
+#include "mock_switch.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cctype>
+#include <cstdio>
+#include <httplib.h>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <sstream>
+#include <stdexcept>
+
+using nlohmann::json;
+
+namespace {
+    // NX-API answers failed CLI command with "Invalid params" JSON-RPC error
+    constexpr int InvalidParamsCode{-32602};
+
+    std::vector<string> splitWords(const string& text) {
+        std::vector<string> words;
+        std::istringstream  stream(text);
+        string              word;
+        while (stream >> word) { words.push_back(std::move(word)); }
+        return words;
+    }
+
+    // values of the switch are addresses and interface names, but keep JSON valid
+    void appendJsonString(string& out, const string& value) {
+        out += '"';
+        for (char c : value) {
+            if (c == '"' || c == '\\') { out += '\\'; }
+            out += c;
+        }
+        out += '"';
+    }
+
+    void appendMember(string& out, const char* key, const string& value) {
+        appendJsonString(out, key);
+        out += ':';
+        appendJsonString(out, value);
+    }
+
+    // address part of "addr/len", false if it isn't IPv6 address
+    bool parseAddress(const string& text, std::array<uint8_t, 16>& address, int& length) {
+        auto   slash{text.find('/')};
+        string addressText{text.substr(0, slash)};
+        length = 128;
+        if (slash != string::npos) {
+            try {
+                length = std::stoi(text.substr(slash + 1));
+            } catch (const std::exception&) { return false; }
+            if (length < 0 || length > 128) { return false; }
+        }
+        return inet_pton(AF_INET6, addressText.c_str(), address.data()) == 1;
+    }
+
+    bool prefixContains(const std::array<uint8_t, 16>& prefix,
+                        int                            length,
+                        const std::array<uint8_t, 16>& address) {
+        for (int bit = 0; bit < length; ++bit) {
+            uint8_t mask = static_cast<uint8_t>(0x80 >> (bit % 8));
+            if ((prefix[bit / 8] & mask) != (address[bit / 8] & mask)) { return false; }
+        }
+        return true;
+    }
+
+    // DME uses lowercase interface names, CLI capitalizes them
+    string cliInterfaceName(string name) {
+        if (!name.empty()) {
+            auto first{static_cast<unsigned char>(name[0])};
+            name[0] = static_cast<char>(std::toupper(first));
+        }
+        return name;
+    }
+
+    string dmeInterfaceName(string name) {
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        return name;
+    }
+
+    bool isAddress(const string& nexthop) { return nexthop.find(':') != string::npos; }
+
+    struct KeyPair {
+        EVP_PKEY* key{nullptr};
+        X509*     cert{nullptr};
+
+        ~KeyPair() {
+            X509_free(cert);
+            EVP_PKEY_free(key);
+        }
+    };
+
+    void generateKeyPair(KeyPair& pair) {
+        auto* context{EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr)};
+        if (!context || EVP_PKEY_keygen_init(context) <= 0 ||
+            EVP_PKEY_CTX_set_ec_paramgen_curve_nid(context, NID_X9_62_prime256v1) <= 0 ||
+            EVP_PKEY_keygen(context, &pair.key) <= 0) {
+            EVP_PKEY_CTX_free(context);
+            throw std::runtime_error("failed to generate key");
+        }
+        EVP_PKEY_CTX_free(context);
+        pair.cert = X509_new();
+        ASN1_INTEGER_set(X509_get_serialNumber(pair.cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(pair.cert), 0);
+        X509_gmtime_adj(X509_getm_notAfter(pair.cert), 24 * 3600);
+        X509_set_pubkey(pair.cert, pair.key);
+        auto* name{X509_get_subject_name(pair.cert)};
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                   reinterpret_cast<const unsigned char*>("localhost"),
+                                   -1, -1, 0);
+        X509_set_issuer_name(pair.cert, name);
+        if (!X509_sign(pair.cert, pair.key, EVP_sha256())) {
+            throw std::runtime_error("failed to sign certificate");
+        }
+    }
+}    // namespace
+
+MockSwitch::MockSwitch() : MockSwitch(Config()) {}
+
+MockSwitch::MockSwitch(const Config& config) :
+    m_config(config), m_bootedAt(std::chrono::steady_clock::now()) {}
+
+MockSwitch::~MockSwitch() { stop(); }
+
+void MockSwitch::start() {
+    if (m_config.tls) {
+        KeyPair pair;
+        generateKeyPair(pair);
+        // server takes its own references of certificate and key
+        auto server{std::make_unique<httplib::SSLServer>(pair.cert, pair.key)};
+        if (!server->is_valid()) {
+            throw std::runtime_error("failed to create TLS context of mock switch");
+        }
+        m_server = std::move(server);
+    } else {
+        m_server = std::make_unique<httplib::Server>();
+    }
+    auto threads{m_config.threads};
+    m_server->new_task_queue = [threads] { return new httplib::ThreadPool(threads); };
+    // client keeps connections open as long as it has requests
+    m_server->set_keep_alive_max_count(m_config.keepAliveRequests
+                                           ? m_config.keepAliveRequests
+                                           : std::numeric_limits<size_t>::max());
+    m_server->set_keep_alive_timeout(30);
+    m_server->Post("/ins", [this](const httplib::Request& request,
+                                  httplib::Response&      response) {
+        handleNxApi(request, response);
+    });
+    m_server->Post("/api/aaaLogin.json", [this](const httplib::Request& request,
+                                                httplib::Response&      response) {
+        handleLogin(request, response);
+    });
+    auto dme{[this](const httplib::Request& request, httplib::Response& response) {
+        handleDme(request, response);
+    }};
+    m_server->Post("/api/mo/.*", dme);
+    m_server->Get("/api/mo/.*", dme);
+
+    if (m_config.port) {
+        if (!m_server->bind_to_port("127.0.0.1", m_config.port)) {
+            throw std::runtime_error("failed to bind port " +
+                                     std::to_string(m_config.port));
+        }
+        m_port = m_config.port;
+    } else {
+        m_port = m_server->bind_to_any_port("127.0.0.1");
+        if (m_port < 0) { throw std::runtime_error("failed to bind any port"); }
+    }
+    m_thread = std::thread([this] { m_server->listen_after_bind(); });
+    m_server->wait_until_ready();
+}
+
+void MockSwitch::stop() {
+    if (!m_server) { return; }
+    m_server->stop();
+    if (m_thread.joinable()) { m_thread.join(); }
+    m_server.reset();
+}
+
+string MockSwitch::url() const {
+    return string(m_config.tls ? "https" : "http") + "://127.0.0.1:" +
+           std::to_string(m_port) + "/";
+}
+
+void MockSwitch::populate(size_t count, size_t vlans) {
+    vlans = std::max<size_t>(vlans, 1);
+    for (size_t vlan = 0; vlan < vlans; ++vlan) {
+        char prefix[64];
+        std::snprintf(prefix, sizeof(prefix), "2001:db8:%zx::/64", 100 + vlan);
+        addConnectedRoute(prefix, "Vlan" + std::to_string(100 + vlan));
+    }
+    std::unique_lock lock(m_mutex);
+    m_neighbors.reserve(m_neighbors.size() + count);
+    for (size_t index = 0; index < count; ++index) {
+        auto vlan{100 + index % vlans};
+        auto host{index / vlans + 1};
+        char address[64];
+        char mac[32];
+        std::snprintf(address, sizeof(address), "2001:db8:%zx::%zx:%zx", vlan,
+                      (host >> 16) & 0xffff, host & 0xffff);
+        std::snprintf(mac, sizeof(mac), "02%02zx.%04zx.%04zx", (index >> 32) & 0xff,
+                      (index >> 16) & 0xffff, index & 0xffff);
+        m_neighbors.push_back({"default", "Vlan" + std::to_string(vlan), address, mac});
+    }
+}
+
+void MockSwitch::addNeighbor(const Neighbor& neighbor) {
+    std::unique_lock lock(m_mutex);
+    m_neighbors.push_back(neighbor);
+}
+
+void MockSwitch::addConnectedRoute(const string& prefix,
+                                   const string& ifName,
+                                   const string& vrf) {
+    Connected connected{vrf, {}, 0, prefix, ifName};
+    if (!parseAddress(prefix, connected.address, connected.length)) {
+        throw std::invalid_argument("invalid prefix: " + prefix);
+    }
+    std::unique_lock lock(m_mutex);
+    m_connected.push_back(std::move(connected));
+}
+
+void MockSwitch::reload() {
+    std::unique_lock lock(m_mutex);
+    m_routes.clear();
+    m_tokens.clear();
+    m_bootedAt = std::chrono::steady_clock::now();
+}
+
+void MockSwitch::expireTokens() {
+    std::unique_lock lock(m_mutex);
+    m_tokens.clear();
+}
+
+std::vector<MockSwitch::Route> MockSwitch::routes() const {
+    std::unique_lock   lock(m_mutex);
+    std::vector<Route> result;
+    result.reserve(m_routes.size());
+    for (const auto& [key, route] : m_routes) { result.push_back(route); }
+    return result;
+}
+
+size_t MockSwitch::routeCount() const {
+    std::unique_lock lock(m_mutex);
+    return m_routes.size();
+}
+
+bool MockSwitch::hasRoute(const string& prefix,
+                          const string& nexthop,
+                          const string& vrf) const {
+    std::unique_lock lock(m_mutex);
+    return m_routes.count(routeKey(vrf, prefix, nexthop)) != 0;
+}
+
+void MockSwitch::setRoute(const Route& route) {
+    std::unique_lock lock(m_mutex);
+    m_routes[routeKey(route.vrf, route.prefix, route.nexthop)] = route;
+}
+
+bool MockSwitch::removeRoute(const string& prefix,
+                             const string& nexthop,
+                             const string& vrf) {
+    std::unique_lock lock(m_mutex);
+    return m_routes.erase(routeKey(vrf, prefix, nexthop)) != 0;
+}
+
+MockSwitch::Stats MockSwitch::stats() const {
+    std::unique_lock lock(m_mutex);
+    return m_stats;
+}
+
+void MockSwitch::resetStats() {
+    std::unique_lock lock(m_mutex);
+    m_stats = {};
+    m_clientPorts.clear();
+}
+
+void MockSwitch::writeSelfSignedCertificate(const string& certPath,
+                                            const string& keyPath) {
+    KeyPair pair;
+    generateKeyPair(pair);
+    auto* certFile{std::fopen(certPath.c_str(), "w")};
+    auto* keyFile{std::fopen(keyPath.c_str(), "w")};
+    bool  written{certFile && keyFile && PEM_write_X509(certFile, pair.cert) &&
+                 PEM_write_PrivateKey(keyFile, pair.key, nullptr, nullptr, 0, nullptr,
+                                      nullptr)};
+    if (certFile) { std::fclose(certFile); }
+    if (keyFile) { std::fclose(keyFile); }
+    if (!written) { throw std::runtime_error("failed to write " + certPath); }
+}
+
+string MockSwitch::routeKey(const string& vrf,
+                            const string& prefix,
+                            const string& nexthop) {
+    return vrf + " " + prefix + " " + nexthop;
+}
+
+void MockSwitch::countRequest(const httplib::Request& request) {
+    std::unique_lock lock(m_mutex);
+    m_stats.requests++;
+    if (!m_clientPorts.insert(request.remote_port).second) { return; }
+    m_stats.connections++;
+    if (request.ssl && SSL_session_reused(request.ssl)) { m_stats.resumedSessions++; }
+}
+
+void MockSwitch::handleNxApi(const httplib::Request& request,
+                             httplib::Response&      response) {
+    countRequest(request);
+    if (m_config.latency.count()) { std::this_thread::sleep_for(m_config.latency); }
+    if (!request.has_header("Authorization")) {
+        response.status = 401;
+        return;
+    }
+    auto parsed{json::parse(request.body, nullptr, /*allow_exceptions=*/false)};
+    if (parsed.is_object()) { parsed = json::array({std::move(parsed)}); }
+    if (!parsed.is_array() || parsed.empty()) {
+        response.status = 400;
+        return;
+    }
+
+    // commands run in order and the first failed one stops the request,
+    // "vrf context" holds for route commands after it
+    std::vector<string> answers;
+    bool                failed{false};
+    {
+        std::unique_lock lock(m_mutex);
+        string           vrf{"default"};
+        for (const auto& item : parsed) {
+            string answer{R"({"jsonrpc":"2.0",)"};
+            string command;
+            if (item.contains("params") && item["params"].contains("cmd") &&
+                item["params"]["cmd"].is_string()) {
+                command = item["params"]["cmd"].get<string>();
+            }
+            string result;
+            string error;
+            m_stats.commands++;
+            if (runCommand(command, vrf, result, error)) {
+                answer += R"("result":)" + result;
+            } else {
+                m_stats.failedCommands++;
+                answer += R"("error":{"code":)" + std::to_string(InvalidParamsCode) +
+                          R"(,"message":"Invalid params","data":{)";
+                appendMember(answer, "msg", error);
+                answer += "}}";
+                failed = true;
+            }
+            answer += R"(,"id":)" + (item.contains("id") ? item["id"].dump() : "null");
+            answer += '}';
+            answers.push_back(std::move(answer));
+            if (failed) { break; }
+        }
+    }
+    // request of one command is answered with single object
+    string body;
+    if (parsed.size() == 1) {
+        body = std::move(answers.front());
+    } else {
+        body = "[";
+        for (size_t index = 0; index < answers.size(); ++index) {
+            if (index) { body += ','; }
+            body += answers[index];
+        }
+        body += ']';
+    }
+    response.status = failed ? 500 : 200;
+    response.set_content(body, "application/json-rpc");
+}
+
+bool MockSwitch::runCommand(const string& command,
+                            string&       vrf,
+                            string&       result,
+                            string&       error) {
+    auto words{splitWords(command)};
+    auto is{[&words](std::initializer_list<const char*> prefix) {
+        if (words.size() < prefix.size()) { return false; }
+        size_t index{0};
+        for (const char* word : prefix) {
+            if (words[index++] != word) { return false; }
+        }
+        return true;
+    }};
+    result = "null";
+    if (is({"show", "version"})) {
+        showVersion(result);
+    } else if (is({"show", "ipv6", "neighbor"})) {
+        showNeighbors(is({"show", "ipv6", "neighbor", "vrf", "all"}), result);
+    } else if (is({"show", "ipv6", "route", "static"})) {
+        showStaticRoutes(is({"show", "ipv6", "route", "static", "vrf", "all"}), result);
+    } else if (is({"show", "ipv6", "route"}) && words.size() >= 4) {
+        string lookupVrf{words.size() >= 6 && words[4] == "vrf" ? words[5] : "default"};
+        if (!showRoute(words[3], lookupVrf, result)) {
+            error = "% Invalid ipv6 address";
+            return false;
+        }
+    } else if (is({"vrf", "context"}) && words.size() == 3) {
+        vrf = words[2];
+    } else if (is({"ipv6", "route"}) && words.size() >= 4) {
+        Route route{vrf, words[2], words[3], {}, {}};
+        for (size_t index = 4; index + 1 < words.size(); index += 2) {
+            if (words[index] == "tag") {
+                route.tag = words[index + 1];
+            } else if (words[index] == "name") {
+                route.name = words[index + 1];
+            }
+        }
+        m_routes[routeKey(vrf, route.prefix, route.nexthop)] = std::move(route);
+    } else if (is({"no", "ipv6", "route"}) && words.size() >= 5) {
+        if (!m_routes.erase(routeKey(vrf, words[3], words[4]))) {
+            error = "% Route not found";
+            return false;
+        }
+    } else if (is({"clear", "ipv6", "neighbor"}) && words.size() >= 4) {
+        // neighbors are learned again, table of the mock stays
+    } else {
+        error = "% Invalid command at '^' marker.";
+        return false;
+    }
+    return true;
+}
+
+void MockSwitch::showVersion(string& out) const {
+    auto seconds{std::chrono::duration_cast<std::chrono::seconds>(
+                     std::chrono::steady_clock::now() - m_bootedAt)
+                     .count()};
+    out = R"({"body":{"kern_uptm_days":)" + std::to_string(seconds / 86400) +
+          R"(,"kern_uptm_hrs":)" + std::to_string(seconds / 3600 % 24) +
+          R"(,"kern_uptm_mins":)" + std::to_string(seconds / 60 % 60) +
+          R"(,"kern_uptm_secs":)" + std::to_string(seconds % 60) + "}}";
+}
+
+void MockSwitch::showNeighbors(bool allVrfs, string& out) const {
+    std::map<string, std::vector<const Neighbor*>> byVrf;
+    byVrf["default"];
+    for (const auto& neighbor : m_neighbors) {
+        if (allVrfs || neighbor.vrf == "default") {
+            byVrf[neighbor.vrf].push_back(&neighbor);
+        }
+    }
+    out = R"({"body":{"TABLE_vrf":{"ROW_vrf":[)";
+    bool firstVrf{true};
+    for (const auto& [vrf, neighbors] : byVrf) {
+        if (!firstVrf) { out += ','; }
+        firstVrf = false;
+        out += '{';
+        appendMember(out, "vrf-name-out", vrf);
+        out += R"(,"TABLE_afi":{"ROW_afi":{"afi":"ipv6","TABLE_adj":{"ROW_adj":[)";
+        for (size_t index = 0; index < neighbors.size(); ++index) {
+            if (index) { out += ','; }
+            out += '{';
+            appendMember(out, "intf-out", neighbors[index]->ifName);
+            out += ',';
+            appendMember(out, "ipv6-addr", neighbors[index]->address);
+            out += ',';
+            appendMember(out, "mac", neighbors[index]->mac);
+            out += '}';
+        }
+        out += "]}}}}";
+    }
+    out += "]}}}";
+}
+
+void MockSwitch::showStaticRoutes(bool allVrfs, string& out) const {
+    // routes of a prefix are paths of one row
+    std::map<string, std::map<string, std::vector<const Route*>>> byVrf;
+    byVrf["default"];
+    for (const auto& [key, route] : m_routes) {
+        if (allVrfs || route.vrf == "default") {
+            byVrf[route.vrf][route.prefix].push_back(&route);
+        }
+    }
+    out = R"({"body":{"TABLE_vrf":{"ROW_vrf":[)";
+    bool firstVrf{true};
+    for (const auto& [vrf, prefixes] : byVrf) {
+        if (!firstVrf) { out += ','; }
+        firstVrf = false;
+        out += '{';
+        appendMember(out, "vrf-name-out", vrf);
+        out += R"(,"TABLE_addrf":{"ROW_addrf":{"addrf":"ipv6")";
+        if (!prefixes.empty()) { out += R"(,"TABLE_prefix":{"ROW_prefix":[)"; }
+        bool firstPrefix{true};
+        for (const auto& [prefix, paths] : prefixes) {
+            if (!firstPrefix) { out += ','; }
+            firstPrefix = false;
+            out += '{';
+            appendMember(out, "ipprefix", prefix);
+            out += R"(,"attached":"false","TABLE_path":{"ROW_path":[)";
+            for (size_t index = 0; index < paths.size(); ++index) {
+                if (index) { out += ','; }
+                out += '{';
+                const auto& nexthop{paths[index]->nexthop};
+                appendMember(out, isAddress(nexthop) ? "ipnexthop" : "ifname", nexthop);
+                if (!paths[index]->tag.empty()) {
+                    out += R"(,"tag":)" + paths[index]->tag;
+                }
+                out += '}';
+            }
+            out += "]}}";
+        }
+        if (!prefixes.empty()) { out += "]}"; }
+        out += "}}}";
+    }
+    out += "]}}}";
+}
+
+bool MockSwitch::showRoute(const string& address, const string& vrf, string& out) const {
+    std::array<uint8_t, 16> target;
+    int                     targetLength;
+    if (!parseAddress(address, target, targetLength)) { return false; }
+    // longest static or connected prefix that holds the address
+    int                 bestLength{-1};
+    string              bestPrefix;
+    std::vector<string> paths;
+    for (const auto& [key, route] : m_routes) {
+        std::array<uint8_t, 16> prefix;
+        int                     length;
+        if (route.vrf != vrf || !parseAddress(route.prefix, prefix, length) ||
+            length > targetLength || length < bestLength ||
+            !prefixContains(prefix, length, target)) {
+            continue;
+        }
+        if (length > bestLength) {
+            bestLength = length;
+            bestPrefix = route.prefix;
+            paths.clear();
+        }
+        string path{"{"};
+        appendMember(path, isAddress(route.nexthop) ? "ipnexthop" : "ifname",
+                     route.nexthop);
+        paths.push_back(path + "}");
+    }
+    for (const auto& connected : m_connected) {
+        if (connected.vrf != vrf || connected.length > targetLength ||
+            connected.length <= bestLength ||
+            !prefixContains(connected.address, connected.length, target)) {
+            continue;
+        }
+        bestLength = connected.length;
+        bestPrefix = connected.prefix;
+        paths.clear();
+        string path{"{"};
+        appendMember(path, "ifname", connected.ifName);
+        paths.push_back(path + "}");
+    }
+    out = R"({"body":{"TABLE_vrf":{"ROW_vrf":{)";
+    appendMember(out, "vrf-name-out", vrf);
+    out += R"(,"TABLE_addrf":{"ROW_addrf":{"addrf":"ipv6")";
+    if (bestLength >= 0) {
+        out += R"(,"TABLE_prefix":{"ROW_prefix":{)";
+        appendMember(out, "ipprefix", bestPrefix);
+        out += R"(,"attached":"true","TABLE_path":{"ROW_path":)";
+        // single path is an object like every single row of NX-OS
+        if (paths.size() == 1) {
+            out += paths.front();
+        } else {
+            out += '[';
+            for (size_t index = 0; index < paths.size(); ++index) {
+                if (index) { out += ','; }
+                out += paths[index];
+            }
+            out += ']';
+        }
+        out += "}}}";
+    }
+    out += "}}}}}";
+    return true;
+}
+
+void MockSwitch::handleLogin(const httplib::Request& request,
+                             httplib::Response&      response) {
+    countRequest(request);
+    auto parsed{json::parse(request.body, nullptr, /*allow_exceptions=*/false)};
+    if (!parsed.is_object() || !parsed.contains("aaaUser")) {
+        response.status = 400;
+        return;
+    }
+    string token;
+    {
+        std::unique_lock lock(m_mutex);
+        m_stats.logins++;
+        token = "mock-token-" + std::to_string(m_nextToken++);
+        m_tokens.insert(token);
+    }
+    json answer{{"imdata", {{{"aaaLogin", {{"attributes", {{"token", token}}}}}}}}};
+    response.set_content(answer.dump(), "application/json");
+}
+
+bool MockSwitch::authorizedDme(const httplib::Request& request) const {
+    static const string CookieName{"APIC-cookie="};
+    auto                cookie{request.get_header_value("Cookie")};
+    auto                start{cookie.find(CookieName)};
+    if (start == string::npos) { return false; }
+    start += CookieName.size();
+    auto token{cookie.substr(start, cookie.find(';', start) - start)};
+    std::unique_lock lock(m_mutex);
+    return m_tokens.count(token) != 0;
+}
+
+void MockSwitch::handleDme(const httplib::Request& request, httplib::Response& response) {
+    static const string DefaultDomPath{"/api/mo/sys/ipv6/inst/dom-default.json"};
+    static const string InstancePath{"/api/mo/sys/ipv6/inst.json"};
+    countRequest(request);
+    if (m_config.latency.count()) { std::this_thread::sleep_for(m_config.latency); }
+    if (!authorizedDme(request)) {
+        response.status = 403;
+        response.set_content(R"({"imdata":[{"error":{"attributes":)"
+                             R"({"code":"403","text":"Token was invalid"}}}]})",
+                             "application/json");
+        return;
+    }
+    bool defaultDom{request.path == DefaultDomPath};
+    if (!defaultDom && request.path != InstancePath) {
+        response.status = 404;
+        return;
+    }
+    if (request.method == "GET") {
+        // only filter of client is "eq(ipv6Nexthop.tag,"<tag>")"
+        string tag;
+        auto   filter{request.get_param_value("rsp-subtree-filter")};
+        auto   open{filter.find('"')};
+        if (open != string::npos) {
+            tag = filter.substr(open + 1, filter.find('"', open + 1) - open - 1);
+        }
+        string body;
+        getDmeRoutes(!defaultDom, tag, body);
+        response.set_content(body, "application/json");
+        return;
+    }
+    auto parsed{json::parse(request.body, nullptr, /*allow_exceptions=*/false)};
+    try {
+        std::unique_lock lock(m_mutex);
+        if (defaultDom) {
+            applyDmeDom("default", parsed.at("ipv6Dom"));
+        } else {
+            for (const auto& child : parsed.at("ipv6Inst").at("children")) {
+                const auto& dom{child.at("ipv6Dom")};
+                applyDmeDom(dom.at("attributes").at("name").get<string>(), dom);
+            }
+        }
+    } catch (const json::exception& ex) {
+        response.status = 400;
+        json error{{"imdata",
+                    {{{"error",
+                       {{"attributes", {{"code", "400"}, {"text", ex.what()}}}}}}}}};
+        response.set_content(error.dump(), "application/json");
+        return;
+    }
+    response.set_content(R"({"imdata":[]})", "application/json");
+}
+
+void MockSwitch::applyDmeDom(const string& vrf, const json& dom) {
+    for (const auto& child : dom.at("children")) {
+        const auto& route{child.at("ipv6Route")};
+        auto        prefix{route.at("attributes").at("prefix").get<string>()};
+        for (const auto& nexthopChild : route.at("children")) {
+            const auto& attributes{nexthopChild.at("ipv6Nexthop").at("attributes")};
+            auto        nhIf{attributes.value("nhIf", string("unspecified"))};
+            auto        nhAddr{attributes.value("nhAddr", string())};
+            string      nexthop{nhIf != "unspecified"
+                                        ? cliInterfaceName(nhIf)
+                                        : nhAddr.substr(0, nhAddr.find('/'))};
+            m_stats.commands++;
+            auto key{routeKey(vrf, prefix, nexthop)};
+            if (attributes.value("status", string()) == "deleted") {
+                m_routes.erase(key);
+                continue;
+            }
+            m_routes[key] = {vrf, prefix, nexthop, attributes.value("tag", string()),
+                             attributes.value("rtname", string())};
+        }
+    }
+}
+
+void MockSwitch::getDmeRoutes(bool allVrfs, const string& tag, string& out) const {
+    std::unique_lock lock(m_mutex);
+    // nexthops of a prefix are children of one `ipv6Route`
+    std::map<std::pair<string, string>, std::vector<const Route*>> byPrefix;
+    for (const auto& [key, route] : m_routes) {
+        if ((!allVrfs && route.vrf != "default") || (!tag.empty() && route.tag != tag)) {
+            continue;
+        }
+        byPrefix[{route.vrf, route.prefix}].push_back(&route);
+    }
+    json imdata = json::array();
+    for (const auto& [vrfPrefix, routes] : byPrefix) {
+        const auto& [vrf, prefix] {vrfPrefix};
+        json children = json::array();
+        for (const auto* route : routes) {
+            bool address{isAddress(route->nexthop)};
+            json attributes{
+                {"nhAddr", address ? route->nexthop + "/128" : string("::/128")},
+                {"nhIf",
+                 address ? string("unspecified") : dmeInterfaceName(route->nexthop)},
+                {"nhVrf", vrf}};
+            if (!route->tag.empty()) { attributes["tag"] = route->tag; }
+            if (!route->name.empty()) { attributes["rtname"] = route->name; }
+            children.push_back({{"ipv6Nexthop", {{"attributes", attributes}}}});
+        }
+        imdata.push_back(
+            {{"ipv6Route",
+              {{"attributes",
+                {{"dn", "sys/ipv6/inst/dom-" + vrf + "/rt-[" + prefix + "]"},
+                 {"prefix", prefix}}},
+               {"children", std::move(children)}}}});
+    }
+    json answer{{"totalCount", std::to_string(imdata.size())}, {"imdata", imdata}};
+    out = answer.dump();
+}
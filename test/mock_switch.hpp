@@ -0,0 +1,176 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json_fwd.hpp>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+
+namespace httplib {
+    class Server;
+    struct Request;
+    struct Response;
+}    // namespace httplib
+
+// NX-OS switch on loopback for tests and benchmarks. Answers NX-API JSON-RPC
+// CLI requests on "/ins" and DME requests under "/api", keeps static routes,
+// neighbors and connected prefixes in memory and counts what it served.
+// Plain HTTP or HTTPS with self-signed certificate generated on start
+class MockSwitch {
+  public:
+    struct Config {
+        bool tls{false};
+        // 0 binds any free port
+        int port{0};
+        // server threads, keep-alive connection holds one while it is open
+        size_t threads{128};
+        // delay of every response, time the switch spends in its CLI
+        std::chrono::milliseconds latency{0};
+        // requests of one connection before the switch closes it, 0 is unlimited
+        size_t keepAliveRequests{0};
+    };
+
+    struct Route {
+        string vrf;
+        string prefix;
+        // address or interface name in CLI form, e.g. "Vlan100"
+        string nexthop;
+        string tag;
+        string name;
+    };
+
+    struct Neighbor {
+        string vrf;
+        string ifName;
+        string address;
+        // "0011.2233.4455" form of NX-OS
+        string mac;
+    };
+
+    struct Stats {
+        uint64_t requests{0};
+        // CLI commands of NX-API and nexthop objects of DME
+        uint64_t commands{0};
+        uint64_t failedCommands{0};
+        uint64_t logins{0};
+        // connections are told apart by client port
+        uint64_t connections{0};
+        uint64_t resumedSessions{0};
+    };
+
+  public:
+    MockSwitch();
+    explicit MockSwitch(const Config& config);
+    ~MockSwitch();
+    MockSwitch(const MockSwitch&)            = delete;
+    MockSwitch& operator=(const MockSwitch&) = delete;
+
+    // binds port and serves on own threads, throws std::runtime_error on failure
+    void start();
+
+    void stop();
+
+    int port() const { return m_port; }
+
+    // "http://127.0.0.1:<port>/", "https://" with TLS
+    string url() const;
+
+    // `count` neighbors spread over `vlans` interfaces from "Vlan100",
+    // every interface gets connected prefix 2001:db8:<vlan>::/64
+    void populate(size_t count, size_t vlans);
+
+    void addNeighbor(const Neighbor& neighbor);
+
+    // lookup of address inside `prefix` resolves to `ifName`
+    void addConnectedRoute(const string& prefix,
+                           const string& ifName,
+                           const string& vrf = "default");
+
+    // switch reload: static routes are lost and uptime starts again
+    void reload();
+
+    // DME tokens issued before are rejected
+    void expireTokens();
+
+    std::vector<Route> routes() const;
+
+    size_t routeCount() const;
+
+    bool hasRoute(const string& prefix,
+                  const string& nexthop,
+                  const string& vrf = "default") const;
+
+    // routes programmed by other servers of the switch, e.g. gNMI stub
+    void setRoute(const Route& route);
+
+    // false if there is no such route
+    bool removeRoute(const string& prefix,
+                     const string& nexthop,
+                     const string& vrf = "default");
+
+    Stats stats() const;
+
+    void resetStats();
+
+    // writes key and self-signed certificate in PEM, e.g. for client credentials
+    static void writeSelfSignedCertificate(const string& certPath, const string& keyPath);
+
+  private:
+    struct Connected {
+        string                  vrf;
+        std::array<uint8_t, 16> address;
+        int                     length;
+        string                  prefix;
+        string                  ifName;
+    };
+
+    Config                           m_config;
+    std::unique_ptr<httplib::Server> m_server;
+    std::thread                      m_thread;
+    int                              m_port{0};
+
+    mutable std::mutex                    m_mutex;
+    std::map<string, Route>               m_routes;
+    std::vector<Neighbor>                 m_neighbors;
+    std::vector<Connected>                m_connected;
+    std::set<string>                      m_tokens;
+    uint64_t                              m_nextToken{1};
+    std::set<int>                         m_clientPorts;
+    Stats                                 m_stats;
+    std::chrono::steady_clock::time_point m_bootedAt;
+
+  private:
+    // counts request and its connection
+    void countRequest(const httplib::Request& request);
+
+    void handleNxApi(const httplib::Request& request, httplib::Response& response);
+
+    void handleLogin(const httplib::Request& request, httplib::Response& response);
+
+    void handleDme(const httplib::Request& request, httplib::Response& response);
+
+    bool authorizedDme(const httplib::Request& request) const;
+
+    // caller holds `m_mutex`. Returns false with `error` set on failed command,
+    // `result` is JSON text of "result" member
+    bool runCommand(const string& command, string& vrf, string& result, string& error);
+
+    void showVersion(string& out) const;
+    void showNeighbors(bool allVrfs, string& out) const;
+    void showStaticRoutes(bool allVrfs, string& out) const;
+    bool showRoute(const string& address, const string& vrf, string& out) const;
+
+    void applyDmeDom(const string& vrf, const nlohmann::json& dom);
+    void getDmeRoutes(bool allVrfs, const string& tag, string& out) const;
+
+    static string routeKey(const string& vrf,
+                           const string& prefix,
+                           const string& nexthop);
+};
@@ -0,0 +1,86 @@
+// Mock NX-OS switch for manual runs of Kea or replay tool against it.
+//
+// usage: nxos_mock_switch [-p port] [-s] [-n neighbors] [-v vlans] [-l latency-ms]
+//
+// Serves until SIGINT or SIGTERM and prints what it served
+#include "mock_switch.hpp"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <pthread.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+    void usage(const char* name) {
+        std::cerr << "usage: " << name
+                  << " [-p port] [-s] [-n neighbors] [-v vlans] [-l latency-ms]\n"
+                     "  -p  port on 127.0.0.1, any free port by default\n"
+                     "  -s  HTTPS with self-signed certificate\n"
+                     "  -n  neighbors of the switch (default 0)\n"
+                     "  -v  vlan interfaces neighbors are spread over (default 1)\n"
+                     "  -l  delay of every response (default 0)\n";
+    }
+
+    long parseNumber(const char* text) {
+        char* end{nullptr};
+        long  value{std::strtol(text, &end, 10)};
+        if (*text == '\0' || *end != '\0' || value < 0) {
+            throw std::invalid_argument(string("invalid number: ") + text);
+        }
+        return value;
+    }
+}    // namespace
+
+int main(int argc, char* argv[]) {
+    MockSwitch::Config config;
+    size_t             neighbors{0};
+    size_t             vlans{1};
+    try {
+        int opt;
+        while ((opt = getopt(argc, argv, "p:sn:v:l:")) != -1) {
+            switch (opt) {
+                case 'p': config.port = static_cast<int>(parseNumber(optarg)); break;
+                case 's': config.tls = true; break;
+                case 'n': neighbors = static_cast<size_t>(parseNumber(optarg)); break;
+                case 'v': vlans = static_cast<size_t>(parseNumber(optarg)); break;
+                case 'l':
+                    config.latency = std::chrono::milliseconds(parseNumber(optarg));
+                    break;
+                default: usage(argv[0]); return 2;
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        usage(argv[0]);
+        return 2;
+    }
+
+    // signals are taken by sigwait, not by handler on random thread
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    MockSwitch mock(config);
+    try {
+        mock.populate(neighbors, vlans);
+        mock.start();
+    } catch (const std::exception& ex) {
+        std::cerr << "mock switch failed: " << ex.what() << "\n";
+        return 1;
+    }
+    std::cout << "serving " << mock.url() << std::endl;
+    int signal;
+    sigwait(&signals, &signal);
+    mock.stop();
+
+    auto stats{mock.stats()};
+    std::cout << "requests: " << stats.requests << ", commands: " << stats.commands
+              << ", failed commands: " << stats.failedCommands
+              << ", logins: " << stats.logins << ", connections: " << stats.connections
+              << ", resumed sessions: " << stats.resumedSessions
+              << ", routes: " << mock.routeCount() << "\n";
+    return 0;
+}
@@ -0,0 +1,167 @@
+// Route apply and remove of resolved routes allocate nothing in steady state:
+// contexts are pooled, request and response buffers keep their capacity and
+// the asio engine reuses its connection. Every heap allocation of the process
+// is counted, so the mock switch runs in a child process
+#include "check.hpp"
+#include "client_fixture.hpp"
+#include "management_client.hpp"
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <dhcp/duid.h>
+#include <new>
+#include <sys/wait.h>
+
+namespace {
+    std::atomic<bool>     counting{false};
+    std::atomic<uint64_t> allocations{0};
+
+    void* countedAlloc(size_t size) {
+        if (counting.load(std::memory_order_relaxed)) {
+            allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (void* ptr = std::malloc(size ? size : 1)) { return ptr; }
+        throw std::bad_alloc();
+    }
+
+    void* countedAlignedAlloc(size_t size, std::align_val_t align) {
+        if (counting.load(std::memory_order_relaxed)) {
+            allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        auto alignment{std::max(static_cast<size_t>(align), sizeof(void*))};
+        void* ptr{nullptr};
+        if (posix_memalign(&ptr, alignment, size ? size : 1) == 0) { return ptr; }
+        throw std::bad_alloc();
+    }
+}    // namespace
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void* operator new(size_t size, std::align_val_t align) {
+    return countedAlignedAlloc(size, align);
+}
+void* operator new[](size_t size, std::align_val_t align) {
+    return countedAlignedAlloc(size, align);
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+namespace {
+    // operations before counting: pools, buffers and connection reach
+    // their steady state
+    constexpr size_t WarmupRounds{200};
+    constexpr size_t CountedRounds{1000};
+    constexpr size_t RoutesPerRound{4};
+
+    // serves until parent closes `control`, returns port through `portPipe`
+    [[noreturn]] void runMockSwitch(int portPipe, int control) {
+        MockSwitch mock;
+        mock.start();
+        int port{mock.port()};
+        if (write(portPipe, &port, sizeof(port)) != sizeof(port)) { _exit(1); }
+        char byte;
+        while (read(control, &byte, 1) > 0) {}
+        mock.stop();
+        _exit(0);
+    }
+
+    std::atomic<uint64_t> answered{0};
+    std::atomic<uint64_t> unanswered{0};
+
+    // one operation at a time, so requests never queue inside the engine
+    void runRound(ManagementClient& client, const std::vector<RouteExport>& routes) {
+        for (bool remove : {false, true}) {
+            for (const auto& route : routes) {
+                auto expected{answered.load() + 1};
+                if (remove) {
+                    client.removeRoutesFromSwitch(route);
+                } else {
+                    client.sendRoutesToSwitch(route);
+                }
+                auto deadline{std::chrono::steady_clock::now() +
+                              std::chrono::seconds(10)};
+                while (answered.load() < expected) {
+                    CHECK(!unanswered.load());
+                    CHECK(std::chrono::steady_clock::now() < deadline);
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+        }
+    }
+}    // namespace
+
+int main() {
+    // fork before any thread of the test is started
+    int portPipe[2];
+    int control[2];
+    CHECK(pipe(portPipe) == 0 && pipe(control) == 0);
+    pid_t child{fork()};
+    CHECK(child >= 0);
+    if (child == 0) {
+        close(portPipe[0]);
+        close(control[1]);
+        runMockSwitch(portPipe[1], control[0]);
+    }
+    close(portPipe[1]);
+    close(control[0]);
+    int port{0};
+    CHECK(read(portPipe[0], &port, sizeof(port)) == sizeof(port));
+
+    initTestLogger("nxos-allocation-test");
+    auto params{isc::data::Element::createMap()};
+    params->set("host", isc::data::Element::create("http://127.0.0.1:" +
+                                                   std::to_string(port) + "/"));
+    params->set("http-engine", isc::data::Element::create("asio"));
+    params->set("max-connections", isc::data::Element::create(1));
+    params->set("route-tag", isc::data::Element::create(7));
+    auto credentials{isc::data::Element::createMap()};
+    credentials->set("login", isc::data::Element::create("admin"));
+    credentials->set("password", isc::data::Element::create("admin"));
+    params->set("credentials", credentials);
+
+    IOThread io;
+    auto     client{ManagementClient::init("nxos", params)};
+    client->setTrafficObserver([](bool success) {
+        if (success) {
+            answered.fetch_add(1);
+        } else {
+            unanswered.fetch_add(1);
+        }
+    });
+    client->startClient(io.io());
+
+    // IA_PD routes and IA_NA routes of known interface need no lookup
+    auto duid{boost::make_shared<isc::dhcp::DUID>(std::vector<uint8_t>{
+        0x00, 0x03, 0x00, 0x01, 0x02, 0x00, 0x00, 0x00, 0x00, 0x01})};
+    auto vlan{InterfaceNames::intern("Vlan100")};
+    std::vector<RouteExport> routes;
+    for (uint32_t index = 0; index < RoutesPerRound / 2; ++index) {
+        IOAddress address{"2001:db8:100::" + std::to_string(index + 10)};
+        IOAddress prefix{"2001:db8:" + std::to_string(1000 + index) + "::"};
+        routes.push_back(RouteExport::makeIA_PD(index, 1, duid, address, prefix, 56));
+        routes.push_back(RouteExport::makeIA_NAFast(index, 1, duid, vlan, address));
+    }
+
+    for (size_t round = 0; round < WarmupRounds; ++round) { runRound(*client, routes); }
+    counting = true;
+    for (size_t round = 0; round < CountedRounds; ++round) { runRound(*client, routes); }
+    counting = false;
+
+    std::cout << "allocations in " << CountedRounds * routes.size() * 2
+              << " operations: " << allocations.load() << "\n";
+    CHECK_EQ(allocations.load(), uint64_t{0});
+
+    client->stopClient();
+    io.stop();
+    close(control[1]);
+    int status{0};
+    waitpid(child, &status, 0);
+    return 0;
+}
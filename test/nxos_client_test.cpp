@@ -0,0 +1,139 @@
+// Management clients against mock switch: routes of IA_PD and IA_NA leases
+// are applied, read back and removed through every transport of the library
+#include "check.hpp"
+#include "client_fixture.hpp"
+#include "management_client.hpp"
+#include <algorithm>
+#include <atomic>
+#include <dhcp/duid.h>
+#include <mutex>
+
+using isc::data::Element;
+using isc::data::ElementPtr;
+
+namespace {
+    const IOAddress RelayAddress{"2001:db8:100::1"};
+    const IOAddress IA_NAAddress{"2001:db8:100::10"};
+    const IOAddress IA_PDPrefix{"2001:db8:1000::"};
+    const char      NeighborMac[]{"0200.0000.0010"};
+
+    struct TestCase {
+        const char* name;
+        const char* connectionType;
+        const char* engine;
+        bool        tls;
+    };
+
+    isc::dhcp::DuidPtr testDuid() {
+        return boost::make_shared<isc::dhcp::DUID>(std::vector<uint8_t>{
+            0x00, 0x03, 0x00, 0x01, 0x02, 0x00, 0x00, 0x00, 0x00, 0x10});
+    }
+
+    ManagementClient::InstalledRoutesPtr getInstalledRoutes(ManagementClient& client) {
+        std::mutex                           mutex;
+        ManagementClient::InstalledRoutesPtr result;
+        std::atomic<bool>                    done{false};
+        bool                                 failed{false};
+        client.asyncGetInstalledRoutes(
+            [&](ManagementClient::InstalledRoutesPtr routes, bool readFailed) {
+                std::unique_lock lock(mutex);
+                result = std::move(routes);
+                failed = readFailed;
+                done   = true;
+            });
+        CHECK(waitFor([&] { return done.load(); }));
+        std::unique_lock lock(mutex);
+        CHECK(!failed);
+        CHECK(result);
+        return result;
+    }
+
+    ManagementClient::HWAddrMapPtr getNeighbors(ManagementClient& client) {
+        std::mutex                     mutex;
+        ManagementClient::HWAddrMapPtr result;
+        std::atomic<bool>              done{false};
+        bool                           failed{false};
+        client.asyncGetHWAddrToInterfaceNameMapping(
+            [&](ManagementClient::HWAddrMapPtr neighbors, bool readFailed) {
+                std::unique_lock lock(mutex);
+                result = std::move(neighbors);
+                failed = readFailed;
+                done   = true;
+            });
+        CHECK(waitFor([&] { return done.load(); }));
+        std::unique_lock lock(mutex);
+        CHECK(!failed);
+        CHECK(result);
+        return result;
+    }
+
+    bool hasInstalledRoute(const ManagementClient::InstalledRoutes& routes,
+                           const string&                            prefix,
+                           const string&                            nexthop) {
+        return std::any_of(routes.begin(), routes.end(), [&](const auto& route) {
+            return route.prefix == prefix && route.nexthop == nexthop &&
+                   route.vrfId == DefaultVrfId;
+        });
+    }
+
+    void runCase(const TestCase& test) {
+        std::cout << test.name << "\n";
+        MockSwitch::Config config;
+        config.tls = test.tls;
+        MockSwitch mock(config);
+        mock.start();
+        mock.addConnectedRoute("2001:db8:100::/64", "Vlan100");
+        mock.addNeighbor({"default", "Vlan100", IA_NAAddress.toText(), NeighborMac});
+        // neighbor of non-vlan interface isn't mapped
+        mock.addNeighbor({"default", "Ethernet1/1", "2001:db8:200::1", "0200.0000.0020"});
+
+        TempDir    dir;
+        ElementPtr params{mockConnectionParams(mock, dir, test.engine)};
+        params->set("route-tag", Element::create(7));
+        IOThread io;
+        auto     client{ManagementClient::init(test.connectionType, params)};
+        client->startClient(io.io());
+
+        auto duid{testDuid()};
+        auto pdRoute{RouteExport::makeIA_PD(1, 1, duid, IA_NAAddress, IA_PDPrefix, 56)};
+        auto naRoute{RouteExport::makeIA_NA(2, 1, duid, RelayAddress, IA_NAAddress)};
+        client->sendRoutesToSwitch(pdRoute);
+        // relay link-address is looked up on the switch first
+        client->sendRoutesToSwitch(naRoute);
+        CHECK(waitFor(
+            [&] { return mock.hasRoute("2001:db8:1000::/56", "2001:db8:100::10"); }));
+        CHECK(waitFor([&] { return mock.hasRoute("2001:db8:100::10/128", "Vlan100"); }));
+        for (const auto& route : mock.routes()) { CHECK_EQ(route.tag, string("7")); }
+
+        auto installed{getInstalledRoutes(*client)};
+        CHECK_EQ(installed->size(), size_t{2});
+        CHECK(hasInstalledRoute(*installed, "2001:db8:1000::/56", "2001:db8:100::10"));
+        CHECK(hasInstalledRoute(*installed, "2001:db8:100::10/128", "Vlan100"));
+
+        auto neighbors{getNeighbors(*client)};
+        CHECK_EQ(neighbors->size(), size_t{1});
+        HWAddrInterfaceMap::MacKey mac;
+        CHECK(HWAddrInterfaceMap::parseCiscoMac(NeighborMac, mac));
+        CHECK_EQ(InterfaceNames::name(neighbors->find(mac)), string("Vlan100"));
+
+        client->removeRoutesFromSwitch(pdRoute);
+        client->removeRoutesFromSwitch(naRoute);
+        CHECK(waitFor([&] { return mock.routeCount() == 0; }));
+        CHECK_EQ(mock.stats().failedCommands, uint64_t{0});
+
+        client->stopClient();
+        io.stop();
+    }
+}    // namespace
+
+int main() {
+    initTestLogger("nxos-client-test");
+    const TestCase cases[]{
+        {"nxos over httplib", "nxos", "httplib", false},
+        {"nxos over asio engine", "nxos", "asio", false},
+        {"nxos over https", "nxos", "httplib", true},
+        {"nxos-rest", "nxos-rest", "httplib", false},
+    };
+    for (const auto& test : cases) { runCase(test); }
+    return 0;
+}
@@ -0,0 +1,88 @@
+// "nxos-gnmi" client against gNMI stub server: routes are batched into Set
+// requests, read back with Get and removed, while IA_NA lookups still go
+// over NX-API of the mock switch behind the stub
+#include "check.hpp"
+#include "client_fixture.hpp"
+#include "gnmi_stub_server.hpp"
+#include <algorithm>
+#include <mutex>
+
+using isc::data::Element;
+using isc::data::ElementPtr;
+
+namespace {
+    constexpr size_t PdRoutes{100};
+
+    ManagementClient::InstalledRoutesPtr getInstalledRoutes(ManagementClient& client) {
+        std::mutex                           mutex;
+        ManagementClient::InstalledRoutesPtr result;
+        std::atomic<bool>                    done{false};
+        bool                                 failed{false};
+        client.asyncGetInstalledRoutes(
+            [&](ManagementClient::InstalledRoutesPtr routes, bool readFailed) {
+                std::unique_lock lock(mutex);
+                result = std::move(routes);
+                failed = readFailed;
+                done   = true;
+            });
+        CHECK(waitFor([&] { return done.load(); }));
+        std::unique_lock lock(mutex);
+        CHECK(!failed);
+        CHECK(result);
+        return result;
+    }
+}    // namespace
+
+int main() {
+    initTestLogger("nxos-gnmi-test");
+    MockSwitch mock;
+    mock.start();
+    mock.addConnectedRoute("2001:db8:100::/64", "Vlan100");
+    GnmiStubServer gnmi(mock);
+    gnmi.start();
+
+    TempDir    dir;
+    ElementPtr params{mockConnectionParams(mock, dir)};
+    params->set("gnmi-port", Element::create(gnmi.port()));
+    params->set("route-tag", Element::create(7));
+    IOThread io;
+    auto     client{ManagementClient::init("nxos-gnmi", params)};
+    client->startClient(io.io());
+
+    auto pdRoutes{makePdRoutes(PdRoutes)};
+    // address outside of IA_NA range of IA_PD nexthops
+    auto naRoute{RouteExport::makeIA_NA(1, 1, indexedDuid(PdRoutes),
+                                        IOAddress("2001:db8:100::1"),
+                                        IOAddress("2001:db8:100::8"))};
+    for (const auto& route : pdRoutes) { client->sendRoutesToSwitch(route); }
+    // relay link-address is looked up over NX-API first
+    client->sendRoutesToSwitch(naRoute);
+    CHECK(waitFor([&] { return mock.routeCount() == PdRoutes + 1; }));
+    CHECK(mock.hasRoute("2001:db8:1000::/56", "2001:db8:100::10"));
+    CHECK(mock.hasRoute("2001:db8:100::8/128", "Vlan100"));
+    for (const auto& route : mock.routes()) { CHECK_EQ(route.tag, string("7")); }
+    auto stats{gnmi.stats()};
+    CHECK_EQ(stats.updates, uint64_t{PdRoutes + 1});
+    // operations of one batch interval share a Set
+    CHECK(stats.sets < stats.updates);
+
+    auto installed{getInstalledRoutes(*client)};
+    CHECK_EQ(installed->size(), PdRoutes + 1);
+    CHECK(std::any_of(installed->begin(), installed->end(), [](const auto& route) {
+        return route.prefix == "2001:db8:1000::/56" &&
+               route.nexthop == "2001:db8:100::10";
+    }));
+
+    for (const auto& route : pdRoutes) { client->removeRoutesFromSwitch(route); }
+    client->removeRoutesFromSwitch(naRoute);
+    CHECK(waitFor([&] { return mock.routeCount() == 0; }));
+    stats = gnmi.stats();
+    CHECK_EQ(stats.deletes, uint64_t{PdRoutes + 1});
+    CHECK_EQ(stats.failedRequests, uint64_t{0});
+    CHECK_EQ(mock.stats().failedCommands, uint64_t{0});
+
+    client->stopClient();
+    io.stop();
+    gnmi.stop();
+    return 0;
+}
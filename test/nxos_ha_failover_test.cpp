@@ -0,0 +1,283 @@
+// Failover of HA hot-standby pair: two exporter instances run in processes of
+// their own, as two Kea servers, and write to one mock switch. Every instance
+// answers in-process `status-get` with HA state set by the test, in place of
+// the HA hooks library of Kea. Both see every lease, as with HA lease sync,
+// only primary writes to the switch and standby keeps shadow state. Primary
+// is killed, standby goes to partner-down and replays shadow state, so routes
+// of leases primary never wrote reach the switch
+#include "check.hpp"
+#include "client_fixture.hpp"
+#include "dhcp6_exporter_service.hpp"
+#include <cc/command_interpreter.h>
+#include <config/command_mgr.h>
+#include <csignal>
+#include <cstring>
+#include <dhcpsrv/cfgmgr.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <future>
+#include <sys/wait.h>
+
+using isc::data::ConstElementPtr;
+using isc::data::Element;
+
+namespace {
+    constexpr size_t SyncedRoutes{100};
+    // first synced routes are removed while primary runs
+    constexpr size_t RemovedRoutes{10};
+    // leases standby gets after primary stopped writing
+    constexpr size_t UnwrittenRoutes{10};
+    constexpr size_t PollIntervalMs{50};
+
+    // command of the test to an instance, every command is answered with `Status`
+    struct Command {
+        enum Op : char { STATE, EXPORT, REMOVE, STATUS, EXIT };
+
+        Op     op{STATUS};
+        size_t first{0};
+        size_t count{0};
+        char   state[32]{};
+    };
+
+    struct Status {
+        // HA state set by the test is seen by the exporter
+        bool     synced{false};
+        bool     owner{false};
+        bool     fullStateOwner{false};
+        uint64_t shadowLeases{0};
+        uint64_t replayed{0};
+        uint64_t takeovers{0};
+    };
+
+    struct Instance {
+        pid_t pid{-1};
+        int   commands{-1};
+        int   replies{-1};
+    };
+
+    // HA state of this instance as the HA hooks library would report it
+    std::mutex haMutex;
+    string     haServer;
+    string     haRole;
+    string     haState;
+
+    ConstElementPtr statusGet(const string&, const ConstElementPtr&) {
+        std::unique_lock lock(haMutex);
+        auto             local{Element::createMap()};
+        local->set("server-name", Element::create(haServer));
+        local->set("role", Element::create(haRole));
+        local->set("state", Element::create(haState));
+        auto servers{Element::createMap()};
+        servers->set("local", local);
+        auto relationship{Element::createMap()};
+        relationship->set("ha-mode", Element::create("hot-standby"));
+        relationship->set("ha-servers", servers);
+        auto relationships{Element::createList()};
+        relationships->add(relationship);
+        auto args{Element::createMap()};
+        args->set("high-availability", relationships);
+        return isc::config::createAnswer(isc::config::CONTROL_RESULT_SUCCESS, args);
+    }
+
+    uint64_t counter(const ConstElementPtr& stats, const char* name) {
+        return static_cast<uint64_t>(stats->get(name)->intValue());
+    }
+
+    Status instanceStatus(DHCP6ExporterService& service) {
+        auto   ha{service.haStatus()};
+        Status status;
+        {
+            std::unique_lock lock(haMutex);
+            status.synced = ha->get("state")->stringValue() == haState;
+        }
+        status.owner          = ha->get("owner")->boolValue();
+        status.fullStateOwner = ha->get("full-state-owner")->boolValue();
+        status.shadowLeases   = counter(ha, "shadow-leases");
+        status.replayed       = counter(ha, "replayed");
+        status.takeovers      = counter(ha, "takeovers");
+        return status;
+    }
+
+    // exporter of one server, runs commands of the test until EXIT
+    [[noreturn]] void runInstance(const char* name,
+                                  const char* role,
+                                  int         commands,
+                                  int         replies) {
+        {
+            std::unique_lock lock(haMutex);
+            haServer = name;
+            haRole   = role;
+            haState  = "waiting";
+        }
+        int port{0};
+        if (read(commands, &port, sizeof(port)) != sizeof(port)) { _exit(1); }
+        initTestLogger("nxos-ha-failover-test");
+        isc::config::CommandMgr::instance().registerCommand("status-get", statusGet);
+        isc::dhcp::CfgMgr::instance().setFamily(AF_INET6);
+        isc::dhcp::LeaseMgrFactory::create("type=memfile universe=6 persist=false");
+
+        auto connParams{Element::createMap()};
+        connParams->set("host", Element::create("http://127.0.0.1:" +
+                                                std::to_string(port) + "/"));
+        auto credentials{Element::createMap()};
+        credentials->set("login", Element::create("admin"));
+        credentials->set("password", Element::create("admin"));
+        connParams->set("credentials", credentials);
+        auto ha{Element::createMap()};
+        ha->set("server-name", Element::create(name));
+        ha->set("poll-interval", Element::create(static_cast<long long>(PollIntervalMs)));
+
+        IOThread io;
+        auto     service{std::make_shared<DHCP6ExporterService>(
+            DHCP6ExporterService::Params{Element::create("nxos"), connParams, nullptr,
+                                         nullptr, ha, nullptr})};
+        service->setIOService(io.ioPtr());
+        service->startService();
+
+        auto    routes{makePdRoutes(SyncedRoutes + UnwrittenRoutes)};
+        Command command;
+        while (read(commands, &command, sizeof(command)) == sizeof(command)) {
+            switch (command.op) {
+                case Command::STATE: {
+                    std::unique_lock lock(haMutex);
+                    haState = command.state;
+                    break;
+                }
+                case Command::EXPORT:
+                case Command::REMOVE:
+                    for (size_t index = command.first;
+                         index < command.first + command.count; ++index) {
+                        if (command.op == Command::EXPORT) {
+                            service->exportRoute(routes[index]);
+                        } else {
+                            service->removeRoute(routes[index]);
+                        }
+                    }
+                    break;
+                case Command::STATUS: break;
+                case Command::EXIT: {
+                    // service is stopped on IOService thread as in the server
+                    std::promise<void> stopped;
+                    io.io().post([&] {
+                        service->stopService();
+                        stopped.set_value();
+                    });
+                    stopped.get_future().wait();
+                    io.stop();
+                    break;
+                }
+            }
+            auto status{instanceStatus(*service)};
+            if (write(replies, &status, sizeof(status)) != sizeof(status)) { _exit(1); }
+            if (command.op == Command::EXIT) { _exit(0); }
+        }
+        _exit(1);
+    }
+
+    Instance startInstance(const char* name, const char* role) {
+        int commands[2];
+        int replies[2];
+        CHECK(pipe(commands) == 0 && pipe(replies) == 0);
+        pid_t child{fork()};
+        CHECK(child >= 0);
+        if (child == 0) {
+            close(commands[1]);
+            close(replies[0]);
+            runInstance(name, role, commands[0], replies[1]);
+        }
+        close(commands[0]);
+        close(replies[1]);
+        return {child, commands[1], replies[0]};
+    }
+
+    Status run(const Instance& instance, Command command) {
+        CHECK(write(instance.commands, &command, sizeof(command)) == sizeof(command));
+        Status status;
+        CHECK(read(instance.replies, &status, sizeof(status)) == sizeof(status));
+        return status;
+    }
+
+    void setState(const Instance& instance, const char* state) {
+        Command command{Command::STATE};
+        std::strncpy(command.state, state, sizeof(command.state) - 1);
+        run(instance, command);
+        CHECK(waitFor([&] { return run(instance, {Command::STATUS}).synced; }));
+    }
+
+    void exportRoutes(const Instance& instance, size_t first, size_t count) {
+        run(instance, {Command::EXPORT, first, count});
+    }
+
+    void removeRoutes(const Instance& instance, size_t first, size_t count) {
+        run(instance, {Command::REMOVE, first, count});
+    }
+
+    string pdPrefix(size_t index) {
+        return offsetAddress(IOAddress("2001:db8:1000::"), index, 56).toText() + "/56";
+    }
+
+    string pdNexthop(size_t index) {
+        return offsetAddress(IOAddress("2001:db8:100::"), index + 16, 128).toText();
+    }
+}    // namespace
+
+int main() {
+    // fork before any thread of the test is started
+    auto primary{startInstance("server1", "primary")};
+    auto standby{startInstance("server2", "standby")};
+
+    initTestLogger("nxos-ha-failover-test");
+    MockSwitch mock;
+    mock.start();
+    int port{mock.port()};
+    for (const auto& instance : {primary, standby}) {
+        CHECK(write(instance.commands, &port, sizeof(port)) == sizeof(port));
+    }
+    setState(primary, "hot-standby");
+    setState(standby, "hot-standby");
+    auto status{run(primary, {Command::STATUS})};
+    CHECK(status.owner && status.fullStateOwner);
+    CHECK(!run(standby, {Command::STATUS}).owner);
+
+    // lease sync: both servers see every lease, only primary writes
+    for (const auto& instance : {primary, standby}) {
+        exportRoutes(instance, 0, SyncedRoutes);
+    }
+    CHECK(waitFor([&] { return mock.routeCount() == SyncedRoutes; }));
+    for (const auto& instance : {primary, standby}) {
+        removeRoutes(instance, 0, RemovedRoutes);
+    }
+    CHECK(waitFor([&] { return mock.routeCount() == SyncedRoutes - RemovedRoutes; }));
+    // latest operation of every lease, removals included
+    CHECK_EQ(run(standby, {Command::STATUS}).shadowLeases, uint64_t{SyncedRoutes});
+
+    // primary dies after leases were synced to standby but before it wrote them
+    kill(primary.pid, SIGKILL);
+    CHECK(waitpid(primary.pid, nullptr, 0) == primary.pid);
+    exportRoutes(standby, SyncedRoutes, UnwrittenRoutes);
+    std::this_thread::sleep_for(std::chrono::milliseconds(PollIntervalMs * 4));
+    CHECK_EQ(mock.routeCount(), SyncedRoutes - RemovedRoutes);
+
+    setState(standby, "partner-down");
+    status = run(standby, {Command::STATUS});
+    CHECK(status.owner && status.fullStateOwner);
+    CHECK_EQ(status.takeovers, uint64_t{1});
+    CHECK_EQ(status.replayed, uint64_t{SyncedRoutes + UnwrittenRoutes});
+    CHECK_EQ(status.shadowLeases, uint64_t{0});
+    const size_t installedRoutes{SyncedRoutes - RemovedRoutes + UnwrittenRoutes};
+    CHECK(waitFor([&] { return mock.routeCount() == installedRoutes; }));
+    for (size_t index = 0; index < SyncedRoutes + UnwrittenRoutes; ++index) {
+        CHECK_EQ(mock.hasRoute(pdPrefix(index), pdNexthop(index)),
+                 index >= RemovedRoutes);
+    }
+
+    // standby serving alone writes directly
+    removeRoutes(standby, SyncedRoutes, UnwrittenRoutes);
+    CHECK(waitFor([&] { return mock.routeCount() == SyncedRoutes - RemovedRoutes; }));
+    // only replayed removals of routes primary already removed may fail
+    CHECK(mock.stats().failedCommands <= RemovedRoutes);
+
+    run(standby, {Command::EXIT});
+    CHECK(waitpid(standby.pid, nullptr, 0) == standby.pid);
+    mock.stop();
+    return 0;
+}
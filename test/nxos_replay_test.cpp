@@ -0,0 +1,92 @@
+// Replay tool against mock switch: lease events written by `LeaseCapture`
+// are replayed by `nxos_dhcp6_exporter_replay` and routes left on the switch
+// must be those of the capture
+//
+// usage: nxos_replay_test path-to-nxos_dhcp6_exporter_replay
+#include "check.hpp"
+#include "client_fixture.hpp"
+#include "lease_capture.hpp"
+#include <fstream>
+#include <sys/wait.h>
+
+using isc::data::Element;
+
+namespace {
+    constexpr size_t PdRoutes{100};
+    // first routes of the capture are removed, the next one is reclaimed
+    constexpr size_t RemovedRoutes{10};
+
+    string pdPrefix(size_t index) {
+        return offsetAddress(IOAddress("2001:db8:1000::"), index, 56).toText() + "/56";
+    }
+
+    string pdNexthop(size_t index) {
+        return offsetAddress(IOAddress("2001:db8:100::"), index + 16, 128).toText();
+    }
+
+    void writeCapture(const string& path) {
+        LeaseCapture capture(LeaseCapture::Config{path});
+        auto         routes{makePdRoutes(PdRoutes)};
+        for (const auto& route : routes) {
+            capture.record(LeaseCapture::Event::EXPORT, route);
+        }
+        // relay link-address of IA_NA is looked up on the switch
+        auto naRoute{RouteExport::makeIA_NA(1, 1, indexedDuid(PdRoutes),
+                                            IOAddress("2001:db8:100::1"),
+                                            IOAddress("2001:db8:100::8"))};
+        capture.record(LeaseCapture::Event::EXPORT, naRoute);
+        for (size_t index = 0; index < RemovedRoutes; ++index) {
+            capture.record(LeaseCapture::Event::REMOVE, routes[index]);
+        }
+        capture.record(LeaseCapture::Event::RECLAIM, routes[RemovedRoutes]);
+        capture.stop();
+        CHECK_EQ(capture.stats().events, uint64_t{PdRoutes + RemovedRoutes + 2});
+    }
+
+    void writeParameters(const string& path, const MockSwitch& mock, const TempDir& dir) {
+        auto parameters{Element::createMap()};
+        parameters->set("connection-type", Element::create("nxos"));
+        parameters->set("connection-params", mockConnectionParams(mock, dir));
+        auto library{Element::createMap()};
+        library->set("parameters", parameters);
+        std::ofstream file(path);
+        file << library->str();
+        CHECK(file.good());
+    }
+}    // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " path-to-nxos_dhcp6_exporter_replay\n";
+        return 2;
+    }
+    initTestLogger("nxos-replay-test");
+    MockSwitch mock;
+    mock.start();
+    mock.addConnectedRoute("2001:db8:100::/64", "Vlan100");
+
+    TempDir dir;
+    auto    capturePath{dir.file("lease.capture")};
+    auto    paramsPath{dir.file("parameters.json")};
+    writeCapture(capturePath);
+    writeParameters(paramsPath, mock, dir);
+
+    string command{string(argv[1]) + " -s max -w 2000 -d 3000 '" + paramsPath + "' '" +
+                   capturePath + "'"};
+    int status{std::system(command.c_str())};
+    CHECK(status != -1 && WIFEXITED(status));
+    CHECK_EQ(WEXITSTATUS(status), 0);
+
+    // IA_PD routes without removed and reclaimed ones, and IA_NA route
+    const size_t installedRoutes{PdRoutes - RemovedRoutes - 1 + 1};
+    CHECK(waitFor([&] { return mock.routeCount() == installedRoutes; }));
+    for (size_t index = 0; index <= RemovedRoutes; ++index) {
+        CHECK(!mock.hasRoute(pdPrefix(index), pdNexthop(index)));
+    }
+    for (size_t index = RemovedRoutes + 1; index < PdRoutes; ++index) {
+        CHECK(mock.hasRoute(pdPrefix(index), pdNexthop(index)));
+    }
+    CHECK(mock.hasRoute("2001:db8:100::8/128", "Vlan100"));
+    CHECK_EQ(mock.stats().failedCommands, uint64_t{0});
+    return 0;
+}
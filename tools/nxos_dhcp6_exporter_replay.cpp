@@ -0,0 +1,225 @@
+// Replays lease events captured by the hooks library ("capture" parameter)
+// through DHCP6ExporterService outside of Kea server, so changes can be
+// benchmarked on production traffic against a lab or mock switch.
+//
+// usage: nxos_dhcp6_exporter_replay [-s speed] [-w warmup-ms] [-d drain-ms] [-v]
+//                                   parameters.json capture-file
+//
+// parameters.json holds "parameters" of the hooks library from Kea config.
+// Speed 1 keeps captured pacing, 10 replays ten times faster,
+// 0 or "max" sends events as fast as possible
+#include "dhcp6_exporter_service.hpp"
+#include "lease_capture.hpp"
+#include <algorithm>
+#include <cc/data.h>
+#include <chrono>
+#include <cstdlib>
+#include <dhcpsrv/cfgmgr.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <iostream>
+#include <log/logger_support.h>
+#include <optional>
+#include <thread>
+#include <unistd.h>
+
+using isc::data::Element;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    struct Options {
+        // 0 is as fast as possible
+        double speed{1.0};
+        // heartbeat connects to the switch before the first event
+        long warmupMs{5000};
+        // operations in flight are answered before service is stopped
+        long   drainMs{5000};
+        bool   verbose{false};
+        string paramsPath;
+        string capturePath;
+    };
+
+    struct ReplayStats {
+        uint64_t events{0};
+        uint64_t exports{0};
+        uint64_t removes{0};
+        uint64_t reclaims{0};
+        // time between the first and the last captured event
+        int64_t capturedUs{0};
+        int64_t replayedUs{0};
+    };
+
+    void usage(const char* name) {
+        std::cerr << "usage: " << name
+                  << " [-s speed] [-w warmup-ms] [-d drain-ms] [-v]"
+                     " parameters.json capture-file\n"
+                     "  -s  1 keeps captured pacing, 10 is ten times faster,"
+                     " 0 or max is as fast as possible (default 1)\n"
+                     "  -w  wait for connection to the switch before replay"
+                     " (default 5000)\n"
+                     "  -d  wait for operations in flight after replay (default 5000)\n"
+                     "  -v  debug logging\n";
+    }
+
+    long parseMs(const char* text) {
+        char* end{nullptr};
+        long  value{std::strtol(text, &end, 10)};
+        if (*text == '\0' || *end != '\0' || value < 0) {
+            isc_throw(isc::BadValue, "invalid time: " << text);
+        }
+        return value;
+    }
+
+    Options parseOptions(int argc, char* argv[]) {
+        Options options;
+        int     opt;
+        while ((opt = getopt(argc, argv, "s:w:d:v")) != -1) {
+            switch (opt) {
+                case 's': {
+                    if (string(optarg) == "max") {
+                        options.speed = 0;
+                        break;
+                    }
+                    char* end{nullptr};
+                    options.speed = std::strtod(optarg, &end);
+                    if (*optarg == '\0' || *end != '\0' || options.speed < 0) {
+                        isc_throw(isc::BadValue, "invalid speed: " << optarg);
+                    }
+                } break;
+                case 'w': options.warmupMs = parseMs(optarg); break;
+                case 'd': options.drainMs = parseMs(optarg); break;
+                case 'v': options.verbose = true; break;
+                default: usage(argv[0]); std::exit(2);
+            }
+        }
+        if (argc - optind != 2) {
+            usage(argv[0]);
+            std::exit(2);
+        }
+        options.paramsPath  = argv[optind];
+        options.capturePath = argv[optind + 1];
+        return options;
+    }
+
+    DHCP6ExporterService::Params loadParams(const string& path) {
+        ConstElementPtr config{Element::fromJSONFile(path)};
+        if (config->getType() != Element::map) {
+            isc_throw(isc::BadValue, "parameters must be a map: " << path);
+        }
+        // whole entry of "hooks-libraries" is accepted too
+        if (config->get("parameters")) { config = config->get("parameters"); }
+        auto connType{config->get("connection-type")};
+        if (!connType || connType->getType() != Element::string) {
+            isc_throw(isc::BadValue, "parameter \"connection-type\" must be a string");
+        }
+        auto connParams{config->get("connection-params")};
+        if (!connParams || connParams->getType() != Element::map) {
+            isc_throw(isc::BadValue, "parameter \"connection-params\" must be a map");
+        }
+        // there is no HA partner to ask for ownership, replay is the only writer
+        if (config->get("ha")) {
+            std::cerr << "parameter \"ha\" is ignored, replay writes to the switch\n";
+        }
+        return {connType,
+                connParams,
+                config->get("flap-damping"),
+                config->get("spool"),
+                ConstElementPtr(),
+                config->get("subnet-vrfs")};
+    }
+
+    ReplayStats replay(DHCP6ExporterService& service, const Options& options) {
+        LeaseCaptureReader     reader(options.capturePath);
+        LeaseCapture::Record   record;
+        ReplayStats            stats;
+        std::optional<int64_t> firstUs;
+        auto                   startedAt{Clock::now()};
+        while (reader.next(record)) {
+            if (!firstUs) { firstUs = record.timeUs; }
+            // events of concurrent packet threads may be slightly out of order
+            int64_t offsetUs{std::max<int64_t>(record.timeUs - *firstUs, 0)};
+            stats.capturedUs = std::max(stats.capturedUs, offsetUs);
+            if (options.speed > 0) {
+                std::this_thread::sleep_until(
+                    startedAt + std::chrono::microseconds(static_cast<int64_t>(
+                                    static_cast<double>(offsetUs) / options.speed)));
+            }
+            switch (record.event) {
+                case LeaseCapture::Event::EXPORT: {
+                    service.exportRoute(record.route);
+                    stats.exports++;
+                } break;
+                case LeaseCapture::Event::REMOVE: {
+                    service.removeRoute(record.route);
+                    stats.removes++;
+                } break;
+                case LeaseCapture::Event::RECLAIM: {
+                    service.reclaimRoute(record.route);
+                    stats.reclaims++;
+                } break;
+            }
+            stats.events++;
+        }
+        stats.replayedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                               Clock::now() - startedAt)
+                               .count();
+        return stats;
+    }
+
+    void printStats(const ReplayStats& stats, DHCP6ExporterService& service) {
+        double replayedSec{static_cast<double>(stats.replayedUs) / 1e6};
+        std::cout << "events: " << stats.events << " (export: " << stats.exports
+                  << ", remove: " << stats.removes << ", reclaim: " << stats.reclaims
+                  << ")\n"
+                  << "captured: " << static_cast<double>(stats.capturedUs) / 1e6
+                  << " s, replayed: " << replayedSec << " s, rate: "
+                  << (replayedSec > 0 ? static_cast<double>(stats.events) / replayedSec
+                                      : 0)
+                  << " events/s\n";
+        auto workerPools{service.workerPoolStats()};
+        auto flapDamping{service.flapDampingStats()};
+        auto spool{service.spoolStats()};
+        if (workerPools) { std::cout << "worker-pools: " << workerPools->str() << "\n"; }
+        if (flapDamping) { std::cout << "flap-damping: " << flapDamping->str() << "\n"; }
+        if (spool) { std::cout << "spool: " << spool->str() << "\n"; }
+    }
+}    // namespace
+
+int main(int argc, char* argv[]) {
+    auto options{parseOptions(argc, argv)};
+    isc::log::initLogger("nxos-dhcp6-exporter-replay",
+                         options.verbose ? isc::log::DEBUG : isc::log::INFO,
+                         options.verbose ? isc::log::MAX_DEBUG_LEVEL : 0);
+    try {
+        // restore after heartbeat connects reads empty lease database
+        isc::dhcp::CfgMgr::instance().setFamily(AF_INET6);
+        isc::dhcp::LeaseMgrFactory::create("type=memfile universe=6 persist=false");
+
+        auto io_service{boost::make_shared<IOService>()};
+        auto service{boost::make_shared<DHCP6ExporterService>(
+            loadParams(options.paramsPath))};
+        service->setIOService(io_service);
+        service->startService();
+        // IOService thread of the server, events come from packet threads
+        std::thread ioThread([io_service] { io_service->run(); });
+
+        string error;
+        try {
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.warmupMs));
+            auto stats{replay(*service, options)};
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.drainMs));
+            printStats(stats, *service);
+        } catch (const std::exception& ex) { error = ex.what(); }
+
+        io_service->post([service, io_service] {
+            service->stopService();
+            io_service->stop();
+        });
+        ioThread.join();
+        isc::dhcp::LeaseMgrFactory::destroy();
+        if (!error.empty()) { isc_throw(isc::Unexpected, error); }
+    } catch (const std::exception& ex) {
+        std::cerr << "replay failed: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}